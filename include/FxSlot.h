@@ -29,6 +29,11 @@ namespace plug
     class FxSlot
     {
     public:
+        constexpr FxSlot()
+            : id_(0)
+        {
+        }
+
         constexpr explicit FxSlot(std::uint8_t id)
             : id_(checkRange(id))
         {
@@ -44,10 +49,15 @@ namespace plug
             return id_ >= 4;
         }
 
+        static constexpr bool isValid(std::uint8_t id)
+        {
+            return id <= 7;
+        }
+
     private:
         constexpr std::uint8_t checkRange(std::uint8_t value) const
         {
-            if (value > 7)
+            if (isValid(value) == false)
             {
                 throw std::invalid_argument{"Slot ID out of range: " + std::to_string(value)};
             }
@@ -0,0 +1,148 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "effects_enum.h"
+#include <string_view>
+
+namespace plug
+{
+
+    constexpr std::string_view ampName(amps amp)
+    {
+        switch (amp)
+        {
+            case amps::FENDER_57_DELUXE:
+                return "Fender '57 Deluxe";
+            case amps::FENDER_59_BASSMAN:
+                return "Fender '59 Bassman";
+            case amps::FENDER_57_CHAMP:
+                return "Fender '57 Champ";
+            case amps::FENDER_65_DELUXE_REVERB:
+                return "Fender '65 Deluxe Reverb";
+            case amps::FENDER_65_PRINCETON:
+                return "Fender '65 Princeton";
+            case amps::FENDER_65_TWIN_REVERB:
+                return "Fender '65 Twin Reverb";
+            case amps::FENDER_SUPER_SONIC:
+                return "Fender Super-Sonic";
+            case amps::BRITISH_60S:
+                return "British 60's";
+            case amps::BRITISH_70S:
+                return "British 70's";
+            case amps::BRITISH_80S:
+                return "British 80's";
+            case amps::AMERICAN_90S:
+                return "American 90's";
+            case amps::METAL_2000:
+                return "Metal 2000";
+            default:
+                return "Unknown";
+        }
+    }
+
+
+    constexpr std::string_view effectName(effects effect)
+    {
+        switch (effect)
+        {
+            case effects::EMPTY:
+                return "None";
+            case effects::OVERDRIVE:
+                return "Overdrive";
+            case effects::WAH:
+                return "Wah";
+            case effects::TOUCH_WAH:
+                return "Touch Wah";
+            case effects::FUZZ:
+                return "Fuzz";
+            case effects::FUZZ_TOUCH_WAH:
+                return "Fuzz Touch Wah";
+            case effects::SIMPLE_COMP:
+                return "Simple Compressor";
+            case effects::COMPRESSOR:
+                return "Compressor";
+            case effects::SINE_CHORUS:
+                return "Sine Chorus";
+            case effects::TRIANGLE_CHORUS:
+                return "Triangle Chorus";
+            case effects::SINE_FLANGER:
+                return "Sine Flanger";
+            case effects::TRIANGLE_FLANGER:
+                return "Triangle Flanger";
+            case effects::VIBRATONE:
+                return "Vibratone";
+            case effects::VINTAGE_TREMOLO:
+                return "Vintage Tremolo";
+            case effects::SINE_TREMOLO:
+                return "Sine Tremolo";
+            case effects::RING_MODULATOR:
+                return "Ring Modulator";
+            case effects::STEP_FILTER:
+                return "Step Filter";
+            case effects::PHASER:
+                return "Phaser";
+            case effects::PITCH_SHIFTER:
+                return "Pitch Shifter";
+            case effects::MONO_DELAY:
+                return "Mono Delay";
+            case effects::MONO_ECHO_FILTER:
+                return "Mono Echo Filter";
+            case effects::STEREO_ECHO_FILTER:
+                return "Stereo Echo Filter";
+            case effects::MULTITAP_DELAY:
+                return "Multitap Delay";
+            case effects::PING_PONG_DELAY:
+                return "Ping Pong Delay";
+            case effects::DUCKING_DELAY:
+                return "Ducking Delay";
+            case effects::REVERSE_DELAY:
+                return "Reverse Delay";
+            case effects::TAPE_DELAY:
+                return "Tape Delay";
+            case effects::STEREO_TAPE_DELAY:
+                return "Stereo Tape Delay";
+            case effects::SMALL_HALL_REVERB:
+                return "Small Hall Reverb";
+            case effects::LARGE_HALL_REVERB:
+                return "Large Hall Reverb";
+            case effects::SMALL_ROOM_REVERB:
+                return "Small Room Reverb";
+            case effects::LARGE_ROOM_REVERB:
+                return "Large Room Reverb";
+            case effects::SMALL_PLATE_REVERB:
+                return "Small Plate Reverb";
+            case effects::LARGE_PLATE_REVERB:
+                return "Large Plate Reverb";
+            case effects::AMBIENT_REVERB:
+                return "Ambient Reverb";
+            case effects::ARENA_REVERB:
+                return "Arena Reverb";
+            case effects::FENDER_63_SPRING_REVERB:
+                return "'63 Fender Spring Reverb";
+            case effects::FENDER_65_SPRING_REVERB:
+                return "'65 Fender Spring Reverb";
+            default:
+                return "Unknown";
+        }
+    }
+
+}
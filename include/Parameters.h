@@ -0,0 +1,123 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "data_structs.h"
+#include "com/IdLookup.h"
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace plug
+{
+    // Parameter names, as used by the command line tool and the OSC addresses
+
+    struct AmpParameter
+    {
+        std::string_view key;
+        std::uint8_t amp_settings::*member;
+    };
+
+    inline constexpr std::array<AmpParameter, 13> ampParameters{{{"gain", &amp_settings::gain},
+                                                                 {"volume", &amp_settings::volume},
+                                                                 {"treble", &amp_settings::treble},
+                                                                 {"middle", &amp_settings::middle},
+                                                                 {"bass", &amp_settings::bass},
+                                                                 {"noise_gate", &amp_settings::noise_gate},
+                                                                 {"master_vol", &amp_settings::master_vol},
+                                                                 {"gain2", &amp_settings::gain2},
+                                                                 {"presence", &amp_settings::presence},
+                                                                 {"threshold", &amp_settings::threshold},
+                                                                 {"depth", &amp_settings::depth},
+                                                                 {"bias", &amp_settings::bias},
+                                                                 {"sag", &amp_settings::sag}}};
+
+    struct EffectParameter
+    {
+        std::string_view key;
+        std::uint8_t fx_pedal_settings::*member;
+    };
+
+    inline constexpr std::array<EffectParameter, 6> effectParameters{{{"knob1", &fx_pedal_settings::knob1},
+                                                                      {"knob2", &fx_pedal_settings::knob2},
+                                                                      {"knob3", &fx_pedal_settings::knob3},
+                                                                      {"knob4", &fx_pedal_settings::knob4},
+                                                                      {"knob5", &fx_pedal_settings::knob5},
+                                                                      {"knob6", &fx_pedal_settings::knob6}}};
+
+
+    // Models and cabinets are given by their ids
+    inline void setAmpParameter(amp_settings& amp, std::string_view key, std::uint8_t value)
+    {
+        const auto parameter = std::find_if(ampParameters.cbegin(), ampParameters.cend(), [key](const auto& p)
+                                            { return p.key == key; });
+
+        if (parameter != ampParameters.cend())
+        {
+            amp.*parameter->member = value;
+        }
+        else if (key == "model")
+        {
+            amp.amp_num = lookupAmpById(value);
+        }
+        else if (key == "cabinet")
+        {
+            amp.cabinet = lookupCabinetById(value);
+        }
+        else if (key == "brightness")
+        {
+            amp.brightness = (value != 0);
+        }
+        else if (key == "usb_gain")
+        {
+            amp.usb_gain = value;
+        }
+        else
+        {
+            throw std::invalid_argument{"Unknown amp parameter: " + std::string{key}};
+        }
+    }
+
+    inline void setEffectParameter(fx_pedal_settings& effect, std::string_view key, std::uint8_t value)
+    {
+        const auto parameter = std::find_if(effectParameters.cbegin(), effectParameters.cend(), [key](const auto& p)
+                                            { return p.key == key; });
+
+        if (parameter != effectParameters.cend())
+        {
+            effect.*parameter->member = value;
+        }
+        else if (key == "model")
+        {
+            effect.effect_num = lookupEffectById(value);
+        }
+        else if (key == "enabled")
+        {
+            effect.enabled = (value != 0);
+        }
+        else
+        {
+            throw std::invalid_argument{"Unknown effect parameter: " + std::string{key}};
+        }
+    }
+}
@@ -22,62 +22,393 @@
 
 #include "data_structs.h"
 #include "effects_enum.h"
-#include <string>
-#include <tuple>
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <initializer_list>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
 #include <vector>
+#include <cstdint>
 
 namespace plug
 {
+    // Packets of a preset as read from the amp: name, amp, the four effect DSPs and USB gain
+    using RawPresetData = std::array<std::array<std::uint8_t, 64>, 7>;
 
+    namespace detail
+    {
+        // Raw packets of chains are kept apart, so chains stay small and trivially copyable. Most
+        // entries are kept in a ring of fixed capacity, the oldest is replaced when it's full; the
+        // chains of replaced entries know this and are serialized from their fields. Packets of
+        // chains holding model ids unknown to plug can't be recreated from the fields, so they're
+        // pinned and never replaced. Equal data is stored once, entries are found by their hash.
+        class RawPresetTable
+        {
+        public:
+            static constexpr std::uint32_t capacity{128};
+
+            // Allocates only when pinning new data; returns the id of the entry, which is never 0
+            static std::uint32_t add(const RawPresetData& data, bool pinned)
+            {
+                const auto key = hash(data);
+                auto& table = instance();
+                const std::lock_guard lock{table.mutex};
+
+                if (const auto id = table.find(key, data); id != 0)
+                {
+                    return id;
+                }
+
+                if (pinned == true)
+                {
+                    table.pinnedEntries.push_back({key, data});
+                    return pinnedBit | static_cast<std::uint32_t>(table.pinnedEntries.size());
+                }
+
+                table.lastId = (table.lastId == (pinnedBit - 1)) ? 1 : table.lastId + 1;
+                const auto i = index(table.lastId);
+                table.ids[i] = table.lastId;
+                table.hashes[i] = key;
+                table.entries[i] = data;
+                return table.lastId;
+            }
+
+            // Copies the data of the id into result; returns false if there's none or it was replaced
+            static bool get(std::uint32_t id, RawPresetData& result)
+            {
+                if (id == 0)
+                {
+                    return false;
+                }
+
+                auto& table = instance();
+                const std::lock_guard lock{table.mutex};
+
+                if ((id & pinnedBit) != 0)
+                {
+                    result = table.pinnedEntries[(id & ~pinnedBit) - 1].data;
+                    return true;
+                }
+
+                const auto i = index(id);
+
+                if (table.ids[i] != id)
+                {
+                    return false;
+                }
+                result = table.entries[i];
+                return true;
+            }
+
+        private:
+            static constexpr std::uint32_t pinnedBit{0x80000000};
+
+            struct Entry
+            {
+                std::uint64_t hash;
+                RawPresetData data;
+            };
+
+            static constexpr std::size_t index(std::uint32_t id)
+            {
+                return (id - 1) % capacity;
+            }
+
+            // FNV-1a
+            static std::uint64_t hash(const RawPresetData& data)
+            {
+                std::uint64_t value{0xcbf29ce484222325};
+
+                for (const auto& packet : data)
+                {
+                    for (const auto byte : packet)
+                    {
+                        value = (value ^ byte) * 0x100000001b3;
+                    }
+                }
+                return value;
+            }
+
+            static RawPresetTable& instance()
+            {
+                static RawPresetTable table;
+                return table;
+            }
+
+            std::uint32_t find(std::uint64_t key, const RawPresetData& data) const
+            {
+                for (std::size_t i = 0; i < pinnedEntries.size(); ++i)
+                {
+                    if ((pinnedEntries[i].hash == key) && (pinnedEntries[i].data == data))
+                    {
+                        return pinnedBit | static_cast<std::uint32_t>(i + 1);
+                    }
+                }
+
+                for (std::size_t i = 0; i < capacity; ++i)
+                {
+                    if ((ids[i] != 0) && (hashes[i] == key) && (entries[i] == data))
+                    {
+                        return ids[i];
+                    }
+                }
+                return 0;
+            }
+
+            std::mutex mutex;
+            std::array<std::uint32_t, capacity> ids{};
+            std::array<std::uint64_t, capacity> hashes{};
+            std::array<RawPresetData, capacity> entries{};
+            std::vector<Entry> pinnedEntries;
+            std::uint32_t lastId{0};
+        };
+    }
+
+
+    enum class ChainSection
+    {
+        name,
+        amp,
+        effects,
+        usbGain
+    };
+
+
+    // Effects of a chain in order, stored inline
+    class EffectList
+    {
+    public:
+        static constexpr std::size_t capacity{8};
+
+        using value_type = fx_pedal_settings;
+        using const_iterator = const fx_pedal_settings*;
+        using iterator = const_iterator;
+
+        EffectList() = default;
+
+        EffectList(std::initializer_list<fx_pedal_settings> effects)
+        {
+            assign(effects.begin(), effects.end());
+        }
+
+        EffectList(const std::vector<fx_pedal_settings>& effects)
+        {
+            assign(effects.cbegin(), effects.cend());
+        }
+
+        void push_back(const fx_pedal_settings& effect)
+        {
+            if (size_ == capacity)
+            {
+                throw std::invalid_argument{"Signal chain can't hold more than 8 effects"};
+            }
+            items[size_++] = effect;
+        }
+
+        std::size_t size() const
+        {
+            return size_;
+        }
+
+        bool empty() const
+        {
+            return size_ == 0;
+        }
+
+        const fx_pedal_settings& operator[](std::size_t index) const
+        {
+            return items[index];
+        }
+
+        const_iterator begin() const
+        {
+            return items.data();
+        }
+
+        const_iterator end() const
+        {
+            return items.data() + size_;
+        }
+
+        const_iterator cbegin() const
+        {
+            return begin();
+        }
+
+        const_iterator cend() const
+        {
+            return end();
+        }
+
+        std::vector<fx_pedal_settings> toVector() const
+        {
+            return {begin(), end()};
+        }
+
+    private:
+        template <class Iterator>
+        void assign(Iterator first, Iterator last)
+        {
+            std::for_each(first, last, [this](const auto& effect)
+                          { push_back(effect); });
+        }
+
+        std::array<fx_pedal_settings, capacity> items{};
+        std::uint8_t size_{0};
+    };
+
+    inline bool operator==(const EffectList& lhs, const EffectList& rhs)
+    {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+    inline bool operator!=(const EffectList& lhs, const EffectList& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+
+    // A plain value: trivially copyable, without any allocation; raw packets are referenced by id
     class SignalChain
     {
     public:
+        static constexpr std::size_t maxNameLength{32};
+
         SignalChain()
-            : name_(""), amp_(), effects_()
+            : amp_()
         {
         }
 
-        SignalChain(const std::string& name, amp_settings amp, const std::vector<fx_pedal_settings>& effects)
-            : name_(name), amp_(amp), effects_(effects)
+        SignalChain(std::string_view name, amp_settings amp, const EffectList& effects)
+            : amp_(amp), effects_(effects)
         {
+            assignName(name);
         }
 
+        SignalChain(std::string_view name, amp_settings amp, const EffectList& effects, const RawPresetData& raw)
+            : amp_(amp), effects_(effects), rawId_(detail::RawPresetTable::add(raw, holdsUnknownIds(amp, effects)))
+        {
+            assignName(name);
+        }
 
-        std::string name() const
+
+        // Names are limited to the 32 characters the amp stores
+        std::string_view name() const
         {
-            return name_;
+            return {name_.data(), nameLength_};
         }
 
-        void setName(const std::string& name)
+        void setName(std::string_view name)
         {
-            name_ = name;
+            if (name.substr(0, maxNameLength) != this->name())
+            {
+                modified_.set(index(ChainSection::name));
+            }
+            assignName(name);
         }
 
-        amp_settings amp() const
+        const amp_settings& amp() const
         {
             return amp_;
         }
 
         void setAmp(amp_settings amp)
         {
+            if (amp.usb_gain != amp_.usb_gain)
+            {
+                modified_.set(index(ChainSection::usbGain));
+            }
+            if (withUsbGain(amp, amp_.usb_gain) != amp_)
+            {
+                modified_.set(index(ChainSection::amp));
+            }
             amp_ = amp;
         }
 
-        std::vector<fx_pedal_settings> effects() const
+        const EffectList& effects() const
         {
             return effects_;
         }
 
-        void setEffects(const std::vector<fx_pedal_settings>& effects)
+        void setEffects(const EffectList& effects)
         {
+            if (effects != effects_)
+            {
+                modified_.set(index(ChainSection::effects));
+            }
             effects_ = effects;
         }
 
 
+        // Packets the chain was decoded from, if still known; sections which are not modified
+        // since are written back from these as they are
+        std::optional<RawPresetData> raw() const
+        {
+            RawPresetData data;
+
+            if (detail::RawPresetTable::get(rawId_, data) == false)
+            {
+                return std::nullopt;
+            }
+            return data;
+        }
+
+        // True if the chain was decoded from packets which were replaced in the table since; it's
+        // serialized from its fields then, which keeps the values but not bytes plug doesn't know
+        bool isRawDropped() const
+        {
+            RawPresetData data;
+            return (rawId_ != 0) && (detail::RawPresetTable::get(rawId_, data) == false);
+        }
+
+        bool isModified(ChainSection section) const
+        {
+            return (rawId_ == 0) || modified_.test(index(section));
+        }
+
+
     private:
-        std::string name_;
+        static constexpr std::size_t index(ChainSection section)
+        {
+            return static_cast<std::size_t>(section);
+        }
+
+        static bool holdsUnknownIds(const amp_settings& amp, const EffectList& effects)
+        {
+            return amp.unknownModel.has_value() || amp.unknownCabinet.has_value() ||
+                   std::any_of(effects.begin(), effects.end(), [](const fx_pedal_settings& effect)
+                               { return effect.unknownModel.has_value() || effect.unknownSlot.has_value(); });
+        }
+
+        static amp_settings withUsbGain(amp_settings amp, std::uint8_t usbGain)
+        {
+            amp.usb_gain = usbGain;
+            return amp;
+        }
+
+        void assignName(std::string_view name)
+        {
+            const auto n = std::min(name.size(), maxNameLength);
+            std::copy_n(name.cbegin(), n, name_.begin());
+            std::fill(std::next(name_.begin(), n), name_.end(), '\0');
+            nameLength_ = static_cast<std::uint8_t>(n);
+        }
+
+        std::array<char, maxNameLength> name_{};
+        std::uint8_t nameLength_{0};
         amp_settings amp_;
-        std::vector<fx_pedal_settings> effects_;
+        EffectList effects_;
+        std::uint32_t rawId_{0};
+        std::bitset<4> modified_;
     };
 
+    static_assert(std::is_trivially_copyable_v<EffectList>);
+    static_assert(std::is_trivially_copyable_v<SignalChain>);
+    static_assert(sizeof(SignalChain) <= 256, "Raw packets are kept out of SignalChain");
+
 }
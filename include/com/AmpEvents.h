@@ -0,0 +1,108 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "SignalChain.h"
+#include "com/Mustang.h"
+#include "com/Packet.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <variant>
+#include <vector>
+
+namespace plug::com
+{
+    struct PresetNameChange
+    {
+        std::string name;
+    };
+
+    // An effect was set on or removed (no effect) from an fx slot
+    struct EffectChange
+    {
+        FxSlot slot;
+        std::optional<fx_pedal_settings> effect;
+    };
+
+    using AmpEvent = std::variant<PresetNameChange, amp_settings, EffectChange>;
+
+
+    // Turns the packets the amp sends on its own - when its knobs are used or a preset is selected
+    // on it - into changes against the last known state. Packets that don't change anything yield
+    // no events.
+    class AmpEventDecoder
+    {
+    public:
+        explicit AmpEventDecoder(const SignalChain& current);
+
+        std::vector<AmpEvent> decode(const PacketRawType& packet);
+        SignalChain state() const;
+
+        // Takes a state the amp was set to by commands as the base of the following changes
+        void resync(const SignalChain& current);
+
+    private:
+        std::vector<AmpEvent> decodeName(const PacketRawType& packet);
+        std::vector<AmpEvent> decodeAmp(const PacketRawType& packet);
+        std::vector<AmpEvent> decodeUsbGain(const PacketRawType& packet);
+        std::vector<AmpEvent> decodeEffect(std::size_t index, const PacketRawType& packet);
+
+        std::string name;
+        amp_settings amp;
+        std::array<std::optional<fx_pedal_settings>, 4> effectsByDsp;
+    };
+
+
+    // Reads unsolicited packets in the background while no command is in progress and passes the
+    // decoded changes to the callback, which is called from the listener's thread. Whatever is
+    // sent to the amp must be passed to resync(), otherwise changes are compared to a stale state.
+    class AmpEventListener
+    {
+    public:
+        using Callback = std::function<void(const std::vector<AmpEvent>&)>;
+
+        // A command waits at most this long for the listener to give up the connection
+        static constexpr std::chrono::milliseconds pollTimeout{5};
+
+        AmpEventListener(Mustang& mustang, const SignalChain& current, Callback callback);
+        AmpEventListener(const AmpEventListener&) = delete;
+        ~AmpEventListener();
+
+        void resync(const SignalChain& current);
+
+        AmpEventListener& operator=(const AmpEventListener&) = delete;
+
+    private:
+        void run();
+
+        Mustang& mustang;
+        std::mutex mutex;
+        AmpEventDecoder decoder;
+        Callback callback;
+        std::atomic<bool> running{true};
+        std::thread worker;
+    };
+}
@@ -0,0 +1,174 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "com/CommandScheduler.h"
+#include "com/Connection.h"
+#include <array>
+#include <condition_variable>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace plug::com
+{
+    // Owns the connection and runs all operations on it on a worker thread. An operation is a
+    // callable taking the connection, submitted from any thread; its result or exception is
+    // delivered through a future, or returned by run(). Operations run one at a time, highest
+    // priority first and in order of submission within a priority, so their packets never
+    // interleave. Long transfers are submitted in batches to let interactive operations through.
+    class CommandExecutor
+    {
+    public:
+        explicit CommandExecutor(std::unique_ptr<Connection> connection);
+        CommandExecutor(const CommandExecutor&) = delete;
+        // Operations already submitted are still run
+        ~CommandExecutor();
+
+        template <class Operation>
+        std::future<std::invoke_result_t<Operation&, Connection&>> submit(Priority priority, Operation operation)
+        {
+            using Result = std::invoke_result_t<Operation&, Connection&>;
+
+            auto task = std::make_unique<AsyncTask<std::packaged_task<Result(Connection&)>>>(std::packaged_task<Result(Connection&)>{std::move(operation)});
+            auto result = task->operation.get_future();
+            enqueue(priority, *task.release());
+            return result;
+        }
+
+        // Waits for the operation and returns its result, exceptions are rethrown. The operation
+        // is kept on the caller's stack, so running it doesn't allocate.
+        template <class Operation>
+        std::invoke_result_t<Operation&, Connection&> run(Priority priority, Operation&& operation)
+        {
+            using Result = std::invoke_result_t<Operation&, Connection&>;
+
+            BlockingTask<std::remove_reference_t<Operation>, Result> task{operation};
+            execute(priority, task);
+
+            if (task.error != nullptr)
+            {
+                std::rethrow_exception(task.error);
+            }
+
+            if constexpr (std::is_void_v<Result> == false)
+            {
+                return std::move(*task.result);
+            }
+        }
+
+        CommandExecutor& operator=(const CommandExecutor&) = delete;
+
+    private:
+        struct Task
+        {
+            explicit Task(bool isDetached)
+                : detached(isDetached)
+            {
+            }
+
+            Task(const Task&) = delete;
+            virtual ~Task() = default;
+
+            // Runs on the worker thread, exceptions are kept by the task
+            virtual void execute(Connection& conn) = 0;
+
+            Task& operator=(const Task&) = delete;
+
+            // A detached task is deleted once run, the others are waited for by their caller
+            const bool detached;
+            Task* next{nullptr};
+            bool done{false};
+        };
+
+        template <class PackagedTask>
+        struct AsyncTask : public Task
+        {
+            explicit AsyncTask(PackagedTask task)
+                : Task(true), operation(std::move(task))
+            {
+            }
+
+            void execute(Connection& conn) override
+            {
+                operation(conn);
+            }
+
+            PackagedTask operation;
+        };
+
+        template <class Operation, class Result>
+        struct BlockingTask : public Task
+        {
+            explicit BlockingTask(Operation& op)
+                : Task(false), operation(op)
+            {
+            }
+
+            void execute(Connection& conn) override
+            {
+                try
+                {
+                    if constexpr (std::is_void_v<Result> == true)
+                    {
+                        operation(conn);
+                    }
+                    else
+                    {
+                        result.emplace(operation(conn));
+                    }
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+            }
+
+            Operation& operation;
+            std::optional<std::conditional_t<std::is_void_v<Result>, bool, Result>> result{};
+            std::exception_ptr error;
+        };
+
+        struct Queue
+        {
+            Task* head{nullptr};
+            Task* tail{nullptr};
+        };
+
+        void enqueue(Priority priority, Task& task);
+        void execute(Priority priority, Task& task);
+        Task* next();
+        void work();
+
+        const std::unique_ptr<Connection> conn;
+        std::mutex mutex;
+        std::condition_variable submitted;
+        std::condition_variable finished;
+        std::array<Queue, 3> queues{};
+        bool stopping{false};
+        std::thread worker;
+    };
+}
@@ -0,0 +1,78 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace plug::com
+{
+    enum class Priority : std::uint8_t
+    {
+        interactive,
+        normal,
+        bulk
+    };
+
+
+    // Grants exclusive use of the connection to one command sequence at a time. Waiting sequences
+    // are served by priority, in order of arrival within the same priority. Bulk transfers hold
+    // the connection for one batch only - a preset, a slot update - so an interactive command
+    // waits at most for the batch in progress.
+    class CommandScheduler
+    {
+    public:
+        class Lease
+        {
+        public:
+            explicit Lease(CommandScheduler& owner);
+            Lease(Lease&& other) noexcept;
+            Lease(const Lease&) = delete;
+            ~Lease();
+
+            Lease& operator=(const Lease&) = delete;
+            Lease& operator=(Lease&&) = delete;
+
+        private:
+            CommandScheduler* scheduler;
+        };
+
+        CommandScheduler() = default;
+        CommandScheduler(const CommandScheduler&) = delete;
+
+        Lease acquire(Priority priority);
+        std::size_t waiting(Priority priority) const;
+
+        CommandScheduler& operator=(const CommandScheduler&) = delete;
+
+    private:
+        void release();
+
+        mutable std::mutex mutex;
+        std::condition_variable released;
+        bool busy{false};
+        std::array<std::size_t, 3> waiters{{0, 0, 0}};
+        std::array<std::uint64_t, 3> nextTicket{{0, 0, 0}};
+        std::array<std::uint64_t, 3> serving{{0, 0, 0}};
+    };
+}
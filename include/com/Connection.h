@@ -20,6 +20,8 @@
 
 #pragma once
 
+#include <algorithm>
+#include <chrono>
 #include <vector>
 #include <string>
 #include <cstdint>
@@ -46,12 +48,30 @@ namespace plug::com
             return sendImpl(c.data(), c.size());
         }
 
+        // Receives into the container, returns the number of bytes received
+        template <class Container>
+        std::size_t receiveInto(Container& c)
+        {
+            return receiveImpl(c.data(), c.size());
+        }
+
         virtual std::vector<std::uint8_t> receive(std::size_t recvSize) = 0;
+        // Returns an empty buffer if nothing arrives within the timeout
+        virtual std::vector<std::uint8_t> receiveWithin(std::size_t recvSize, std::chrono::milliseconds timeout) = 0;
 
         virtual std::string name() const = 0;
         virtual ModelVersion modelVersion() const = 0;
 
     private:
         virtual std::size_t sendImpl(std::uint8_t* data, std::size_t size) = 0;
+
+        // Connections able to receive without allocating override this
+        virtual std::size_t receiveImpl(std::uint8_t* data, std::size_t size)
+        {
+            const auto received = receive(size);
+            const auto n = std::min(received.size(), size);
+            std::copy_n(received.cbegin(), n, data);
+            return n;
+        }
     };
 }
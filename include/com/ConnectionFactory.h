@@ -25,5 +25,5 @@
 
 namespace plug::com
 {
-    std::shared_ptr<Connection> createUsbConnection();
+    std::unique_ptr<Connection> createUsbConnection();
 }
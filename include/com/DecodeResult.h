@@ -0,0 +1,62 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace plug::com
+{
+    enum class DecodeField
+    {
+        amp,
+        cabinet,
+        effect,
+        fxSlot
+    };
+
+    // An id the dump carries but which isn't mapped (yet), eg. a model of a newer firmware.
+    // The field is decoded with a default value, the settings keep the raw id as unknown id.
+    struct DecodeDiagnostic
+    {
+        std::size_t packet;
+        DecodeField field;
+        std::uint8_t rawId;
+    };
+
+    std::string describe(const DecodeDiagnostic& diagnostic);
+
+
+    // Result of a decode which doesn't throw on unknown ids, but reports all of them
+    template <class T>
+    struct Decoded
+    {
+        T value;
+        std::vector<DecodeDiagnostic> diagnostics;
+
+        bool ok() const
+        {
+            return diagnostics.empty();
+        }
+    };
+}
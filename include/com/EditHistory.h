@@ -0,0 +1,67 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "SignalChain.h"
+#include <array>
+#include <cstdint>
+#include <optional>
+
+namespace plug::com
+{
+    // Undo history of tone edits. A step keeps only the fields it changed, three bytes each, in a
+    // fixed ring which drops the oldest steps once it's full; recording after an undo discards the
+    // steps which could have been redone. The preset name isn't part of the history.
+    class EditHistory
+    {
+    public:
+        static constexpr std::size_t capacity{2048};
+
+        // Nothing is recorded if both chains have the same tone
+        void record(const SignalChain& before, const SignalChain& after);
+
+        // Returns current with the fields of the step reverted / reapplied, or nothing if there's no step
+        std::optional<SignalChain> undo(const SignalChain& current);
+        std::optional<SignalChain> redo(const SignalChain& current);
+
+        bool canUndo() const;
+        bool canRedo() const;
+        void clear();
+
+
+    private:
+        struct FieldChange
+        {
+            std::uint8_t field;
+            std::uint8_t before;
+            std::uint8_t after;
+        };
+
+        FieldChange& at(std::size_t position);
+        void dropOldestStep();
+
+        std::array<FieldChange, capacity> changes{};
+        // Running positions, the ring holds the changes from first to end
+        std::size_t first{0};
+        std::size_t cursor{0};
+        std::size_t end{0};
+    };
+}
@@ -0,0 +1,430 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "data_structs.h"
+#include "effects_enum.h"
+#include "com/Packet.h"
+#include <array>
+#include <algorithm>
+#include <cstdint>
+
+namespace plug::com
+{
+    constexpr DSP dspFromEffect(effects effect)
+    {
+        switch (effect)
+        {
+            case effects::OVERDRIVE:
+            case effects::WAH:
+            case effects::TOUCH_WAH:
+            case effects::FUZZ:
+            case effects::FUZZ_TOUCH_WAH:
+            case effects::SIMPLE_COMP:
+            case effects::COMPRESSOR:
+                return DSP::effect0;
+
+            case effects::SINE_CHORUS:
+            case effects::TRIANGLE_CHORUS:
+            case effects::SINE_FLANGER:
+            case effects::TRIANGLE_FLANGER:
+            case effects::VIBRATONE:
+            case effects::VINTAGE_TREMOLO:
+            case effects::SINE_TREMOLO:
+            case effects::RING_MODULATOR:
+            case effects::STEP_FILTER:
+            case effects::PHASER:
+            case effects::PITCH_SHIFTER:
+                return DSP::effect1;
+
+            case effects::MONO_DELAY:
+            case effects::MONO_ECHO_FILTER:
+            case effects::STEREO_ECHO_FILTER:
+            case effects::MULTITAP_DELAY:
+            case effects::PING_PONG_DELAY:
+            case effects::DUCKING_DELAY:
+            case effects::REVERSE_DELAY:
+            case effects::TAPE_DELAY:
+            case effects::STEREO_TAPE_DELAY:
+                return DSP::effect2;
+
+            case effects::SMALL_HALL_REVERB:
+            case effects::LARGE_HALL_REVERB:
+            case effects::SMALL_ROOM_REVERB:
+            case effects::LARGE_ROOM_REVERB:
+            case effects::SMALL_PLATE_REVERB:
+            case effects::LARGE_PLATE_REVERB:
+            case effects::AMBIENT_REVERB:
+            case effects::ARENA_REVERB:
+            case effects::FENDER_63_SPRING_REVERB:
+            case effects::FENDER_65_SPRING_REVERB:
+                return DSP::effect3;
+
+            default:
+                return DSP::none;
+        }
+    }
+
+    namespace detail
+    {
+        template <class T, T upperBound>
+        constexpr T clampToRange(T value)
+        {
+            return std::clamp(value, T{0}, upperBound);
+        }
+
+        constexpr std::uint8_t getFxKnob(const fx_pedal_settings& effect)
+        {
+            if ((effect.effect_num >= effects::SINE_CHORUS) && (effect.effect_num <= effects::PITCH_SHIFTER))
+            {
+                return 0x01;
+            }
+            return 0x02;
+        }
+
+        constexpr bool hasExtraKnob(effects e)
+        {
+            switch (e)
+            {
+                case effects::MONO_ECHO_FILTER:
+                case effects::STEREO_ECHO_FILTER:
+                case effects::TAPE_DELAY:
+                case effects::STEREO_TAPE_DELAY:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        constexpr Header makeHeader(Stage stage, Type type, DSP dsp)
+        {
+            Header header{};
+            header.setStage(stage);
+            header.setType(type);
+            header.setDSP(dsp);
+            return header;
+        }
+
+        constexpr Header makeDataHeader(DSP dsp)
+        {
+            auto header = makeHeader(Stage::ready, Type::data, dsp);
+            header.setUnknown(0x00, 0x01, 0x01);
+            return header;
+        }
+
+        constexpr Packet<AmpPayload> makeAmpBasePacket(amps model)
+        {
+            AmpPayload payload{};
+            payload.setUnknown(0x80, 0x80, 0x01);
+            payload.setDepth(0x80);
+
+            switch (model)
+            {
+                case amps::FENDER_57_DELUXE:
+                    payload.setModel(0x67);
+                    payload.setUnknownAmpSpecific(0x01, 0x01, 0x01, 0x01, 0x53);
+                    break;
+
+                case amps::FENDER_59_BASSMAN:
+                    payload.setModel(0x64);
+                    payload.setUnknownAmpSpecific(0x02, 0x02, 0x02, 0x02, 0x67);
+                    break;
+
+                case amps::FENDER_57_CHAMP:
+                    payload.setModel(0x7c);
+                    payload.setUnknownAmpSpecific(0x0c, 0x0c, 0x0c, 0x0c, 0x00);
+                    break;
+
+                case amps::FENDER_65_DELUXE_REVERB:
+                    payload.setModel(0x53);
+                    payload.setUnknownAmpSpecific(0x03, 0x03, 0x03, 0x03, 0x6a);
+                    payload.setUnknown(0x00, 0x00, 0x01);
+                    break;
+
+                case amps::FENDER_65_PRINCETON:
+                    payload.setModel(0x6a);
+                    payload.setUnknownAmpSpecific(0x04, 0x04, 0x04, 0x04, 0x61);
+                    break;
+
+                case amps::FENDER_65_TWIN_REVERB:
+                    payload.setModel(0x75);
+                    payload.setUnknownAmpSpecific(0x05, 0x05, 0x05, 0x05, 0x72);
+                    break;
+
+                case amps::FENDER_SUPER_SONIC:
+                    payload.setModel(0x72);
+                    payload.setUnknownAmpSpecific(0x06, 0x06, 0x06, 0x06, 0x79);
+                    break;
+
+                case amps::BRITISH_60S:
+                    payload.setModel(0x61);
+                    payload.setUnknownAmpSpecific(0x07, 0x07, 0x07, 0x07, 0x5e);
+                    break;
+
+                case amps::BRITISH_70S:
+                    payload.setModel(0x79);
+                    payload.setUnknownAmpSpecific(0x0b, 0x0b, 0x0b, 0x0b, 0x7c);
+                    break;
+
+                case amps::BRITISH_80S:
+                    payload.setModel(0x5e);
+                    payload.setUnknownAmpSpecific(0x09, 0x09, 0x09, 0x09, 0x5d);
+                    break;
+
+                case amps::AMERICAN_90S:
+                    payload.setModel(0x5d);
+                    payload.setUnknownAmpSpecific(0x0a, 0x0a, 0x0a, 0x0a, 0x6d);
+                    break;
+
+                case amps::METAL_2000:
+                    payload.setModel(0x6d);
+                    payload.setUnknownAmpSpecific(0x08, 0x08, 0x08, 0x08, 0x75);
+                    break;
+            }
+
+            return Packet<AmpPayload>{makeDataHeader(DSP::amp), payload};
+        }
+
+        constexpr Packet<EffectPayload> makeEffectBasePacket(effects effect)
+        {
+            EffectPayload payload{};
+            payload.setUnknown(0x00, 0x08, 0x01);
+
+            switch (effect)
+            {
+                case effects::OVERDRIVE:
+                    payload.setModel(0x3c);
+                    break;
+
+                case effects::WAH:
+                    payload.setModel(0x49);
+                    payload.setUnknown(0x01, 0x08, 0x01);
+                    break;
+
+                case effects::TOUCH_WAH:
+                    payload.setModel(0x4a);
+                    payload.setUnknown(0x01, 0x08, 0x01);
+                    break;
+
+                case effects::FUZZ:
+                    payload.setModel(0x1a);
+                    break;
+
+                case effects::FUZZ_TOUCH_WAH:
+                    payload.setModel(0x1c);
+                    break;
+
+                case effects::SIMPLE_COMP:
+                    payload.setModel(0x88);
+                    payload.setUnknown(0x08, 0x08, 0x01);
+                    break;
+
+                case effects::COMPRESSOR:
+                    payload.setModel(0x07);
+                    break;
+
+                case effects::SINE_CHORUS:
+                    payload.setModel(0x12);
+                    payload.setUnknown(0x01, 0x01, 0x01);
+                    break;
+
+                case effects::TRIANGLE_CHORUS:
+                    payload.setModel(0x13);
+                    payload.setUnknown(0x01, 0x01, 0x01);
+                    break;
+
+                case effects::SINE_FLANGER:
+                    payload.setModel(0x18);
+                    payload.setUnknown(0x01, 0x01, 0x01);
+                    break;
+
+                case effects::TRIANGLE_FLANGER:
+                    payload.setModel(0x19);
+                    payload.setUnknown(0x01, 0x01, 0x01);
+                    break;
+
+                case effects::VIBRATONE:
+                    payload.setModel(0x2d);
+                    payload.setUnknown(0x01, 0x01, 0x01);
+                    break;
+
+                case effects::VINTAGE_TREMOLO:
+                    payload.setModel(0x40);
+                    payload.setUnknown(0x01, 0x01, 0x01);
+                    break;
+
+                case effects::SINE_TREMOLO:
+                    payload.setModel(0x41);
+                    payload.setUnknown(0x01, 0x01, 0x01);
+                    break;
+
+                case effects::RING_MODULATOR:
+                    payload.setModel(0x22);
+                    payload.setUnknown(0x01, 0x08, 0x01);
+                    break;
+
+                case effects::STEP_FILTER:
+                    payload.setModel(0x29);
+                    payload.setUnknown(0x01, 0x01, 0x01);
+                    break;
+
+                case effects::PHASER:
+                    payload.setModel(0x4f);
+                    payload.setUnknown(0x01, 0x01, 0x01);
+                    break;
+
+                case effects::PITCH_SHIFTER:
+                    payload.setModel(0x1f);
+                    payload.setUnknown(0x01, 0x08, 0x01);
+                    break;
+
+                case effects::MONO_DELAY:
+                    payload.setModel(0x16);
+                    payload.setUnknown(0x02, 0x01, 0x01);
+                    break;
+
+                case effects::MONO_ECHO_FILTER:
+                    payload.setModel(0x43);
+                    payload.setUnknown(0x02, 0x01, 0x01);
+                    break;
+
+                case effects::STEREO_ECHO_FILTER:
+                    payload.setModel(0x48);
+                    payload.setUnknown(0x02, 0x01, 0x01);
+                    break;
+
+                case effects::MULTITAP_DELAY:
+                    payload.setModel(0x44);
+                    payload.setUnknown(0x02, 0x01, 0x01);
+                    break;
+
+                case effects::PING_PONG_DELAY:
+                    payload.setModel(0x45);
+                    payload.setUnknown(0x02, 0x01, 0x01);
+                    break;
+
+                case effects::DUCKING_DELAY:
+                    payload.setModel(0x15);
+                    payload.setUnknown(0x02, 0x01, 0x01);
+                    break;
+
+                case effects::REVERSE_DELAY:
+                    payload.setModel(0x46);
+                    payload.setUnknown(0x02, 0x01, 0x01);
+                    break;
+
+                case effects::TAPE_DELAY:
+                    payload.setModel(0x2b);
+                    payload.setUnknown(0x02, 0x01, 0x01);
+                    break;
+
+                case effects::STEREO_TAPE_DELAY:
+                    payload.setModel(0x2a);
+                    payload.setUnknown(0x02, 0x01, 0x01);
+                    break;
+
+                case effects::SMALL_HALL_REVERB:
+                    payload.setModel(0x24);
+                    break;
+
+                case effects::LARGE_HALL_REVERB:
+                    payload.setModel(0x3a);
+                    break;
+
+                case effects::SMALL_ROOM_REVERB:
+                    payload.setModel(0x26);
+                    break;
+
+                case effects::LARGE_ROOM_REVERB:
+                    payload.setModel(0x3b);
+                    break;
+
+                case effects::SMALL_PLATE_REVERB:
+                    payload.setModel(0x4e);
+                    break;
+
+                case effects::LARGE_PLATE_REVERB:
+                    payload.setModel(0x4b);
+                    break;
+
+                case effects::AMBIENT_REVERB:
+                    payload.setModel(0x4c);
+                    break;
+
+                case effects::ARENA_REVERB:
+                    payload.setModel(0x4d);
+                    break;
+
+                case effects::FENDER_63_SPRING_REVERB:
+                    payload.setModel(0x21);
+                    break;
+
+                case effects::FENDER_65_SPRING_REVERB:
+                    payload.setModel(0x0b);
+                    break;
+
+                default:
+                    break;
+            }
+
+            return Packet<EffectPayload>{makeDataHeader(dspFromEffect(effect)), payload};
+        }
+
+        template <class Enum, class Payload, std::size_t n>
+        constexpr std::array<Packet<Payload>, n> makeTable(Packet<Payload> (*make)(Enum))
+        {
+            std::array<Packet<Payload>, n> table{};
+
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                table[i] = make(static_cast<Enum>(i));
+            }
+            return table;
+        }
+
+        constexpr Packet<EmptyPayload> makeLoadSlotBasePacket()
+        {
+            auto header = makeHeader(Stage::ready, Type::operation, DSP::opSelectMemBank);
+            header.setUnknown(0x00, 0x01, 0x00);
+            return Packet<EmptyPayload>{header, EmptyPayload{}};
+        }
+    }
+
+
+    // Packets which never change are built once at compile time; serializing a command
+    // copies one of them and stores the few fields taken from the settings.
+
+    inline constexpr std::size_t ampModelCount{value(amps::METAL_2000) + 1};
+    inline constexpr std::size_t effectModelCount{value(effects::FENDER_65_SPRING_REVERB) + 1};
+
+    // Amp DSP packet per amp model with model id, constant bytes and the default noise gate depth
+    inline constexpr auto ampBasePackets = detail::makeTable<amps, AmpPayload, ampModelCount>(detail::makeAmpBasePacket);
+
+    // Effect DSP packet per effect model with DSP, model id and constant bytes
+    inline constexpr auto effectBasePackets = detail::makeTable<effects, EffectPayload, effectModelCount>(detail::makeEffectBasePacket);
+
+    inline constexpr Packet<AmpPayload> usbGainBasePacket{detail::makeDataHeader(DSP::usbGain), AmpPayload{}};
+    inline constexpr Packet<EmptyPayload> loadSlotBasePacket{detail::makeLoadSlotBasePacket()};
+    inline constexpr Packet<EmptyPayload> loadCommandPacket{detail::makeHeader(Stage::unknown, Type::load, DSP::none), EmptyPayload{}};
+    inline constexpr Packet<EmptyPayload> applyCommandPacket{detail::makeHeader(Stage::ready, Type::data, DSP::none), EmptyPayload{}};
+    inline constexpr std::array<Packet<EmptyPayload>, 2> initCommandPackets{{Packet<EmptyPayload>{detail::makeHeader(Stage::init0, Type::init0, DSP::none), EmptyPayload{}},
+                                                                             Packet<EmptyPayload>{detail::makeHeader(Stage::init1, Type::init1, DSP::none), EmptyPayload{}}}};
+}
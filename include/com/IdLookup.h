@@ -22,13 +22,14 @@
 
 #include "effects_enum.h"
 #include <cstdint>
+#include <optional>
 #include <stdexcept>
 #include <string>
 
 namespace plug
 {
 
-    constexpr amps lookupAmpById(std::uint8_t id)
+    constexpr std::optional<amps> findAmpById(std::uint8_t id)
     {
         switch (id)
         {
@@ -57,12 +58,21 @@ namespace plug
             case 0x6d:
                 return amps::METAL_2000;
             default:
-                throw std::invalid_argument{"Invalid amp id: " + std::to_string(id)};
+                return std::nullopt;
         }
     }
 
+    constexpr amps lookupAmpById(std::uint8_t id)
+    {
+        if (const auto value = findAmpById(id); value.has_value() == true)
+        {
+            return *value;
+        }
+        throw std::invalid_argument{"Invalid amp id: " + std::to_string(id)};
+    }
 
-    constexpr effects lookupEffectById(std::uint8_t id)
+
+    constexpr std::optional<effects> findEffectById(std::uint8_t id)
     {
         switch (id)
         {
@@ -143,12 +153,141 @@ namespace plug
             case 0x0b:
                 return effects::FENDER_65_SPRING_REVERB;
             default:
-                throw std::invalid_argument{"Invalid effect id: " + std::to_string(id)};
+                return std::nullopt;
+        }
+    }
+
+    constexpr effects lookupEffectById(std::uint8_t id)
+    {
+        if (const auto value = findEffectById(id); value.has_value() == true)
+        {
+            return *value;
         }
+        throw std::invalid_argument{"Invalid effect id: " + std::to_string(id)};
     }
 
 
-    constexpr cabinets lookupCabinetById(std::uint8_t id)
+    constexpr std::uint8_t lookupIdByAmp(amps value)
+    {
+        switch (value)
+        {
+            case amps::FENDER_57_DELUXE:
+                return 0x67;
+            case amps::FENDER_59_BASSMAN:
+                return 0x64;
+            case amps::FENDER_57_CHAMP:
+                return 0x7c;
+            case amps::FENDER_65_DELUXE_REVERB:
+                return 0x53;
+            case amps::FENDER_65_PRINCETON:
+                return 0x6a;
+            case amps::FENDER_65_TWIN_REVERB:
+                return 0x75;
+            case amps::FENDER_SUPER_SONIC:
+                return 0x72;
+            case amps::BRITISH_60S:
+                return 0x61;
+            case amps::BRITISH_70S:
+                return 0x79;
+            case amps::BRITISH_80S:
+                return 0x5e;
+            case amps::AMERICAN_90S:
+                return 0x5d;
+            case amps::METAL_2000:
+                return 0x6d;
+            default:
+                throw std::invalid_argument{"Invalid amp"};
+        }
+    }
+
+
+    constexpr std::uint8_t lookupIdByEffect(effects value)
+    {
+        switch (value)
+        {
+            case effects::EMPTY:
+                return 0x00;
+            case effects::OVERDRIVE:
+                return 0x3c;
+            case effects::WAH:
+                return 0x49;
+            case effects::TOUCH_WAH:
+                return 0x4a;
+            case effects::FUZZ:
+                return 0x1a;
+            case effects::FUZZ_TOUCH_WAH:
+                return 0x1c;
+            case effects::SIMPLE_COMP:
+                return 0x88;
+            case effects::COMPRESSOR:
+                return 0x07;
+            case effects::SINE_CHORUS:
+                return 0x12;
+            case effects::TRIANGLE_CHORUS:
+                return 0x13;
+            case effects::SINE_FLANGER:
+                return 0x18;
+            case effects::TRIANGLE_FLANGER:
+                return 0x19;
+            case effects::VIBRATONE:
+                return 0x2d;
+            case effects::VINTAGE_TREMOLO:
+                return 0x40;
+            case effects::SINE_TREMOLO:
+                return 0x41;
+            case effects::RING_MODULATOR:
+                return 0x22;
+            case effects::STEP_FILTER:
+                return 0x29;
+            case effects::PHASER:
+                return 0x4f;
+            case effects::PITCH_SHIFTER:
+                return 0x1f;
+            case effects::MONO_DELAY:
+                return 0x16;
+            case effects::MONO_ECHO_FILTER:
+                return 0x43;
+            case effects::STEREO_ECHO_FILTER:
+                return 0x48;
+            case effects::MULTITAP_DELAY:
+                return 0x44;
+            case effects::PING_PONG_DELAY:
+                return 0x45;
+            case effects::DUCKING_DELAY:
+                return 0x15;
+            case effects::REVERSE_DELAY:
+                return 0x46;
+            case effects::TAPE_DELAY:
+                return 0x2b;
+            case effects::STEREO_TAPE_DELAY:
+                return 0x2a;
+            case effects::SMALL_HALL_REVERB:
+                return 0x24;
+            case effects::LARGE_HALL_REVERB:
+                return 0x3a;
+            case effects::SMALL_ROOM_REVERB:
+                return 0x26;
+            case effects::LARGE_ROOM_REVERB:
+                return 0x3b;
+            case effects::SMALL_PLATE_REVERB:
+                return 0x4e;
+            case effects::LARGE_PLATE_REVERB:
+                return 0x4b;
+            case effects::AMBIENT_REVERB:
+                return 0x4c;
+            case effects::ARENA_REVERB:
+                return 0x4d;
+            case effects::FENDER_63_SPRING_REVERB:
+                return 0x21;
+            case effects::FENDER_65_SPRING_REVERB:
+                return 0x0b;
+            default:
+                throw std::invalid_argument{"Invalid effect"};
+        }
+    }
+
+
+    constexpr std::optional<cabinets> findCabinetById(std::uint8_t id)
     {
         switch (id)
         {
@@ -179,8 +318,17 @@ namespace plug
             case 0x0c:
                 return cabinets::cabSS112;
             default:
-                throw std::invalid_argument{"Invalid cabinet id: " + std::to_string(id)};
+                return std::nullopt;
+        }
+    }
+
+    constexpr cabinets lookupCabinetById(std::uint8_t id)
+    {
+        if (const auto value = findCabinetById(id); value.has_value() == true)
+        {
+            return *value;
         }
+        throw std::invalid_argument{"Invalid cabinet id: " + std::to_string(id)};
     }
 
 }
@@ -22,8 +22,17 @@
 #pragma once
 
 #include "SignalChain.h"
+#include "com/CommandExecutor.h"
 #include "com/Connection.h"
+#include "com/DecodeResult.h"
+#include "com/PresetBank.h"
+#include "com/RestorePlan.h"
+#include <array>
+#include <chrono>
+#include <functional>
+#include <optional>
 #include <string_view>
+#include <utility>
 #include <vector>
 #include <memory>
 #include <cstdint>
@@ -34,32 +43,94 @@ namespace plug::com
     {
         SignalChain signalChain;
         std::vector<std::string> presetNames;
+        // Ids of the current preset which could not be mapped
+        std::vector<DecodeDiagnostic> diagnostics;
     };
 
+    using ProgressCallback = std::function<void(std::size_t done, std::size_t total)>;
+
+    // Packets the amp sends on its own carry a preset section - name, amp, an effect DSP or the USB
+    // gain - in a ready header; anything else received after a command is its ack
+    bool isStatePacket(const PacketRawType& packet);
+
+    // Packets the amp sent on its own while a command waited for its ack, kept until receiveEvents()
+    // passes them on; packets arriving while it's full are dropped. Only used by operations, which
+    // run one at a time, so it needs no lock and never allocates.
+    class PendingEvents
+    {
+    public:
+        void push(const PacketRawType& packet);
+        std::optional<PacketRawType> pop();
+
+    private:
+        std::array<PacketRawType, 16> packets{};
+        std::size_t first{0};
+        std::size_t count{0};
+    };
+
+    // The packets set_signal_chain sends, prepared ahead to be sent with write_commands
+    std::vector<PacketRawType> serializeSignalChainCommands(const SignalChain& chain);
+
+    // True if updating previous to chain has to send the amp or an effect holding ids unknown to
+    // plug; these have no encoding, update_signal_chain() would throw
+    bool changesUnknownModels(const SignalChain& previous, const SignalChain& chain);
+
+
+    // Safe to share between threads: the connection is owned by an executor, which runs every
+    // operation as one uninterrupted sequence, scheduled by its priority. Parameter changes are
+    // interactive, backup and restore are bulk transfers which give way to other commands after each slot.
     class Mustang
     {
     public:
-        explicit Mustang(std::shared_ptr<Connection> connection);
+        explicit Mustang(std::unique_ptr<Connection> connection);
         Mustang(const Mustang&) = delete;
 
         InitialData start_amp();
         void stop_amp();
         void set_effect(fx_pedal_settings value);
         void set_amplifier(amp_settings value);
+        void set_signal_chain(const SignalChain& chain);
+        // Sends only the amp and the effect DSPs which differ from previous; returns false if nothing differs
+        bool update_signal_chain(const SignalChain& previous, const SignalChain& chain, Priority priority = Priority::interactive);
+        // Same packets as update_signal_chain, but all are sent before their acks are read; returns the number of packets
+        std::size_t write_signal_chain(const SignalChain& previous, const SignalChain& chain);
+        // Sends all commands before reading their acks
+        void write_commands(const std::vector<PacketRawType>& commands);
         void save_on_amp(std::string_view name, std::uint8_t slot);
         SignalChain load_memory_bank(std::uint8_t slot);
+        // Receives the slot's packets into the record without allocating
+        void load_memory_bank(std::uint8_t slot, PresetRecord& record);
         void save_effects(std::uint8_t slot, std::string_view name, const std::vector<fx_pedal_settings>& effects);
 
+        std::vector<PresetRecord> backupAll(std::size_t slots, const ProgressCallback& progress = {});
+        void restoreAll(const std::vector<PresetRecord>& records, const ProgressCallback& progress = {});
+        void restore(const std::vector<SlotUpdate>& updates, const ProgressCallback& progress = {});
+
+        // Packets the amp sent on its own; waits at most timeout for each. Other commands take precedence.
+        std::vector<PacketRawType> receiveEvents(std::chrono::milliseconds timeout);
+
         std::string getDeviceName() const;
         ModelVersion getDeviceModelVersion() const;
 
+        // Operations of their own on the connection, eg. a measurement, run between the others
+        template <class Operation>
+        auto run(Priority priority, Operation&& operation)
+        {
+            return executor.run(priority, std::forward<Operation>(operation));
+        }
+
+        template <class Operation>
+        auto submit(Priority priority, Operation operation)
+        {
+            return executor.submit(priority, std::move(operation));
+        }
+
         Mustang& operator=(const Mustang&) = delete;
 
 
     private:
-        InitialData loadData();
-        void initializeAmp();
-
-        const std::shared_ptr<Connection> conn;
+        // Declared first, operations still run by the executor's destructor may use it
+        PendingEvents pendingEvents;
+        mutable CommandExecutor executor;
     };
 }
@@ -21,9 +21,9 @@
 #pragma once
 
 #include <array>
-#include <algorithm>
 #include <string>
 #include <string_view>
+#include <stdexcept>
 #include <cstdint>
 
 namespace plug::com
@@ -64,22 +64,165 @@ namespace plug::com
     public:
         using RawType = std::array<std::uint8_t, 16>;
 
-        void setStage(Stage stage);
-        Stage getStage() const;
+        constexpr void setStage(Stage stage)
+        {
+            bytes[0] = [stage]() -> std::uint8_t
+            {
+                switch (stage)
+                {
+                    case Stage::init0:
+                        return 0x00;
+                    case Stage::init1:
+                        return 0x1a;
+                    case Stage::ready:
+                        return 0x1c;
+                    default:
+                        return 0xff;
+                }
+            }();
+        }
+
+        constexpr Stage getStage() const
+        {
+            switch (bytes[0])
+            {
+                case 0x00:
+                    return Stage::init0;
+                case 0x1a:
+                    return Stage::init1;
+                case 0x1c:
+                    return Stage::ready;
+                default:
+                    return Stage::unknown;
+            }
+        }
+
+        constexpr void setType(Type type)
+        {
+            bytes[1] = [type]() -> std::uint8_t
+            {
+                switch (type)
+                {
+                    case Type::operation:
+                        return 0x01;
+                    case Type::data:
+                        return 0x03;
+                    case Type::init0:
+                        return 0xc3;
+                    case Type::init1:
+                        return 0x03;
+                    case Type::load:
+                        return 0xc1;
+                    default:
+                        return 0xff;
+                }
+            }();
+        }
+
+        constexpr Type getType() const
+        {
+            switch (bytes[1])
+            {
+                case 0x01:
+                    return Type::operation;
+                case 0x03:
+                    return Type::data; // Same value as Type::init1
+                case 0xc3:
+                    return Type::init0;
+                case 0xc1:
+                    return Type::load;
+                default:
+                    throw std::domain_error("Invalid Type: " + std::to_string(bytes[1]));
+            }
+        }
 
-        void setType(Type type);
-        Type getType() const;
+        constexpr void setDSP(DSP dsp)
+        {
+            bytes[2] = [dsp]() -> std::uint8_t
+            {
+                switch (dsp)
+                {
+                    case DSP::none:
+                        return 0x00;
+                    case DSP::amp:
+                        return 0x05;
+                    case DSP::usbGain:
+                        return 0x0d;
+                    case DSP::effect0:
+                        return 0x06;
+                    case DSP::effect1:
+                        return 0x07;
+                    case DSP::effect2:
+                        return 0x08;
+                    case DSP::effect3:
+                        return 0x09;
+                    case DSP::opSave:
+                        return 0x03;
+                    case DSP::opSaveEffectName:
+                        return 0x04;
+                    case DSP::opSelectMemBank:
+                        return 0x01;
+                    default:
+                        return 0xff;
+                }
+            }();
+        }
 
-        void setDSP(DSP dsp);
-        DSP getDSP() const;
+        constexpr DSP getDSP() const
+        {
+            switch (bytes[2])
+            {
+                case 0x00:
+                    return DSP::none;
+                case 0x05:
+                    return DSP::amp;
+                case 0x0d:
+                    return DSP::usbGain;
+                case 0x06:
+                    return DSP::effect0;
+                case 0x07:
+                    return DSP::effect1;
+                case 0x08:
+                    return DSP::effect2;
+                case 0x09:
+                    return DSP::effect3;
+                case 0x03:
+                    return DSP::opSave;
+                case 0x04:
+                    return DSP::opSaveEffectName;
+                case 0x01:
+                    return DSP::opSelectMemBank;
+                default:
+                    throw std::domain_error("Invalid DSP: " + std::to_string(bytes[2]));
+            }
+        }
 
-        void setSlot(std::uint8_t slot);
-        std::uint8_t getSlot() const;
+        constexpr void setSlot(std::uint8_t slot)
+        {
+            bytes[4] = slot;
+        }
+
+        constexpr std::uint8_t getSlot() const
+        {
+            return bytes[4];
+        }
+
+        constexpr void setUnknown(std::uint8_t value0, std::uint8_t value1, std::uint8_t value2)
+        {
+            bytes[3] = value0;
+            bytes[6] = value1;
+            bytes[7] = value2;
+        }
 
-        void setUnknown(std::uint8_t value0, std::uint8_t value1, std::uint8_t value2);
+        constexpr RawType getBytes() const
+        {
+            return bytes;
+        }
 
-        RawType getBytes() const;
-        void fromBytes(const RawType& data);
+        constexpr void fromBytes(const RawType& data)
+        {
+            bytes = data;
+        }
 
     private:
         RawType bytes{{}};
@@ -91,8 +234,15 @@ namespace plug::com
     public:
         using RawType = std::array<std::uint8_t, 48>;
 
-        RawType getBytes() const;
-        void fromBytes(const RawType& data);
+        constexpr RawType getBytes() const
+        {
+            return bytes;
+        }
+
+        constexpr void fromBytes(const RawType& data)
+        {
+            bytes = data;
+        }
 
     protected:
         RawType bytes{{}};
@@ -106,97 +256,301 @@ namespace plug::com
     class NamePayload : public PayloadBase
     {
     public:
-        void setName(std::string_view name);
+        static constexpr std::size_t nameLength{32};
+
+        constexpr void setName(std::string_view name)
+        {
+            for (std::size_t i = 0; (i < name.length()) && (i < nameLength); ++i)
+            {
+                bytes[i] = static_cast<std::uint8_t>(name[i]);
+            }
+        }
+
         std::string getName() const;
+        // Views the name in place, valid as long as the payload
+        std::string_view getNameView() const;
     };
 
     class EffectPayload : public PayloadBase
     {
     public:
-        void setKnob1(std::uint8_t value);
-        std::uint8_t getKnob1() const;
+        constexpr void setKnob1(std::uint8_t value)
+        {
+            bytes[16] = value;
+        }
+
+        constexpr std::uint8_t getKnob1() const
+        {
+            return bytes[16];
+        }
+
+        constexpr void setKnob2(std::uint8_t value)
+        {
+            bytes[17] = value;
+        }
+
+        constexpr std::uint8_t getKnob2() const
+        {
+            return bytes[17];
+        }
+
+        constexpr void setKnob3(std::uint8_t value)
+        {
+            bytes[18] = value;
+        }
+
+        constexpr std::uint8_t getKnob3() const
+        {
+            return bytes[18];
+        }
 
-        void setKnob2(std::uint8_t value);
-        std::uint8_t getKnob2() const;
+        constexpr void setKnob4(std::uint8_t value)
+        {
+            bytes[19] = value;
+        }
+
+        constexpr std::uint8_t getKnob4() const
+        {
+            return bytes[19];
+        }
+
+        constexpr void setKnob5(std::uint8_t value)
+        {
+            bytes[20] = value;
+        }
+
+        constexpr std::uint8_t getKnob5() const
+        {
+            return bytes[20];
+        }
 
-        void setKnob3(std::uint8_t value);
-        std::uint8_t getKnob3() const;
+        constexpr void setKnob6(std::uint8_t value)
+        {
+            bytes[21] = value;
+        }
 
-        void setKnob4(std::uint8_t value);
-        std::uint8_t getKnob4() const;
+        constexpr std::uint8_t getKnob6() const
+        {
+            return bytes[21];
+        }
 
-        void setKnob5(std::uint8_t value);
-        std::uint8_t getKnob5() const;
+        constexpr void setSlot(std::uint8_t slot)
+        {
+            bytes[2] = slot;
+        }
 
-        void setKnob6(std::uint8_t value);
-        std::uint8_t getKnob6() const;
+        constexpr std::uint8_t getSlot() const
+        {
+            return bytes[2];
+        }
 
-        void setSlot(std::uint8_t slot);
-        std::uint8_t getSlot() const;
+        constexpr void setModel(std::uint8_t model)
+        {
+            bytes[0] = model;
+        }
 
-        void setModel(std::uint8_t model);
-        std::uint8_t getModel() const;
+        constexpr std::uint8_t getModel() const
+        {
+            return bytes[0];
+        }
 
-        void setUnknown(std::uint8_t value0, std::uint8_t value1, std::uint8_t value2);
+        constexpr void setUnknown(std::uint8_t value0, std::uint8_t value1, std::uint8_t value2)
+        {
+            bytes[3] = value0;
+            bytes[4] = value1;
+            bytes[5] = value2;
+        }
     };
 
 
     class AmpPayload : public PayloadBase
     {
     public:
-        void setModel(std::uint8_t value);
-        std::uint8_t getModel() const;
+        constexpr void setModel(std::uint8_t value)
+        {
+            bytes[0] = value;
+        }
+
+        constexpr std::uint8_t getModel() const
+        {
+            return bytes[0];
+        }
+
+        constexpr void setVolume(std::uint8_t value)
+        {
+            bytes[16] = value;
+        }
 
-        void setVolume(std::uint8_t value);
-        std::uint8_t getVolume() const;
+        constexpr std::uint8_t getVolume() const
+        {
+            return bytes[16];
+        }
+
+        constexpr void setGain(std::uint8_t value)
+        {
+            bytes[17] = value;
+        }
+
+        constexpr std::uint8_t getGain() const
+        {
+            return bytes[17];
+        }
+
+        constexpr void setGain2(std::uint8_t value)
+        {
+            bytes[18] = value;
+        }
+
+        constexpr std::uint8_t getGain2() const
+        {
+            return bytes[18];
+        }
+
+        constexpr void setMasterVolume(std::uint8_t value)
+        {
+            bytes[19] = value;
+        }
+
+        constexpr std::uint8_t getMasterVolume() const
+        {
+            return bytes[19];
+        }
+
+        constexpr void setTreble(std::uint8_t value)
+        {
+            bytes[20] = value;
+        }
+
+        constexpr std::uint8_t getTreble() const
+        {
+            return bytes[20];
+        }
+
+        constexpr void setMiddle(std::uint8_t value)
+        {
+            bytes[21] = value;
+        }
+
+        constexpr std::uint8_t getMiddle() const
+        {
+            return bytes[21];
+        }
+
+        constexpr void setBass(std::uint8_t value)
+        {
+            bytes[22] = value;
+        }
+
+        constexpr std::uint8_t getBass() const
+        {
+            return bytes[22];
+        }
+
+        constexpr void setPresence(std::uint8_t value)
+        {
+            bytes[23] = value;
+        }
+
+        constexpr std::uint8_t getPresence() const
+        {
+            return bytes[23];
+        }
 
-        void setGain(std::uint8_t value);
-        std::uint8_t getGain() const;
+        constexpr void setDepth(std::uint8_t value)
+        {
+            bytes[25] = value;
+        }
 
-        void setGain2(std::uint8_t value);
-        std::uint8_t getGain2() const;
+        constexpr std::uint8_t getDepth() const
+        {
+            return bytes[25];
+        }
 
-        void setMasterVolume(std::uint8_t value);
-        std::uint8_t getMasterVolume() const;
+        constexpr void setBias(std::uint8_t value)
+        {
+            bytes[26] = value;
+        }
+
+        constexpr std::uint8_t getBias() const
+        {
+            return bytes[26];
+        }
+
+        constexpr void setNoiseGate(std::uint8_t value)
+        {
+            bytes[31] = value;
+        }
 
-        void setTreble(std::uint8_t value);
-        std::uint8_t getTreble() const;
+        constexpr std::uint8_t getNoiseGate() const
+        {
+            return bytes[31];
+        }
 
-        void setMiddle(std::uint8_t value);
-        std::uint8_t getMiddle() const;
+        constexpr void setThreshold(std::uint8_t value)
+        {
+            bytes[32] = value;
+        }
 
-        void setBass(std::uint8_t value);
-        std::uint8_t getBass() const;
+        constexpr std::uint8_t getThreshold() const
+        {
+            return bytes[32];
+        }
 
-        void setPresence(std::uint8_t value);
-        std::uint8_t getPresence() const;
+        constexpr void setCabinet(std::uint8_t value)
+        {
+            bytes[33] = value;
+        }
 
-        void setDepth(std::uint8_t value);
-        std::uint8_t getDepth() const;
+        constexpr std::uint8_t getCabinet() const
+        {
+            return bytes[33];
+        }
 
-        void setBias(std::uint8_t value);
-        std::uint8_t getBias() const;
+        constexpr void setSag(std::uint8_t value)
+        {
+            bytes[35] = value;
+        }
 
-        void setNoiseGate(std::uint8_t value);
-        std::uint8_t getNoiseGate() const;
+        constexpr std::uint8_t getSag() const
+        {
+            return bytes[35];
+        }
 
-        void setThreshold(std::uint8_t value);
-        std::uint8_t getThreshold() const;
+        constexpr void setBrightness(std::uint8_t value)
+        {
+            bytes[36] = value;
+        }
 
-        void setCabinet(std::uint8_t value);
-        std::uint8_t getCabinet() const;
+        constexpr std::uint8_t getBrightness() const
+        {
+            return bytes[36];
+        }
 
-        void setSag(std::uint8_t value);
-        std::uint8_t getSag() const;
+        constexpr void setUnknown(std::uint8_t value0, std::uint8_t value1, std::uint8_t value2)
+        {
+            bytes[24] = value0;
+            bytes[27] = value1;
+            bytes[37] = value2;
+        }
 
-        void setBrightness(std::uint8_t value);
-        std::uint8_t getBrightness() const;
+        constexpr void setUnknownAmpSpecific(std::uint8_t value0, std::uint8_t value1, std::uint8_t value2, std::uint8_t value3, std::uint8_t value4)
+        {
+            bytes[28] = value0;
+            bytes[29] = value1;
+            bytes[30] = value2;
+            bytes[34] = value3;
+            bytes[38] = value4;
+        }
 
-        void setUnknown(std::uint8_t value0, std::uint8_t value1, std::uint8_t value2);
-        void setUnknownAmpSpecific(std::uint8_t value0, std::uint8_t value1, std::uint8_t value2, std::uint8_t value3, std::uint8_t value4);
+        constexpr void setUsbGain(std::uint8_t value)
+        {
+            bytes[0] = value;
+        }
 
-        void setUsbGain(std::uint8_t value);
-        std::uint8_t getUsbGain() const;
+        constexpr std::uint8_t getUsbGain() const
+        {
+            return bytes[0];
+        }
     };
 
 
@@ -209,55 +563,64 @@ namespace plug::com
     public:
         using RawType = PacketRawType;
 
-        Packet(const Header& h, const Payload& p)
+        constexpr Packet(const Header& h, const Payload& p)
             : header(h), payload(p)
         {
         }
 
-        Packet()
-        {
-        }
+        constexpr Packet() = default;
 
-        void setHeader(const Header& h)
+        constexpr void setHeader(const Header& h)
         {
             header = h;
         }
 
-        const Header& getHeader() const
+        constexpr const Header& getHeader() const
         {
             return header;
         }
 
-        void setPayload(const Payload& p)
+        constexpr void setPayload(const Payload& p)
         {
             payload = p;
         }
 
-        const Payload& getPayload() const
+        constexpr const Payload& getPayload() const
         {
             return payload;
         }
 
-        RawType getBytes() const
+        constexpr RawType getBytes() const
         {
             RawType bytes{{}};
             const auto headerBytes = header.getBytes();
             const auto payloadBytes = payload.getBytes();
-            const auto itr = std::copy(headerBytes.cbegin(), headerBytes.cend(), bytes.begin());
-            std::copy(payloadBytes.cbegin(), payloadBytes.cend(), itr);
 
+            for (std::size_t i = 0; i < headerBytes.size(); ++i)
+            {
+                bytes[i] = headerBytes[i];
+            }
+            for (std::size_t i = 0; i < payloadBytes.size(); ++i)
+            {
+                bytes[headerBytes.size() + i] = payloadBytes[i];
+            }
             return bytes;
         }
 
-        void fromBytes(const RawType& data)
+        constexpr void fromBytes(const RawType& data)
         {
             typename Header::RawType headerData{{}};
-            const auto startOfPayload = std::next(data.cbegin(), headerData.size());
-            std::copy(data.cbegin(), startOfPayload, headerData.begin());
-            header.fromBytes(headerData);
-
             typename Payload::RawType payloadData{{}};
-            std::copy(startOfPayload, data.cend(), payloadData.begin());
+
+            for (std::size_t i = 0; i < headerData.size(); ++i)
+            {
+                headerData[i] = data[i];
+            }
+            for (std::size_t i = 0; i < payloadData.size(); ++i)
+            {
+                payloadData[i] = data[headerData.size() + i];
+            }
+            header.fromBytes(headerData);
             payload.fromBytes(payloadData);
         }
 
@@ -21,12 +21,16 @@
 
 #pragma once
 
+#include "SignalChain.h"
 #include "data_structs.h"
 #include "effects_enum.h"
 #include "com/Packet.h"
+#include "com/DecodeResult.h"
+#include "com/FactoryPackets.h"
 #include <string>
 #include <vector>
 #include <array>
+#include <stdexcept>
 #include <cstdint>
 
 namespace plug::com
@@ -44,20 +48,151 @@ namespace plug::com
 
     std::vector<fx_pedal_settings> decodeEffectsFromData(const std::array<Packet<EffectPayload>, 4>& packet);
     std::vector<std::string> decodePresetListFromData(const std::vector<Packet<NamePayload>>& packet);
+    SignalChain decodeSignalChain(const std::array<PacketRawType, 7>& data);
+
+    // Doesn't throw on ids which aren't mapped: these are kept in the settings as unknown ids
+    // and reported. Sections holding them are written from the raw packets only, encoding them throws.
+    Decoded<SignalChain> tryDecodeSignalChain(const std::array<PacketRawType, 7>& data);
 
-    Packet<AmpPayload> serializeAmpSettings(const amp_settings& value);
-    Packet<AmpPayload> serializeAmpSettingsUsbGain(const amp_settings& value);
     Packet<NamePayload> serializeName(std::uint8_t slot, std::string_view name);
-    Packet<EffectPayload> serializeEffectSettings(const fx_pedal_settings& value);
     Packet<EffectPayload> serializeClearEffectSettings(fx_pedal_settings effect);
     Packet<NamePayload> serializeSaveEffectName(std::uint8_t slot, std::string_view name, const std::vector<fx_pedal_settings>& effects);
     std::vector<Packet<EffectPayload>> serializeSaveEffectPacket(std::uint8_t slot, const std::vector<fx_pedal_settings>& effects);
 
-    Packet<EmptyPayload> serializeLoadSlotCommand(std::uint8_t slot);
-    Packet<EmptyPayload> serializeLoadCommand();
-    Packet<EmptyPayload> serializeApplyCommand();
-    Packet<EmptyPayload> serializeApplyCommand(fx_pedal_settings effect);
+    // Packets of a preset in the layout of a memory bank dump: name, amp, the four effect DSPs and USB gain
+    std::array<PacketRawType, 7> serializeSignalChain(std::uint8_t slot, const SignalChain& chain);
+
+    // Commands writing a memory bank dump to a slot: amp, effect DSPs and USB gain as data packets,
+    // an apply command and the save command carrying the name
+    std::array<PacketRawType, 8> serializeRestoreSlotCommands(std::uint8_t slot, const std::array<PacketRawType, 7>& data);
+
+
+    constexpr Packet<AmpPayload> serializeAmpSettings(const amp_settings& value)
+    {
+        if (value.unknownModel.has_value() || value.unknownCabinet.has_value())
+        {
+            throw std::invalid_argument{"Amp with an unknown model or cabinet can't be encoded"};
+        }
+
+        const auto model = plug::value(value.amp_num);
+        auto packet = (model < ampBasePackets.size()) ? ampBasePackets[model] : detail::makeAmpBasePacket(value.amp_num);
+        AmpPayload payload = packet.getPayload();
+        payload.setVolume(value.volume);
+        payload.setGain(value.gain);
+        payload.setGain2(value.gain2);
+        payload.setMasterVolume(value.master_vol);
+        payload.setTreble(value.treble);
+        payload.setMiddle(value.middle);
+        payload.setBass(value.bass);
+        payload.setPresence(value.presence);
+        payload.setBias(value.bias);
+        payload.setNoiseGate(detail::clampToRange<std::uint8_t, 0x05>(value.noise_gate));
+        payload.setCabinet(plug::value(value.cabinet));
+        payload.setSag(detail::clampToRange<std::uint8_t, 0x02>(value.sag));
+        payload.setBrightness(value.brightness);
+
+        if (value.noise_gate == 0x05)
+        {
+            payload.setThreshold(detail::clampToRange<std::uint8_t, 0x09>(value.threshold));
+            payload.setDepth(value.depth);
+        }
+
+        packet.setPayload(payload);
+        return packet;
+    }
+
+    constexpr Packet<AmpPayload> serializeAmpSettingsUsbGain(const amp_settings& value)
+    {
+        auto packet = usbGainBasePacket;
+        AmpPayload payload{};
+        payload.setUsbGain(value.usb_gain);
+        packet.setPayload(payload);
+        return packet;
+    }
+
+    constexpr Packet<EffectPayload> serializeEffectSettings(const fx_pedal_settings& value)
+    {
+        if (value.unknownModel.has_value() || value.unknownSlot.has_value())
+        {
+            throw std::invalid_argument{"Effect with an unknown model or slot can't be encoded"};
+        }
+
+        const auto model = plug::value(value.effect_num);
+        auto packet = (model < effectBasePackets.size()) ? effectBasePackets[model] : detail::makeEffectBasePacket(value.effect_num);
+        EffectPayload payload = packet.getPayload();
+        payload.setSlot(value.slot.id());
+        payload.setKnob1(value.knob1);
+        payload.setKnob2(value.knob2);
+        payload.setKnob3(value.knob3);
+        payload.setKnob4(value.knob4);
+        payload.setKnob5(value.knob5);
+
+        if (detail::hasExtraKnob(value.effect_num) == true)
+        {
+            payload.setKnob6(value.knob6);
+        }
+
+        switch (value.effect_num)
+        {
+            case effects::SIMPLE_COMP:
+                payload.setKnob1(detail::clampToRange<std::uint8_t, 0x03>(value.knob1));
+                payload.setKnob2(0x00);
+                payload.setKnob3(0x00);
+                payload.setKnob4(0x00);
+                payload.setKnob5(0x00);
+                break;
+
+            case effects::RING_MODULATOR:
+                payload.setKnob4(detail::clampToRange<std::uint8_t, 0x01>(value.knob4));
+                break;
+
+            case effects::PHASER:
+                payload.setKnob5(detail::clampToRange<std::uint8_t, 0x01>(value.knob5));
+                break;
 
-    std::array<Packet<EmptyPayload>, 2> serializeInitCommand();
+            case effects::MULTITAP_DELAY:
+                payload.setKnob5(detail::clampToRange<std::uint8_t, 0x03>(value.knob5));
+                break;
+
+            default:
+                break;
+        }
+
+        packet.setPayload(payload);
+        return packet;
+    }
+
+    constexpr Packet<EmptyPayload> serializeLoadSlotCommand(std::uint8_t slot)
+    {
+        auto packet = loadSlotBasePacket;
+        auto header = packet.getHeader();
+        header.setSlot(slot);
+        packet.setHeader(header);
+        return packet;
+    }
+
+    constexpr Packet<EmptyPayload> serializeLoadCommand()
+    {
+        return loadCommandPacket;
+    }
+
+    constexpr Packet<EmptyPayload> serializeApplyCommand()
+    {
+        return applyCommandPacket;
+    }
+
+    constexpr Packet<EmptyPayload> serializeApplyCommand(fx_pedal_settings effect)
+    {
+        auto applyCommand = serializeApplyCommand();
+        auto header = applyCommand.getHeader();
+        header.setUnknown(detail::getFxKnob(effect), 0x00, 0x00);
+        applyCommand.setHeader(header);
+        return applyCommand;
+    }
+
+    constexpr std::array<Packet<EmptyPayload>, 2> serializeInitCommand()
+    {
+        return initCommandPackets;
+    }
 
 }
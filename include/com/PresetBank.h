@@ -0,0 +1,79 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "SignalChain.h"
+#include "com/Packet.h"
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+namespace plug::com
+{
+    // The packets of one preset, as received from a memory bank: name, amp, the four effect DSPs
+    // and USB gain.
+    using PresetRecord = std::array<PacketRawType, 7>;
+
+
+    // Preset bank file: a header packet followed by fixed size records. Since the records are the raw
+    // packets, they can be sent to the amp without decoding.
+    //
+    // Header: "PLUGBANK", version (u16), packets per record (u16), packet size (u16), reserved (u16),
+    // record count (u32), zero padding to 64 bytes. All integers are little endian.
+    namespace bank
+    {
+        inline constexpr std::uint16_t version{1};
+        inline constexpr std::size_t headerSize{packetRawTypeSize};
+        inline constexpr std::size_t recordSize{sizeof(PresetRecord)};
+        inline constexpr std::string_view fileExtension{".plugbank"};
+        // Preset slots of the largest amps (Mustang III - V); slot numbers are a single byte
+        inline constexpr std::size_t maxRecords{100};
+    }
+
+    void writeBank(const std::string& path, const std::vector<PresetRecord>& records);
+
+
+    // Read only view of a bank file, the file is mapped into memory.
+    class MappedBank
+    {
+    public:
+        explicit MappedBank(const std::string& path);
+        MappedBank(const MappedBank&) = delete;
+        ~MappedBank();
+
+        std::size_t size() const;
+
+        PresetRecord record(std::size_t index) const;
+        std::string name(std::size_t index) const;
+        SignalChain decode(std::size_t index) const;
+
+        MappedBank& operator=(const MappedBank&) = delete;
+
+    private:
+        const std::uint8_t* recordData(std::size_t index) const;
+
+        void* mapping;
+        std::size_t length;
+        std::size_t count;
+    };
+}
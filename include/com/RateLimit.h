@@ -0,0 +1,61 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "com/Connection.h"
+#include <array>
+#include <chrono>
+#include <string>
+
+namespace plug::com
+{
+    // Number of parameter updates per second an amp accepts without dropping commands; an update
+    // is a settings packet followed by an apply command.
+    struct RateLimit
+    {
+        double updatesPerSecond;
+        std::chrono::microseconds ackLatency;
+
+        std::chrono::steady_clock::duration interval() const;
+    };
+
+    // Used until a model version has been measured
+    inline constexpr RateLimit defaultRateLimit{50.0, std::chrono::microseconds{0}};
+
+
+    // Measured limits per model version, stored as text lines: "<v1|v2> <updates/s> <latency us>".
+    class RateLimits
+    {
+    public:
+        RateLimit get(ModelVersion version) const;
+        void set(ModelVersion version, const RateLimit& limit);
+
+        // A missing file yields the defaults
+        static RateLimits load(const std::string& path);
+        void save(const std::string& path) const;
+
+    private:
+        std::array<RateLimit, 2> limits{{defaultRateLimit, defaultRateLimit}};
+    };
+
+    // $XDG_CONFIG_HOME/plug/ratelimits or ~/.config/plug/ratelimits
+    std::string defaultRateLimitsPath();
+}
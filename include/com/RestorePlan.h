@@ -0,0 +1,43 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "com/PresetBank.h"
+#include <vector>
+#include <cstdint>
+
+namespace plug::com
+{
+    // Commands bringing one slot to the target state. If only a few sections differ, the slot is
+    // selected first and just those sections are sent before saving it again.
+    struct SlotUpdate
+    {
+        std::uint8_t slot;
+        bool selectSlot;
+        std::vector<PacketRawType> commands;
+    };
+
+    inline constexpr std::size_t maxPartialSections{2};
+
+    // Compares the target records with the current amp contents slot by slot, identical slots are
+    // skipped. Headers are ignored, so dumps and serialized presets compare equal.
+    std::vector<SlotUpdate> planRestore(const std::vector<PresetRecord>& current, const std::vector<PresetRecord>& target);
+}
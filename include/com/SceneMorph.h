@@ -0,0 +1,69 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "SignalChain.h"
+#include "com/Mustang.h"
+#include "com/RateLimit.h"
+#include <chrono>
+#include <functional>
+
+namespace plug::com
+{
+    // Continuous parameters are interpolated linearly. Discrete ones - models, cabinet, noise gate,
+    // threshold, sag and brightness - as well as effects without a counterpart of the same model
+    // on their DSP switch from the first to the second chain once the position reaches switchPoint.
+    SignalChain interpolate(const SignalChain& from, const SignalChain& to, double position, double switchPoint = 0.5);
+
+
+    // Glides between two presets in real time. Every frame is computed from the current time and
+    // only the DSPs changed since the previous frame are written, so frames which can't be sent in
+    // time are dropped rather than queued. The frame interval adapts to the measured time the amp
+    // takes per frame. Frames are bulk transfers, other commands are sent between two frames.
+    class SceneMorph
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+        using NowFunction = std::function<Clock::time_point()>;
+        using SleepFunction = std::function<void(Clock::time_point)>;
+
+        static constexpr Clock::duration minFrameInterval{std::chrono::milliseconds{20}};
+
+        explicit SceneMorph(Mustang& mustang);
+        SceneMorph(Mustang& mustang, NowFunction now, SleepFunction sleepUntil);
+
+        // The amp is expected to be set to the first preset; returns the number of frames sent
+        std::size_t run(const SignalChain& from, const SignalChain& to, Clock::duration duration, double switchPoint = 0.5);
+
+        // Frames are sent no faster than the limit, minFrameInterval is used by default
+        void setRateLimit(const RateLimit& limit);
+        Clock::duration frameInterval() const;
+
+    private:
+        bool send(const SignalChain& frame, const SignalChain& previous);
+
+        Mustang& mustang;
+        NowFunction now;
+        SleepFunction sleepUntil;
+        Clock::duration minimumInterval;
+        Clock::duration frameCost;
+    };
+}
@@ -0,0 +1,106 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "SignalChain.h"
+#include "com/ToneState.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+namespace plug::com
+{
+    // Append only journal of the tone changes of a session, used to recover unsaved edits after a
+    // crash.
+    //
+    // Header: "PLUGJRNL", version (u16), zero padding to 16 bytes. Each record is a type (u8), the
+    // payload size (u8), the payload and the FNV-1a hash (u32) of the preceding bytes. All integers
+    // are little endian. Payloads: snapshot (name size, name, tone state), amp (amp fields) and
+    // effect (slot, slot fields). A torn record at the end ends the replay.
+    namespace journal
+    {
+        inline constexpr std::uint16_t version{2};
+        inline constexpr std::size_t headerSize{16};
+    }
+
+    struct JournalPolicy
+    {
+        // Changes are synced at most this often, all changes in between share one sync
+        std::chrono::milliseconds syncInterval{250};
+        // Beyond this size the journal is replaced by a single snapshot
+        std::size_t compactSize{64 * 1024};
+    };
+
+
+    // Changes are only encoded into memory by the caller, they are written and synced by the
+    // journal's thread.
+    class SessionJournal
+    {
+    public:
+        // Starts a new journal with the chain as snapshot, an existing file is replaced
+        SessionJournal(const std::string& path, const SignalChain& chain, JournalPolicy policy = {});
+        SessionJournal(const SessionJournal&) = delete;
+        ~SessionJournal();
+
+        // Appends the amp and the effect slots which differ from the last update, a new name
+        // appends a snapshot
+        void update(const SignalChain& chain);
+
+        // Blocks until all updates are written and synced
+        void flush();
+
+        SessionJournal& operator=(const SessionJournal&) = delete;
+
+    private:
+        void appendSnapshot();
+        void run();
+        bool replaceFile(const std::vector<std::uint8_t>& snapshot);
+
+        const std::string path;
+        const JournalPolicy policy;
+        int fd;
+        std::size_t fileSize;
+
+        std::mutex mutex;
+        std::condition_variable wakeup;
+        std::condition_variable synced;
+        std::vector<std::uint8_t> pending;
+        std::vector<std::uint8_t> writing;
+        std::uint64_t appended;
+        std::uint64_t written;
+        std::string name;
+        ToneState state;
+        bool flushRequested;
+        bool stopping;
+        bool failed;
+        std::thread worker;
+    };
+
+
+    // Rebuilds the last chain of the journal; nothing if there's no readable journal
+    std::optional<SignalChain> recoverJournal(const std::string& path);
+}
@@ -0,0 +1,58 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "SignalChain.h"
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace plug::com
+{
+    // A fixed number of in-memory snapshots of the editor's tone. Switching between them is meant
+    // to go through Mustang::update_signal_chain(), which sends only the DSPs that differ.
+    class SnapshotRegisters
+    {
+    public:
+        explicit SnapshotRegisters(std::size_t count);
+
+        std::size_t size() const;
+
+        // Stores the chain and makes the register active
+        void store(std::size_t index, const SignalChain& chain);
+        bool isStored(std::size_t index) const;
+        const SignalChain& at(std::size_t index) const;
+
+        // Makes a stored register active and returns its chain, nothing if the register is empty
+        std::optional<SignalChain> recall(std::size_t index);
+        // Recalls the next stored register after the active one, wrapping around
+        std::optional<SignalChain> toggle();
+
+        std::optional<std::size_t> active() const;
+        void clear();
+
+    private:
+        void checkIndex(std::size_t index) const;
+
+        std::vector<std::optional<SignalChain>> registers;
+        std::optional<std::size_t> current;
+    };
+}
@@ -0,0 +1,85 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "com/Connection.h"
+#include "com/Packet.h"
+#include "com/RateLimit.h"
+#include "data_structs.h"
+#include <chrono>
+#include <functional>
+#include <vector>
+
+namespace plug::com
+{
+    struct ProbeOptions
+    {
+        double startRate{10.0};
+        double maxRate{500.0};
+        double growth{1.5};
+        std::size_t updatesPerStep{20};
+        // Fraction of the highest sustained rate used as limit
+        double safetyFactor{0.8};
+    };
+
+    struct ProbeStep
+    {
+        double updatesPerSecond;
+        std::size_t updates;
+        std::size_t timeouts;
+        std::chrono::microseconds meanLatency;
+        std::chrono::microseconds maxLatency;
+        bool sustained;
+    };
+
+    struct ProbeResult
+    {
+        RateLimit limit;
+        std::vector<ProbeStep> steps;
+    };
+
+
+    // Measures the update rate an amp sustains. The current amp settings are sent repeatedly at
+    // increasing rates, so the sound doesn't change while probing. A step is sustained if every
+    // packet is acknowledged and the acks keep up with the rate; probing stops at the first step
+    // that isn't.
+    class ThroughputProbe
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+        using NowFunction = std::function<Clock::time_point()>;
+        using SleepFunction = std::function<void(Clock::time_point)>;
+
+        explicit ThroughputProbe(Connection& connection);
+        ThroughputProbe(Connection& connection, NowFunction now, SleepFunction sleepUntil);
+
+        ProbeResult run(const amp_settings& current, const ProbeOptions& options = {});
+
+    private:
+        ProbeStep runStep(const amp_settings& current, double rate, std::size_t updates);
+        bool sendAcknowledged(const PacketRawType& packet);
+        void drain();
+
+        Connection& conn;
+        NowFunction now;
+        SleepFunction sleepUntil;
+    };
+}
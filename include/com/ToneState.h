@@ -0,0 +1,52 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "SignalChain.h"
+#include <array>
+#include <string_view>
+#include <cstdint>
+
+namespace plug::com
+{
+    // The tone of a chain as byte fields: the amp settings followed by the model, six knobs and the
+    // enabled flag of each effect slot. Ids unknown to plug are kept as a flag and id pair each: amp
+    // model and cabinet, effect model and slot. Empty slots are all zero, the name isn't part of the tone.
+    namespace tone
+    {
+        inline constexpr std::size_t ampFields{21};
+        inline constexpr std::size_t fieldsPerSlot{12};
+        inline constexpr std::size_t slotCount{8};
+    }
+
+    using ToneState = std::array<std::uint8_t, tone::ampFields + tone::slotCount * tone::fieldsPerSlot>;
+
+    ToneState toToneState(const SignalChain& chain);
+    SignalChain fromToneState(std::string_view name, const ToneState& state);
+
+    amp_settings ampFields(const ToneState& state);
+    // An empty slot is returned as a disabled empty effect
+    fx_pedal_settings slotFields(const ToneState& state, FxSlot slot);
+
+    void setAmpFields(ToneState& state, const amp_settings& amp);
+    // An empty effect clears its slot
+    void setSlotFields(ToneState& state, const fx_pedal_settings& effect);
+}
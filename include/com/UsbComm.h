@@ -36,12 +36,14 @@ namespace plug::com
         bool isOpen() const override;
 
         std::vector<std::uint8_t> receive(std::size_t recvSize) override;
+        std::vector<std::uint8_t> receiveWithin(std::size_t recvSize, std::chrono::milliseconds timeout) override;
 
         std::string name() const override;
         ModelVersion modelVersion() const override;
 
     private:
         std::size_t sendImpl(std::uint8_t* data, std::size_t size) override;
+        std::size_t receiveImpl(std::uint8_t* data, std::size_t size) override;
 
         usb::Device device_;
         const std::string name_;
@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <string>
 #include <vector>
 #include <cstdint>
@@ -67,6 +68,9 @@ namespace plug::com::usb
 
         std::size_t write(std::uint8_t endpoint, std::uint8_t* data, std::size_t dataSize);
         std::vector<std::uint8_t> receive(std::uint8_t endpoint, std::size_t dataSize);
+        // Returns the number of bytes read, 0 on timeout
+        std::size_t read(std::uint8_t endpoint, std::uint8_t* data, std::size_t dataSize);
+        std::vector<std::uint8_t> receive(std::uint8_t endpoint, std::size_t dataSize, std::chrono::milliseconds timeout);
 
         Device& operator=(Device&&) = default;
 
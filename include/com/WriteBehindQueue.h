@@ -0,0 +1,52 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "SignalChain.h"
+#include <array>
+#include <optional>
+
+namespace plug::com
+{
+    // Edits made while no amp is connected. Only the latest edit of the amp and of each effect slot
+    // is kept; applied to the amp's preset on connect they give the final state of every DSP, which
+    // is then sent in one batch.
+    class WriteBehindQueue
+    {
+    public:
+        void setAmplifier(const amp_settings& amp);
+        // An empty effect clears its slot, an effect replaces the effects queued for its DSP
+        void setEffect(const fx_pedal_settings& effect);
+        void setSignalChain(const SignalChain& chain);
+
+        bool empty() const;
+        void clear();
+
+        // The chain with the queued edits on top; an effect replaces the one on its DSP
+        SignalChain apply(const SignalChain& chain) const;
+
+    private:
+        bool replacesEffect(const fx_pedal_settings& effect) const;
+
+        std::optional<amp_settings> amp;
+        std::array<std::optional<fx_pedal_settings>, 8> slots;
+    };
+}
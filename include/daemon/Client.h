@@ -0,0 +1,63 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "daemon/Protocol.h"
+#include "com/Mustang.h"
+#include <chrono>
+#include <string>
+
+namespace plug::daemon
+{
+    // Client side of the daemon API, the methods follow those of com::Mustang
+    class Client
+    {
+    public:
+        explicit Client(const std::string& socketPath = defaultSocketPath());
+        Client(const Client&) = delete;
+        ~Client();
+
+        com::InitialData start_amp();
+        void stop_amp();
+        void set_effect(fx_pedal_settings value);
+        void set_amplifier(amp_settings value);
+        void set_signal_chain(const SignalChain& chain);
+        void save_on_amp(std::string_view name, std::uint8_t slot);
+        SignalChain load_memory_bank(std::uint8_t slot);
+
+        std::vector<com::PresetRecord> backupAll();
+        std::size_t restore(const std::vector<com::PresetRecord>& records, bool full);
+
+        // Glides from the current preset to the target; returns the number of frames sent
+        std::size_t morph(const SignalChain& target, std::chrono::milliseconds duration);
+        std::size_t morph(std::uint8_t slot, std::chrono::milliseconds duration);
+
+        std::string getDeviceName();
+        com::ModelVersion getDeviceModelVersion();
+
+        Client& operator=(const Client&) = delete;
+
+    private:
+        std::vector<std::uint8_t> request(Request type, const PayloadWriter& writer = {});
+
+        int fd;
+    };
+}
@@ -0,0 +1,73 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "SignalChain.h"
+#include <array>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+#include <cstdint>
+
+namespace plug::daemon
+{
+    // Open Sound Control messages addressing amp and effect parameters:
+    //
+    //   /amp/<parameter> <value>
+    //   /fx/<fx slot>/<parameter> <value>
+    //
+    // Integer values are taken as is, floats as fraction of the parameter range (0.0 - 1.0).
+    struct OscMessage
+    {
+        std::string address;
+        std::vector<std::variant<std::int32_t, float>> arguments;
+    };
+
+    // Decodes a datagram; the messages of bundles are returned in order, their time tags are ignored
+    std::vector<OscMessage> parseOsc(const std::uint8_t* data, std::size_t size);
+
+    std::uint8_t parameterValue(const OscMessage& message);
+
+
+    // Collects the changes of a batch of messages on top of the current preset. However many
+    // messages address a DSP, it's written at most once per batch; like on the amp, an effect
+    // takes the place of the one on its DSP, whatever slot that is in.
+    //
+    // Model and cabinet ids are validated before they are taken, floats select one of the valid ids.
+    class ParameterBatch
+    {
+    public:
+        explicit ParameterBatch(const SignalChain& current);
+
+        void add(const OscMessage& message);
+
+        std::optional<amp_settings> amp() const;
+        std::vector<fx_pedal_settings> effects() const;
+
+    private:
+        amp_settings ampState;
+        bool ampChanged;
+        std::array<std::optional<fx_pedal_settings>, 4> effectState;
+        std::array<bool, 4> effectChanged;
+        std::vector<std::uint8_t> removedSlots;
+    };
+}
@@ -0,0 +1,134 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "SignalChain.h"
+#include "com/PresetBank.h"
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+namespace plug::daemon
+{
+    // Messages are a header followed by the payload: type (u8), status (u8), reserved (u16) and
+    // payload size (u32). Integers are little endian, strings are prefixed by their size (u16).
+    enum class Request : std::uint8_t
+    {
+        info = 0x01,
+        presets,
+        current,
+        loadSlot,
+        setAmp,
+        setEffect,
+        setSignalChain,
+        saveOnAmp,
+        backup,
+        restore,
+        morph
+    };
+
+    // Target of a morph request, followed by the preset or the slot and the duration in ms
+    enum class MorphTarget : std::uint8_t
+    {
+        preset,
+        slot
+    };
+
+    enum class Status : std::uint8_t
+    {
+        ok,
+        error
+    };
+
+    struct Message
+    {
+        Request type;
+        Status status;
+        std::vector<std::uint8_t> payload;
+    };
+
+    inline constexpr std::size_t headerSize{8};
+    inline constexpr std::size_t maxPayloadSize{1024 * 1024};
+
+    std::vector<std::uint8_t> encodeMessage(const Message& message);
+
+    void writeMessage(int fd, const Message& message);
+    std::optional<Message> readMessage(int fd);
+
+    // Collects the data of a connection without blocking until complete messages are available,
+    // so a client sending a partial message can't stall the others
+    class MessageBuffer
+    {
+    public:
+        // Reads what is available; false if the peer closed the connection between two messages
+        bool receive(int fd);
+        void append(const std::uint8_t* bytes, std::size_t size);
+
+        // The next complete message, if any
+        std::optional<Message> next();
+
+    private:
+        std::vector<std::uint8_t> data;
+    };
+
+    std::string defaultSocketPath();
+
+
+    class PayloadWriter
+    {
+    public:
+        void putByte(std::uint8_t value);
+        void putU16(std::uint16_t value);
+        void putString(std::string_view value);
+        void putRecord(const com::PresetRecord& record);
+        void putAmp(const amp_settings& amp);
+        void putEffect(const fx_pedal_settings& effect);
+
+        std::vector<std::uint8_t> data() const;
+
+    private:
+        std::vector<std::uint8_t> bytes;
+    };
+
+
+    class PayloadReader
+    {
+    public:
+        explicit PayloadReader(const std::vector<std::uint8_t>& data);
+
+        std::uint8_t getByte();
+        std::uint16_t getU16();
+        std::string getString();
+        com::PresetRecord getRecord();
+        amp_settings getAmp();
+        fx_pedal_settings getEffect();
+
+        bool atEnd() const;
+
+    private:
+        const std::uint8_t* take(std::size_t size);
+
+        const std::vector<std::uint8_t>& bytes;
+        std::size_t pos;
+    };
+}
@@ -0,0 +1,62 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "daemon/Protocol.h"
+#include "com/Mustang.h"
+#include "com/RateLimit.h"
+#include <memory>
+
+namespace plug::daemon
+{
+    // Holds the amp session of the daemon and answers the requests of its clients. The preset
+    // names, the current preset and the last known amp contents are kept, so most requests don't
+    // need a round trip to the amp.
+    class Session
+    {
+    public:
+        explicit Session(std::unique_ptr<com::Connection> connection);
+
+        void start();
+        void stop();
+
+        Message handle(const Message& request);
+
+        const SignalChain& currentChain() const;
+        void setAmp(amp_settings amp);
+        void setEffect(fx_pedal_settings effect);
+
+        // Paces morphs and the OSC batches of the daemon, the default limit is used until set
+        void setRateLimit(const com::RateLimit& limit);
+        const com::RateLimit& rateLimit() const;
+
+    private:
+        std::vector<std::uint8_t> dispatch(Request type, PayloadReader& reader);
+        SignalChain morphTarget(PayloadReader& reader);
+        void readAmpBank();
+
+        com::Mustang mustang;
+        std::vector<std::string> presetNames;
+        SignalChain current;
+        std::vector<com::PresetRecord> ampBank;
+        com::RateLimit updateLimit{com::defaultRateLimit};
+    };
+}
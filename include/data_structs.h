@@ -23,6 +23,7 @@
 
 #include "FxSlot.h"
 #include "effects_enum.h"
+#include <optional>
 #include <cstdint>
 
 namespace plug
@@ -47,6 +48,10 @@ namespace plug
         std::uint8_t sag;
         bool brightness;
         std::uint8_t usb_gain;
+        // Raw ids of models plug doesn't know, eg. of a newer firmware; amp_num and cabinet hold
+        // defaults then and the settings can't be encoded
+        std::optional<std::uint8_t> unknownModel{};
+        std::optional<std::uint8_t> unknownCabinet{};
     };
 
     struct fx_pedal_settings
@@ -60,5 +65,36 @@ namespace plug
         std::uint8_t knob5;
         std::uint8_t knob6;
         bool enabled{true};
+        // Raw ids plug doesn't know; effect_num is the first model of the packet's DSP then,
+        // slot is 0 and the settings can't be encoded
+        std::optional<std::uint8_t> unknownModel{};
+        std::optional<std::uint8_t> unknownSlot{};
     };
+
+
+    inline bool operator==(const amp_settings& lhs, const amp_settings& rhs)
+    {
+        return (lhs.amp_num == rhs.amp_num) && (lhs.gain == rhs.gain) && (lhs.volume == rhs.volume) && (lhs.treble == rhs.treble) &&
+               (lhs.middle == rhs.middle) && (lhs.bass == rhs.bass) && (lhs.cabinet == rhs.cabinet) && (lhs.noise_gate == rhs.noise_gate) &&
+               (lhs.master_vol == rhs.master_vol) && (lhs.gain2 == rhs.gain2) && (lhs.presence == rhs.presence) && (lhs.threshold == rhs.threshold) &&
+               (lhs.depth == rhs.depth) && (lhs.bias == rhs.bias) && (lhs.sag == rhs.sag) && (lhs.brightness == rhs.brightness) &&
+               (lhs.usb_gain == rhs.usb_gain) && (lhs.unknownModel == rhs.unknownModel) && (lhs.unknownCabinet == rhs.unknownCabinet);
+    }
+
+    inline bool operator!=(const amp_settings& lhs, const amp_settings& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    inline bool operator==(const fx_pedal_settings& lhs, const fx_pedal_settings& rhs)
+    {
+        return (lhs.slot.id() == rhs.slot.id()) && (lhs.effect_num == rhs.effect_num) && (lhs.knob1 == rhs.knob1) && (lhs.knob2 == rhs.knob2) &&
+               (lhs.knob3 == rhs.knob3) && (lhs.knob4 == rhs.knob4) && (lhs.knob5 == rhs.knob5) && (lhs.knob6 == rhs.knob6) &&
+               (lhs.enabled == rhs.enabled) && (lhs.unknownModel == rhs.unknownModel) && (lhs.unknownSlot == rhs.unknownSlot);
+    }
+
+    inline bool operator!=(const fx_pedal_settings& lhs, const fx_pedal_settings& rhs)
+    {
+        return !(lhs == rhs);
+    }
 }
@@ -0,0 +1,34 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace plug::library
+{
+    // Packs the preset files, in the given order, into a preset bank.
+    void fuseToBank(const std::vector<std::string>& files, const std::string& bankFile);
+
+    // Writes every preset of the bank as numbered preset file into the directory. Returns the paths
+    // of the written files.
+    std::vector<std::string> bankToFuse(const std::string& bankFile, const std::string& directory);
+}
@@ -0,0 +1,51 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "library/LibraryIndex.h"
+#include <functional>
+#include <vector>
+#include <cstdint>
+
+namespace plug::library
+{
+    struct DuplicateGroup
+    {
+        // True if all files are byte for byte copies, otherwise they only decode to the same settings
+        bool identical;
+        std::uint64_t hash;
+        std::vector<std::size_t> entries;
+    };
+
+
+    // Decides if two entries with the same content hash have the same content
+    using SameContent = std::function<bool(const LibraryEntry&, const LibraryEntry&)>;
+
+    // Compares the files of the entries byte by byte; false if either can't be read
+    bool sameFileContent(const LibraryEntry& lhs, const LibraryEntry& rhs);
+
+
+    // Groups entries by their canonical signal chain; files which couldn't be decoded are grouped
+    // by content only. Entries count as copies only if their hashes match and sameContent confirms
+    // it, so a hash collision never makes distinct files identical. Returns only groups with more
+    // than one entry, ordered by their first entry.
+    std::vector<DuplicateGroup> findDuplicates(const std::vector<LibraryEntry>& entries, const SameContent& sameContent = sameFileContent);
+}
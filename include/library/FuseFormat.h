@@ -0,0 +1,37 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "SignalChain.h"
+#include <string>
+#include <string_view>
+
+namespace plug::library
+{
+    // Reads FUSE preset documents without depending on Qt; used by the GUI as well as
+    // the preset library and tools, so all of them read files the same way.
+    SignalChain parseFuse(std::string_view document);
+    SignalChain loadFuseFile(const std::string& path);
+
+    // Writes FUSE documents as saved by the GUI; the author is stored with the name.
+    std::string formatFuse(const SignalChain& chain, std::string_view author = {});
+    void saveFuseFile(const std::string& path, const SignalChain& chain, std::string_view author = {});
+}
@@ -0,0 +1,67 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "SignalChain.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace plug::library
+{
+    struct LibraryEntry
+    {
+        std::string path;
+        std::uint64_t size;
+        std::int64_t modified;
+        std::uint64_t contentHash;
+        bool valid;
+        SignalChain chain;
+    };
+
+
+    // The decoded presets of a directory. The entries can be stored in a cache file, so only new or
+    // modified files are parsed again on the next refresh.
+    class LibraryIndex
+    {
+    public:
+        // Scans the directory for preset files, ordered by file name. Returns the number of files
+        // which had to be parsed; these are parsed in parallel.
+        std::size_t refresh(const std::string& directory);
+
+        const std::vector<LibraryEntry>& entries() const;
+
+        // Returns false if the cache file is missing or incompatible, the index is empty then.
+        bool load(const std::string& cacheFile);
+        void save(const std::string& cacheFile) const;
+
+    private:
+        std::vector<LibraryEntry> entries_;
+    };
+
+
+    // Name of the cache file of a directory, shared by all tools using the index.
+    std::string cacheFileName(const std::string& directory);
+
+    // Directory of the cache files, shared by the library window and the tools. It follows the
+    // cache location Qt uses for the application ("offa/Plug"); empty if there's no home directory.
+    std::string defaultCacheDirectory();
+}
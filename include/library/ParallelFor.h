@@ -0,0 +1,54 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace plug::library
+{
+    // Calls function(i) for every i in [0, count) on all available cores. The first exception
+    // thrown by a worker is rethrown after all workers have finished.
+    template <class Function>
+    void parallelFor(std::size_t count, Function function)
+    {
+        const std::size_t workers = std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()), count);
+        std::vector<std::future<void>> tasks;
+        tasks.reserve(workers);
+
+        for (std::size_t worker = 0; worker < workers; ++worker)
+        {
+            tasks.push_back(std::async(std::launch::async, [worker, workers, count, &function]
+                                       {
+                                           for (std::size_t i = worker; i < count; i += workers)
+                                           {
+                                               function(i);
+                                           } }));
+        }
+
+        std::for_each(tasks.begin(), tasks.end(), [](auto& task)
+                      { task.wait(); });
+        std::for_each(tasks.begin(), tasks.end(), [](auto& task)
+                      { task.get(); });
+    }
+}
@@ -0,0 +1,49 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "SignalChain.h"
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+namespace plug::library
+{
+    // 64 bit FNV-1a
+    constexpr std::uint64_t hashBytes(std::string_view data)
+    {
+        std::uint64_t hash{0xcbf29ce484222325};
+
+        for (const char c : data)
+        {
+            hash ^= static_cast<std::uint8_t>(c);
+            hash *= 0x100000001b3;
+        }
+        return hash;
+    }
+
+
+    // Byte representation of the settings of a chain. It doesn't depend on the preset name or on
+    // the order of the effects, so presets sounding the same have the same representation.
+    std::string canonicalize(const SignalChain& chain);
+
+    std::uint64_t hashSignalChain(const SignalChain& chain);
+}
@@ -0,0 +1,59 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "SignalChain.h"
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+namespace plug::library
+{
+    std::string describeSignalChain(const SignalChain& chain);
+
+
+    class SearchIndex
+    {
+    public:
+        using Id = std::size_t;
+
+        void insert(Id id, std::string_view name, std::string_view metadata = {});
+        void clear();
+
+        std::size_t size() const;
+
+        // Returns the ids of all entries containing every term of the query, in insertion order. If
+        // the query extends the previous one, only the previous matches are rechecked.
+        std::vector<Id> search(std::string_view query);
+
+    private:
+        std::vector<std::size_t> fullSearch(const std::vector<std::string>& terms) const;
+        bool matches(std::size_t entry, const std::vector<std::string>& terms) const;
+
+        std::vector<Id> ids;
+        std::vector<std::string> texts;
+        std::unordered_map<std::uint32_t, std::vector<std::size_t>> trigrams;
+        std::string lastQuery;
+        std::vector<std::size_t> lastMatches;
+    };
+}
@@ -0,0 +1,104 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "SignalChain.h"
+#include "com/Mustang.h"
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace plug::library
+{
+    struct AmpSlot
+    {
+        std::uint8_t slot;
+    };
+
+    // A memory slot of the amp or the path of a FUSE file
+    using SetlistEntry = std::variant<AmpSlot, std::string>;
+
+    // One entry per line: a number selects a memory slot of the amp, anything else is a FUSE file
+    // relative to the directory. Empty lines and lines starting with '#' are skipped.
+    // Slots are numbered from 1 to slots, as shown in the UI; AmpSlot holds the 0-based slot.
+    std::vector<SetlistEntry> parseSetlist(std::string_view text, const std::string& directory, std::size_t slots);
+    std::vector<SetlistEntry> loadSetlistFile(const std::string& path, std::size_t slots);
+
+
+    // Steps through a setlist. While an entry is active its neighbours are loaded and their packets
+    // are prepared in the background, so switching only costs sending them. Amp slots are read up
+    // front, since reading a slot switches the amp to it.
+    class SetlistPlayer
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        struct Transition
+        {
+            std::size_t index;
+            // From the request until the amp acknowledged every packet
+            Clock::duration latency;
+            // The entry was prepared before it was requested
+            bool prefetched;
+        };
+
+        SetlistPlayer(com::Mustang& mustang, std::vector<SetlistEntry> entries);
+        SetlistPlayer(const SetlistPlayer&) = delete;
+        ~SetlistPlayer();
+
+        // Files which can't be loaded throw once they are selected
+        Transition select(std::size_t index);
+        // Nothing at the end of the setlist
+        std::optional<Transition> next();
+        std::optional<Transition> previous();
+        // Blocks until the entries around the active one are prepared
+        void waitForPrefetch() const;
+
+        std::size_t size() const;
+        std::optional<std::size_t> position() const;
+        const SignalChain& current() const;
+
+        SetlistPlayer& operator=(const SetlistPlayer&) = delete;
+
+    private:
+        struct Prepared
+        {
+            SignalChain chain;
+            std::vector<com::PacketRawType> commands;
+        };
+
+        void prefetch(std::size_t index);
+        Prepared prepare(std::size_t index) const;
+
+        com::Mustang& mustang;
+        const std::vector<SetlistEntry> entries;
+        std::map<std::uint8_t, SignalChain> ampSlots;
+        std::vector<std::shared_future<Prepared>> prepared;
+        std::optional<std::size_t> active;
+        SignalChain chain;
+    };
+}
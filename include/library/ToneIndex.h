@@ -0,0 +1,68 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "SignalChain.h"
+#include <array>
+#include <vector>
+#include <cstdint>
+
+namespace plug::library
+{
+    // Nearest neighbour search over signal chains. Every chain is encoded as a fixed length feature
+    // vector, stored column wise so the distance kernel runs over contiguous arrays.
+    class ToneIndex
+    {
+    public:
+        using Id = std::size_t;
+
+        struct Match
+        {
+            Id id;
+            float distance;
+        };
+
+        void insert(Id id, const SignalChain& chain);
+        void clear();
+
+        std::size_t size() const;
+
+        // Returns up to k entries ordered by ascending distance to the chain.
+        std::vector<Match> nearest(const SignalChain& chain, std::size_t k) const;
+
+
+        static constexpr std::size_t effectFamilies{4};
+        static constexpr std::size_t ampFeatures{14};
+        static constexpr std::size_t features{ampFeatures + effectFamilies * 6};
+        static constexpr std::size_t categories{2 + effectFamilies};
+
+        using FeatureVector = std::array<float, features>;
+        using CategoryVector = std::array<std::uint8_t, categories>;
+
+        static FeatureVector encodeFeatures(const SignalChain& chain);
+        static CategoryVector encodeCategories(const SignalChain& chain);
+
+    private:
+        std::vector<Id> ids;
+        std::array<std::vector<float>, features> featureColumns;
+        std::array<std::vector<std::uint8_t>, categories> categoryColumns;
+    };
+}
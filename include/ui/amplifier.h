@@ -51,7 +51,11 @@ namespace plug
         Amplifier& operator=(const Amplifier&) = delete;
 
     private:
+        void set_advanced(const amp_settings& settings);
+        void update_advanced();
+
         const std::unique_ptr<Ui::Amplifier> ui;
+        // Created when first opened
         std::unique_ptr<Amp_Advanced> advanced;
         amps amp_num;
         unsigned char gain, volume, treble, middle, bass;
@@ -85,9 +89,13 @@ namespace plug
         void send_amp();
 
         void load(amp_settings);
+        void update(amp_settings);
         void get_settings(amp_settings*);
         void enable_set_button(bool);
 
         void showAndActivate();
+
+    private slots:
+        void show_advanced();
     };
 }
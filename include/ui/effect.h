@@ -79,12 +79,14 @@ namespace plug
         void set_knob6(int);
         void choose_fx(int);
         void off_switch(bool);
+        void toggle_off_switch();
         void enable_set_button(bool);
 
         // send settings to the amplifier
         void send_fx();
 
         void load(fx_pedal_settings);
+        void update(fx_pedal_settings);
         void load_default_fx();
 
         void showAndActivate();
@@ -21,6 +21,10 @@
 
 #pragma once
 
+#include "library/LibraryIndex.h"
+#include "library/SearchIndex.h"
+#include "library/ToneIndex.h"
+#include "com/PresetBank.h"
 #include <QDialog>
 #include <QResizeEvent>
 #include <QFileInfoList>
@@ -49,15 +53,26 @@ namespace plug
     private:
         const std::unique_ptr<Ui::Library> ui;
         const std::unique_ptr<QFileInfoList> files;
+        library::SearchIndex ampIndex;
+        library::SearchIndex fileIndex;
+        library::LibraryIndex presetFiles;
+        library::ToneIndex toneIndex;
+        std::unique_ptr<com::MappedBank> bank;
         void resizeEvent(QResizeEvent*) override;
+        void show_files(const std::vector<std::size_t>& rows, const std::vector<QString>& notes = {});
 
     private slots:
         void load_slot(std::size_t slot);
         void get_directory();
         void get_files(const QString&);
+        void open_bank();
         void load_file(std::size_t row);
         void change_font_size(int);
         void change_font_family(QFont);
+        void filter(const QString&);
+        void show_similar(bool);
+        void show_duplicates(bool);
+        void update_files();
 
     signals:
         void directory_changed(QString);
@@ -21,6 +21,7 @@
 
 #pragma once
 
+#include "library/SearchIndex.h"
 #include <QMainWindow>
 #include <vector>
 #include <memory>
@@ -49,9 +50,15 @@ namespace plug
         LoadFromAmp& operator=(const LoadFromAmp&) = delete;
 
     private:
+        void populate(const std::vector<library::SearchIndex::Id>& slots);
+        void rebuildIndex();
+
         const std::unique_ptr<Ui::LoadFromAmp> ui;
+        std::vector<QString> labels;
+        library::SearchIndex index;
 
     private slots:
         void load();
+        void filter(const QString&);
     };
 }
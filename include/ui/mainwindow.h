@@ -21,9 +21,17 @@
 
 #pragma once
 
+#include "SignalChain.h"
 #include "data_structs.h"
+#include "com/AmpEvents.h"
+#include "com/EditHistory.h"
+#include "com/WriteBehindQueue.h"
+#include "com/SnapshotRegisters.h"
+#include "com/PresetBank.h"
+#include "com/ToneState.h"
 #include <QMainWindow>
 #include <array>
+#include <chrono>
 #include <memory>
 
 namespace Ui
@@ -45,6 +53,13 @@ namespace plug
     namespace com
     {
         class Mustang;
+        class AmpEventListener;
+        class SessionJournal;
+    }
+
+    namespace library
+    {
+        class SetlistPlayer;
     }
 }
 
@@ -75,26 +90,86 @@ namespace plug
         void save_effects(int, char*, int, bool, bool, bool);
         void set_index(int);
         void loadfile(QString filename = QString());
+        void load_signal_chain(const SignalChain& chain);
         void get_settings(amp_settings*, std::vector<fx_pedal_settings>&);
         void change_title(const QString&);
         void update_firmware();
+        void backup_amp();
+        void restore_amp();
         void empty_other(int, Effect*);
+        void apply_amp_events(const std::vector<com::AmpEvent>& events);
+        void undo_edit();
+        void redo_edit();
+        void open_setlist();
+        void next_song();
+        void previous_song();
+        void toggle_snapshot();
 
     private:
+        SignalChain current_tone() const;
+        void resend_amp();
+        void record_edit();
+        void set_tone(const SignalChain& chain);
+        void resync_amp_events(const SignalChain& chain);
+        void restore_session();
+        void close_journal();
+        void show_tone(const SignalChain& chain);
+        void show_song(std::chrono::steady_clock::duration latency, bool prefetched);
+        void store_snapshot(std::size_t index);
+        void recall_snapshot(std::size_t index);
+        void apply_snapshot(std::size_t index, const SignalChain& chain);
+        Amplifier* amp_window();
+        Effect* effect_window(std::size_t slot);
+        void track_unknown_models(const SignalChain& chain);
+        void load_amp(const amp_settings& settings, bool popup);
+        void load_effect(const fx_pedal_settings& effect, bool popup);
+        void enable_set_buttons(bool value);
+        SaveOnAmp* save_window();
+        LoadFromAmp* load_window();
+        QuickPresets* quick_presets_window();
+        template <class Window>
+        Window* create_window(Window*& window);
+        void load_preset_names();
+        void clear_preset_names();
+        bool apply_history_step(const SignalChain& current, const SignalChain& target);
+
         const std::unique_ptr<Ui::MainWindow> ui;
 
         QString current_name;
+        // Preset names of the amp, the preset windows are filled from them when first shown
         std::vector<std::string> presetNames;
+        int presetIndex;
+        std::vector<com::PresetRecord> ampBank;
         bool connected;
         std::unique_ptr<com::Mustang> amp_ops;
+        std::unique_ptr<com::AmpEventListener> eventListener;
+        // Tone of the editor, the amp and effect windows are created when first used and start with it
+        com::ToneState editorTone;
         Amplifier* amp;
         std::array<Effect*, 8> effectComponents;
+        // Applied to the windows created later
+        bool setButtonsEnabled;
+        // Dialogs are created on first use
         SaveOnAmp* save;
         LoadFromAmp* load;
         SaveEffects* seffects;
         Settings* settings_win;
         SaveToFile* saver;
         QuickPresets* quickpres;
+        com::EditHistory history;
+        // Tone of the last recorded step
+        SignalChain tone;
+        std::unique_ptr<com::SessionJournal> journal;
+        // Edits made while disconnected, sent on connect
+        com::WriteBehindQueue offlineEdits;
+        std::unique_ptr<library::SetlistPlayer> setlist;
+        // Sections of the amp's preset with models PLUG doesn't know, edits of them aren't sent
+        bool unknownAmp;
+        std::array<bool, com::tone::slotCount> unknownEffects;
+        // A/B registers of the editor's tone
+        com::SnapshotRegisters snapshots{4};
+        bool recordEdits;
+        bool applyingHistory;
 
     private slots:
         void about();
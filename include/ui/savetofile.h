@@ -23,7 +23,6 @@
 
 #include "data_structs.h"
 #include <QDialog>
-#include <QXmlStreamWriter>
 #include <vector>
 #include <memory>
 
@@ -51,12 +50,5 @@ namespace plug
 
     private:
         const std::unique_ptr<Ui::SaveToFile> ui;
-        std::unique_ptr<QXmlStreamWriter> xml;
-
-        void writeAmp(amp_settings);
-        void manageWriteFX(const std::vector<fx_pedal_settings>& settings);
-        void writeFX(fx_pedal_settings);
-        void writeFUSE();
-        void writeUSBGain(int);
     };
 }
@@ -0,0 +1,223 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/AmpEvents.h"
+#include "com/IdLookup.h"
+#include "com/PacketSerializer.h"
+#include <stdexcept>
+
+namespace plug::com
+{
+    namespace
+    {
+        std::size_t effectIndex(DSP dsp)
+        {
+            return static_cast<std::size_t>(dsp) - static_cast<std::size_t>(DSP::effect0);
+        }
+
+        // Preset names are sent with the id of the effect name operation
+        inline constexpr DSP presetNameDsp{DSP::opSaveEffectName};
+    }
+
+
+    AmpEventDecoder::AmpEventDecoder(const SignalChain& current)
+    {
+        resync(current);
+    }
+
+    void AmpEventDecoder::resync(const SignalChain& current)
+    {
+        name = current.name();
+        amp = current.amp();
+        effectsByDsp.fill(std::nullopt);
+
+        for (const auto& effect : current.effects())
+        {
+            if ((effect.enabled == true) && (effect.effect_num != effects::EMPTY))
+            {
+                effectsByDsp[effectIndex(dspFromEffect(effect.effect_num))] = effect;
+            }
+        }
+    }
+
+    // Acks and packets with unknown ids are ignored
+    std::vector<AmpEvent> AmpEventDecoder::decode(const PacketRawType& packet)
+    {
+        if (isStatePacket(packet) == false)
+        {
+            return {};
+        }
+
+        try
+        {
+            switch (const auto dsp = fromRawData<EmptyPayload>(packet).getHeader().getDSP(); dsp)
+            {
+                case presetNameDsp:
+                    return decodeName(packet);
+                case DSP::amp:
+                    return decodeAmp(packet);
+                case DSP::usbGain:
+                    return decodeUsbGain(packet);
+                case DSP::effect0:
+                case DSP::effect1:
+                case DSP::effect2:
+                case DSP::effect3:
+                    return decodeEffect(effectIndex(dsp), packet);
+                default:
+                    return {};
+            }
+        }
+        catch (const std::domain_error&)
+        {
+            return {};
+        }
+        catch (const std::invalid_argument&)
+        {
+            return {};
+        }
+    }
+
+    SignalChain AmpEventDecoder::state() const
+    {
+        EffectList chainEffects;
+
+        for (const auto& effect : effectsByDsp)
+        {
+            if (effect.has_value() == true)
+            {
+                chainEffects.push_back(*effect);
+            }
+        }
+        return SignalChain{name, amp, chainEffects};
+    }
+
+    std::vector<AmpEvent> AmpEventDecoder::decodeName(const PacketRawType& packet)
+    {
+        const auto decoded = decodeNameFromData(fromRawData<NamePayload>(packet));
+
+        if (decoded == name)
+        {
+            return {};
+        }
+        name = decoded;
+        return {PresetNameChange{name}};
+    }
+
+    // The usb gain is sent separately
+    std::vector<AmpEvent> AmpEventDecoder::decodeAmp(const PacketRawType& packet)
+    {
+        const auto data = fromRawData<AmpPayload>(packet);
+        auto decoded = decodeAmpFromData(data, data);
+        decoded.usb_gain = amp.usb_gain;
+
+        if (decoded == amp)
+        {
+            return {};
+        }
+        amp = decoded;
+        return {amp};
+    }
+
+    std::vector<AmpEvent> AmpEventDecoder::decodeUsbGain(const PacketRawType& packet)
+    {
+        const auto gain = fromRawData<AmpPayload>(packet).getPayload().getUsbGain();
+
+        if (gain == amp.usb_gain)
+        {
+            return {};
+        }
+        amp.usb_gain = gain;
+        return {amp};
+    }
+
+    std::vector<AmpEvent> AmpEventDecoder::decodeEffect(std::size_t index, const PacketRawType& packet)
+    {
+        std::optional<fx_pedal_settings> decoded;
+
+        if (const auto effect = decodeEffectsFromData({{fromRawData<EffectPayload>(packet), {}, {}, {}}})[0]; effect.effect_num != effects::EMPTY)
+        {
+            decoded = effect;
+        }
+
+        auto& current = effectsByDsp[index];
+        std::vector<AmpEvent> events;
+
+        if (current.has_value() && ((decoded.has_value() == false) || (current->slot.id() != decoded->slot.id())))
+        {
+            events.push_back(EffectChange{current->slot, std::nullopt});
+        }
+        if (decoded.has_value() && ((current.has_value() == false) || (*current != *decoded)))
+        {
+            events.push_back(EffectChange{decoded->slot, decoded});
+        }
+
+        current = decoded;
+        return events;
+    }
+
+
+    AmpEventListener::AmpEventListener(Mustang& mustangRef, const SignalChain& current, Callback eventCallback)
+        : mustang(mustangRef), decoder(current), callback(eventCallback), worker([this]
+                                                                                 { run(); })
+    {
+    }
+
+    AmpEventListener::~AmpEventListener()
+    {
+        running = false;
+        worker.join();
+    }
+
+    void AmpEventListener::resync(const SignalChain& current)
+    {
+        const std::lock_guard lock{mutex};
+        decoder.resync(current);
+    }
+
+    void AmpEventListener::run()
+    {
+        while (running == true)
+        {
+            std::vector<AmpEvent> events;
+
+            try
+            {
+                const auto packets = mustang.receiveEvents(pollTimeout);
+                const std::lock_guard lock{mutex};
+
+                for (const auto& packet : packets)
+                {
+                    const auto decoded = decoder.decode(packet);
+                    events.insert(events.end(), decoded.cbegin(), decoded.cend());
+                }
+            }
+            catch (const std::exception&)
+            {
+                // The connection is gone, commands report the error
+                return;
+            }
+
+            if (events.empty() == false)
+            {
+                callback(events);
+            }
+        }
+    }
+}
@@ -0,0 +1,133 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/CommandExecutor.h"
+#include <stdexcept>
+
+namespace plug::com
+{
+    CommandExecutor::CommandExecutor(std::unique_ptr<Connection> connection)
+        : conn(std::move(connection))
+    {
+        if (conn == nullptr)
+        {
+            throw std::invalid_argument{"No connection"};
+        }
+        worker = std::thread{[this]
+                             { work(); }};
+    }
+
+    CommandExecutor::~CommandExecutor()
+    {
+        {
+            std::lock_guard lock{mutex};
+            stopping = true;
+        }
+        submitted.notify_one();
+        worker.join();
+    }
+
+    void CommandExecutor::enqueue(Priority priority, Task& task)
+    {
+        {
+            std::lock_guard lock{mutex};
+            auto& queue = queues[static_cast<std::size_t>(priority)];
+
+            if (queue.tail == nullptr)
+            {
+                queue.head = &task;
+            }
+            else
+            {
+                queue.tail->next = &task;
+            }
+            queue.tail = &task;
+        }
+        submitted.notify_one();
+    }
+
+    // An operation run by another operation is run right away, waiting for it would never end
+    void CommandExecutor::execute(Priority priority, Task& task)
+    {
+        if (std::this_thread::get_id() == worker.get_id())
+        {
+            task.execute(*conn);
+            return;
+        }
+
+        enqueue(priority, task);
+
+        std::unique_lock lock{mutex};
+        finished.wait(lock, [&task]
+                      { return task.done; });
+    }
+
+    CommandExecutor::Task* CommandExecutor::next()
+    {
+        for (auto& queue : queues)
+        {
+            if (Task* task = queue.head; task != nullptr)
+            {
+                queue.head = task->next;
+
+                if (queue.head == nullptr)
+                {
+                    queue.tail = nullptr;
+                }
+                return task;
+            }
+        }
+        return nullptr;
+    }
+
+    void CommandExecutor::work()
+    {
+        while (true)
+        {
+            Task* task{nullptr};
+            {
+                std::unique_lock lock{mutex};
+                submitted.wait(lock, [this, &task]
+                               {
+                    task = next();
+                    return stopping || (task != nullptr); });
+
+                if (task == nullptr)
+                {
+                    return;
+                }
+            }
+
+            task->execute(*conn);
+
+            if (task->detached == true)
+            {
+                delete task;
+                continue;
+            }
+
+            {
+                std::lock_guard lock{mutex};
+                task->done = true;
+            }
+            finished.notify_all();
+        }
+    }
+}
@@ -0,0 +1,87 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/CommandScheduler.h"
+#include <algorithm>
+
+namespace plug::com
+{
+    namespace
+    {
+        std::size_t index(Priority priority)
+        {
+            return static_cast<std::size_t>(priority);
+        }
+    }
+
+
+    CommandScheduler::Lease::Lease(CommandScheduler& owner)
+        : scheduler(&owner)
+    {
+    }
+
+    CommandScheduler::Lease::Lease(Lease&& other) noexcept
+        : scheduler(other.scheduler)
+    {
+        other.scheduler = nullptr;
+    }
+
+    CommandScheduler::Lease::~Lease()
+    {
+        if (scheduler != nullptr)
+        {
+            scheduler->release();
+        }
+    }
+
+
+    CommandScheduler::Lease CommandScheduler::acquire(Priority priority)
+    {
+        const auto i = index(priority);
+        std::unique_lock lock{mutex};
+        const auto ticket = nextTicket[i]++;
+        ++waiters[i];
+
+        released.wait(lock, [this, i, ticket]
+                      { return (busy == false) && (serving[i] == ticket) &&
+                               std::all_of(waiters.cbegin(), std::next(waiters.cbegin(), i), [](std::size_t n)
+                                           { return n == 0; }); });
+
+        --waiters[i];
+        ++serving[i];
+        busy = true;
+        return Lease{*this};
+    }
+
+    std::size_t CommandScheduler::waiting(Priority priority) const
+    {
+        std::lock_guard lock{mutex};
+        return waiters[index(priority)];
+    }
+
+    void CommandScheduler::release()
+    {
+        {
+            std::lock_guard lock{mutex};
+            busy = false;
+        }
+        released.notify_all();
+    }
+}
@@ -56,7 +56,7 @@ namespace plug::com
         }
     }
 
-    std::shared_ptr<Connection> createUsbConnection()
+    std::unique_ptr<Connection> createUsbConnection()
     {
         auto devices = usb::listDevices();
 
@@ -69,6 +69,6 @@ namespace plug::com
             throw CommunicationException{"No device found"};
         }
         const auto modelVersion = isV2(itr->productId()) ? ModelVersion::v2 : ModelVersion::v1;
-        return std::make_shared<UsbComm>(std::move(*itr), modelVersion);
+        return std::make_unique<UsbComm>(std::move(*itr), modelVersion);
     }
 }
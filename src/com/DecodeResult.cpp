@@ -0,0 +1,54 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/DecodeResult.h"
+#include <iomanip>
+#include <sstream>
+
+namespace plug::com
+{
+    namespace
+    {
+        std::string fieldName(DecodeField field)
+        {
+            switch (field)
+            {
+                case DecodeField::amp:
+                    return "amp";
+                case DecodeField::cabinet:
+                    return "cabinet";
+                case DecodeField::effect:
+                    return "effect";
+                case DecodeField::fxSlot:
+                    return "fx slot";
+                default:
+                    return "field";
+            }
+        }
+    }
+
+    std::string describe(const DecodeDiagnostic& diagnostic)
+    {
+        std::ostringstream out;
+        out << "packet " << diagnostic.packet << ": " << fieldName(diagnostic.field) << " unknown(0x"
+            << std::hex << std::setw(2) << std::setfill('0') << int{diagnostic.rawId} << ")";
+        return out.str();
+    }
+}
@@ -0,0 +1,140 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/EditHistory.h"
+#include "com/ToneState.h"
+#include <algorithm>
+
+namespace plug::com
+{
+    namespace
+    {
+        constexpr std::uint8_t stepEnd{0x80};
+
+        static_assert(std::tuple_size_v<ToneState> <= stepEnd, "field ids must not collide with the step marker");
+    }
+
+
+    void EditHistory::record(const SignalChain& before, const SignalChain& after)
+    {
+        const auto from = toToneState(before);
+        const auto to = toToneState(after);
+        std::size_t count{0};
+
+        for (std::size_t i = 0; i < from.size(); ++i)
+        {
+            count += (from[i] != to[i]) ? 1 : 0;
+        }
+
+        if (count == 0)
+        {
+            return;
+        }
+
+        end = cursor;
+
+        while ((end - first + count) > capacity)
+        {
+            dropOldestStep();
+        }
+
+        for (std::size_t i = 0; i < from.size(); ++i)
+        {
+            if (from[i] != to[i])
+            {
+                at(end++) = FieldChange{static_cast<std::uint8_t>(i), from[i], to[i]};
+            }
+        }
+        at(end - 1).field |= stepEnd;
+        cursor = end;
+    }
+
+    std::optional<SignalChain> EditHistory::undo(const SignalChain& current)
+    {
+        if (canUndo() == false)
+        {
+            return std::nullopt;
+        }
+
+        auto state = toToneState(current);
+
+        do
+        {
+            --cursor;
+            const auto& change = at(cursor);
+            state[change.field & ~stepEnd] = change.before;
+        } while ((cursor > first) && ((at(cursor - 1).field & stepEnd) == 0));
+
+        return fromToneState(current.name(), state);
+    }
+
+    std::optional<SignalChain> EditHistory::redo(const SignalChain& current)
+    {
+        if (canRedo() == false)
+        {
+            return std::nullopt;
+        }
+
+        auto state = toToneState(current);
+        bool stepDone{false};
+
+        while (stepDone == false)
+        {
+            const auto& change = at(cursor++);
+            state[change.field & ~stepEnd] = change.after;
+            stepDone = ((change.field & stepEnd) != 0);
+        }
+
+        return fromToneState(current.name(), state);
+    }
+
+    bool EditHistory::canUndo() const
+    {
+        return cursor > first;
+    }
+
+    bool EditHistory::canRedo() const
+    {
+        return cursor < end;
+    }
+
+    void EditHistory::clear()
+    {
+        first = 0;
+        cursor = 0;
+        end = 0;
+    }
+
+    EditHistory::FieldChange& EditHistory::at(std::size_t position)
+    {
+        return changes[position % capacity];
+    }
+
+    void EditHistory::dropOldestStep()
+    {
+        bool stepDone{false};
+
+        while ((stepDone == false) && (first < end))
+        {
+            stepDone = ((at(first++).field & stepEnd) != 0);
+        }
+        cursor = std::max(cursor, first);
+    }
+}
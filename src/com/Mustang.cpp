@@ -24,17 +24,71 @@
 #include "com/CommunicationException.h"
 #include "com/Packet.h"
 #include <algorithm>
+#include <array>
+#include <chrono>
+#include <string>
 
 namespace plug::com
 {
-    SignalChain decode_data(const std::array<PacketRawType, 7>& data)
+    namespace
     {
-        const auto name = decodeNameFromData(fromRawData<NamePayload>(data[0]));
-        const auto amp = decodeAmpFromData(fromRawData<AmpPayload>(data[1]), fromRawData<AmpPayload>(data[6]));
-        const auto effects = decodeEffectsFromData({{fromRawData<EffectPayload>(data[2]), fromRawData<EffectPayload>(data[3]),
-                                                     fromRawData<EffectPayload>(data[4]), fromRawData<EffectPayload>(data[5])}});
+        // One effect of each DSP, used to clear a DSP
+        inline constexpr std::array<effects, 4> dspEffects{{effects::OVERDRIVE, effects::SINE_CHORUS, effects::MONO_DELAY, effects::SMALL_HALL_REVERB}};
 
-        return SignalChain{name, amp, effects};
+        const fx_pedal_settings* effectOn(const EffectList& effects, DSP dsp)
+        {
+            const auto itr = std::find_if(effects.cbegin(), effects.cend(), [dsp](const auto& e)
+                                          { return e.enabled && (dspFromEffect(e.effect_num) == dsp); });
+            return (itr != effects.cend()) ? &(*itr) : nullptr;
+        }
+
+        // DSP id of each packet of a preset dump; the name may also come as save operation (0x03)
+        inline constexpr std::array<std::uint8_t, 7> presetSectionDsps{{0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0d}};
+
+        // Packets which aren't state packets count as ack, as does a receive which times out
+        void receiveAcks(Connection& conn, std::size_t count, PendingEvents& events)
+        {
+            PacketRawType packet;
+
+            while (count > 0)
+            {
+                if ((conn.receiveInto(packet) == packet.size()) && (isStatePacket(packet) == true))
+                {
+                    events.push(packet);
+                }
+                else
+                {
+                    --count;
+                }
+            }
+        }
+    }
+
+    bool isStatePacket(const PacketRawType& packet)
+    {
+        return (packet[0] == 0x1c) && (std::find(presetSectionDsps.cbegin(), presetSectionDsps.cend(), packet[2]) != presetSectionDsps.cend());
+    }
+
+    void PendingEvents::push(const PacketRawType& packet)
+    {
+        if (count < packets.size())
+        {
+            packets[(first + count) % packets.size()] = packet;
+            ++count;
+        }
+    }
+
+    std::optional<PacketRawType> PendingEvents::pop()
+    {
+        if (count == 0)
+        {
+            return std::nullopt;
+        }
+
+        const auto packet = packets[first];
+        first = (first + 1) % packets.size();
+        --count;
+        return packet;
     }
 
     std::vector<std::uint8_t> receivePacket(Connection& conn)
@@ -43,155 +97,484 @@ namespace plug::com
     }
 
 
-    void sendCommand(Connection& conn, const PacketRawType& packet)
+    // The ack is received into a stack buffer, so commands don't allocate
+    void sendCommand(Connection& conn, const PacketRawType& packet, PendingEvents& events)
     {
         conn.send(packet);
-        receivePacket(conn);
+        receiveAcks(conn, 1, events);
     }
 
-    void sendApplyCommand(Connection& conn)
+    void sendApplyCommand(Connection& conn, PendingEvents& events)
     {
-        sendCommand(conn, serializeApplyCommand().getBytes());
+        sendCommand(conn, serializeApplyCommand().getBytes(), events);
     }
 
-    std::array<PacketRawType, 7> loadBankData(Connection& conn, std::uint8_t slot)
+    void loadBankData(Connection& conn, std::uint8_t slot, PresetRecord& data)
     {
-        std::array<PacketRawType, 7> data{{}};
+        data = {};
+        PacketRawType surplus;
 
         const auto loadCommand = serializeLoadSlotCommand(slot);
         auto n = conn.send(loadCommand.getBytes());
 
         for (std::size_t i = 0; n != 0; ++i)
+        {
+            n = conn.receiveInto(i < data.size() ? data[i] : surplus);
+        }
+    }
+
+
+    namespace
+    {
+
+        bool isPresetSection(std::size_t section, std::uint8_t dsp)
+        {
+            return (dsp == presetSectionDsps[section]) || ((section == 0) && (dsp == 0x03));
+        }
+
+        bool isPresetPacket(std::uint8_t dsp)
+        {
+            return (dsp == 0x03) || (std::find(presetSectionDsps.cbegin(), presetSectionDsps.cend(), dsp) != presetSectionDsps.cend());
+        }
+
+        // Packets trailing a dump are sent right after it; waiting this long instead of the USB
+        // timeout keeps a slot at a few milliseconds
+        inline constexpr std::chrono::milliseconds dumpDrainTimeout{20};
+    }
+
+    // Selects a slot and reads the seven preset packets it is answered with. Packets of other DSPs,
+    // which the amp sends in between, are skipped; trailing packets are drained with a short
+    // timeout, so the next command starts at its own answer.
+    PresetRecord selectSlot(Connection& conn, std::uint8_t slot)
+    {
+        conn.send(serializeLoadSlotCommand(slot).getBytes());
+
+        PresetRecord record{{}};
+        std::size_t section{0};
+
+        while (section < record.size())
         {
             const auto recvData = receivePacket(conn);
-            n = recvData.size();
 
-            if (i < 7)
+            if (recvData.size() != record[section].size())
+            {
+                throw CommunicationException{"Incomplete preset data of slot " + std::to_string(slot)};
+            }
+
+            const auto dsp = recvData[2];
+
+            if (isPresetSection(section, dsp) == true)
             {
-                std::copy(recvData.cbegin(), recvData.cend(), data[i].begin());
+                std::copy(recvData.cbegin(), recvData.cend(), record[section].begin());
+                ++section;
             }
+            else if (isPresetPacket(dsp) == true)
+            {
+                throw CommunicationException{"Unexpected packet of DSP " + std::to_string(dsp) + " in preset data of slot " + std::to_string(slot)};
+            }
+        }
+
+        while (conn.receiveWithin(packetRawTypeSize, dumpDrainTimeout).empty() == false)
+        {
         }
-        return data;
+        return record;
     }
 
+    void sendCommands(Connection& conn, const std::vector<PacketRawType>& commands, PendingEvents& events)
+    {
+        std::for_each(commands.cbegin(), commands.cend(), [&conn](const auto& p)
+                      { conn.send(p); });
+        receiveAcks(conn, commands.size(), events);
+    }
+
+
+    // The settings are encoded first, an effect which can't be encoded doesn't clear its DSP
+    template <class Function>
+    void forEachEffectCommand(const fx_pedal_settings& value, Function send)
+    {
+        const bool enable = (value.enabled == true) && (value.effect_num != effects::EMPTY);
+        const auto settings = enable ? serializeEffectSettings(value).getBytes() : PacketRawType{};
+
+        send(serializeClearEffectSettings(value).getBytes());
+        send(serializeApplyCommand().getBytes());
 
-    Mustang::Mustang(std::shared_ptr<Connection> connection)
-        : conn(connection)
+        if (enable == true)
+        {
+            send(settings);
+            send(serializeApplyCommand().getBytes());
+        }
+    }
+
+    template <class Function>
+    void forEachAmpCommand(const amp_settings& value, Function send)
     {
+        send(serializeAmpSettings(value).getBytes());
+        send(serializeApplyCommand().getBytes());
+        send(serializeAmpSettingsUsbGain(value).getBytes());
+        send(serializeApplyCommand().getBytes());
     }
 
-    InitialData Mustang::start_amp()
+    // Only the packets whose fields differ are written: the amp and USB gain packets separately,
+    // just the settings of an effect which keeps its model and slot, DSPs no longer used are cleared
+    template <class Function>
+    bool forEachChangeCommand(const SignalChain& previous, const SignalChain& chain, Function send)
     {
-        if (conn->isOpen() == false)
+        bool changed{false};
+        auto ampWithPreviousGain = chain.amp();
+        ampWithPreviousGain.usb_gain = previous.amp().usb_gain;
+
+        if (ampWithPreviousGain != previous.amp())
+        {
+            send(serializeAmpSettings(chain.amp()).getBytes());
+            send(serializeApplyCommand().getBytes());
+            changed = true;
+        }
+
+        if (chain.amp().usb_gain != previous.amp().usb_gain)
+        {
+            send(serializeAmpSettingsUsbGain(chain.amp()).getBytes());
+            send(serializeApplyCommand().getBytes());
+            changed = true;
+        }
+
+        for (const auto effect : dspEffects)
         {
-            throw CommunicationException{"Device not connected"};
+            const auto dsp = dspFromEffect(effect);
+            const auto current = effectOn(chain.effects(), dsp);
+            const auto last = effectOn(previous.effects(), dsp);
+
+            if ((current != nullptr) && (last != nullptr) && (current->effect_num == last->effect_num) && (current->slot.id() == last->slot.id()))
+            {
+                if (*current != *last)
+                {
+                    send(serializeEffectSettings(*current).getBytes());
+                    send(serializeApplyCommand().getBytes());
+                    changed = true;
+                }
+            }
+            else if (current != nullptr)
+            {
+                forEachEffectCommand(*current, send);
+                changed = true;
+            }
+            else if (last != nullptr)
+            {
+                auto cleared = *last;
+                cleared.enabled = false;
+                forEachEffectCommand(cleared, send);
+                changed = true;
+            }
         }
+        return changed;
+    }
+
+    template <class Function>
+    void forEachChainCommand(const SignalChain& chain, Function send)
+    {
+        forEachAmpCommand(chain.amp(), send);
 
-        initializeAmp();
+        for (std::size_t i = 0; i < dspEffects.size(); ++i)
+        {
+            const auto effect = effectOn(chain.effects(), dspFromEffect(dspEffects[i]));
 
-        return loadData();
+            if (effect != nullptr)
+            {
+                forEachEffectCommand(*effect, send);
+            }
+            else
+            {
+                forEachEffectCommand(fx_pedal_settings{FxSlot{static_cast<std::uint8_t>(i)}, dspEffects[i], 0, 0, 0, 0, 0, 0, false}, send);
+            }
+        }
     }
 
-    void Mustang::stop_amp()
+    void setEffect(Connection& conn, const fx_pedal_settings& value, PendingEvents& events)
     {
-        conn->close();
+        forEachEffectCommand(value, [&conn, &events](const PacketRawType& packet)
+                             { sendCommand(conn, packet, events); });
     }
 
-    void Mustang::set_effect(fx_pedal_settings value)
+    void setAmplifier(Connection& conn, const amp_settings& value, PendingEvents& events)
     {
-        const auto clearEffectPacket = serializeClearEffectSettings(value);
-        sendCommand(*conn, clearEffectPacket.getBytes());
-        sendApplyCommand(*conn);
+        forEachAmpCommand(value, [&conn, &events](const PacketRawType& packet)
+                          { sendCommand(conn, packet, events); });
+    }
 
-        if ((value.enabled == true) && (value.effect_num != effects::EMPTY))
+
+    std::vector<PacketRawType> serializeSignalChainCommands(const SignalChain& chain)
+    {
+        std::vector<PacketRawType> commands;
+        forEachChainCommand(chain, [&commands](const PacketRawType& packet)
+                            { commands.push_back(packet); });
+        return commands;
+    }
+
+    bool changesUnknownModels(const SignalChain& previous, const SignalChain& chain)
+    {
+        const auto& amp = chain.amp();
+        auto ampWithPreviousGain = amp;
+        ampWithPreviousGain.usb_gain = previous.amp().usb_gain;
+
+        if ((amp.unknownModel.has_value() || amp.unknownCabinet.has_value()) && (ampWithPreviousGain != previous.amp()))
+        {
+            return true;
+        }
+
+        return std::any_of(dspEffects.cbegin(), dspEffects.cend(), [&previous, &chain](effects effect)
+                           {
+            const auto dsp = dspFromEffect(effect);
+            const auto current = effectOn(chain.effects(), dsp);
+            const auto last = effectOn(previous.effects(), dsp);
+            return (current != nullptr) && (current->unknownModel.has_value() || current->unknownSlot.has_value()) &&
+                   ((last == nullptr) || (*current != *last)); });
+    }
+
+
+    namespace
+    {
+        void initializeAmp(Connection& conn, PendingEvents& events)
         {
-            const auto settingsPacket = serializeEffectSettings(value);
-            sendCommand(*conn, settingsPacket.getBytes());
-            sendApplyCommand(*conn);
+            const auto packets = serializeInitCommand();
+            std::for_each(packets.cbegin(), packets.cend(), [&conn, &events](const auto& p)
+                          { sendCommand(conn, p.getBytes(), events); });
         }
+
+        InitialData loadData(Connection& conn)
+        {
+            std::vector<std::array<std::uint8_t, 64>> recieved_data;
+
+            const auto loadCommand = serializeLoadCommand();
+            auto recieved = conn.send(loadCommand.getBytes());
+
+            while (recieved != 0)
+            {
+                const auto recvData = receivePacket(conn);
+                recieved = recvData.size();
+                PacketRawType p{};
+                std::copy(recvData.cbegin(), recvData.cend(), p.begin());
+                recieved_data.push_back(p);
+            }
+
+            const std::size_t max_to_receive = (recieved_data.size() > 143 ? 200 : 48);
+            std::vector<Packet<NamePayload>> presetListData;
+            presetListData.reserve(max_to_receive);
+            std::transform(recieved_data.cbegin(), std::next(recieved_data.cbegin(), max_to_receive), std::back_inserter(presetListData), [](const auto& p)
+                           {
+                Packet<NamePayload> packet{};
+                packet.fromBytes(p);
+                return packet; });
+            auto presetNames = decodePresetListFromData(presetListData);
+
+            std::array<PacketRawType, 7> presetData{{}};
+            std::copy(std::next(recieved_data.cbegin(), max_to_receive), std::next(recieved_data.cbegin(), max_to_receive + 7), presetData.begin());
+
+            auto [signalChain, diagnostics] = tryDecodeSignalChain(presetData);
+            return {signalChain, presetNames, diagnostics};
+        }
+    }
+
+
+    Mustang::Mustang(std::unique_ptr<Connection> connection)
+        : executor(std::move(connection))
+    {
+    }
+
+    InitialData Mustang::start_amp()
+    {
+        return executor.run(Priority::normal, [this](Connection& conn)
+                            {
+            if (conn.isOpen() == false)
+            {
+                throw CommunicationException{"Device not connected"};
+            }
+
+            initializeAmp(conn, pendingEvents);
+            return loadData(conn); });
+    }
+
+    void Mustang::stop_amp()
+    {
+        executor.run(Priority::normal, [](Connection& conn)
+                     { conn.close(); });
+    }
+
+    void Mustang::set_effect(fx_pedal_settings value)
+    {
+        executor.run(Priority::interactive, [this, &value](Connection& conn)
+                     { setEffect(conn, value, pendingEvents); });
     }
 
     void Mustang::set_amplifier(amp_settings value)
     {
-        const auto settingsPacket = serializeAmpSettings(value);
-        sendCommand(*conn, settingsPacket.getBytes());
-        sendApplyCommand(*conn);
+        executor.run(Priority::interactive, [this, &value](Connection& conn)
+                     { setAmplifier(conn, value, pendingEvents); });
+    }
+
+    // Effect DSPs not used by the chain are cleared
+    void Mustang::set_signal_chain(const SignalChain& chain)
+    {
+        executor.run(Priority::interactive, [this, &chain](Connection& conn)
+                     { forEachChainCommand(chain, [this, &conn](const PacketRawType& packet)
+                                           { sendCommand(conn, packet, pendingEvents); }); });
+    }
+
+    bool Mustang::update_signal_chain(const SignalChain& previous, const SignalChain& chain, Priority priority)
+    {
+        return executor.run(priority, [this, &previous, &chain](Connection& conn)
+                            { return forEachChangeCommand(previous, chain, [this, &conn](const PacketRawType& packet)
+                                                          { sendCommand(conn, packet, pendingEvents); }); });
+    }
+
+    std::size_t Mustang::write_signal_chain(const SignalChain& previous, const SignalChain& chain)
+    {
+        std::vector<PacketRawType> commands;
+        forEachChangeCommand(previous, chain, [&commands](const PacketRawType& packet)
+                             { commands.push_back(packet); });
+        write_commands(commands);
+        return commands.size();
+    }
 
-        const auto settingsGainPacket = serializeAmpSettingsUsbGain(value);
-        sendCommand(*conn, settingsGainPacket.getBytes());
-        sendApplyCommand(*conn);
+    void Mustang::write_commands(const std::vector<PacketRawType>& commands)
+    {
+        executor.run(Priority::interactive, [this, &commands](Connection& conn)
+                     { sendCommands(conn, commands, pendingEvents); });
     }
 
     void Mustang::save_on_amp(std::string_view name, std::uint8_t slot)
     {
         const auto data = serializeName(slot, name).getBytes();
-        sendCommand(*conn, data);
-        loadBankData(*conn, slot);
+
+        executor.run(Priority::normal, [this, &data, slot](Connection& conn)
+                     {
+            sendCommand(conn, data, pendingEvents);
+
+            PresetRecord record;
+            loadBankData(conn, slot, record); });
     }
 
     SignalChain Mustang::load_memory_bank(std::uint8_t slot)
     {
-        return decode_data(loadBankData(*conn, slot));
+        PresetRecord record;
+        load_memory_bank(slot, record);
+        return tryDecodeSignalChain(record).value;
+    }
+
+    void Mustang::load_memory_bank(std::uint8_t slot, PresetRecord& record)
+    {
+        executor.run(Priority::normal, [slot, &record](Connection& conn)
+                     { loadBankData(conn, slot, record); });
     }
 
     void Mustang::save_effects(std::uint8_t slot, std::string_view name, const std::vector<fx_pedal_settings>& effects)
     {
         const auto saveNamePacket = serializeSaveEffectName(slot, name, effects);
-        sendCommand(*conn, saveNamePacket.getBytes());
-
         const auto packets = serializeSaveEffectPacket(slot, effects);
-        std::for_each(packets.cbegin(), packets.cend(), [this](const auto& p)
-                      { sendCommand(*conn, p.getBytes()); });
 
-        sendCommand(*conn, serializeApplyCommand(effects[0]).getBytes());
-    }
+        executor.run(Priority::normal, [&](Connection& conn)
+                     {
+            sendCommand(conn, saveNamePacket.getBytes(), pendingEvents);
+            std::for_each(packets.cbegin(), packets.cend(), [this, &conn](const auto& p)
+                          { sendCommand(conn, p.getBytes(), pendingEvents); });
 
-    std::string Mustang::getDeviceName() const
-    {
-        return conn->name();
+            sendCommand(conn, serializeApplyCommand(effects[0]).getBytes(), pendingEvents); });
     }
 
-    ModelVersion Mustang::getDeviceModelVersion() const
+    // Each slot is read completely before the next one is requested, so extra packets of a dump
+    // can't shift the following slots. Other commands may run between two slots.
+    std::vector<PresetRecord> Mustang::backupAll(std::size_t slots, const ProgressCallback& progress)
     {
-        return conn->modelVersion();
+        std::vector<PresetRecord> records;
+        records.reserve(slots);
+
+        for (std::size_t slot = 0; slot < slots; ++slot)
+        {
+            records.push_back(executor.run(Priority::bulk, [slot](Connection& conn)
+                                           { return selectSlot(conn, static_cast<std::uint8_t>(slot)); }));
+
+            if (progress)
+            {
+                progress(slot + 1, slots);
+            }
+        }
+        return records;
     }
 
-    InitialData Mustang::loadData()
+    void Mustang::restoreAll(const std::vector<PresetRecord>& records, const ProgressCallback& progress)
     {
-        std::vector<std::array<std::uint8_t, 64>> recieved_data;
+        for (std::size_t slot = 0; slot < records.size(); ++slot)
+        {
+            const auto commands = serializeRestoreSlotCommands(static_cast<std::uint8_t>(slot), records[slot]);
+            executor.run(Priority::bulk, [this, &commands](Connection& conn)
+                         { sendCommands(conn, {commands.cbegin(), commands.cend()}, pendingEvents); });
 
-        const auto loadCommand = serializeLoadCommand();
-        auto recieved = conn->send(loadCommand.getBytes());
+            if (progress)
+            {
+                progress(slot + 1, records.size());
+            }
+        }
+    }
 
-        while (recieved != 0)
+    // Partial updates select their slot first, the dump it is answered with is read before sending the sections
+    void Mustang::restore(const std::vector<SlotUpdate>& updates, const ProgressCallback& progress)
+    {
+        for (std::size_t i = 0; i < updates.size(); ++i)
         {
-            const auto recvData = receivePacket(*conn);
-            recieved = recvData.size();
-            PacketRawType p{};
-            std::copy(recvData.cbegin(), recvData.cend(), p.begin());
-            recieved_data.push_back(p);
+            executor.run(Priority::bulk, [this, &update = updates[i]](Connection& conn)
+                         {
+                if (update.selectSlot == true)
+                {
+                    selectSlot(conn, update.slot);
+                }
+                sendCommands(conn, update.commands, pendingEvents); });
+
+            if (progress)
+            {
+                progress(i + 1, updates.size());
+            }
         }
+    }
+
+    // Each packet is received by an operation of its own, so commands get the connection in between;
+    // packets which arrived while a command waited for its ack come first. Stray acks are dropped.
+    std::vector<PacketRawType> Mustang::receiveEvents(std::chrono::milliseconds timeout)
+    {
+        std::vector<PacketRawType> packets;
+        const auto receiveEvent = [this, timeout](Connection& conn) -> std::optional<PacketRawType>
+        {
+            if (const auto pending = pendingEvents.pop(); pending.has_value() == true)
+            {
+                return pending;
+            }
 
-        const std::size_t max_to_receive = (recieved_data.size() > 143 ? 200 : 48);
-        std::vector<Packet<NamePayload>> presetListData;
-        presetListData.reserve(max_to_receive);
-        std::transform(recieved_data.cbegin(), std::next(recieved_data.cbegin(), max_to_receive), std::back_inserter(presetListData), [](const auto& p)
-                       {
-            Packet<NamePayload> packet{};
-            packet.fromBytes(p);
-            return packet; });
-        auto presetNames = decodePresetListFromData(presetListData);
+            for (auto data = conn.receiveWithin(packetRawTypeSize, timeout); data.size() == packetRawTypeSize; data = conn.receiveWithin(packetRawTypeSize, timeout))
+            {
+                PacketRawType packet{};
+                std::copy(data.cbegin(), data.cend(), packet.begin());
 
-        std::array<PacketRawType, 7> presetData{{}};
-        std::copy(std::next(recieved_data.cbegin(), max_to_receive), std::next(recieved_data.cbegin(), max_to_receive + 7), presetData.begin());
+                if (isStatePacket(packet) == true)
+                {
+                    return packet;
+                }
+            }
+            return std::nullopt;
+        };
 
-        return {decode_data(presetData), presetNames};
+        for (auto packet = executor.run(Priority::bulk, receiveEvent); packet.has_value() == true; packet = executor.run(Priority::bulk, receiveEvent))
+        {
+            packets.push_back(*packet);
+        }
+        return packets;
     }
 
-    void Mustang::initializeAmp()
+    std::string Mustang::getDeviceName() const
+    {
+        return executor.run(Priority::normal, [](Connection& conn)
+                            { return conn.name(); });
+    }
+
+    ModelVersion Mustang::getDeviceModelVersion() const
     {
-        const auto packets = serializeInitCommand();
-        std::for_each(packets.cbegin(), packets.cend(), [this](const auto& p)
-                      { sendCommand(*conn, p.getBytes()); });
+        return executor.run(Priority::normal, [](Connection& conn)
+                            { return conn.modelVersion(); });
     }
 }
@@ -23,112 +23,108 @@
 #include "com/IdLookup.h"
 #include "effects_enum.h"
 #include <algorithm>
+#include <optional>
 
 namespace plug::com
 {
     namespace
     {
-        template <class T, T upperBound>
-        constexpr T clampToRange(T value)
-        {
-            return std::clamp(value, T{0}, upperBound);
-        }
+        // A model of each effect DSP, in the order of the effect packets of a dump
+        constexpr std::array<effects, 4> dspEffects{{effects::OVERDRIVE, effects::SINE_CHORUS, effects::MONO_DELAY, effects::SMALL_HALL_REVERB}};
 
-        constexpr std::uint8_t getFxKnob(const fx_pedal_settings& effect)
+        std::size_t getSaveEffectsRepeats(const std::vector<fx_pedal_settings>& effects)
         {
-            if ((effect.effect_num >= effects::SINE_CHORUS) && (effect.effect_num <= effects::PITCH_SHIFTER))
+            const auto size = effects.size();
+
+            if (size > 2)
+            {
+                return 1;
+            }
+            const auto effect = effects[0].effect_num;
+
+            if ((effect >= effects::SINE_CHORUS) && (effect <= effects::PITCH_SHIFTER))
             {
-                return 0x01;
+                return 1;
             }
-            return 0x02;
+            return size;
         }
 
+        void throwOnUnknown(DecodeField field, std::uint8_t id)
+        {
+            throw std::invalid_argument{describe(DecodeDiagnostic{0, field, id})};
+        }
 
-        constexpr bool hasExtraKnob(effects e)
+        // An id which isn't mapped is reported and kept as unknown id, the field takes the fallback
+        template <class T, class OnUnknown>
+        T orUnknown(std::optional<T> value, T fallback, std::optional<std::uint8_t>& unknownId, DecodeField field, std::uint8_t id, OnUnknown onUnknown)
         {
-            switch (e)
+            if (value.has_value() == false)
             {
-                case effects::MONO_ECHO_FILTER:
-                case effects::STEREO_ECHO_FILTER:
-                case effects::TAPE_DELAY:
-                case effects::STEREO_TAPE_DELAY:
-                    return true;
-                default:
-                    return false;
+                onUnknown(field, id);
+                unknownId = id;
+                return fallback;
             }
+            return *value;
         }
 
+        template <class OnUnknown>
+        amp_settings decodeAmp(const AmpPayload& payload, const AmpPayload& usbGainPayload, OnUnknown onUnknown)
+        {
+            amp_settings settings{};
+            settings.amp_num = orUnknown(findAmpById(payload.getModel()), amps::FENDER_57_DELUXE, settings.unknownModel, DecodeField::amp, payload.getModel(), onUnknown);
+            settings.gain = payload.getGain();
+            settings.volume = payload.getVolume();
+            settings.treble = payload.getTreble();
+            settings.middle = payload.getMiddle();
+            settings.bass = payload.getBass();
+            settings.cabinet = orUnknown(findCabinetById(payload.getCabinet()), cabinets::OFF, settings.unknownCabinet, DecodeField::cabinet, payload.getCabinet(), onUnknown);
+            settings.noise_gate = payload.getNoiseGate();
+            settings.master_vol = payload.getMasterVolume();
+            settings.gain2 = payload.getGain2();
+            settings.presence = payload.getPresence();
+            settings.threshold = payload.getThreshold();
+            settings.depth = payload.getDepth();
+            settings.bias = payload.getBias();
+            settings.sag = payload.getSag();
+            settings.brightness = payload.getBrightness();
+            settings.usb_gain = usbGainPayload.getUsbGain();
+            return settings;
+        }
 
-        std::size_t getSaveEffectsRepeats(const std::vector<fx_pedal_settings>& effects)
+        // An unknown model decodes as the fallback, which is a model of the packet's DSP
+        template <class OnUnknown>
+        fx_pedal_settings decodeEffect(const EffectPayload& payload, effects fallback, OnUnknown onUnknown)
         {
-            const auto size = effects.size();
+            fx_pedal_settings settings{FxSlot{0}, effects::EMPTY, payload.getKnob1(), payload.getKnob2(), payload.getKnob3(),
+                                       payload.getKnob4(), payload.getKnob5(), payload.getKnob6(), true};
+            settings.effect_num = orUnknown(findEffectById(payload.getModel()), fallback, settings.unknownModel, DecodeField::effect, payload.getModel(), onUnknown);
 
-            if (size > 2)
+            if (const auto slot = payload.getSlot(); FxSlot::isValid(slot) == true)
             {
-                return 1;
+                settings.slot = FxSlot{slot};
             }
-            const auto effect = effects[0].effect_num;
-
-            if ((effect >= effects::SINE_CHORUS) && (effect <= effects::PITCH_SHIFTER))
+            else
             {
-                return 1;
+                onUnknown(DecodeField::fxSlot, slot);
+                settings.unknownSlot = slot;
             }
-            return size;
+            return settings;
         }
 
-
-        constexpr DSP dspFromEffect(effects effect)
+        // Decodes a chain without allocating; reportIn(packet) returns the handler of unknown ids within that packet
+        template <class ReportIn>
+        SignalChain decodeChain(const std::array<PacketRawType, 7>& data, ReportIn reportIn)
         {
-            switch (effect)
+            const auto amp = decodeAmp(fromRawData<AmpPayload>(data[1]).getPayload(), fromRawData<AmpPayload>(data[6]).getPayload(), reportIn(1));
+            EffectList effects;
+
+            for (std::size_t i = 2; i < 6; ++i)
             {
-                case effects::OVERDRIVE:
-                case effects::WAH:
-                case effects::TOUCH_WAH:
-                case effects::FUZZ:
-                case effects::FUZZ_TOUCH_WAH:
-                case effects::SIMPLE_COMP:
-                case effects::COMPRESSOR:
-                    return DSP::effect0;
-
-                case effects::SINE_CHORUS:
-                case effects::TRIANGLE_CHORUS:
-                case effects::SINE_FLANGER:
-                case effects::TRIANGLE_FLANGER:
-                case effects::VIBRATONE:
-                case effects::VINTAGE_TREMOLO:
-                case effects::SINE_TREMOLO:
-                case effects::RING_MODULATOR:
-                case effects::STEP_FILTER:
-                case effects::PHASER:
-                case effects::PITCH_SHIFTER:
-                    return DSP::effect1;
-
-                case effects::MONO_DELAY:
-                case effects::MONO_ECHO_FILTER:
-                case effects::STEREO_ECHO_FILTER:
-                case effects::MULTITAP_DELAY:
-                case effects::PING_PONG_DELAY:
-                case effects::DUCKING_DELAY:
-                case effects::REVERSE_DELAY:
-                case effects::TAPE_DELAY:
-                case effects::STEREO_TAPE_DELAY:
-                    return DSP::effect2;
-
-                case effects::SMALL_HALL_REVERB:
-                case effects::LARGE_HALL_REVERB:
-                case effects::SMALL_ROOM_REVERB:
-                case effects::LARGE_ROOM_REVERB:
-                case effects::SMALL_PLATE_REVERB:
-                case effects::LARGE_PLATE_REVERB:
-                case effects::AMBIENT_REVERB:
-                case effects::ARENA_REVERB:
-                case effects::FENDER_63_SPRING_REVERB:
-                case effects::FENDER_65_SPRING_REVERB:
-                    return DSP::effect3;
-
-                default:
-                    return DSP::none;
+                effects.push_back(decodeEffect(fromRawData<EffectPayload>(data[i]).getPayload(), dspEffects[i - 2], reportIn(i)));
             }
+
+            const auto namePacket = fromRawData<NamePayload>(data[0]);
+            return SignalChain{namePacket.getPayload().getNameView(), amp, effects, data};
         }
     }
 
@@ -140,46 +136,14 @@ namespace plug::com
 
     amp_settings decodeAmpFromData(const Packet<AmpPayload>& packet, const Packet<AmpPayload>& packetUsbGain)
     {
-        const auto payload = packet.getPayload();
-
-        amp_settings settings{};
-        settings.amp_num = lookupAmpById(payload.getModel());
-        settings.gain = payload.getGain();
-        settings.volume = payload.getVolume();
-        settings.treble = payload.getTreble();
-        settings.middle = payload.getMiddle();
-        settings.bass = payload.getBass();
-        settings.cabinet = lookupCabinetById(payload.getCabinet());
-        settings.noise_gate = payload.getNoiseGate();
-        settings.master_vol = payload.getMasterVolume();
-        settings.gain2 = payload.getGain2();
-        settings.presence = payload.getPresence();
-        settings.threshold = payload.getThreshold();
-        settings.depth = payload.getDepth();
-        settings.bias = payload.getBias();
-        settings.sag = payload.getSag();
-        settings.brightness = payload.getBrightness();
-        settings.usb_gain = packetUsbGain.getPayload().getUsbGain();
-        return settings;
+        return decodeAmp(packet.getPayload(), packetUsbGain.getPayload(), throwOnUnknown);
     }
 
     std::vector<fx_pedal_settings> decodeEffectsFromData(const std::array<Packet<EffectPayload>, 4>& packet)
     {
         std::vector<fx_pedal_settings> effects;
-
         std::transform(packet.cbegin(), packet.cend(), std::back_inserter(effects), [](const auto& p)
-                       {
-            const auto payload = p.getPayload();
-            return fx_pedal_settings{FxSlot{payload.getSlot()},
-                    lookupEffectById(payload.getModel()),
-                    payload.getKnob1(),
-                    payload.getKnob2(),
-                    payload.getKnob3(),
-                    payload.getKnob4(),
-                    payload.getKnob5(),
-                    payload.getKnob6(),
-                    true
-                    }; });
+                       { return decodeEffect(p.getPayload(), effects::EMPTY, throwOnUnknown); });
         return effects;
     }
 
@@ -197,119 +161,19 @@ namespace plug::com
         return presetNames;
     }
 
-    Packet<AmpPayload> serializeAmpSettings(const amp_settings& value)
+    SignalChain decodeSignalChain(const std::array<PacketRawType, 7>& data)
     {
-        Header header{};
-        header.setStage(Stage::ready);
-        header.setType(Type::data);
-        header.setDSP(DSP::amp);
-        header.setUnknown(0x00, 0x01, 0x01);
-
-        AmpPayload payload{};
-        payload.setVolume(value.volume);
-        payload.setGain(value.gain);
-        payload.setGain2(value.gain2);
-        payload.setMasterVolume(value.master_vol);
-        payload.setTreble(value.treble);
-        payload.setMiddle(value.middle);
-        payload.setBass(value.bass);
-        payload.setPresence(value.presence);
-        payload.setBias(value.bias);
-        payload.setNoiseGate(clampToRange<std::uint8_t, 0x05>(value.noise_gate));
-        payload.setCabinet(plug::value(value.cabinet));
-        payload.setSag(clampToRange<std::uint8_t, 0x02>(value.sag));
-        payload.setBrightness(value.brightness);
-        payload.setUnknown(0x80, 0x80, 0x01);
-
-        if (value.noise_gate == 0x05)
-        {
-            payload.setThreshold(clampToRange<uint8_t, 0x09>(value.threshold));
-            payload.setDepth(value.depth);
-        }
-        else
-        {
-            payload.setDepth(0x80);
-        }
-
-        switch (value.amp_num)
-        {
-            case amps::FENDER_57_DELUXE:
-                payload.setModel(0x67);
-                payload.setUnknownAmpSpecific(0x01, 0x01, 0x01, 0x01, 0x53);
-                break;
-
-            case amps::FENDER_59_BASSMAN:
-                payload.setModel(0x64);
-                payload.setUnknownAmpSpecific(0x02, 0x02, 0x02, 0x02, 0x67);
-                break;
-
-            case amps::FENDER_57_CHAMP:
-                payload.setModel(0x7c);
-                payload.setUnknownAmpSpecific(0x0c, 0x0c, 0x0c, 0x0c, 0x00);
-                break;
-
-            case amps::FENDER_65_DELUXE_REVERB:
-                payload.setModel(0x53);
-                payload.setUnknownAmpSpecific(0x03, 0x03, 0x03, 0x03, 0x6a);
-                payload.setUnknown(0x00, 0x00, 0x01);
-                break;
-
-            case amps::FENDER_65_PRINCETON:
-                payload.setModel(0x6a);
-                payload.setUnknownAmpSpecific(0x04, 0x04, 0x04, 0x04, 0x61);
-                break;
-
-            case amps::FENDER_65_TWIN_REVERB:
-                payload.setModel(0x75);
-                payload.setUnknownAmpSpecific(0x05, 0x05, 0x05, 0x05, 0x72);
-                break;
-
-            case amps::FENDER_SUPER_SONIC:
-                payload.setModel(0x72);
-                payload.setUnknownAmpSpecific(0x06, 0x06, 0x06, 0x06, 0x79);
-                break;
-
-            case amps::BRITISH_60S:
-                payload.setModel(0x61);
-                payload.setUnknownAmpSpecific(0x07, 0x07, 0x07, 0x07, 0x5e);
-                break;
-
-            case amps::BRITISH_70S:
-                payload.setModel(0x79);
-                payload.setUnknownAmpSpecific(0x0b, 0x0b, 0x0b, 0x0b, 0x7c);
-                break;
-
-            case amps::BRITISH_80S:
-                payload.setModel(0x5e);
-                payload.setUnknownAmpSpecific(0x09, 0x09, 0x09, 0x09, 0x5d);
-                break;
-
-            case amps::AMERICAN_90S:
-                payload.setModel(0x5d);
-                payload.setUnknownAmpSpecific(0x0a, 0x0a, 0x0a, 0x0a, 0x6d);
-                break;
-
-            case amps::METAL_2000:
-                payload.setModel(0x6d);
-                payload.setUnknownAmpSpecific(0x08, 0x08, 0x08, 0x08, 0x75);
-                break;
-        }
-
-        return Packet<AmpPayload>{header, payload};
+        return decodeChain(data, [](std::size_t)
+                           { return throwOnUnknown; });
     }
 
-    Packet<AmpPayload> serializeAmpSettingsUsbGain(const amp_settings& value)
+    Decoded<SignalChain> tryDecodeSignalChain(const std::array<PacketRawType, 7>& data)
     {
-        Header header{};
-        header.setStage(Stage::ready);
-        header.setType(Type::data);
-        header.setDSP(DSP::usbGain);
-        header.setUnknown(0x00, 0x01, 0x01);
-
-        AmpPayload payload{};
-        payload.setUsbGain(value.usb_gain);
-
-        return Packet<AmpPayload>{header, payload};
+        std::vector<DecodeDiagnostic> diagnostics;
+        const auto chain = decodeChain(data, [&diagnostics](std::size_t packet)
+                                       { return [&diagnostics, packet](DecodeField field, std::uint8_t id)
+                                         { diagnostics.push_back(DecodeDiagnostic{packet, field, id}); }; });
+        return {chain, diagnostics};
     }
 
     Packet<NamePayload> serializeName(std::uint8_t slot, std::string_view name)
@@ -327,216 +191,6 @@ namespace plug::com
         return Packet<NamePayload>{header, payload};
     }
 
-    Packet<EffectPayload> serializeEffectSettings(const fx_pedal_settings& value)
-    {
-        Header header{};
-        header.setStage(Stage::ready);
-        header.setType(Type::data);
-        header.setUnknown(0x00, 0x01, 0x01);
-        header.setDSP(dspFromEffect(value.effect_num));
-
-        EffectPayload payload{};
-        payload.setSlot(value.slot.id());
-        payload.setUnknown(0x00, 0x08, 0x01);
-        payload.setKnob1(value.knob1);
-        payload.setKnob2(value.knob2);
-        payload.setKnob3(value.knob3);
-        payload.setKnob4(value.knob4);
-        payload.setKnob5(value.knob5);
-
-        if (hasExtraKnob(value.effect_num) == true)
-        {
-            payload.setKnob6(value.knob6);
-        }
-
-        switch (value.effect_num)
-        {
-            case effects::OVERDRIVE:
-                payload.setModel(0x3c);
-                break;
-
-            case effects::WAH:
-                payload.setModel(0x49);
-                payload.setUnknown(0x01, 0x08, 0x01);
-                break;
-
-            case effects::TOUCH_WAH:
-                payload.setModel(0x4a);
-                payload.setUnknown(0x01, 0x08, 0x01);
-                break;
-
-            case effects::FUZZ:
-                payload.setModel(0x1a);
-                break;
-
-            case effects::FUZZ_TOUCH_WAH:
-                payload.setModel(0x1c);
-                break;
-
-            case effects::SIMPLE_COMP:
-                payload.setModel(0x88);
-                payload.setKnob1(clampToRange<std::uint8_t, 0x03>(value.knob1));
-                payload.setKnob2(0x00);
-                payload.setKnob3(0x00);
-                payload.setKnob4(0x00);
-                payload.setKnob5(0x00);
-                payload.setUnknown(0x08, 0x08, 0x01);
-                break;
-
-            case effects::COMPRESSOR:
-                payload.setModel(0x07);
-                break;
-
-            case effects::SINE_CHORUS:
-                payload.setModel(0x12);
-                payload.setUnknown(0x01, 0x01, 0x01);
-                break;
-
-            case effects::TRIANGLE_CHORUS:
-                payload.setModel(0x13);
-                payload.setUnknown(0x01, 0x01, 0x01);
-                break;
-
-            case effects::SINE_FLANGER:
-                payload.setModel(0x18);
-                payload.setUnknown(0x01, 0x01, 0x01);
-                break;
-
-            case effects::TRIANGLE_FLANGER:
-                payload.setModel(0x19);
-                payload.setUnknown(0x01, 0x01, 0x01);
-                break;
-
-            case effects::VIBRATONE:
-                payload.setModel(0x2d);
-                payload.setUnknown(0x01, 0x01, 0x01);
-                break;
-
-            case effects::VINTAGE_TREMOLO:
-                payload.setModel(0x40);
-                payload.setUnknown(0x01, 0x01, 0x01);
-                break;
-
-            case effects::SINE_TREMOLO:
-                payload.setModel(0x41);
-                payload.setUnknown(0x01, 0x01, 0x01);
-                break;
-
-            case effects::RING_MODULATOR:
-                payload.setModel(0x22);
-                payload.setKnob4(clampToRange<std::uint8_t, 0x01>(value.knob4));
-                payload.setUnknown(0x01, 0x08, 0x01);
-                break;
-
-            case effects::STEP_FILTER:
-                payload.setModel(0x29);
-                payload.setUnknown(0x01, 0x01, 0x01);
-                break;
-
-            case effects::PHASER:
-                payload.setModel(0x4f);
-                payload.setKnob5(clampToRange<std::uint8_t, 0x01>(value.knob5));
-                payload.setUnknown(0x01, 0x01, 0x01);
-                break;
-
-            case effects::PITCH_SHIFTER:
-                payload.setModel(0x1f);
-                payload.setUnknown(0x01, 0x08, 0x01);
-                break;
-
-            case effects::MONO_DELAY:
-                payload.setModel(0x16);
-                payload.setUnknown(0x02, 0x01, 0x01);
-                break;
-
-            case effects::MONO_ECHO_FILTER:
-                payload.setModel(0x43);
-                payload.setUnknown(0x02, 0x01, 0x01);
-                break;
-
-            case effects::STEREO_ECHO_FILTER:
-                payload.setModel(0x48);
-                payload.setUnknown(0x02, 0x01, 0x01);
-                break;
-
-            case effects::MULTITAP_DELAY:
-                payload.setModel(0x44);
-                payload.setKnob5(clampToRange<std::uint8_t, 0x03>(value.knob5));
-                payload.setUnknown(0x02, 0x01, 0x01);
-                break;
-
-            case effects::PING_PONG_DELAY:
-                payload.setModel(0x45);
-                payload.setUnknown(0x02, 0x01, 0x01);
-                break;
-
-            case effects::DUCKING_DELAY:
-                payload.setModel(0x15);
-                payload.setUnknown(0x02, 0x01, 0x01);
-                break;
-
-            case effects::REVERSE_DELAY:
-                payload.setModel(0x46);
-                payload.setUnknown(0x02, 0x01, 0x01);
-                break;
-
-            case effects::TAPE_DELAY:
-                payload.setModel(0x2b);
-                payload.setUnknown(0x02, 0x01, 0x01);
-                break;
-
-            case effects::STEREO_TAPE_DELAY:
-                payload.setModel(0x2a);
-                payload.setUnknown(0x02, 0x01, 0x01);
-                break;
-
-            case effects::SMALL_HALL_REVERB:
-                payload.setModel(0x24);
-                break;
-
-            case effects::LARGE_HALL_REVERB:
-                payload.setModel(0x3a);
-                break;
-
-            case effects::SMALL_ROOM_REVERB:
-                payload.setModel(0x26);
-                break;
-
-            case effects::LARGE_ROOM_REVERB:
-                payload.setModel(0x3b);
-                break;
-
-            case effects::SMALL_PLATE_REVERB:
-                payload.setModel(0x4e);
-                break;
-
-            case effects::LARGE_PLATE_REVERB:
-                payload.setModel(0x4b);
-                break;
-
-            case effects::AMBIENT_REVERB:
-                payload.setModel(0x4c);
-                break;
-
-            case effects::ARENA_REVERB:
-                payload.setModel(0x4d);
-                break;
-
-            case effects::FENDER_63_SPRING_REVERB:
-                payload.setModel(0x21);
-                break;
-
-            case effects::FENDER_65_SPRING_REVERB:
-                payload.setModel(0x0b);
-                break;
-
-            default:
-                break;
-        }
-
-        return Packet<EffectPayload>{header, payload};
-    }
-
     Packet<EffectPayload> serializeClearEffectSettings(fx_pedal_settings effect)
     {
         Header header{};
@@ -567,7 +221,7 @@ namespace plug::com
         header.setType(Type::operation);
         header.setDSP(DSP::opSaveEffectName);
         header.setSlot(slot);
-        header.setUnknown(getFxKnob(effects[0]), 0x01, 0x01);
+        header.setUnknown(detail::getFxKnob(effects[0]), 0x01, 0x01);
 
         constexpr std::size_t nameLength{24};
         NamePayload payload{};
@@ -578,7 +232,7 @@ namespace plug::com
 
     std::vector<Packet<EffectPayload>> serializeSaveEffectPacket(std::uint8_t slot, const std::vector<fx_pedal_settings>& effects)
     {
-        const auto fxKnob = getFxKnob(effects[0]);
+        const auto fxKnob = detail::getFxKnob(effects[0]);
         const std::size_t repeat = getSaveEffectsRepeats(effects);
 
         for (std::size_t i = 0; i < repeat; ++i)
@@ -604,56 +258,83 @@ namespace plug::com
         return packets;
     }
 
-    Packet<EmptyPayload> serializeLoadSlotCommand(std::uint8_t slot)
+    std::array<PacketRawType, 7> serializeSignalChain(std::uint8_t slot, const SignalChain& chain)
     {
-        Header header{};
-        header.setStage(Stage::ready);
-        header.setType(Type::operation);
-        header.setDSP(DSP::opSelectMemBank);
-        header.setSlot(slot);
-        header.setUnknown(0x00, 0x01, 0x00);
+        const auto& amp = chain.amp();
+        const auto raw = chain.raw();
+        std::array<PacketRawType, 7> data = raw.value_or(RawPresetData{});
 
-        return Packet<EmptyPayload>{header, EmptyPayload{}};
-    }
+        // Without raw packets every section is encoded; see SignalChain::isRawDropped(). Packets of
+        // chains with unknown model ids are never dropped, as these can't be encoded.
+        const auto encode = [&chain, hasRaw = raw.has_value()](ChainSection section)
+        {
+            return (hasRaw == false) || chain.isModified(section);
+        };
 
-    Packet<EmptyPayload> serializeLoadCommand()
-    {
-        Header header{};
-        header.setStage(Stage::unknown);
-        header.setType(Type::load);
-        header.setDSP(DSP::none);
-        return Packet<EmptyPayload>{header, EmptyPayload{}};
-    }
+        if (encode(ChainSection::name) == true)
+        {
+            data[0] = serializeName(slot, chain.name()).getBytes();
+        }
+        else
+        {
+            auto packet = fromRawData<NamePayload>(data[0]);
+            auto header = packet.getHeader();
+            header.setSlot(slot);
+            packet.setHeader(header);
+            data[0] = packet.getBytes();
+        }
 
-    Packet<EmptyPayload> serializeApplyCommand()
-    {
-        Header header{};
-        header.setStage(Stage::ready);
-        header.setType(Type::data);
-        header.setDSP(DSP::none);
-        return Packet<EmptyPayload>{header, EmptyPayload{}};
-    }
+        if (encode(ChainSection::amp) == true)
+        {
+            data[1] = serializeAmpSettings(amp).getBytes();
+        }
 
-    Packet<EmptyPayload> serializeApplyCommand(fx_pedal_settings effect)
-    {
-        auto applyCommand = serializeApplyCommand();
-        auto header = applyCommand.getHeader();
-        header.setUnknown(getFxKnob(effect), 0x00, 0x00);
-        applyCommand.setHeader(header);
-        return applyCommand;
+        if (encode(ChainSection::usbGain) == true)
+        {
+            data[6] = serializeAmpSettingsUsbGain(amp).getBytes();
+        }
+
+        if (encode(ChainSection::effects) == true)
+        {
+            const auto& effects = chain.effects();
+
+            for (std::size_t i = 0; i < dspEffects.size(); ++i)
+            {
+                const auto dsp = dspFromEffect(dspEffects[i]);
+                const auto effect = std::find_if(effects.cbegin(), effects.cend(), [dsp](const auto& e)
+                                                 { return e.enabled && (dspFromEffect(e.effect_num) == dsp); });
+
+                if (effect != effects.cend())
+                {
+                    data[i + 2] = serializeEffectSettings(*effect).getBytes();
+                }
+                else
+                {
+                    data[i + 2] = serializeClearEffectSettings(fx_pedal_settings{FxSlot{0}, dspEffects[i], 0, 0, 0, 0, 0, 0, false}).getBytes();
+                }
+            }
+        }
+
+        return data;
     }
 
-    std::array<Packet<EmptyPayload>, 2> serializeInitCommand()
+    std::array<PacketRawType, 8> serializeRestoreSlotCommands(std::uint8_t slot, const std::array<PacketRawType, 7>& data)
     {
-        Header header0{};
-        header0.setStage(Stage::init0);
-        header0.setType(Type::init0);
-        header0.setDSP(DSP::none);
-
-        Header header1{};
-        header1.setStage(Stage::init1);
-        header1.setType(Type::init1);
-        header1.setDSP(DSP::none);
-        return {{Packet<EmptyPayload>{header0, EmptyPayload{}}, Packet<EmptyPayload>{header1, EmptyPayload{}}}};
+        std::array<PacketRawType, 8> commands{{}};
+
+        for (std::size_t i = 1; i < data.size(); ++i)
+        {
+            auto packet = fromRawData<EmptyPayload>(data[i]);
+            auto header = packet.getHeader();
+            header.setStage(Stage::ready);
+            header.setType(Type::data);
+            header.setUnknown(0x00, 0x01, 0x01);
+            packet.setHeader(header);
+            commands[i - 1] = packet.getBytes();
+        }
+
+        commands[6] = serializeApplyCommand().getBytes();
+        commands[7] = serializeName(slot, decodeNameFromData(fromRawData<NamePayload>(data[0]))).getBytes();
+        return commands;
     }
 }
@@ -0,0 +1,210 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/PresetBank.h"
+#include "com/PacketSerializer.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace plug::com
+{
+    namespace
+    {
+        constexpr std::string_view magic{"PLUGBANK"};
+
+        template <class T>
+        void putInteger(std::uint8_t* out, T value)
+        {
+            for (std::size_t i = 0; i < sizeof(T); ++i)
+            {
+                out[i] = static_cast<std::uint8_t>((value >> (i * 8)) & 0xff);
+            }
+        }
+
+        template <class T>
+        T getInteger(const std::uint8_t* in)
+        {
+            T value{0};
+
+            for (std::size_t i = 0; i < sizeof(T); ++i)
+            {
+                value = static_cast<T>(value | static_cast<T>(in[i]) << (i * 8));
+            }
+            return value;
+        }
+
+        PacketRawType createHeader(std::size_t count)
+        {
+            PacketRawType header{{}};
+            std::copy(magic.cbegin(), magic.cend(), header.begin());
+            putInteger(&header[8], bank::version);
+            putInteger(&header[10], static_cast<std::uint16_t>(std::tuple_size_v<PresetRecord>));
+            putInteger(&header[12], static_cast<std::uint16_t>(packetRawTypeSize));
+            putInteger(&header[16], static_cast<std::uint32_t>(count));
+            return header;
+        }
+
+        std::size_t checkHeader(const std::uint8_t* data, std::size_t length)
+        {
+            if ((length < bank::headerSize) || (std::equal(magic.cbegin(), magic.cend(), data) == false))
+            {
+                throw std::runtime_error{"Not a preset bank"};
+            }
+
+            if ((getInteger<std::uint16_t>(data + 8) != bank::version) ||
+                (getInteger<std::uint16_t>(data + 10) != std::tuple_size_v<PresetRecord>) ||
+                (getInteger<std::uint16_t>(data + 12) != packetRawTypeSize))
+            {
+                throw std::runtime_error{"Unsupported preset bank version"};
+            }
+
+            const std::size_t count = getInteger<std::uint32_t>(data + 16);
+
+            if (length != bank::headerSize + count * bank::recordSize)
+            {
+                throw std::runtime_error{"Invalid preset bank size"};
+            }
+            return count;
+        }
+    }
+
+
+    void writeBank(const std::string& path, const std::vector<PresetRecord>& records)
+    {
+        const std::string temporary = path + ".tmp";
+
+        {
+            std::ofstream file{temporary, std::ios::binary | std::ios::trunc};
+
+            if (file.is_open() == false)
+            {
+                throw std::runtime_error{"Could not create bank file: " + path};
+            }
+
+            const auto header = createHeader(records.size());
+            file.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+
+            for (const auto& record : records)
+            {
+                for (const auto& packet : record)
+                {
+                    file.write(reinterpret_cast<const char*>(packet.data()), static_cast<std::streamsize>(packet.size()));
+                }
+            }
+
+            if (file.flush().fail())
+            {
+                throw std::runtime_error{"Could not write bank file: " + path};
+            }
+        }
+
+        std::filesystem::rename(temporary, path);
+    }
+
+
+    MappedBank::MappedBank(const std::string& path)
+        : mapping(nullptr), length(0), count(0)
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+        if (fd < 0)
+        {
+            throw std::runtime_error{"Could not open bank file: " + path};
+        }
+
+        struct stat info{};
+
+        if ((::fstat(fd, &info) != 0) || (info.st_size < static_cast<off_t>(bank::headerSize)))
+        {
+            ::close(fd);
+            throw std::runtime_error{"Not a preset bank: " + path};
+        }
+
+        length = static_cast<std::size_t>(info.st_size);
+        mapping = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+
+        if (mapping == MAP_FAILED)
+        {
+            throw std::runtime_error{"Could not map bank file: " + path};
+        }
+
+        try
+        {
+            count = checkHeader(static_cast<const std::uint8_t*>(mapping), length);
+        }
+        catch (...)
+        {
+            ::munmap(mapping, length);
+            throw;
+        }
+    }
+
+    MappedBank::~MappedBank()
+    {
+        ::munmap(mapping, length);
+    }
+
+    std::size_t MappedBank::size() const
+    {
+        return count;
+    }
+
+    PresetRecord MappedBank::record(std::size_t index) const
+    {
+        const auto* data = recordData(index);
+        PresetRecord record{{}};
+
+        for (auto& packet : record)
+        {
+            std::copy(data, data + packet.size(), packet.begin());
+            data += packet.size();
+        }
+        return record;
+    }
+
+    std::string MappedBank::name(std::size_t index) const
+    {
+        PacketRawType packet{{}};
+        const auto* data = recordData(index);
+        std::copy(data, data + packet.size(), packet.begin());
+        return decodeNameFromData(fromRawData<NamePayload>(packet));
+    }
+
+    SignalChain MappedBank::decode(std::size_t index) const
+    {
+        return decodeSignalChain(record(index));
+    }
+
+    const std::uint8_t* MappedBank::recordData(std::size_t index) const
+    {
+        if (index >= count)
+        {
+            throw std::out_of_range{"Invalid bank record: " + std::to_string(index)};
+        }
+        return static_cast<const std::uint8_t*>(mapping) + bank::headerSize + index * bank::recordSize;
+    }
+}
@@ -0,0 +1,133 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/RateLimit.h"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace plug::com
+{
+    namespace
+    {
+        std::string versionName(ModelVersion version)
+        {
+            return version == ModelVersion::v1 ? "v1" : "v2";
+        }
+
+        ModelVersion versionFromName(const std::string& name)
+        {
+            if (name == "v1")
+            {
+                return ModelVersion::v1;
+            }
+            if (name == "v2")
+            {
+                return ModelVersion::v2;
+            }
+            throw std::invalid_argument{"Invalid model version: " + name};
+        }
+    }
+
+
+    std::chrono::steady_clock::duration RateLimit::interval() const
+    {
+        return std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>{1.0 / updatesPerSecond});
+    }
+
+
+    RateLimit RateLimits::get(ModelVersion version) const
+    {
+        return limits[version];
+    }
+
+    void RateLimits::set(ModelVersion version, const RateLimit& limit)
+    {
+        if ((limit.updatesPerSecond > 0.0) == false)
+        {
+            throw std::invalid_argument{"Invalid rate limit"};
+        }
+        limits[version] = limit;
+    }
+
+    RateLimits RateLimits::load(const std::string& path)
+    {
+        RateLimits result;
+        std::ifstream in{path};
+
+        if (in.is_open() == false)
+        {
+            return result;
+        }
+
+        std::string line;
+
+        while (std::getline(in, line))
+        {
+            std::istringstream fields{line};
+            std::string version;
+            double rate{0.0};
+            std::int64_t latency{0};
+
+            if ((fields >> version >> rate >> latency).fail() == true)
+            {
+                throw std::runtime_error{"Invalid rate limit entry in " + path + ": " + line};
+            }
+            result.set(versionFromName(version), RateLimit{rate, std::chrono::microseconds{latency}});
+        }
+        return result;
+    }
+
+    void RateLimits::save(const std::string& path) const
+    {
+        if (const auto parent = std::filesystem::path{path}.parent_path(); parent.empty() == false)
+        {
+            std::filesystem::create_directories(parent);
+        }
+
+        std::ofstream out{path, std::ios::trunc};
+
+        for (const auto version : {ModelVersion::v1, ModelVersion::v2})
+        {
+            out << versionName(version) << ' ' << limits[version].updatesPerSecond << ' ' << limits[version].ackLatency.count() << '\n';
+        }
+
+        if (out.flush().fail() == true)
+        {
+            throw std::runtime_error{"Failed to write " + path};
+        }
+    }
+
+
+    std::string defaultRateLimitsPath()
+    {
+        if (const char* configDir = std::getenv("XDG_CONFIG_HOME"); (configDir != nullptr) && (*configDir != '\0'))
+        {
+            return std::string{configDir} + "/plug/ratelimits";
+        }
+        if (const char* home = std::getenv("HOME"); (home != nullptr) && (*home != '\0'))
+        {
+            return std::string{home} + "/.config/plug/ratelimits";
+        }
+        throw std::runtime_error{"Neither XDG_CONFIG_HOME nor HOME is set"};
+    }
+}
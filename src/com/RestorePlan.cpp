@@ -0,0 +1,93 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/RestorePlan.h"
+#include "com/PacketSerializer.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace plug::com
+{
+    namespace
+    {
+        bool samePayload(const PacketRawType& lhs, const PacketRawType& rhs)
+        {
+            constexpr std::size_t payloadOffset{16};
+            return std::equal(std::next(lhs.cbegin(), payloadOffset), lhs.cend(), std::next(rhs.cbegin(), payloadOffset));
+        }
+
+        std::string nameOf(const PresetRecord& record)
+        {
+            return decodeNameFromData(fromRawData<NamePayload>(record[0]));
+        }
+    }
+
+    std::vector<SlotUpdate> planRestore(const std::vector<PresetRecord>& current, const std::vector<PresetRecord>& target)
+    {
+        if (current.size() < target.size())
+        {
+            throw std::invalid_argument{"More target presets than slots"};
+        }
+
+        std::vector<SlotUpdate> updates;
+
+        for (std::size_t i = 0; i < target.size(); ++i)
+        {
+            std::vector<std::size_t> changed;
+
+            for (std::size_t section = 1; section < target[i].size(); ++section)
+            {
+                if (samePayload(current[i][section], target[i][section]) == false)
+                {
+                    changed.push_back(section);
+                }
+            }
+
+            const bool renamed = (nameOf(current[i]) != nameOf(target[i]));
+
+            if ((changed.empty() == true) && (renamed == false))
+            {
+                continue;
+            }
+
+            const auto slot = static_cast<std::uint8_t>(i);
+            const auto commands = serializeRestoreSlotCommands(slot, target[i]);
+
+            if (changed.size() > maxPartialSections)
+            {
+                updates.push_back(SlotUpdate{slot, false, {commands.cbegin(), commands.cend()}});
+                continue;
+            }
+
+            SlotUpdate update{slot, true, {}};
+            std::transform(changed.cbegin(), changed.cend(), std::back_inserter(update.commands), [&commands](std::size_t section)
+                           { return commands[section - 1]; });
+
+            if (changed.empty() == false)
+            {
+                update.commands.push_back(commands[6]);
+            }
+            update.commands.push_back(commands[7]);
+            updates.push_back(update);
+        }
+        return updates;
+    }
+}
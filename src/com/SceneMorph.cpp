@@ -0,0 +1,159 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/SceneMorph.h"
+#include "com/PacketSerializer.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <optional>
+#include <thread>
+
+namespace plug::com
+{
+    namespace
+    {
+        inline constexpr std::array<DSP, 4> effectDsps{{DSP::effect0, DSP::effect1, DSP::effect2, DSP::effect3}};
+
+        std::uint8_t lerp(std::uint8_t from, std::uint8_t to, double position)
+        {
+            return static_cast<std::uint8_t>(std::lround(from + (to - from) * position));
+        }
+
+        std::optional<fx_pedal_settings> effectOn(const EffectList& effects, DSP dsp)
+        {
+            const auto itr = std::find_if(effects.cbegin(), effects.cend(), [dsp](const auto& e)
+                                          { return e.enabled && (dspFromEffect(e.effect_num) == dsp); });
+
+            if (itr != effects.cend())
+            {
+                return *itr;
+            }
+            return std::nullopt;
+        }
+    }
+
+
+    SignalChain interpolate(const SignalChain& from, const SignalChain& to, double position, double switchPoint)
+    {
+        position = std::clamp(position, 0.0, 1.0);
+        const bool switched = (position >= switchPoint);
+
+        const auto a = from.amp();
+        const auto b = to.amp();
+        auto amp = switched ? b : a;
+        amp.gain = lerp(a.gain, b.gain, position);
+        amp.volume = lerp(a.volume, b.volume, position);
+        amp.treble = lerp(a.treble, b.treble, position);
+        amp.middle = lerp(a.middle, b.middle, position);
+        amp.bass = lerp(a.bass, b.bass, position);
+        amp.master_vol = lerp(a.master_vol, b.master_vol, position);
+        amp.gain2 = lerp(a.gain2, b.gain2, position);
+        amp.presence = lerp(a.presence, b.presence, position);
+        amp.depth = lerp(a.depth, b.depth, position);
+        amp.bias = lerp(a.bias, b.bias, position);
+        amp.usb_gain = lerp(a.usb_gain, b.usb_gain, position);
+
+        EffectList effects;
+        const auto& fromEffects = from.effects();
+        const auto& toEffects = to.effects();
+
+        for (const auto dsp : effectDsps)
+        {
+            const auto first = effectOn(fromEffects, dsp);
+            const auto second = effectOn(toEffects, dsp);
+
+            if (first.has_value() && second.has_value() && (first->effect_num == second->effect_num))
+            {
+                auto effect = switched ? *second : *first;
+                effect.knob1 = lerp(first->knob1, second->knob1, position);
+                effect.knob2 = lerp(first->knob2, second->knob2, position);
+                effect.knob3 = lerp(first->knob3, second->knob3, position);
+                effect.knob4 = lerp(first->knob4, second->knob4, position);
+                effect.knob5 = lerp(first->knob5, second->knob5, position);
+                effect.knob6 = lerp(first->knob6, second->knob6, position);
+                effects.push_back(effect);
+            }
+            else if (const auto& effect = switched ? second : first; effect.has_value())
+            {
+                effects.push_back(*effect);
+            }
+        }
+
+        return SignalChain{switched ? to.name() : from.name(), amp, effects};
+    }
+
+
+    SceneMorph::SceneMorph(Mustang& mustangRef)
+        : SceneMorph(mustangRef, Clock::now, [](Clock::time_point t)
+                     { std::this_thread::sleep_until(t); })
+    {
+    }
+
+    SceneMorph::SceneMorph(Mustang& mustangRef, NowFunction nowFunction, SleepFunction sleepFunction)
+        : mustang(mustangRef), now(nowFunction), sleepUntil(sleepFunction), minimumInterval(minFrameInterval), frameCost(Clock::duration::zero())
+    {
+    }
+
+    std::size_t SceneMorph::run(const SignalChain& from, const SignalChain& to, Clock::duration duration, double switchPoint)
+    {
+        const auto start = now();
+        SignalChain previous = from;
+        std::size_t frames{0};
+        double position{0.0};
+
+        while (position < 1.0)
+        {
+            const auto frameStart = now();
+            position = (duration > Clock::duration::zero()) ? std::chrono::duration<double>(frameStart - start) / duration : 1.0;
+
+            const auto frame = interpolate(from, to, position, switchPoint);
+
+            if (send(frame, previous) == true)
+            {
+                ++frames;
+                const auto cost = now() - frameStart;
+                frameCost = (frameCost == Clock::duration::zero()) ? cost : (frameCost * 3 + cost) / 4;
+            }
+            previous = frame;
+
+            if (position < 1.0)
+            {
+                sleepUntil(frameStart + frameInterval());
+            }
+        }
+        return frames;
+    }
+
+    void SceneMorph::setRateLimit(const RateLimit& limit)
+    {
+        minimumInterval = limit.interval();
+    }
+
+    SceneMorph::Clock::duration SceneMorph::frameInterval() const
+    {
+        return std::max(minimumInterval, frameCost);
+    }
+
+    bool SceneMorph::send(const SignalChain& frame, const SignalChain& previous)
+    {
+        return mustang.update_signal_chain(previous, frame, Priority::bulk);
+    }
+}
@@ -0,0 +1,347 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/SessionJournal.h"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace plug::com
+{
+    namespace
+    {
+        constexpr std::string_view magic{"PLUGJRNL"};
+        constexpr std::size_t recordOverhead{2 + sizeof(std::uint32_t)};
+
+        enum class RecordType : std::uint8_t
+        {
+            snapshot = 1,
+            amp = 2,
+            effect = 3
+        };
+
+        std::uint32_t hash(const std::uint8_t* data, std::size_t size)
+        {
+            std::uint32_t value{2166136261u};
+
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                value = (value ^ data[i]) * 16777619u;
+            }
+            return value;
+        }
+
+        void appendRecord(std::vector<std::uint8_t>& out, RecordType type, const std::uint8_t* payload, std::size_t size)
+        {
+            const auto start = out.size();
+            out.push_back(static_cast<std::uint8_t>(type));
+            out.push_back(static_cast<std::uint8_t>(size));
+            out.insert(out.end(), payload, payload + size);
+
+            const auto checksum = hash(out.data() + start, out.size() - start);
+
+            for (std::size_t i = 0; i < sizeof(checksum); ++i)
+            {
+                out.push_back(static_cast<std::uint8_t>((checksum >> (i * 8)) & 0xff));
+            }
+        }
+
+        void appendSnapshotRecord(std::vector<std::uint8_t>& out, std::string_view name, const ToneState& state)
+        {
+            std::array<std::uint8_t, 1 + SignalChain::maxNameLength + std::tuple_size_v<ToneState>> payload{{}};
+            const auto nameSize = std::min(name.size(), SignalChain::maxNameLength);
+            payload[0] = static_cast<std::uint8_t>(nameSize);
+            std::copy_n(name.cbegin(), nameSize, std::next(payload.begin()));
+            std::copy(state.cbegin(), state.cend(), std::next(payload.begin(), static_cast<std::ptrdiff_t>(1 + nameSize)));
+            appendRecord(out, RecordType::snapshot, payload.data(), 1 + nameSize + state.size());
+        }
+
+        bool writeAll(int fd, const std::uint8_t* data, std::size_t size)
+        {
+            while (size > 0)
+            {
+                const auto result = ::write(fd, data, size);
+
+                if (result < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    return false;
+                }
+                data += result;
+                size -= static_cast<std::size_t>(result);
+            }
+            return true;
+        }
+    }
+
+
+    SessionJournal::SessionJournal(const std::string& journalPath, const SignalChain& chain, JournalPolicy journalPolicy)
+        : path(journalPath), policy(journalPolicy), fd(-1), fileSize(0), appended(0), written(0), name(chain.name()),
+          state(toToneState(chain)), flushRequested(false), stopping(false), failed(false)
+    {
+        std::vector<std::uint8_t> snapshot;
+        appendSnapshotRecord(snapshot, name, state);
+
+        if (replaceFile(snapshot) == false)
+        {
+            throw std::runtime_error{"Could not create journal: " + path};
+        }
+        worker = std::thread{[this]
+                             { run(); }};
+    }
+
+    SessionJournal::~SessionJournal()
+    {
+        {
+            const std::lock_guard lock{mutex};
+            stopping = true;
+        }
+        wakeup.notify_one();
+        worker.join();
+        ::close(fd);
+    }
+
+    void SessionJournal::update(const SignalChain& chain)
+    {
+        const auto next = toToneState(chain);
+        const std::lock_guard lock{mutex};
+
+        if (chain.name() != name)
+        {
+            name = chain.name();
+            state = next;
+            appendSnapshot();
+            return;
+        }
+
+        if (std::equal(state.cbegin(), std::next(state.cbegin(), tone::ampFields), next.cbegin()) == false)
+        {
+            appendRecord(pending, RecordType::amp, next.data(), tone::ampFields);
+            ++appended;
+        }
+
+        for (std::uint8_t slot = 0; slot < tone::slotCount; ++slot)
+        {
+            const auto base = static_cast<std::ptrdiff_t>(tone::ampFields + slot * tone::fieldsPerSlot);
+
+            if (std::equal(std::next(state.cbegin(), base), std::next(state.cbegin(), base + tone::fieldsPerSlot), std::next(next.cbegin(), base)) == false)
+            {
+                std::array<std::uint8_t, 1 + tone::fieldsPerSlot> payload{{slot}};
+                std::copy_n(std::next(next.cbegin(), base), tone::fieldsPerSlot, std::next(payload.begin()));
+                appendRecord(pending, RecordType::effect, payload.data(), payload.size());
+                ++appended;
+            }
+        }
+
+        state = next;
+        wakeup.notify_one();
+    }
+
+    void SessionJournal::flush()
+    {
+        std::unique_lock lock{mutex};
+        const auto target = appended;
+        flushRequested = true;
+        wakeup.notify_one();
+        synced.wait(lock, [this, target]
+                    { return (written >= target) || failed; });
+
+        if (failed == true)
+        {
+            throw std::runtime_error{"Could not write journal: " + path};
+        }
+    }
+
+    void SessionJournal::appendSnapshot()
+    {
+        appendSnapshotRecord(pending, name, state);
+        ++appended;
+        wakeup.notify_one();
+    }
+
+    void SessionJournal::run()
+    {
+        std::unique_lock lock{mutex};
+
+        while (true)
+        {
+            wakeup.wait(lock, [this]
+                        { return stopping || flushRequested || (pending.empty() == false); });
+
+            if (pending.empty() && stopping)
+            {
+                return;
+            }
+
+            const auto target = appended;
+            flushRequested = false;
+            const bool compact = (fileSize + pending.size()) > policy.compactSize;
+
+            if (compact == true)
+            {
+                pending.clear();
+                appendSnapshotRecord(writing, name, state);
+            }
+            else
+            {
+                std::swap(pending, writing);
+            }
+            lock.unlock();
+
+            bool ok{true};
+
+            if (compact == true)
+            {
+                ok = replaceFile(writing);
+            }
+            else if (writing.empty() == false)
+            {
+                ok = writeAll(fd, writing.data(), writing.size()) && (::fdatasync(fd) == 0);
+                fileSize += writing.size();
+            }
+            writing.clear();
+
+            lock.lock();
+            written = target;
+            failed = failed || (ok == false);
+            synced.notify_all();
+
+            // Changes arriving meanwhile are batched into the next sync
+            wakeup.wait_for(lock, policy.syncInterval, [this]
+                            { return stopping || flushRequested; });
+        }
+    }
+
+    // The snapshot is written to a new file which replaces the journal, so there's always a
+    // complete journal on disk
+    bool SessionJournal::replaceFile(const std::vector<std::uint8_t>& snapshot)
+    {
+        const std::string temporary = path + ".tmp";
+        const int file = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+        if (file < 0)
+        {
+            return false;
+        }
+
+        std::array<std::uint8_t, journal::headerSize> header{{}};
+        std::copy(magic.cbegin(), magic.cend(), header.begin());
+        header[8] = static_cast<std::uint8_t>(journal::version & 0xff);
+        header[9] = static_cast<std::uint8_t>(journal::version >> 8);
+
+        if ((writeAll(file, header.data(), header.size()) == false) || (writeAll(file, snapshot.data(), snapshot.size()) == false) ||
+            (::fdatasync(file) != 0) || (::rename(temporary.c_str(), path.c_str()) != 0))
+        {
+            ::close(file);
+            ::unlink(temporary.c_str());
+            return false;
+        }
+
+        if (fd >= 0)
+        {
+            ::close(fd);
+        }
+        fd = file;
+        fileSize = header.size() + snapshot.size();
+        return true;
+    }
+
+
+    std::optional<SignalChain> recoverJournal(const std::string& path)
+    {
+        std::ifstream file{path, std::ios::binary};
+
+        if (file.is_open() == false)
+        {
+            return std::nullopt;
+        }
+
+        const std::vector<std::uint8_t> data{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+
+        if ((data.size() < journal::headerSize) || (std::equal(magic.cbegin(), magic.cend(), data.cbegin()) == false) ||
+            ((data[8] | (data[9] << 8)) != journal::version))
+        {
+            return std::nullopt;
+        }
+
+        std::optional<std::string> name;
+        ToneState state{{}};
+        std::size_t position{journal::headerSize};
+
+        while ((data.size() - position) >= recordOverhead)
+        {
+            const auto* record = data.data() + position;
+            const std::size_t size = record[1];
+
+            if ((data.size() - position) < (size + recordOverhead))
+            {
+                break;
+            }
+
+            std::uint32_t checksum{0};
+
+            for (std::size_t i = 0; i < sizeof(checksum); ++i)
+            {
+                checksum |= static_cast<std::uint32_t>(record[2 + size + i]) << (i * 8);
+            }
+
+            if (checksum != hash(record, 2 + size))
+            {
+                break;
+            }
+
+            const auto* payload = record + 2;
+            const auto type = static_cast<RecordType>(record[0]);
+
+            if ((type == RecordType::snapshot) && (size > 0) && (size == 1 + payload[0] + state.size()))
+            {
+                name = std::string{payload + 1, payload + 1 + payload[0]};
+                std::copy_n(payload + 1 + payload[0], state.size(), state.begin());
+            }
+            else if ((type == RecordType::amp) && (size == tone::ampFields))
+            {
+                std::copy_n(payload, size, state.begin());
+            }
+            else if ((type == RecordType::effect) && (size == 1 + tone::fieldsPerSlot) && (payload[0] < tone::slotCount))
+            {
+                std::copy_n(payload + 1, tone::fieldsPerSlot, std::next(state.begin(), static_cast<std::ptrdiff_t>(tone::ampFields + payload[0] * tone::fieldsPerSlot)));
+            }
+            else
+            {
+                break;
+            }
+            position += size + recordOverhead;
+        }
+
+        if (name.has_value() == false)
+        {
+            return std::nullopt;
+        }
+        return fromToneState(*name, state);
+    }
+}
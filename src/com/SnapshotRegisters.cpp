@@ -0,0 +1,107 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/SnapshotRegisters.h"
+#include <stdexcept>
+#include <string>
+
+namespace plug::com
+{
+    SnapshotRegisters::SnapshotRegisters(std::size_t count)
+        : registers(count)
+    {
+    }
+
+    std::size_t SnapshotRegisters::size() const
+    {
+        return registers.size();
+    }
+
+    void SnapshotRegisters::store(std::size_t index, const SignalChain& chain)
+    {
+        checkIndex(index);
+        registers[index] = chain;
+        current = index;
+    }
+
+    bool SnapshotRegisters::isStored(std::size_t index) const
+    {
+        checkIndex(index);
+        return registers[index].has_value();
+    }
+
+    const SignalChain& SnapshotRegisters::at(std::size_t index) const
+    {
+        if (isStored(index) == false)
+        {
+            throw std::out_of_range{"Snapshot register " + std::to_string(index) + " is empty"};
+        }
+        return *registers[index];
+    }
+
+    std::optional<SignalChain> SnapshotRegisters::recall(std::size_t index)
+    {
+        if (isStored(index) == false)
+        {
+            return {};
+        }
+        current = index;
+        return registers[index];
+    }
+
+    std::optional<SignalChain> SnapshotRegisters::toggle()
+    {
+        const std::size_t start = current.value_or(registers.size() - 1);
+
+        for (std::size_t offset = 1; offset <= registers.size(); ++offset)
+        {
+            const std::size_t index = (start + offset) % registers.size();
+
+            if (registers[index].has_value())
+            {
+                current = index;
+                return registers[index];
+            }
+        }
+        return {};
+    }
+
+    std::optional<std::size_t> SnapshotRegisters::active() const
+    {
+        return current;
+    }
+
+    void SnapshotRegisters::clear()
+    {
+        for (auto& snapshot : registers)
+        {
+            snapshot.reset();
+        }
+        current.reset();
+    }
+
+    void SnapshotRegisters::checkIndex(std::size_t index) const
+    {
+        if (index >= registers.size())
+        {
+            throw std::out_of_range{"Invalid snapshot register: " + std::to_string(index)};
+        }
+    }
+}
@@ -0,0 +1,135 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/ThroughputProbe.h"
+#include "com/CommunicationException.h"
+#include "com/PacketSerializer.h"
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+namespace plug::com
+{
+    namespace
+    {
+        // Late acks of a failed step are discarded before the next one
+        inline constexpr std::size_t maxDrainPackets{16};
+    }
+
+
+    ThroughputProbe::ThroughputProbe(Connection& connection)
+        : ThroughputProbe(connection, Clock::now, [](Clock::time_point t)
+                          { std::this_thread::sleep_until(t); })
+    {
+    }
+
+    ThroughputProbe::ThroughputProbe(Connection& connection, NowFunction nowFunction, SleepFunction sleepFunction)
+        : conn(connection), now(nowFunction), sleepUntil(sleepFunction)
+    {
+    }
+
+    ProbeResult ThroughputProbe::run(const amp_settings& current, const ProbeOptions& options)
+    {
+        if (((options.startRate > 0.0) == false) || ((options.growth > 1.0) == false) || (options.updatesPerStep == 0))
+        {
+            throw std::invalid_argument{"Invalid probe options"};
+        }
+
+        ProbeResult result{defaultRateLimit, {}};
+        const ProbeStep* best{nullptr};
+
+        for (double rate = options.startRate; rate <= options.maxRate; rate *= options.growth)
+        {
+            result.steps.push_back(runStep(current, rate, options.updatesPerStep));
+
+            if (result.steps.back().sustained == false)
+            {
+                drain();
+                break;
+            }
+        }
+
+        for (const auto& step : result.steps)
+        {
+            if (step.sustained == true)
+            {
+                best = &step;
+            }
+        }
+
+        if (best == nullptr)
+        {
+            throw CommunicationException{"The amp didn't sustain the minimum probe rate"};
+        }
+
+        result.limit = RateLimit{best->updatesPerSecond * options.safetyFactor, best->meanLatency};
+        return result;
+    }
+
+    ProbeStep ThroughputProbe::runStep(const amp_settings& current, double rate, std::size_t updates)
+    {
+        const auto settings = serializeAmpSettings(current).getBytes();
+        const auto apply = serializeApplyCommand().getBytes();
+        const auto interval = RateLimit{rate, {}}.interval();
+
+        ProbeStep step{rate, 0, 0, std::chrono::microseconds{0}, std::chrono::microseconds{0}, false};
+        Clock::duration total{0};
+        const auto start = now();
+
+        for (std::size_t i = 0; i < updates; ++i)
+        {
+            sleepUntil(start + interval * static_cast<int>(i + 1));
+
+            const auto sendTime = now();
+            const bool acknowledged = sendAcknowledged(settings) && sendAcknowledged(apply);
+            const auto latency = now() - sendTime;
+
+            if (acknowledged == false)
+            {
+                ++step.timeouts;
+                break;
+            }
+
+            ++step.updates;
+            total += latency;
+            step.maxLatency = std::max(step.maxLatency, std::chrono::duration_cast<std::chrono::microseconds>(latency));
+        }
+
+        if (step.updates > 0)
+        {
+            step.meanLatency = std::chrono::duration_cast<std::chrono::microseconds>(total / step.updates);
+        }
+        step.sustained = (step.timeouts == 0) && (total / updates <= interval);
+        return step;
+    }
+
+    bool ThroughputProbe::sendAcknowledged(const PacketRawType& packet)
+    {
+        conn.send(packet);
+        return conn.receive(packetRawTypeSize).empty() == false;
+    }
+
+    void ThroughputProbe::drain()
+    {
+        for (std::size_t i = 0; (i < maxDrainPackets) && (conn.receive(packetRawTypeSize).empty() == false); ++i)
+        {
+        }
+    }
+}
@@ -0,0 +1,128 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/ToneState.h"
+#include <algorithm>
+#include <iterator>
+#include <optional>
+
+namespace plug::com
+{
+    namespace
+    {
+        constexpr std::size_t unknownAmpModel{17};
+        constexpr std::size_t unknownCabinet{19};
+        constexpr std::size_t unknownEffectModel{8};
+        constexpr std::size_t unknownEffectSlot{10};
+
+        std::optional<std::uint8_t> unknownId(const ToneState& state, std::size_t field)
+        {
+            if (state[field] == 0)
+            {
+                return std::nullopt;
+            }
+            return state[field + 1];
+        }
+
+        void setUnknownId(ToneState& state, std::size_t field, std::optional<std::uint8_t> id)
+        {
+            state[field] = static_cast<std::uint8_t>(id.has_value());
+            state[field + 1] = id.value_or(0);
+        }
+    }
+
+    ToneState toToneState(const SignalChain& chain)
+    {
+        ToneState state{{}};
+        setAmpFields(state, chain.amp());
+
+        for (const auto& effect : chain.effects())
+        {
+            setSlotFields(state, effect);
+        }
+        return state;
+    }
+
+    SignalChain fromToneState(std::string_view name, const ToneState& state)
+    {
+        EffectList effectList;
+
+        for (std::uint8_t slot = 0; slot < tone::slotCount; ++slot)
+        {
+            if (const auto effect = slotFields(state, FxSlot{slot}); effect.effect_num != effects::EMPTY)
+            {
+                effectList.push_back(effect);
+            }
+        }
+        return SignalChain{name, ampFields(state), effectList};
+    }
+
+    amp_settings ampFields(const ToneState& state)
+    {
+        amp_settings amp{static_cast<amps>(state[0]), state[1], state[2], state[3], state[4], state[5], static_cast<cabinets>(state[6]),
+                         state[7], state[8], state[9], state[10], state[11], state[12], state[13], state[14], state[15] != 0, state[16]};
+        amp.unknownModel = unknownId(state, unknownAmpModel);
+        amp.unknownCabinet = unknownId(state, unknownCabinet);
+        return amp;
+    }
+
+    fx_pedal_settings slotFields(const ToneState& state, FxSlot slot)
+    {
+        const auto base = tone::ampFields + slot.id() * tone::fieldsPerSlot;
+        fx_pedal_settings effect{slot, static_cast<effects>(state[base]), state[base + 1], state[base + 2], state[base + 3],
+                                 state[base + 4], state[base + 5], state[base + 6], state[base + 7] != 0};
+        effect.unknownModel = unknownId(state, base + unknownEffectModel);
+        effect.unknownSlot = unknownId(state, base + unknownEffectSlot);
+        return effect;
+    }
+
+    void setAmpFields(ToneState& state, const amp_settings& amp)
+    {
+        const std::array<std::uint8_t, unknownAmpModel> fields{{value(amp.amp_num), amp.gain, amp.volume, amp.treble, amp.middle, amp.bass,
+                                                   value(amp.cabinet), amp.noise_gate, amp.master_vol, amp.gain2, amp.presence,
+                                                   amp.threshold, amp.depth, amp.bias, amp.sag, static_cast<std::uint8_t>(amp.brightness),
+                                                   amp.usb_gain}};
+        std::copy(fields.cbegin(), fields.cend(), state.begin());
+        setUnknownId(state, unknownAmpModel, amp.unknownModel);
+        setUnknownId(state, unknownCabinet, amp.unknownCabinet);
+    }
+
+    void setSlotFields(ToneState& state, const fx_pedal_settings& effect)
+    {
+        const auto base = tone::ampFields + effect.slot.id() * tone::fieldsPerSlot;
+
+        if (effect.effect_num == effects::EMPTY)
+        {
+            std::fill_n(std::next(state.begin(), static_cast<std::ptrdiff_t>(base)), tone::fieldsPerSlot, 0);
+            return;
+        }
+
+        state[base] = value(effect.effect_num);
+        state[base + 1] = effect.knob1;
+        state[base + 2] = effect.knob2;
+        state[base + 3] = effect.knob3;
+        state[base + 4] = effect.knob4;
+        state[base + 5] = effect.knob5;
+        state[base + 6] = effect.knob6;
+        state[base + 7] = static_cast<std::uint8_t>(effect.enabled);
+        setUnknownId(state, base + unknownEffectModel, effect.unknownModel);
+        setUnknownId(state, base + unknownEffectSlot, effect.unknownSlot);
+    }
+}
@@ -57,6 +57,11 @@ namespace plug::com
         return device_.receive(endpointRecv, recvSize);
     }
 
+    std::vector<std::uint8_t> UsbComm::receiveWithin(std::size_t recvSize, std::chrono::milliseconds timeout)
+    {
+        return device_.receive(endpointRecv, recvSize, timeout);
+    }
+
     std::string UsbComm::name() const
     {
         return name_;
@@ -71,4 +76,9 @@ namespace plug::com
     {
         return device_.write(endpointSend, data, size);
     }
+
+    std::size_t UsbComm::receiveImpl(std::uint8_t* data, std::size_t size)
+    {
+        return device_.read(endpointRecv, data, size);
+    }
 }
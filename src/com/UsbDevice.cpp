@@ -115,12 +115,28 @@ namespace plug::com::usb
         return transfered;
     }
 
+    std::size_t Device::read(std::uint8_t endpoint, std::uint8_t* data, std::size_t dataSize)
+    {
+        int transfered{0};
+
+        if (const auto result = libusb_interrupt_transfer(handle_.get(), endpoint, data, dataSize, &transfered, usbTimeout.count()); (result != LIBUSB_SUCCESS) && (result != LIBUSB_ERROR_TIMEOUT))
+        {
+            throw UsbException{result};
+        }
+        return transfered;
+    }
+
     std::vector<std::uint8_t> Device::receive(std::uint8_t endpoint, std::size_t dataSize)
+    {
+        return receive(endpoint, dataSize, usbTimeout);
+    }
+
+    std::vector<std::uint8_t> Device::receive(std::uint8_t endpoint, std::size_t dataSize, std::chrono::milliseconds timeout)
     {
         std::vector<std::uint8_t> buffer(dataSize);
         int transfered{0};
 
-        if (const auto result = libusb_interrupt_transfer(handle_.get(), endpoint, buffer.data(), dataSize, &transfered, usbTimeout.count()); (result != LIBUSB_SUCCESS) && (result != LIBUSB_ERROR_TIMEOUT))
+        if (const auto result = libusb_interrupt_transfer(handle_.get(), endpoint, buffer.data(), dataSize, &transfered, timeout.count()); (result != LIBUSB_SUCCESS) && (result != LIBUSB_ERROR_TIMEOUT))
         {
             throw UsbException{result};
         }
@@ -0,0 +1,118 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/WriteBehindQueue.h"
+#include "com/FactoryPackets.h"
+#include <algorithm>
+
+namespace plug::com
+{
+    namespace
+    {
+        bool isEmpty(const fx_pedal_settings& effect)
+        {
+            return effect.effect_num == effects::EMPTY;
+        }
+    }
+
+
+    void WriteBehindQueue::setAmplifier(const amp_settings& value)
+    {
+        amp = value;
+    }
+
+    void WriteBehindQueue::setEffect(const fx_pedal_settings& effect)
+    {
+        if (isEmpty(effect) == false)
+        {
+            const auto dsp = dspFromEffect(effect.effect_num);
+
+            for (auto& queued : slots)
+            {
+                if (queued.has_value() && (isEmpty(*queued) == false) && (dspFromEffect(queued->effect_num) == dsp))
+                {
+                    queued = fx_pedal_settings{queued->slot, effects::EMPTY, 0, 0, 0, 0, 0, 0, false};
+                }
+            }
+        }
+        slots[effect.slot.id()] = effect;
+    }
+
+    void WriteBehindQueue::setSignalChain(const SignalChain& chain)
+    {
+        amp = chain.amp();
+
+        for (std::uint8_t slot = 0; slot < slots.size(); ++slot)
+        {
+            slots[slot] = fx_pedal_settings{FxSlot{slot}, effects::EMPTY, 0, 0, 0, 0, 0, 0, false};
+        }
+
+        for (const auto& effect : chain.effects())
+        {
+            setEffect(effect);
+        }
+    }
+
+    bool WriteBehindQueue::empty() const
+    {
+        return (amp.has_value() == false) && std::none_of(slots.cbegin(), slots.cend(), [](const auto& queued)
+                                                           { return queued.has_value(); });
+    }
+
+    void WriteBehindQueue::clear()
+    {
+        amp.reset();
+        slots.fill(std::nullopt);
+    }
+
+    SignalChain WriteBehindQueue::apply(const SignalChain& chain) const
+    {
+        EffectList effectList;
+
+        for (const auto& effect : chain.effects())
+        {
+            if (replacesEffect(effect) == false)
+            {
+                effectList.push_back(effect);
+            }
+        }
+
+        for (const auto& queued : slots)
+        {
+            if (queued.has_value() && (isEmpty(*queued) == false))
+            {
+                effectList.push_back(*queued);
+            }
+        }
+        return SignalChain{chain.name(), amp.value_or(chain.amp()), effectList};
+    }
+
+    bool WriteBehindQueue::replacesEffect(const fx_pedal_settings& effect) const
+    {
+        if (slots[effect.slot.id()].has_value())
+        {
+            return true;
+        }
+
+        return (isEmpty(effect) == false) && std::any_of(slots.cbegin(), slots.cend(), [&effect](const auto& queued)
+                                                          { return queued.has_value() && (isEmpty(*queued) == false) &&
+                                                                   (dspFromEffect(queued->effect_num) == dspFromEffect(effect.effect_num)); });
+    }
+}
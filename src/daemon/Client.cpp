@@ -0,0 +1,200 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "daemon/Client.h"
+#include "com/CommunicationException.h"
+#include "com/PacketSerializer.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace plug::daemon
+{
+    Client::Client(const std::string& socketPath)
+        : fd(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0))
+    {
+        if (fd < 0)
+        {
+            throw std::system_error{errno, std::generic_category(), "Creating socket failed"};
+        }
+
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+
+        if (socketPath.size() >= sizeof(address.sun_path))
+        {
+            ::close(fd);
+            throw std::invalid_argument{"Socket path too long: " + socketPath};
+        }
+        std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+        if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+        {
+            const auto error = errno;
+            ::close(fd);
+            throw com::CommunicationException{"Connecting to " + socketPath + " failed: " + std::strerror(error)};
+        }
+    }
+
+    Client::~Client()
+    {
+        ::close(fd);
+    }
+
+    com::InitialData Client::start_amp()
+    {
+        const auto presetData = request(Request::presets);
+        PayloadReader reader{presetData};
+        std::vector<std::string> names(reader.getU16());
+        std::generate(names.begin(), names.end(), [&reader]
+                      { return reader.getString(); });
+
+        const auto currentData = request(Request::current);
+        PayloadReader currentReader{currentData};
+        auto [signalChain, diagnostics] = com::tryDecodeSignalChain(currentReader.getRecord());
+        return {signalChain, names, diagnostics};
+    }
+
+    void Client::stop_amp()
+    {
+        ::shutdown(fd, SHUT_RDWR);
+    }
+
+    void Client::set_effect(fx_pedal_settings value)
+    {
+        PayloadWriter writer;
+        writer.putEffect(value);
+        request(Request::setEffect, writer);
+    }
+
+    void Client::set_amplifier(amp_settings value)
+    {
+        PayloadWriter writer;
+        writer.putAmp(value);
+        request(Request::setAmp, writer);
+    }
+
+    void Client::set_signal_chain(const SignalChain& chain)
+    {
+        PayloadWriter writer;
+        writer.putRecord(com::serializeSignalChain(0, chain));
+        request(Request::setSignalChain, writer);
+    }
+
+    void Client::save_on_amp(std::string_view name, std::uint8_t slot)
+    {
+        PayloadWriter writer;
+        writer.putByte(slot);
+        writer.putString(name);
+        request(Request::saveOnAmp, writer);
+    }
+
+    SignalChain Client::load_memory_bank(std::uint8_t slot)
+    {
+        PayloadWriter writer;
+        writer.putByte(slot);
+        const auto data = request(Request::loadSlot, writer);
+        PayloadReader reader{data};
+        return com::tryDecodeSignalChain(reader.getRecord()).value;
+    }
+
+    std::vector<com::PresetRecord> Client::backupAll()
+    {
+        const auto data = request(Request::backup);
+        PayloadReader reader{data};
+        std::vector<com::PresetRecord> records(reader.getU16());
+        std::generate(records.begin(), records.end(), [&reader]
+                      { return reader.getRecord(); });
+        return records;
+    }
+
+    std::size_t Client::restore(const std::vector<com::PresetRecord>& records, bool full)
+    {
+        PayloadWriter writer;
+        writer.putByte(full ? 1 : 0);
+        writer.putU16(static_cast<std::uint16_t>(records.size()));
+        std::for_each(records.cbegin(), records.cend(), [&writer](const auto& record)
+                      { writer.putRecord(record); });
+
+        const auto data = request(Request::restore, writer);
+        PayloadReader reader{data};
+        return reader.getU16();
+    }
+
+    std::size_t Client::morph(const SignalChain& target, std::chrono::milliseconds duration)
+    {
+        PayloadWriter writer;
+        writer.putByte(static_cast<std::uint8_t>(MorphTarget::preset));
+        writer.putRecord(com::serializeSignalChain(0, target));
+        writer.putU16(static_cast<std::uint16_t>(duration.count()));
+
+        const auto data = request(Request::morph, writer);
+        PayloadReader reader{data};
+        return reader.getU16();
+    }
+
+    std::size_t Client::morph(std::uint8_t slot, std::chrono::milliseconds duration)
+    {
+        PayloadWriter writer;
+        writer.putByte(static_cast<std::uint8_t>(MorphTarget::slot));
+        writer.putByte(slot);
+        writer.putU16(static_cast<std::uint16_t>(duration.count()));
+
+        const auto data = request(Request::morph, writer);
+        PayloadReader reader{data};
+        return reader.getU16();
+    }
+
+    std::string Client::getDeviceName()
+    {
+        const auto data = request(Request::info);
+        PayloadReader reader{data};
+        reader.getByte();
+        return reader.getString();
+    }
+
+    com::ModelVersion Client::getDeviceModelVersion()
+    {
+        const auto data = request(Request::info);
+        PayloadReader reader{data};
+        return reader.getByte() == 1 ? com::ModelVersion::v1 : com::ModelVersion::v2;
+    }
+
+    std::vector<std::uint8_t> Client::request(Request type, const PayloadWriter& writer)
+    {
+        writeMessage(fd, Message{type, Status::ok, writer.data()});
+        const auto response = readMessage(fd);
+
+        if (response.has_value() == false)
+        {
+            throw com::CommunicationException{"Daemon closed the connection"};
+        }
+        if (response->status != Status::ok)
+        {
+            PayloadReader reader{response->payload};
+            throw com::CommunicationException{reader.getString()};
+        }
+        return response->payload;
+    }
+}
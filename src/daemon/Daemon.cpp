@@ -0,0 +1,349 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "daemon/Session.h"
+#include "daemon/Osc.h"
+#include "com/ConnectionFactory.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <string_view>
+#include <system_error>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+    volatile std::sig_atomic_t running{1};
+
+    void stopRunning(int)
+    {
+        running = 0;
+    }
+
+    int usage(std::string_view program)
+    {
+        std::cerr << "Usage: " << program << " [--socket <path>] [--osc-port <port>]\n\n"
+                  << "Keeps the amplifier connected and serves requests of clients on a local socket.\n"
+                  << "With --osc-port, OSC messages (/amp/<parameter>, /fx/<fx slot>/<parameter>) are\n"
+                  << "accepted on that UDP port of localhost.\n";
+        return EXIT_FAILURE;
+    }
+
+    int listenOn(const std::string& path)
+    {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+
+        if (path.size() >= sizeof(address.sun_path))
+        {
+            throw std::invalid_argument{"Socket path too long: " + path};
+        }
+        std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+        if (fd < 0)
+        {
+            throw std::system_error{errno, std::generic_category(), "Creating socket failed"};
+        }
+
+        ::unlink(path.c_str());
+        const auto mask = ::umask(0077);
+        const bool bound = (::bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0);
+        ::umask(mask);
+
+        if ((bound == false) || (::listen(fd, 8) != 0))
+        {
+            const auto error = errno;
+            ::close(fd);
+            throw std::system_error{error, std::generic_category(), "Listening on " + path + " failed"};
+        }
+        return fd;
+    }
+
+    int bindOsc(std::uint16_t port)
+    {
+        const int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+
+        if (fd < 0)
+        {
+            throw std::system_error{errno, std::generic_category(), "Creating OSC socket failed"};
+        }
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        if (::bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+        {
+            const auto error = errno;
+            ::close(fd);
+            throw std::system_error{error, std::generic_category(), "Binding OSC port " + std::to_string(port) + " failed"};
+        }
+        return fd;
+    }
+
+    // All queued datagrams are read before anything is sent, while the amp is busy new messages
+    // queue up in the socket and are merged into the next batch. Batches are paced by the rate
+    // limit of the amp: the socket isn't polled before nextBatch, messages arriving in between are
+    // merged as well.
+    void receiveOsc(int oscFd, std::vector<std::uint8_t>& buffer, plug::daemon::Session& session, std::chrono::steady_clock::time_point& nextBatch)
+    {
+        constexpr std::size_t maxBatchSize{1024};
+        plug::daemon::ParameterBatch batch{session.currentChain()};
+
+        for (std::size_t i = 0; i < maxBatchSize; ++i)
+        {
+            const auto size = ::recv(oscFd, buffer.data(), buffer.size(), MSG_DONTWAIT);
+
+            if (size < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                break;
+            }
+
+            try
+            {
+                for (const auto& message : plug::daemon::parseOsc(buffer.data(), static_cast<std::size_t>(size)))
+                {
+                    batch.add(message);
+                }
+            }
+            catch (const std::exception& ex)
+            {
+                std::cerr << "OSC: " << ex.what() << '\n';
+            }
+        }
+
+        const auto amp = batch.amp();
+        const auto effects = batch.effects();
+        const auto updates = effects.size() + (amp.has_value() ? 1 : 0);
+        nextBatch = std::chrono::steady_clock::now() + session.rateLimit().interval() * updates;
+
+        try
+        {
+            if (amp.has_value() == true)
+            {
+                session.setAmp(*amp);
+            }
+
+            for (const auto& effect : effects)
+            {
+                session.setEffect(effect);
+            }
+        }
+        catch (const std::exception& ex)
+        {
+            std::cerr << "OSC: " << ex.what() << '\n';
+        }
+    }
+
+    // Replies to a client that doesn't read them are given up after this time
+    constexpr timeval clientSendTimeout{5, 0};
+
+    // Clients are served one request at a time, which also serializes the access to the amp.
+    // Their sockets are read without blocking, partial messages are kept until completed.
+    void serve(int listenFd, int oscFd, plug::daemon::Session& session)
+    {
+        std::vector<pollfd> fds{{listenFd, POLLIN, 0}, {oscFd, POLLIN, 0}};
+        std::map<int, plug::daemon::MessageBuffer> buffers;
+        std::vector<std::uint8_t> oscBuffer(oscFd >= 0 ? 65536 : 0);
+        auto nextOscBatch = std::chrono::steady_clock::now();
+
+        while (running != 0)
+        {
+            // Clients are served while the OSC socket waits for its next batch
+            const auto now = std::chrono::steady_clock::now();
+            const bool oscDue = (now >= nextOscBatch);
+            fds[1].events = oscDue ? POLLIN : 0;
+            const int timeout = oscDue ? -1 : static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(nextOscBatch - now).count());
+
+            if (::poll(fds.data(), fds.size(), timeout) < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                throw std::system_error{errno, std::generic_category(), "Polling failed"};
+            }
+
+            if ((fds[1].revents & POLLIN) != 0)
+            {
+                receiveOsc(oscFd, oscBuffer, session, nextOscBatch);
+            }
+
+            for (auto& client : fds)
+            {
+                if ((client.fd == listenFd) || (client.fd == oscFd) || (client.revents == 0))
+                {
+                    continue;
+                }
+
+                try
+                {
+                    auto& buffer = buffers[client.fd];
+                    const bool connected = buffer.receive(client.fd);
+
+                    while (const auto request = buffer.next())
+                    {
+                        plug::daemon::writeMessage(client.fd, session.handle(*request));
+                    }
+
+                    if (connected == true)
+                    {
+                        continue;
+                    }
+                }
+                catch (const std::exception& ex)
+                {
+                    std::cerr << "Client error: " << ex.what() << '\n';
+                }
+                buffers.erase(client.fd);
+                ::close(client.fd);
+                client.fd = -1;
+            }
+            fds.erase(std::remove_if(std::next(fds.begin(), 2), fds.end(), [](const auto& p)
+                                     { return p.fd < 0; }),
+                      fds.end());
+
+            if ((fds.front().revents & POLLIN) != 0)
+            {
+                if (const int clientFd = ::accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC); clientFd >= 0)
+                {
+                    ::setsockopt(clientFd, SOL_SOCKET, SO_SNDTIMEO, &clientSendTimeout, sizeof(clientSendTimeout));
+                    fds.push_back({clientFd, POLLIN, 0});
+                }
+            }
+        }
+
+        std::for_each(std::next(fds.cbegin(), 2), fds.cend(), [](const auto& p)
+                      { ::close(p.fd); });
+    }
+
+    // A missing config location or a broken entry must not keep the daemon from starting
+    plug::com::RateLimit loadRateLimit(plug::com::ModelVersion modelVersion)
+    {
+        try
+        {
+            return plug::com::RateLimits::load(plug::com::defaultRateLimitsPath()).get(modelVersion);
+        }
+        catch (const std::exception& ex)
+        {
+            std::cerr << "Warning: " << ex.what() << ", using the default rate limit\n";
+            return plug::com::defaultRateLimit;
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string socketPath = plug::daemon::defaultSocketPath();
+    std::optional<std::uint16_t> oscPort;
+
+    for (int i = 1; i < argc; i += 2)
+    {
+        const std::string_view option{argv[i]};
+
+        if ((i + 1) >= argc)
+        {
+            return usage(argv[0]);
+        }
+        else if (option == "--socket")
+        {
+            socketPath = argv[i + 1];
+        }
+        else if (option == "--osc-port")
+        {
+            const auto port = std::strtoul(argv[i + 1], nullptr, 10);
+
+            if ((port == 0) || (port > 0xffff))
+            {
+                return usage(argv[0]);
+            }
+            oscPort = static_cast<std::uint16_t>(port);
+        }
+        else
+        {
+            return usage(argv[0]);
+        }
+    }
+
+    struct sigaction action{};
+    action.sa_handler = stopRunning;
+    ::sigaction(SIGINT, &action, nullptr);
+    ::sigaction(SIGTERM, &action, nullptr);
+
+    try
+    {
+        auto connection = plug::com::createUsbConnection();
+        const auto modelVersion = connection->modelVersion();
+        plug::daemon::Session session{std::move(connection)};
+        session.start();
+
+        const auto limit = loadRateLimit(modelVersion);
+        session.setRateLimit(limit);
+        std::cerr << "Rate limit: " << limit.updatesPerSecond << " updates/s\n";
+
+        const int listenFd = listenOn(socketPath);
+        std::cerr << "Listening on " << socketPath << '\n';
+
+        const int oscFd = oscPort.has_value() ? bindOsc(*oscPort) : -1;
+
+        if (oscFd >= 0)
+        {
+            std::cerr << "Receiving OSC on 127.0.0.1:" << *oscPort << '\n';
+        }
+
+        serve(listenFd, oscFd, session);
+
+        if (oscFd >= 0)
+        {
+            ::close(oscFd);
+        }
+        ::close(listenFd);
+        ::unlink(socketPath.c_str());
+        session.stop();
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "Error: " << ex.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,330 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "daemon/Osc.h"
+#include "Parameters.h"
+#include "com/FactoryPackets.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+
+namespace plug::daemon
+{
+    namespace
+    {
+        constexpr std::string_view bundleTag{"#bundle"};
+
+        class OscReader
+        {
+        public:
+            OscReader(const std::uint8_t* data, std::size_t size)
+                : begin(data), end(data + size)
+            {
+            }
+
+            bool atEnd() const
+            {
+                return begin == end;
+            }
+
+            std::string getString()
+            {
+                const auto terminator = std::find(begin, end, '\0');
+
+                if (terminator == end)
+                {
+                    throw std::invalid_argument{"Unterminated OSC string"};
+                }
+
+                std::string value{begin, terminator};
+                take(((value.size() / 4) + 1) * 4);
+                return value;
+            }
+
+            std::uint32_t getU32()
+            {
+                const auto data = take(4);
+                return (std::uint32_t{data[0]} << 24) | (std::uint32_t{data[1]} << 16) | (std::uint32_t{data[2]} << 8) | std::uint32_t{data[3]};
+            }
+
+            const std::uint8_t* take(std::size_t size)
+            {
+                if (static_cast<std::size_t>(end - begin) < size)
+                {
+                    throw std::invalid_argument{"Truncated OSC packet"};
+                }
+                const auto data = begin;
+                begin += size;
+                return data;
+            }
+
+        private:
+            const std::uint8_t* begin;
+            const std::uint8_t* end;
+        };
+
+        void parseElement(const std::uint8_t* data, std::size_t size, std::vector<OscMessage>& messages)
+        {
+            OscReader reader{data, size};
+            auto address = reader.getString();
+
+            if (address == bundleTag)
+            {
+                reader.take(8);
+
+                while (reader.atEnd() == false)
+                {
+                    const auto elementSize = reader.getU32();
+                    parseElement(reader.take(elementSize), elementSize, messages);
+                }
+                return;
+            }
+
+            if (address.empty() || (address.front() != '/'))
+            {
+                throw std::invalid_argument{"Invalid OSC address: " + address};
+            }
+
+            OscMessage message{std::move(address), {}};
+            const auto types = reader.atEnd() ? std::string{","} : reader.getString();
+
+            if (types.empty() || (types.front() != ','))
+            {
+                throw std::invalid_argument{"Invalid OSC type tags"};
+            }
+
+            for (const char type : std::string_view{types}.substr(1))
+            {
+                switch (type)
+                {
+                    case 'i':
+                        message.arguments.emplace_back(static_cast<std::int32_t>(reader.getU32()));
+                        break;
+                    case 'f':
+                    {
+                        const auto bits = reader.getU32();
+                        float value{0.0f};
+                        std::memcpy(&value, &bits, sizeof(value));
+                        message.arguments.emplace_back(value);
+                        break;
+                    }
+                    case 'T':
+                        message.arguments.emplace_back(std::int32_t{1});
+                        break;
+                    case 'F':
+                        message.arguments.emplace_back(std::int32_t{0});
+                        break;
+                    default:
+                        throw std::invalid_argument{"Unsupported OSC argument type: " + std::string{type}};
+                }
+            }
+            messages.push_back(std::move(message));
+        }
+
+        std::vector<std::string_view> split(std::string_view address)
+        {
+            std::vector<std::string_view> parts;
+
+            while (address.empty() == false)
+            {
+                address.remove_prefix(1);
+                const auto pos = std::min(address.find('/'), address.size());
+                parts.push_back(address.substr(0, pos));
+                address.remove_prefix(pos);
+            }
+            return parts;
+        }
+
+        std::size_t effectIndex(com::DSP dsp)
+        {
+            return static_cast<std::size_t>(dsp) - static_cast<std::size_t>(com::DSP::effect0);
+        }
+
+        // Floats select one of the valid ids in ascending order, so the whole range of a fader maps onto existing models
+        template <class Find>
+        std::uint8_t idValue(const OscMessage& message, Find find)
+        {
+            const auto value = parameterValue(message);
+
+            if (std::holds_alternative<float>(message.arguments.front()) == true)
+            {
+                std::vector<std::uint8_t> ids;
+
+                for (unsigned int id = 0; id <= 0xff; ++id)
+                {
+                    if (find(static_cast<std::uint8_t>(id)).has_value() == true)
+                    {
+                        ids.push_back(static_cast<std::uint8_t>(id));
+                    }
+                }
+
+                const auto fraction = std::clamp(std::get<float>(message.arguments.front()), 0.0f, 1.0f);
+                return ids[static_cast<std::size_t>(std::lround(fraction * static_cast<float>(ids.size() - 1)))];
+            }
+
+            if (find(value).has_value() == false)
+            {
+                throw std::invalid_argument{"Invalid id " + std::to_string(value) + ": " + message.address};
+            }
+            return value;
+        }
+    }
+
+
+    std::vector<OscMessage> parseOsc(const std::uint8_t* data, std::size_t size)
+    {
+        if ((size % 4) != 0)
+        {
+            throw std::invalid_argument{"OSC packet size not a multiple of 4"};
+        }
+
+        std::vector<OscMessage> messages;
+        parseElement(data, size, messages);
+        return messages;
+    }
+
+    std::uint8_t parameterValue(const OscMessage& message)
+    {
+        if (message.arguments.empty())
+        {
+            throw std::invalid_argument{"Missing value: " + message.address};
+        }
+
+        const auto& argument = message.arguments.front();
+
+        if (const auto value = std::get_if<std::int32_t>(&argument))
+        {
+            if ((*value < 0) || (*value > 0xff))
+            {
+                throw std::invalid_argument{"Value out of range: " + message.address};
+            }
+            return static_cast<std::uint8_t>(*value);
+        }
+
+        const auto fraction = std::clamp(std::get<float>(argument), 0.0f, 1.0f);
+        return static_cast<std::uint8_t>(std::lround(fraction * 255.0f));
+    }
+
+
+    ParameterBatch::ParameterBatch(const SignalChain& current)
+        : ampState(current.amp()), ampChanged(false), effectState(), effectChanged(), removedSlots()
+    {
+        for (const auto& effect : current.effects())
+        {
+            if (effect.effect_num != plug::effects::EMPTY)
+            {
+                effectState[effectIndex(com::dspFromEffect(effect.effect_num))] = effect;
+            }
+        }
+    }
+
+    void ParameterBatch::add(const OscMessage& message)
+    {
+        const auto parts = split(message.address);
+
+        if ((parts.size() == 2) && (parts[0] == "amp"))
+        {
+            if (parts[1] == "model")
+            {
+                setAmpParameter(ampState, parts[1], idValue(message, findAmpById));
+            }
+            else if (parts[1] == "cabinet")
+            {
+                setAmpParameter(ampState, parts[1], idValue(message, findCabinetById));
+            }
+            else
+            {
+                setAmpParameter(ampState, parts[1], parameterValue(message));
+            }
+            ampChanged = true;
+            return;
+        }
+
+        if ((parts.size() != 3) || (parts[0] != "fx") || (parts[1].size() != 1) || (parts[1][0] < '0') || (parts[1][0] > '7'))
+        {
+            throw std::invalid_argument{"Unknown OSC address: " + message.address};
+        }
+
+        const auto slot = static_cast<std::uint8_t>(parts[1][0] - '0');
+        const auto current = std::find_if(effectState.begin(), effectState.end(), [slot](const auto& e)
+                                          { return e.has_value() && (e->slot.id() == slot); });
+
+        if (parts[2] != "model")
+        {
+            if (current == effectState.end())
+            {
+                throw std::invalid_argument{"No effect in slot " + std::to_string(slot)};
+            }
+            setEffectParameter(**current, parts[2], parameterValue(message));
+            effectChanged[static_cast<std::size_t>(std::distance(effectState.begin(), current))] = true;
+            return;
+        }
+
+        auto effect = (current != effectState.end()) ? **current : fx_pedal_settings{FxSlot{slot}, plug::effects::EMPTY, 0, 0, 0, 0, 0, 0, true};
+        setEffectParameter(effect, parts[2], idValue(message, findEffectById));
+
+        if (current != effectState.end())
+        {
+            current->reset();
+            effectChanged[static_cast<std::size_t>(std::distance(effectState.begin(), current))] = false;
+        }
+        removedSlots.erase(std::remove(removedSlots.begin(), removedSlots.end(), slot), removedSlots.end());
+
+        if (effect.effect_num == plug::effects::EMPTY)
+        {
+            removedSlots.push_back(slot);
+            return;
+        }
+
+        const auto index = effectIndex(com::dspFromEffect(effect.effect_num));
+        effectState[index] = effect;
+        effectChanged[index] = true;
+    }
+
+    std::optional<amp_settings> ParameterBatch::amp() const
+    {
+        if (ampChanged == true)
+        {
+            return ampState;
+        }
+        return std::nullopt;
+    }
+
+    std::vector<fx_pedal_settings> ParameterBatch::effects() const
+    {
+        std::vector<fx_pedal_settings> changed;
+
+        for (const auto slot : removedSlots)
+        {
+            changed.push_back(fx_pedal_settings{FxSlot{slot}, plug::effects::EMPTY, 0, 0, 0, 0, 0, 0, false});
+        }
+
+        for (std::size_t i = 0; i < effectState.size(); ++i)
+        {
+            if (effectChanged[i] == true)
+            {
+                changed.push_back(*effectState[i]);
+            }
+        }
+        return changed;
+    }
+}
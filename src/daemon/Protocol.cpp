@@ -0,0 +1,343 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "daemon/Protocol.h"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdlib>
+#include <stdexcept>
+#include <system_error>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace plug::daemon
+{
+    namespace
+    {
+        template <class T>
+        void putInteger(std::vector<std::uint8_t>& out, T value)
+        {
+            for (std::size_t i = 0; i < sizeof(T); ++i)
+            {
+                out.push_back(static_cast<std::uint8_t>((value >> (i * 8)) & 0xff));
+            }
+        }
+
+        template <class T>
+        T getInteger(const std::uint8_t* in)
+        {
+            T value{0};
+
+            for (std::size_t i = 0; i < sizeof(T); ++i)
+            {
+                value = static_cast<T>(value | static_cast<T>(in[i]) << (i * 8));
+            }
+            return value;
+        }
+
+        template <class T>
+        T checkedEnum(std::uint8_t value, T last)
+        {
+            if (value > static_cast<std::uint8_t>(last))
+            {
+                throw std::invalid_argument{"Invalid value in message: " + std::to_string(value)};
+            }
+            return static_cast<T>(value);
+        }
+
+        // Payload size of a message, checked against the maximum
+        std::uint32_t payloadSize(const std::uint8_t* header)
+        {
+            const auto size = getInteger<std::uint32_t>(header + 4);
+
+            if (size > maxPayloadSize)
+            {
+                throw std::runtime_error{"Message payload too large"};
+            }
+            return size;
+        }
+
+        bool readFully(int fd, std::uint8_t* data, std::size_t size)
+        {
+            std::size_t done{0};
+
+            while (done < size)
+            {
+                const auto n = ::read(fd, data + done, size - done);
+
+                if (n == 0)
+                {
+                    if (done == 0)
+                    {
+                        return false;
+                    }
+                    throw std::runtime_error{"Connection closed within a message"};
+                }
+                if (n < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    throw std::system_error{errno, std::generic_category(), "Reading message failed"};
+                }
+                done += static_cast<std::size_t>(n);
+            }
+            return true;
+        }
+    }
+
+
+    std::vector<std::uint8_t> encodeMessage(const Message& message)
+    {
+        if (message.payload.size() > maxPayloadSize)
+        {
+            throw std::invalid_argument{"Message payload too large"};
+        }
+
+        std::vector<std::uint8_t> data;
+        data.reserve(headerSize + message.payload.size());
+        data.push_back(static_cast<std::uint8_t>(message.type));
+        data.push_back(static_cast<std::uint8_t>(message.status));
+        putInteger<std::uint16_t>(data, 0);
+        putInteger(data, static_cast<std::uint32_t>(message.payload.size()));
+        data.insert(data.end(), message.payload.cbegin(), message.payload.cend());
+        return data;
+    }
+
+    void writeMessage(int fd, const Message& message)
+    {
+        const auto data = encodeMessage(message);
+        std::size_t done{0};
+
+        while (done < data.size())
+        {
+            const auto n = ::send(fd, data.data() + done, data.size() - done, MSG_NOSIGNAL);
+
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                throw std::system_error{errno, std::generic_category(), "Writing message failed"};
+            }
+            done += static_cast<std::size_t>(n);
+        }
+    }
+
+    std::optional<Message> readMessage(int fd)
+    {
+        std::array<std::uint8_t, headerSize> header{{}};
+
+        if (readFully(fd, header.data(), header.size()) == false)
+        {
+            return std::nullopt;
+        }
+
+        const auto size = payloadSize(header.data());
+        Message message{static_cast<Request>(header[0]), checkedEnum(header[1], Status::error), std::vector<std::uint8_t>(size)};
+
+        if ((size > 0) && (readFully(fd, message.payload.data(), size) == false))
+        {
+            throw std::runtime_error{"Connection closed within a message"};
+        }
+        return message;
+    }
+
+    bool MessageBuffer::receive(int fd)
+    {
+        std::array<std::uint8_t, 4096> chunk{{}};
+
+        while (true)
+        {
+            const auto n = ::recv(fd, chunk.data(), chunk.size(), MSG_DONTWAIT);
+
+            if (n > 0)
+            {
+                append(chunk.data(), static_cast<std::size_t>(n));
+                continue;
+            }
+            if (n == 0)
+            {
+                if (data.empty() == false)
+                {
+                    throw std::runtime_error{"Connection closed within a message"};
+                }
+                return false;
+            }
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+            {
+                return true;
+            }
+            throw std::system_error{errno, std::generic_category(), "Reading message failed"};
+        }
+    }
+
+    void MessageBuffer::append(const std::uint8_t* bytes, std::size_t size)
+    {
+        data.insert(data.end(), bytes, bytes + size);
+    }
+
+    std::optional<Message> MessageBuffer::next()
+    {
+        if (data.size() < headerSize)
+        {
+            return std::nullopt;
+        }
+
+        const auto size = payloadSize(data.data());
+
+        if (data.size() < (headerSize + size))
+        {
+            return std::nullopt;
+        }
+
+        const auto payload = std::next(data.cbegin(), headerSize);
+        Message message{static_cast<Request>(data[0]), checkedEnum(data[1], Status::error), {payload, std::next(payload, size)}};
+        data.erase(data.cbegin(), std::next(payload, size));
+        return message;
+    }
+
+    std::string defaultSocketPath()
+    {
+        if (const char* runtimeDir = std::getenv("XDG_RUNTIME_DIR"); (runtimeDir != nullptr) && (*runtimeDir != '\0'))
+        {
+            return std::string{runtimeDir} + "/plugd.sock";
+        }
+        return "/tmp/plugd-" + std::to_string(::getuid()) + ".sock";
+    }
+
+
+    void PayloadWriter::putByte(std::uint8_t value)
+    {
+        bytes.push_back(value);
+    }
+
+    void PayloadWriter::putU16(std::uint16_t value)
+    {
+        putInteger(bytes, value);
+    }
+
+    void PayloadWriter::putString(std::string_view value)
+    {
+        if (value.size() > 0xffff)
+        {
+            throw std::invalid_argument{"String too long"};
+        }
+        putU16(static_cast<std::uint16_t>(value.size()));
+        bytes.insert(bytes.end(), value.cbegin(), value.cend());
+    }
+
+    void PayloadWriter::putRecord(const com::PresetRecord& record)
+    {
+        std::for_each(record.cbegin(), record.cend(), [this](const auto& packet)
+                      { bytes.insert(bytes.end(), packet.cbegin(), packet.cend()); });
+    }
+
+    void PayloadWriter::putAmp(const amp_settings& amp)
+    {
+        bytes.insert(bytes.end(), {value(amp.amp_num), amp.gain, amp.volume, amp.treble, amp.middle, amp.bass,
+                                   value(amp.cabinet), amp.noise_gate, amp.master_vol, amp.gain2, amp.presence,
+                                   amp.threshold, amp.depth, amp.bias, amp.sag, static_cast<std::uint8_t>(amp.brightness), amp.usb_gain});
+    }
+
+    void PayloadWriter::putEffect(const fx_pedal_settings& effect)
+    {
+        bytes.insert(bytes.end(), {effect.slot.id(), value(effect.effect_num), effect.knob1, effect.knob2, effect.knob3,
+                                   effect.knob4, effect.knob5, effect.knob6, static_cast<std::uint8_t>(effect.enabled)});
+    }
+
+    std::vector<std::uint8_t> PayloadWriter::data() const
+    {
+        return bytes;
+    }
+
+
+    PayloadReader::PayloadReader(const std::vector<std::uint8_t>& data)
+        : bytes(data), pos(0)
+    {
+    }
+
+    std::uint8_t PayloadReader::getByte()
+    {
+        return *take(1);
+    }
+
+    std::uint16_t PayloadReader::getU16()
+    {
+        return getInteger<std::uint16_t>(take(2));
+    }
+
+    std::string PayloadReader::getString()
+    {
+        const auto size = getU16();
+        const auto data = take(size);
+        return std::string{data, data + size};
+    }
+
+    com::PresetRecord PayloadReader::getRecord()
+    {
+        com::PresetRecord record{{}};
+
+        for (auto& packet : record)
+        {
+            const auto data = take(packet.size());
+            std::copy(data, data + packet.size(), packet.begin());
+        }
+        return record;
+    }
+
+    amp_settings PayloadReader::getAmp()
+    {
+        const auto data = take(17);
+        return amp_settings{checkedEnum(data[0], amps::METAL_2000), data[1], data[2], data[3], data[4], data[5],
+                            checkedEnum(data[6], cabinets::cabSS112), data[7], data[8], data[9], data[10],
+                            data[11], data[12], data[13], data[14], (data[15] != 0), data[16]};
+    }
+
+    fx_pedal_settings PayloadReader::getEffect()
+    {
+        const auto data = take(9);
+        return fx_pedal_settings{FxSlot{data[0]}, checkedEnum(data[1], effects::FENDER_65_SPRING_REVERB),
+                                 data[2], data[3], data[4], data[5], data[6], data[7], (data[8] != 0)};
+    }
+
+    bool PayloadReader::atEnd() const
+    {
+        return pos == bytes.size();
+    }
+
+    const std::uint8_t* PayloadReader::take(std::size_t size)
+    {
+        if ((bytes.size() - pos) < size)
+        {
+            throw std::invalid_argument{"Truncated message"};
+        }
+        const auto data = bytes.data() + pos;
+        pos += size;
+        return data;
+    }
+}
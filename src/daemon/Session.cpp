@@ -0,0 +1,306 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "daemon/Session.h"
+#include "com/FactoryPackets.h"
+#include "com/PacketSerializer.h"
+#include "com/RestorePlan.h"
+#include "com/SceneMorph.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+namespace plug::daemon
+{
+    Session::Session(std::unique_ptr<com::Connection> connection)
+        : mustang(std::move(connection))
+    {
+    }
+
+    void Session::start()
+    {
+        auto [signalChain, names, diagnostics] = mustang.start_amp();
+
+        for (const auto& diagnostic : diagnostics)
+        {
+            std::cerr << "Current preset: " << com::describe(diagnostic) << '\n';
+        }
+
+        current = signalChain;
+        presetNames = names;
+        ampBank.clear();
+    }
+
+    void Session::stop()
+    {
+        mustang.stop_amp();
+    }
+
+    Message Session::handle(const Message& request)
+    {
+        try
+        {
+            PayloadReader reader{request.payload};
+            auto payload = dispatch(request.type, reader);
+
+            if (reader.atEnd() == false)
+            {
+                throw std::invalid_argument{"Unexpected data in request"};
+            }
+            return Message{request.type, Status::ok, payload};
+        }
+        catch (const std::exception& ex)
+        {
+            PayloadWriter writer;
+            writer.putString(ex.what());
+            return Message{request.type, Status::error, writer.data()};
+        }
+    }
+
+    const SignalChain& Session::currentChain() const
+    {
+        return current;
+    }
+
+    void Session::setAmp(amp_settings amp)
+    {
+        mustang.set_amplifier(amp);
+        current.setAmp(amp);
+    }
+
+    void Session::setEffect(fx_pedal_settings effect)
+    {
+        mustang.set_effect(effect);
+
+        // The amp runs one effect per DSP, an effect replaces the one of its DSP in another slot
+        const auto replaces = [&effect](const fx_pedal_settings& e)
+        {
+            return (e.slot.id() == effect.slot.id()) || ((effect.effect_num != effects::EMPTY) && (e.effect_num != effects::EMPTY) && (com::dspFromEffect(e.effect_num) == com::dspFromEffect(effect.effect_num)));
+        };
+
+        EffectList effects;
+        for (const auto& e : current.effects())
+        {
+            if (replaces(e) == false)
+            {
+                effects.push_back(e);
+            }
+        }
+        effects.push_back(effect);
+        current.setEffects(effects);
+    }
+
+    void Session::setRateLimit(const com::RateLimit& limit)
+    {
+        updateLimit = limit;
+    }
+
+    const com::RateLimit& Session::rateLimit() const
+    {
+        return updateLimit;
+    }
+
+    std::vector<std::uint8_t> Session::dispatch(Request type, PayloadReader& reader)
+    {
+        PayloadWriter writer;
+
+        switch (type)
+        {
+            case Request::info:
+                writer.putByte(mustang.getDeviceModelVersion() == com::ModelVersion::v1 ? 1 : 2);
+                writer.putString(mustang.getDeviceName());
+                break;
+            case Request::presets:
+                writer.putU16(static_cast<std::uint16_t>(presetNames.size()));
+                std::for_each(presetNames.cbegin(), presetNames.cend(), [&writer](const auto& name)
+                              { writer.putString(name); });
+                break;
+            case Request::current:
+                writer.putRecord(com::serializeSignalChain(0, current));
+                break;
+            case Request::loadSlot:
+            {
+                const auto slot = reader.getByte();
+
+                if (slot >= presetNames.size())
+                {
+                    throw std::invalid_argument{"Invalid slot: " + std::to_string(slot)};
+                }
+                current = mustang.load_memory_bank(slot);
+                writer.putRecord(com::serializeSignalChain(slot, current));
+                break;
+            }
+            case Request::setAmp:
+                setAmp(reader.getAmp());
+                break;
+            case Request::setEffect:
+                setEffect(reader.getEffect());
+                break;
+            case Request::setSignalChain:
+            {
+                // Sections with unknown models can't be written, the current preset is kept then
+                const auto chain = com::tryDecodeSignalChain(reader.getRecord()).value;
+                mustang.set_signal_chain(chain);
+                current = chain;
+                break;
+            }
+            case Request::saveOnAmp:
+            {
+                const auto slot = reader.getByte();
+                const auto name = reader.getString();
+
+                if (slot >= presetNames.size())
+                {
+                    throw std::invalid_argument{"Invalid slot: " + std::to_string(slot)};
+                }
+                ampBank.clear();
+                mustang.save_on_amp(name, slot);
+                presetNames[slot] = name;
+                current.setName(name);
+                break;
+            }
+            case Request::backup:
+                readAmpBank();
+                writer.putU16(static_cast<std::uint16_t>(ampBank.size()));
+                std::for_each(ampBank.cbegin(), ampBank.cend(), [&writer](const auto& record)
+                              { writer.putRecord(record); });
+                break;
+            case Request::restore:
+            {
+                const bool full = (reader.getByte() != 0);
+                std::vector<com::PresetRecord> records(reader.getU16());
+                std::generate(records.begin(), records.end(), [&reader]
+                              { return reader.getRecord(); });
+
+                if (records.size() > presetNames.size())
+                {
+                    throw std::invalid_argument{"More presets than slots"};
+                }
+
+                auto bank = std::move(ampBank);
+                ampBank.clear();
+
+                // Without a cached bank, only the slots the records cover are read for the differences
+                if ((full == false) && (bank.size() != presetNames.size()))
+                {
+                    bank = mustang.backupAll(records.size());
+                }
+
+                std::optional<std::uint8_t> lastWritten;
+
+                if (full == true)
+                {
+                    mustang.restoreAll(records);
+                    writer.putU16(static_cast<std::uint16_t>(records.size()));
+
+                    if (records.empty() == false)
+                    {
+                        lastWritten = static_cast<std::uint8_t>(records.size() - 1);
+                    }
+                }
+                else
+                {
+                    const auto updates = com::planRestore(bank, records);
+                    mustang.restore(updates);
+                    writer.putU16(static_cast<std::uint16_t>(updates.size()));
+
+                    if (updates.empty() == false)
+                    {
+                        lastWritten = updates.back().slot;
+                    }
+                }
+
+                // Writing the slots replaced the amp's live tone; the last written slot is loaded,
+                // so the current preset is known again
+                if (lastWritten.has_value())
+                {
+                    current = mustang.load_memory_bank(*lastWritten);
+                }
+
+                if (bank.size() == presetNames.size())
+                {
+                    std::copy(records.cbegin(), records.cend(), bank.begin());
+                    ampBank = std::move(bank);
+                }
+                std::transform(records.cbegin(), records.cend(), presetNames.begin(), [](const auto& record)
+                               { return com::decodeNameFromData(com::fromRawData<com::NamePayload>(record[0])); });
+                break;
+            }
+            case Request::morph:
+            {
+                const auto target = morphTarget(reader);
+                const std::chrono::milliseconds duration{reader.getU16()};
+
+                com::SceneMorph morph{mustang};
+                morph.setRateLimit(updateLimit);
+                const auto frames = morph.run(current, target, duration);
+                current = target;
+                writer.putU16(static_cast<std::uint16_t>(std::min<std::size_t>(frames, 0xffff)));
+                break;
+            }
+            default:
+                throw std::invalid_argument{"Unknown request: " + std::to_string(static_cast<int>(type))};
+        }
+        return writer.data();
+    }
+
+    // A slot is taken from the amp bank if it has been read already. Otherwise it's loaded, which
+    // switches the amp to it, so the current preset is set again before the morph starts.
+    SignalChain Session::morphTarget(PayloadReader& reader)
+    {
+        const auto type = reader.getByte();
+
+        if (type == static_cast<std::uint8_t>(MorphTarget::preset))
+        {
+            return com::tryDecodeSignalChain(reader.getRecord()).value;
+        }
+        if (type != static_cast<std::uint8_t>(MorphTarget::slot))
+        {
+            throw std::invalid_argument{"Invalid morph target: " + std::to_string(type)};
+        }
+
+        const auto slot = reader.getByte();
+
+        if (slot >= presetNames.size())
+        {
+            throw std::invalid_argument{"Invalid slot: " + std::to_string(slot)};
+        }
+
+        if (ampBank.size() == presetNames.size())
+        {
+            return com::tryDecodeSignalChain(ampBank[slot]).value;
+        }
+
+        auto target = mustang.load_memory_bank(slot);
+        mustang.set_signal_chain(current);
+        return target;
+    }
+
+    void Session::readAmpBank()
+    {
+        if (ampBank.size() != presetNames.size())
+        {
+            ampBank = mustang.backupAll(presetNames.size());
+        }
+    }
+}
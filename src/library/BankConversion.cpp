@@ -0,0 +1,90 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "library/BankConversion.h"
+#include "library/FuseFormat.h"
+#include "com/PacketSerializer.h"
+#include "com/PresetBank.h"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace plug::library
+{
+    namespace
+    {
+        std::string fileName(std::size_t index, std::string_view presetName)
+        {
+            std::string name{presetName};
+            std::replace_if(name.begin(), name.end(), [](unsigned char c)
+                            { return (std::isalnum(c) == 0) && (std::string_view{" -_'()"}.find(static_cast<char>(c)) == std::string_view::npos); },
+                            '_');
+
+            std::ostringstream out;
+            out << std::setw(3) << std::setfill('0') << index;
+
+            if (name.empty() == false)
+            {
+                out << ' ' << name;
+            }
+            out << ".fuse";
+            return out.str();
+        }
+    }
+
+
+    void fuseToBank(const std::vector<std::string>& files, const std::string& bankFile)
+    {
+        if (files.size() > com::bank::maxRecords)
+        {
+            throw std::invalid_argument{"Too many preset files: " + std::to_string(files.size()) + ", the amp has at most " +
+                                        std::to_string(com::bank::maxRecords) + " slots"};
+        }
+
+        std::vector<com::PresetRecord> records;
+        records.reserve(files.size());
+
+        for (const auto& file : files)
+        {
+            const auto slot = static_cast<std::uint8_t>(records.size());
+            records.push_back(com::serializeSignalChain(slot, loadFuseFile(file)));
+        }
+        com::writeBank(bankFile, records);
+    }
+
+    std::vector<std::string> bankToFuse(const std::string& bankFile, const std::string& directory)
+    {
+        const com::MappedBank bank{bankFile};
+        std::vector<std::string> written;
+        written.reserve(bank.size());
+
+        for (std::size_t i = 0; i < bank.size(); ++i)
+        {
+            const auto chain = bank.decode(i);
+            const auto path = (std::filesystem::path{directory} / fileName(i + 1, chain.name())).string();
+            saveFuseFile(path, chain);
+            written.push_back(path);
+        }
+        return written;
+    }
+}
@@ -0,0 +1,116 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "library/Deduplication.h"
+#include "library/ParallelFor.h"
+#include "library/PresetHash.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+
+namespace plug::library
+{
+    bool sameFileContent(const LibraryEntry& lhs, const LibraryEntry& rhs)
+    {
+        if (lhs.size != rhs.size)
+        {
+            return false;
+        }
+
+        std::ifstream lhsFile{lhs.path, std::ios::binary};
+        std::ifstream rhsFile{rhs.path, std::ios::binary};
+
+        if ((lhsFile.is_open() == false) || (rhsFile.is_open() == false))
+        {
+            return false;
+        }
+
+        return std::equal(std::istreambuf_iterator<char>{lhsFile}, std::istreambuf_iterator<char>{},
+                          std::istreambuf_iterator<char>{rhsFile}, std::istreambuf_iterator<char>{});
+    }
+
+    std::vector<DuplicateGroup> findDuplicates(const std::vector<LibraryEntry>& entries, const SameContent& sameContent)
+    {
+        const auto copies = [&entries, &sameContent](std::size_t lhs, std::size_t rhs)
+        {
+            return (entries[lhs].contentHash == entries[rhs].contentHash) && sameContent(entries[lhs], entries[rhs]);
+        };
+
+        std::vector<std::string> canonical(entries.size());
+        parallelFor(entries.size(), [&entries, &canonical](std::size_t i)
+                    {
+                        if (entries[i].valid)
+                        {
+                            canonical[i] = canonicalize(entries[i].chain);
+                        } });
+
+        std::unordered_map<std::string, std::size_t> equivalentGroups;
+        std::unordered_multimap<std::uint64_t, std::size_t> identicalGroups;
+        std::vector<DuplicateGroup> groups;
+
+        for (std::size_t i = 0; i < entries.size(); ++i)
+        {
+            const auto& entry = entries[i];
+            const auto next = groups.size();
+            std::size_t group{next};
+            std::uint64_t hash{entry.contentHash};
+
+            if (entry.valid)
+            {
+                const auto itr = equivalentGroups.emplace(std::move(canonical[i]), next).first;
+                group = itr->second;
+                hash = hashBytes(itr->first);
+            }
+            else
+            {
+                const auto [first, last] = identicalGroups.equal_range(entry.contentHash);
+                const auto itr = std::find_if(first, last, [&groups, &copies, i](const auto& candidate)
+                                              { return copies(groups[candidate.second].entries.front(), i); });
+
+                if (itr != last)
+                {
+                    group = itr->second;
+                }
+                else
+                {
+                    identicalGroups.emplace(entry.contentHash, next);
+                }
+            }
+
+            if (group == next)
+            {
+                groups.push_back(DuplicateGroup{true, hash, {i}});
+            }
+            else
+            {
+                auto& duplicates = groups[group];
+                duplicates.identical = duplicates.identical && copies(duplicates.entries.front(), i);
+                duplicates.entries.push_back(i);
+            }
+        }
+
+        groups.erase(std::remove_if(groups.begin(), groups.end(), [](const auto& group)
+                                    { return group.entries.size() < 2; }),
+                     groups.end());
+        return groups;
+    }
+}
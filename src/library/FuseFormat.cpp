@@ -0,0 +1,714 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "library/FuseFormat.h"
+#include "com/IdLookup.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <cstdint>
+
+namespace plug::library
+{
+    namespace
+    {
+        constexpr std::string_view whitespace{" \t\r\n"};
+
+        std::string_view trim(std::string_view text)
+        {
+            const auto begin = text.find_first_not_of(whitespace);
+
+            if (begin == std::string_view::npos)
+            {
+                return {};
+            }
+            return text.substr(begin, text.find_last_not_of(whitespace) - begin + 1);
+        }
+
+        // Code point of a reference like "#233" or "#xe9", which must be a character allowed in XML
+        char32_t characterReference(std::string_view entity)
+        {
+            const bool hex = (entity.size() > 1) && (entity[1] == 'x');
+            const auto digits = entity.substr(hex ? 2 : 1);
+            std::uint32_t code{0};
+            const auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.size(), code, hex ? 16 : 10);
+
+            if ((digits.empty() == true) || (error != std::errc{}) || (end != digits.data() + digits.size()) || (code == 0) ||
+                (code > 0x10ffff) || ((code >= 0xd800) && (code <= 0xdfff)))
+            {
+                throw std::invalid_argument{"Invalid character reference: &" + std::string{entity} + ";"};
+            }
+            return static_cast<char32_t>(code);
+        }
+
+        void appendUtf8(std::string& out, char32_t code)
+        {
+            if (code < 0x80)
+            {
+                out.push_back(static_cast<char>(code));
+            }
+            else if (code < 0x800)
+            {
+                out.push_back(static_cast<char>(0xc0 | (code >> 6)));
+                out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+            }
+            else if (code < 0x10000)
+            {
+                out.push_back(static_cast<char>(0xe0 | (code >> 12)));
+                out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+                out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+            }
+            else
+            {
+                out.push_back(static_cast<char>(0xf0 | (code >> 18)));
+                out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3f)));
+                out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+                out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+            }
+        }
+
+        std::string decodeEntities(std::string_view text)
+        {
+            std::string result;
+            result.reserve(text.size());
+
+            for (std::size_t i = 0; i < text.size(); ++i)
+            {
+                const auto end = text.find(';', i);
+
+                if ((text[i] != '&') || (end == std::string_view::npos))
+                {
+                    result.push_back(text[i]);
+                    continue;
+                }
+
+                const auto entity = text.substr(i + 1, end - i - 1);
+
+                if (entity == "amp")
+                {
+                    result.push_back('&');
+                }
+                else if (entity == "lt")
+                {
+                    result.push_back('<');
+                }
+                else if (entity == "gt")
+                {
+                    result.push_back('>');
+                }
+                else if (entity == "quot")
+                {
+                    result.push_back('"');
+                }
+                else if (entity == "apos")
+                {
+                    result.push_back('\'');
+                }
+                else if ((entity.empty() == false) && (entity[0] == '#'))
+                {
+                    appendUtf8(result, characterReference(entity));
+                }
+                else
+                {
+                    result.push_back(text[i]);
+                    continue;
+                }
+                i = end;
+            }
+            return result;
+        }
+
+        std::optional<std::string> attribute(std::string_view attributes, std::string_view key)
+        {
+            std::size_t pos{0};
+
+            while ((pos = attributes.find_first_not_of(whitespace, pos)) != std::string_view::npos)
+            {
+                const auto equals = attributes.find('=', pos);
+                const auto quote = attributes.find_first_of("\"'", equals);
+
+                if ((equals == std::string_view::npos) || (quote == std::string_view::npos))
+                {
+                    break;
+                }
+
+                const auto end = attributes.find(attributes[quote], quote + 1);
+
+                if (end == std::string_view::npos)
+                {
+                    throw std::invalid_argument{"Unterminated attribute value"};
+                }
+
+                if (trim(attributes.substr(pos, equals - pos)) == key)
+                {
+                    return decodeEntities(attributes.substr(quote + 1, end - quote - 1));
+                }
+                pos = end + 1;
+            }
+            return std::nullopt;
+        }
+
+        int toInt(std::string_view text)
+        {
+            const auto trimmed = trim(text);
+            int value{0};
+            std::from_chars(trimmed.data(), trimmed.data() + trimmed.size(), value);
+            return value;
+        }
+
+        int intAttribute(std::string_view attributes, std::string_view key)
+        {
+            const auto value = attribute(attributes, key);
+            return value ? toInt(*value) : 0;
+        }
+
+        constexpr std::uint8_t knobValue(int value)
+        {
+            return static_cast<std::uint8_t>(value >> 8);
+        }
+
+
+        class FuseParser
+        {
+        public:
+            SignalChain parse(std::string_view document)
+            {
+                std::size_t pos{0};
+
+                while ((pos = document.find('<', pos)) != std::string_view::npos)
+                {
+                    if (document.compare(pos, 4, "<!--") == 0)
+                    {
+                        pos = skipPast(document, pos, "-->");
+                        continue;
+                    }
+                    if ((document.compare(pos, 2, "<?") == 0) || (document.compare(pos, 2, "<!") == 0))
+                    {
+                        pos = skipPast(document, pos, ">");
+                        continue;
+                    }
+
+                    const auto end = findTagEnd(document, pos);
+                    onTag(document.substr(pos + 1, end - pos - 1));
+                    pos = end + 1;
+
+                    const auto nextTag = std::min(document.find('<', pos), document.size());
+                    text = document.substr(pos, nextTag - pos);
+                }
+
+                if (root.empty())
+                {
+                    throw std::invalid_argument{"Not a FUSE preset: no root element"};
+                }
+                if (hasAmpModule == false)
+                {
+                    throw std::invalid_argument{"Not a FUSE preset: no amplifier module"};
+                }
+                return SignalChain{name, amp, effects};
+            }
+
+        private:
+            static std::size_t skipPast(std::string_view document, std::size_t pos, std::string_view terminator)
+            {
+                const auto end = document.find(terminator, pos);
+
+                if (end == std::string_view::npos)
+                {
+                    throw std::invalid_argument{"Unterminated markup"};
+                }
+                return end + terminator.size();
+            }
+
+            static std::size_t findTagEnd(std::string_view document, std::size_t pos)
+            {
+                char quote{'\0'};
+
+                for (std::size_t i = pos + 1; i < document.size(); ++i)
+                {
+                    const char c = document[i];
+
+                    if (quote != '\0')
+                    {
+                        quote = (c == quote ? '\0' : quote);
+                    }
+                    else if ((c == '"') || (c == '\''))
+                    {
+                        quote = c;
+                    }
+                    else if (c == '>')
+                    {
+                        return i;
+                    }
+                }
+                throw std::invalid_argument{"Unterminated tag"};
+            }
+
+            void onTag(std::string_view tag)
+            {
+                if (tag.empty() == false && tag[0] == '/')
+                {
+                    onEndElement(trim(tag.substr(1)));
+                    return;
+                }
+
+                const bool selfClosing = (tag.empty() == false) && (tag.back() == '/');
+
+                if (selfClosing)
+                {
+                    tag.remove_suffix(1);
+                }
+
+                const auto nameEnd = std::min(tag.find_first_of(whitespace), tag.size());
+                const auto element = tag.substr(0, nameEnd);
+                onStartElement(element, tag.substr(nameEnd));
+
+                if (selfClosing)
+                {
+                    text = {};
+                    onEndElement(element);
+                }
+            }
+
+            void onStartElement(std::string_view element, std::string_view attributes)
+            {
+                if (root.empty())
+                {
+                    if (element != "Preset")
+                    {
+                        throw std::invalid_argument{"Not a FUSE preset: unexpected root element <" + std::string{element} + ">"};
+                    }
+                    root = element;
+                }
+
+                if (element == "Amplifier")
+                {
+                    section = Section::amp;
+                }
+                else if (element == "FX")
+                {
+                    section = Section::fx;
+                }
+                else if (element == "Module")
+                {
+                    onModule(attributes);
+                }
+                else if (element == "Param")
+                {
+                    controlIndex = intAttribute(attributes, "ControlIndex");
+                }
+                else if (element == "Info")
+                {
+                    name = attribute(attributes, "name").value_or("");
+                }
+            }
+
+            void onEndElement(std::string_view element)
+            {
+                if ((element == "Amplifier") || (element == "FX"))
+                {
+                    section = Section::none;
+                }
+                else if (element == "Param")
+                {
+                    onParam(toInt(text));
+                }
+                else if ((element == "Module") && effect)
+                {
+                    if (effect->effect_num != effects::EMPTY)
+                    {
+                        effects.push_back(*effect);
+                    }
+                    effect.reset();
+                }
+                else if (element == "UsbGain")
+                {
+                    amp.usb_gain = static_cast<std::uint8_t>(toInt(text));
+                }
+            }
+
+            void onModule(std::string_view attributes)
+            {
+                const auto id = static_cast<std::uint8_t>(intAttribute(attributes, "ID"));
+
+                if (section == Section::amp)
+                {
+                    amp.amp_num = lookupAmpById(id);
+                    hasAmpModule = true;
+                }
+                else if (section == Section::fx)
+                {
+                    const auto position = static_cast<std::uint8_t>(intAttribute(attributes, "POS"));
+                    effect = fx_pedal_settings{FxSlot{position}, lookupEffectById(id), 0, 0, 0, 0, 0, 0, true};
+                }
+            }
+
+            void onParam(int value)
+            {
+                if (section == Section::amp)
+                {
+                    onAmpParam(value);
+                }
+                else if (effect)
+                {
+                    onEffectParam(value);
+                }
+            }
+
+            void onAmpParam(int value)
+            {
+                switch (controlIndex)
+                {
+                    case 0:
+                        amp.volume = knobValue(value);
+                        break;
+                    case 1:
+                        amp.gain = knobValue(value);
+                        break;
+                    case 2:
+                        amp.gain2 = knobValue(value);
+                        break;
+                    case 3:
+                        amp.master_vol = knobValue(value);
+                        break;
+                    case 4:
+                        amp.treble = knobValue(value);
+                        break;
+                    case 5:
+                        amp.middle = knobValue(value);
+                        break;
+                    case 6:
+                        amp.bass = knobValue(value);
+                        break;
+                    case 7:
+                        amp.presence = knobValue(value);
+                        break;
+                    case 9:
+                        amp.depth = knobValue(value);
+                        break;
+                    case 10:
+                        amp.bias = knobValue(value);
+                        break;
+                    case 15:
+                        amp.noise_gate = static_cast<std::uint8_t>(value);
+                        break;
+                    case 16:
+                        amp.threshold = static_cast<std::uint8_t>(value);
+                        break;
+                    case 17:
+                        amp.cabinet = static_cast<cabinets>(value);
+                        break;
+                    case 19:
+                        amp.sag = static_cast<std::uint8_t>(value);
+                        break;
+                    case 20:
+                        amp.brightness = (value != 0);
+                        break;
+                    default:
+                        break;
+                }
+            }
+
+            void onEffectParam(int value)
+            {
+                switch (controlIndex)
+                {
+                    case 0:
+                        effect->knob1 = knobValue(value);
+                        break;
+                    case 1:
+                        effect->knob2 = knobValue(value);
+                        break;
+                    case 2:
+                        effect->knob3 = knobValue(value);
+                        break;
+                    case 3:
+                        effect->knob4 = knobValue(value);
+                        break;
+                    case 4:
+                        effect->knob5 = knobValue(value);
+                        break;
+                    case 5:
+                        effect->knob6 = knobValue(value);
+                        break;
+                    default:
+                        break;
+                }
+            }
+
+            enum class Section
+            {
+                none,
+                amp,
+                fx
+            };
+
+            Section section{Section::none};
+            std::string_view root{};
+            bool hasAmpModule{false};
+            std::string_view text{};
+            int controlIndex{-1};
+            std::string name{};
+            amp_settings amp{};
+            std::vector<fx_pedal_settings> effects{};
+            std::optional<fx_pedal_settings> effect{};
+        };
+
+
+        struct AmpSpecific
+        {
+            int value0;
+            int value1;
+            int value2;
+        };
+
+        constexpr AmpSpecific ampSpecific(amps amp)
+        {
+            switch (amp)
+            {
+                case amps::FENDER_57_DELUXE:
+                    return {0x01, 0x53, 0x80};
+                case amps::FENDER_59_BASSMAN:
+                    return {0x02, 0x67, 0x80};
+                case amps::FENDER_57_CHAMP:
+                    return {0x0c, 0x00, 0x80};
+                case amps::FENDER_65_DELUXE_REVERB:
+                    return {0x03, 0x6a, 0x00};
+                case amps::FENDER_65_PRINCETON:
+                    return {0x04, 0x61, 0x80};
+                case amps::FENDER_65_TWIN_REVERB:
+                    return {0x05, 0x72, 0x80};
+                case amps::FENDER_SUPER_SONIC:
+                    return {0x06, 0x79, 0x80};
+                case amps::BRITISH_60S:
+                    return {0x07, 0x5e, 0x80};
+                case amps::BRITISH_70S:
+                    return {0x0b, 0x7c, 0x80};
+                case amps::BRITISH_80S:
+                    return {0x09, 0x5d, 0x80};
+                case amps::AMERICAN_90S:
+                    return {0x0a, 0x6d, 0x80};
+                case amps::METAL_2000:
+                    return {0x08, 0x75, 0x80};
+                default:
+                    return {0x00, 0x00, 0x80};
+            }
+        }
+
+        std::string escape(std::string_view text)
+        {
+            std::string result;
+            result.reserve(text.size());
+
+            for (const char c : text)
+            {
+                switch (c)
+                {
+                    case '&':
+                        result += "&amp;";
+                        break;
+                    case '<':
+                        result += "&lt;";
+                        break;
+                    case '>':
+                        result += "&gt;";
+                        break;
+                    case '"':
+                        result += "&quot;";
+                        break;
+                    default:
+                        result.push_back(c);
+                        break;
+                }
+            }
+            return result;
+        }
+
+        constexpr int knobParam(std::uint8_t value)
+        {
+            return (value << 8) | value;
+        }
+
+
+        class FuseWriter
+        {
+        public:
+            std::string format(const SignalChain& chain, std::string_view author)
+            {
+                const auto amp = chain.amp();
+
+                out << R"(<?xml version="1.0" encoding="UTF-8"?>)" << '\n'
+                    << R"(<Preset amplifier="Mustang I/II" ProductId="1">)" << '\n';
+                writeAmp(amp);
+                writeEffects(chain.effects());
+                out << "    <FUSE>\n"
+                    << R"(        <Info name=")" << escape(chain.name())
+                    << R"(" author=")" << escape(author)
+                    << R"(" rating="0" genre1="-1" genre2="-1" genre3="-1" tags="" fenderid="0"></Info>)" << '\n'
+                    << "    </FUSE>\n"
+                    << "    <UsbGain>" << static_cast<int>(amp.usb_gain) << "</UsbGain>\n"
+                    << "</Preset>\n";
+                return out.str();
+            }
+
+        private:
+            void writeParam(std::string_view indent, int index, int value)
+            {
+                out << indent << R"(<Param ControlIndex=")" << index << R"(">)" << value << "</Param>\n";
+            }
+
+            void writeAmp(const amp_settings& amp)
+            {
+                constexpr std::string_view indent{"            "};
+                const auto specific = ampSpecific(amp.amp_num);
+
+                out << "    <Amplifier>\n"
+                    << R"(        <Module ID=")" << static_cast<int>(lookupIdByAmp(amp.amp_num)) << R"(" POS="0" BypassState="1">)" << '\n';
+                writeParam(indent, 0, knobParam(amp.volume));
+                writeParam(indent, 1, knobParam(amp.gain));
+                writeParam(indent, 2, knobParam(amp.gain2));
+                writeParam(indent, 3, knobParam(amp.master_vol));
+                writeParam(indent, 4, knobParam(amp.treble));
+                writeParam(indent, 5, knobParam(amp.middle));
+                writeParam(indent, 6, knobParam(amp.bass));
+                writeParam(indent, 7, knobParam(amp.presence));
+                writeParam(indent, 8, (specific.value2 << 8) | specific.value2);
+                writeParam(indent, 9, knobParam(amp.depth));
+                writeParam(indent, 10, knobParam(amp.bias));
+                writeParam(indent, 11, (specific.value2 << 8) | specific.value2);
+                writeParam(indent, 12, specific.value0);
+                writeParam(indent, 13, specific.value0);
+                writeParam(indent, 14, specific.value0);
+                writeParam(indent, 15, amp.noise_gate);
+                writeParam(indent, 16, amp.threshold);
+                writeParam(indent, 17, value(amp.cabinet));
+                writeParam(indent, 18, specific.value0);
+                writeParam(indent, 19, amp.sag);
+                writeParam(indent, 20, (amp.brightness ? 1 : 0));
+                writeParam(indent, 21, 1);
+                writeParam(indent, 22, (specific.value1 << 8) | specific.value1);
+                out << "        </Module>\n"
+                    << "    </Amplifier>\n";
+            }
+
+            void writeEffects(const EffectList& settings)
+            {
+                constexpr std::array<std::string_view, 4> groups{{"Stompbox", "Modulation", "Delay", "Reverb"}};
+                constexpr std::array<effects, 4> lastOfGroup{{effects::COMPRESSOR, effects::PITCH_SHIFTER, effects::STEREO_TAPE_DELAY, effects::FENDER_65_SPRING_REVERB}};
+                effects first{effects::OVERDRIVE};
+
+                out << "    <FX>\n";
+
+                for (std::size_t i = 0; i < groups.size(); ++i)
+                {
+                    const auto last = lastOfGroup[i];
+                    const auto effect = std::find_if(settings.cbegin(), settings.cend(), [first, last](const auto& e)
+                                                     { return (e.effect_num >= first) && (e.effect_num <= last); });
+
+                    out << "        <" << groups[i] << R"( ID=")" << (i + 1) << R"(">)" << '\n';
+                    writeEffect(effect != settings.cend() ? *effect : fx_pedal_settings{FxSlot{0}, effects::EMPTY, 0, 0, 0, 0, 0, 0, false});
+                    out << "        </" << groups[i] << ">\n";
+
+                    first = static_cast<effects>(value(last) + 1);
+                }
+                out << "    </FX>\n";
+            }
+
+            void writeEffect(const fx_pedal_settings& effect)
+            {
+                constexpr std::string_view indent{"                "};
+
+                out << R"(            <Module ID=")" << static_cast<int>(lookupIdByEffect(effect.effect_num)) << R"(" POS=")"
+                    << static_cast<int>(effect.slot.id()) << R"(" BypassState="1">)";
+
+                if (effect.effect_num == effects::EMPTY)
+                {
+                    out << "</Module>\n";
+                    return;
+                }
+
+                out << '\n';
+                writeParam(indent, 0, knobParam(effect.knob1));
+
+                if (effect.effect_num != effects::SIMPLE_COMP)
+                {
+                    writeParam(indent, 1, knobParam(effect.knob2));
+                    writeParam(indent, 2, knobParam(effect.knob3));
+                    writeParam(indent, 3, knobParam(effect.knob4));
+                    writeParam(indent, 4, knobParam(effect.knob5));
+
+                    if ((effect.effect_num == effects::MONO_ECHO_FILTER) || (effect.effect_num == effects::STEREO_ECHO_FILTER) ||
+                        (effect.effect_num == effects::TAPE_DELAY) || (effect.effect_num == effects::STEREO_TAPE_DELAY))
+                    {
+                        writeParam(indent, 5, knobParam(effect.knob6));
+                    }
+                }
+                out << "            </Module>\n";
+            }
+
+            std::ostringstream out;
+        };
+    }
+
+
+    SignalChain parseFuse(std::string_view document)
+    {
+        return FuseParser{}.parse(document);
+    }
+
+    SignalChain loadFuseFile(const std::string& path)
+    {
+        std::ifstream file{path, std::ios::binary};
+
+        if (file.is_open() == false)
+        {
+            throw std::runtime_error{"Could not open file: " + path};
+        }
+
+        std::ostringstream buffer;
+        buffer << file.rdbuf();
+        const std::string document = buffer.str();
+        return parseFuse(document);
+    }
+
+    std::string formatFuse(const SignalChain& chain, std::string_view author)
+    {
+        return FuseWriter{}.format(chain, author);
+    }
+
+    void saveFuseFile(const std::string& path, const SignalChain& chain, std::string_view author)
+    {
+        std::ofstream file{path, std::ios::binary | std::ios::trunc};
+
+        if (file.is_open() == false)
+        {
+            throw std::runtime_error{"Could not create file: " + path};
+        }
+
+        if ((file << formatFuse(chain, author)).flush().fail())
+        {
+            throw std::runtime_error{"Could not write file: " + path};
+        }
+    }
+}
@@ -0,0 +1,382 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "library/LibraryIndex.h"
+#include "library/FuseFormat.h"
+#include "library/ParallelFor.h"
+#include "library/PresetHash.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace plug::library
+{
+    namespace
+    {
+        namespace fs = std::filesystem;
+
+        constexpr std::uint32_t cacheMagic{0x42494c50}; // "PLIB"
+        constexpr std::uint32_t cacheVersion{2};
+        constexpr std::uint32_t maxStringSize{4096};
+
+
+        std::string lowercase(std::string text)
+        {
+            std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c)
+                           { return static_cast<char>(std::tolower(c)); });
+            return text;
+        }
+
+        bool isPresetFile(const fs::directory_entry& entry)
+        {
+            return entry.is_regular_file() && (lowercase(entry.path().extension().string()) == ".fuse");
+        }
+
+        std::int64_t modificationTime(const fs::path& path)
+        {
+            return static_cast<std::int64_t>(fs::last_write_time(path).time_since_epoch().count());
+        }
+
+
+        void parse(LibraryEntry& entry)
+        {
+            std::ifstream file{entry.path, std::ios::binary};
+
+            if (file.is_open() == false)
+            {
+                // Stays invalid; its content is unknown, so it's never grouped as duplicate
+                entry.contentHash = 0;
+                return;
+            }
+
+            std::ostringstream buffer;
+            buffer << file.rdbuf();
+            const std::string document = buffer.str();
+            entry.contentHash = hashBytes(document);
+
+            try
+            {
+                entry.chain = parseFuse(document);
+                entry.valid = true;
+            }
+            catch (const std::exception&)
+            {
+                // Kept as invalid entry, so the file isn't parsed again until it changes
+            }
+        }
+
+
+        template <class T>
+        void write(std::ostream& stream, T value)
+        {
+            for (std::size_t i = 0; i < sizeof(T); ++i)
+            {
+                stream.put(static_cast<char>((static_cast<std::uint64_t>(value) >> (i * 8)) & 0xff));
+            }
+        }
+
+        void writeString(std::ostream& stream, std::string_view value)
+        {
+            write(stream, static_cast<std::uint32_t>(value.size()));
+            stream.write(value.data(), static_cast<std::streamsize>(value.size()));
+        }
+
+        void writeSignalChain(std::ostream& stream, const SignalChain& chain)
+        {
+            const auto& amp = chain.amp();
+            const auto& effects = chain.effects();
+
+            writeString(stream, chain.name());
+            for (const auto byte : {value(amp.amp_num), amp.gain, amp.volume, amp.treble, amp.middle, amp.bass,
+                                    value(amp.cabinet), amp.noise_gate, amp.master_vol, amp.gain2, amp.presence,
+                                    amp.threshold, amp.depth, amp.bias, amp.sag,
+                                    static_cast<std::uint8_t>(amp.brightness), amp.usb_gain})
+            {
+                write(stream, byte);
+            }
+
+            write(stream, static_cast<std::uint8_t>(effects.size()));
+            for (const auto& effect : effects)
+            {
+                for (const auto byte : {effect.slot.id(), value(effect.effect_num), effect.knob1, effect.knob2, effect.knob3,
+                                        effect.knob4, effect.knob5, effect.knob6, static_cast<std::uint8_t>(effect.enabled)})
+                {
+                    write(stream, byte);
+                }
+            }
+        }
+
+
+        class CacheReader
+        {
+        public:
+            explicit CacheReader(std::istream& input)
+                : stream(input)
+            {
+            }
+
+            template <class T>
+            T read()
+            {
+                std::uint64_t result{0};
+
+                for (std::size_t i = 0; i < sizeof(T); ++i)
+                {
+                    result |= static_cast<std::uint64_t>(byte()) << (i * 8);
+                }
+                return static_cast<T>(result);
+            }
+
+            std::string readString()
+            {
+                const auto size = read<std::uint32_t>();
+
+                if (size > maxStringSize)
+                {
+                    throw std::runtime_error{"Invalid string size"};
+                }
+
+                std::string result(size, '\0');
+
+                if (stream.read(result.data(), static_cast<std::streamsize>(size)).fail())
+                {
+                    throw std::runtime_error{"Truncated cache"};
+                }
+                return result;
+            }
+
+            SignalChain readSignalChain()
+            {
+                const auto name = readString();
+                amp_settings amp{};
+                amp.amp_num = static_cast<amps>(byte());
+                amp.gain = byte();
+                amp.volume = byte();
+                amp.treble = byte();
+                amp.middle = byte();
+                amp.bass = byte();
+                amp.cabinet = static_cast<cabinets>(byte());
+                amp.noise_gate = byte();
+                amp.master_vol = byte();
+                amp.gain2 = byte();
+                amp.presence = byte();
+                amp.threshold = byte();
+                amp.depth = byte();
+                amp.bias = byte();
+                amp.sag = byte();
+                amp.brightness = (byte() != 0);
+                amp.usb_gain = byte();
+
+                std::vector<fx_pedal_settings> effects;
+                const auto count = byte();
+                effects.reserve(count);
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    const FxSlot slot{byte()};
+                    const auto effect = static_cast<plug::effects>(byte());
+                    const auto knob1 = byte();
+                    const auto knob2 = byte();
+                    const auto knob3 = byte();
+                    const auto knob4 = byte();
+                    const auto knob5 = byte();
+                    const auto knob6 = byte();
+                    const bool enabled = (byte() != 0);
+                    effects.push_back(fx_pedal_settings{slot, effect, knob1, knob2, knob3, knob4, knob5, knob6, enabled});
+                }
+                return SignalChain{name, amp, effects};
+            }
+
+        private:
+            std::uint8_t byte()
+            {
+                const auto value = stream.get();
+
+                if (value == std::istream::traits_type::eof())
+                {
+                    throw std::runtime_error{"Truncated cache"};
+                }
+                return static_cast<std::uint8_t>(value);
+            }
+
+            std::istream& stream;
+        };
+    }
+
+
+    std::size_t LibraryIndex::refresh(const std::string& directory)
+    {
+        std::unordered_map<std::string, LibraryEntry> previous;
+
+        for (auto& entry : entries_)
+        {
+            auto path = entry.path;
+            previous.emplace(std::move(path), std::move(entry));
+        }
+        entries_.clear();
+
+        std::vector<std::size_t> pending;
+
+        for (const auto& file : fs::directory_iterator{directory, fs::directory_options::skip_permission_denied})
+        {
+            if (isPresetFile(file) == false)
+            {
+                continue;
+            }
+
+            const auto path = file.path().string();
+            const auto size = static_cast<std::uint64_t>(file.file_size());
+            const auto modified = modificationTime(file.path());
+            const auto cached = previous.find(path);
+
+            if ((cached != previous.end()) && (cached->second.size == size) && (cached->second.modified == modified))
+            {
+                entries_.push_back(std::move(cached->second));
+                continue;
+            }
+
+            pending.push_back(entries_.size());
+            entries_.push_back(LibraryEntry{path, size, modified, 0, false, SignalChain{}});
+        }
+
+        parallelFor(pending.size(), [this, &pending](std::size_t i)
+                    { parse(entries_[pending[i]]); });
+
+        std::sort(entries_.begin(), entries_.end(), [](const auto& lhs, const auto& rhs)
+                  { return lowercase(fs::path{lhs.path}.filename().string()) < lowercase(fs::path{rhs.path}.filename().string()); });
+        return pending.size();
+    }
+
+    const std::vector<LibraryEntry>& LibraryIndex::entries() const
+    {
+        return entries_;
+    }
+
+    bool LibraryIndex::load(const std::string& cacheFile)
+    {
+        entries_.clear();
+        std::ifstream file{cacheFile, std::ios::binary};
+
+        if (file.is_open() == false)
+        {
+            return false;
+        }
+
+        try
+        {
+            CacheReader reader{file};
+
+            if ((reader.read<std::uint32_t>() != cacheMagic) || (reader.read<std::uint32_t>() != cacheVersion))
+            {
+                return false;
+            }
+
+            const auto count = reader.read<std::uint32_t>();
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                LibraryEntry entry{};
+                entry.path = reader.readString();
+                entry.size = reader.read<std::uint64_t>();
+                entry.modified = reader.read<std::int64_t>();
+                entry.contentHash = reader.read<std::uint64_t>();
+                entry.valid = (reader.read<std::uint8_t>() != 0);
+
+                if (entry.valid)
+                {
+                    entry.chain = reader.readSignalChain();
+                }
+                entries_.push_back(std::move(entry));
+            }
+        }
+        catch (const std::exception&)
+        {
+            entries_.clear();
+            return false;
+        }
+        return true;
+    }
+
+    void LibraryIndex::save(const std::string& cacheFile) const
+    {
+        std::ofstream file{cacheFile, std::ios::binary | std::ios::trunc};
+
+        if (file.is_open() == false)
+        {
+            throw std::runtime_error{"Could not create cache file: " + cacheFile};
+        }
+
+        write(file, cacheMagic);
+        write(file, cacheVersion);
+        write(file, static_cast<std::uint32_t>(entries_.size()));
+
+        for (const auto& entry : entries_)
+        {
+            writeString(file, entry.path);
+            write(file, entry.size);
+            write(file, entry.modified);
+            write(file, entry.contentHash);
+            write(file, static_cast<std::uint8_t>(entry.valid));
+
+            if (entry.valid)
+            {
+                writeSignalChain(file, entry.chain);
+            }
+        }
+    }
+
+    std::string cacheFileName(const std::string& directory)
+    {
+        constexpr std::string_view digits{"0123456789abcdef"};
+        auto path = fs::absolute(directory).lexically_normal();
+
+        if (path.has_filename() == false)
+        {
+            path = path.parent_path();
+        }
+
+        auto hash = hashBytes(path.string());
+        std::string name{"library-0000000000000000.cache"};
+
+        for (auto digit = name.rbegin() + 6; hash != 0; ++digit, hash >>= 4)
+        {
+            *digit = digits[hash & 0xf];
+        }
+        return name;
+    }
+
+    std::string defaultCacheDirectory()
+    {
+        if (const char* xdgCache = std::getenv("XDG_CACHE_HOME"); (xdgCache != nullptr) && (*xdgCache != '\0'))
+        {
+            return (fs::path{xdgCache} / "offa" / "Plug").string();
+        }
+        if (const char* home = std::getenv("HOME"); home != nullptr)
+        {
+            return (fs::path{home} / ".cache" / "offa" / "Plug").string();
+        }
+        return {};
+    }
+}
@@ -0,0 +1,83 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "library/PresetHash.h"
+#include <algorithm>
+#include <tuple>
+
+namespace plug::library
+{
+    namespace
+    {
+        // Knobs a model doesn't have are zeroed, as they are neither used by the amp nor saved to
+        // preset files
+        fx_pedal_settings withoutUnusedKnobs(fx_pedal_settings effect)
+        {
+            if (effect.effect_num == effects::SIMPLE_COMP)
+            {
+                effect.knob2 = 0;
+                effect.knob3 = 0;
+                effect.knob4 = 0;
+                effect.knob5 = 0;
+            }
+
+            if ((effect.effect_num != effects::MONO_ECHO_FILTER) && (effect.effect_num != effects::STEREO_ECHO_FILTER) &&
+                (effect.effect_num != effects::TAPE_DELAY) && (effect.effect_num != effects::STEREO_TAPE_DELAY))
+            {
+                effect.knob6 = 0;
+            }
+            return effect;
+        }
+    }
+
+
+    std::string canonicalize(const SignalChain& chain)
+    {
+        const auto amp = chain.amp();
+        auto effects = chain.effects().toVector();
+
+        effects.erase(std::remove_if(effects.begin(), effects.end(), [](const auto& effect)
+                                     { return effect.effect_num == effects::EMPTY; }),
+                      effects.end());
+        std::transform(effects.cbegin(), effects.cend(), effects.begin(), withoutUnusedKnobs);
+        std::sort(effects.begin(), effects.end(), [](const auto& lhs, const auto& rhs)
+                  { return std::make_tuple(lhs.slot.id(), lhs.effect_num) < std::make_tuple(rhs.slot.id(), rhs.effect_num); });
+
+        std::string canonical{static_cast<char>(value(amp.amp_num)), static_cast<char>(amp.gain), static_cast<char>(amp.volume),
+                              static_cast<char>(amp.treble), static_cast<char>(amp.middle), static_cast<char>(amp.bass),
+                              static_cast<char>(value(amp.cabinet)), static_cast<char>(amp.noise_gate), static_cast<char>(amp.master_vol),
+                              static_cast<char>(amp.gain2), static_cast<char>(amp.presence), static_cast<char>(amp.threshold),
+                              static_cast<char>(amp.depth), static_cast<char>(amp.bias), static_cast<char>(amp.sag),
+                              static_cast<char>(amp.brightness), static_cast<char>(amp.usb_gain)};
+
+        for (const auto& effect : effects)
+        {
+            canonical += {static_cast<char>(effect.slot.id()), static_cast<char>(value(effect.effect_num)), static_cast<char>(effect.knob1),
+                          static_cast<char>(effect.knob2), static_cast<char>(effect.knob3), static_cast<char>(effect.knob4),
+                          static_cast<char>(effect.knob5), static_cast<char>(effect.knob6), static_cast<char>(effect.enabled)};
+        }
+        return canonical;
+    }
+
+    std::uint64_t hashSignalChain(const SignalChain& chain)
+    {
+        return hashBytes(canonicalize(chain));
+    }
+}
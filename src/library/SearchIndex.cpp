@@ -0,0 +1,203 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "library/SearchIndex.h"
+#include "ModelNames.h"
+#include <algorithm>
+#include <iterator>
+
+namespace plug::library
+{
+    namespace
+    {
+        constexpr std::size_t trigramLength{3};
+
+        std::string normalize(std::string_view text)
+        {
+            std::string result(text.size(), ' ');
+            std::transform(text.cbegin(), text.cend(), result.begin(), [](char c)
+                           {
+                const auto u = static_cast<unsigned char>(c);
+
+                if ((u >= 'A') && (u <= 'Z'))
+                {
+                    return static_cast<char>(u - 'A' + 'a');
+                }
+                if (((u >= 'a') && (u <= 'z')) || ((u >= '0') && (u <= '9')) || (u >= 0x80))
+                {
+                    return c;
+                }
+                return ' '; });
+            return result;
+        }
+
+        std::vector<std::string> splitTerms(std::string_view normalized)
+        {
+            std::vector<std::string> terms;
+            std::size_t pos{0};
+
+            while ((pos = normalized.find_first_not_of(' ', pos)) != std::string_view::npos)
+            {
+                const auto end = std::min(normalized.find(' ', pos), normalized.size());
+                terms.emplace_back(normalized.substr(pos, end - pos));
+                pos = end;
+            }
+            return terms;
+        }
+
+        constexpr std::uint32_t trigramKey(std::string_view text, std::size_t pos)
+        {
+            return (std::uint32_t{static_cast<unsigned char>(text[pos])} << 16)
+                   | (std::uint32_t{static_cast<unsigned char>(text[pos + 1])} << 8)
+                   | std::uint32_t{static_cast<unsigned char>(text[pos + 2])};
+        }
+    }
+
+
+    std::string describeSignalChain(const SignalChain& chain)
+    {
+        std::string description{ampName(chain.amp().amp_num)};
+
+        for (const auto& effect : chain.effects())
+        {
+            if (effect.effect_num != effects::EMPTY)
+            {
+                description.append(" ").append(effectName(effect.effect_num));
+            }
+        }
+        return description;
+    }
+
+
+    void SearchIndex::insert(Id id, std::string_view name, std::string_view metadata)
+    {
+        const std::size_t entry = texts.size();
+        std::string text = normalize(name);
+
+        if (metadata.empty() == false)
+        {
+            text.append(" ").append(normalize(metadata));
+        }
+
+        for (std::size_t i = 0; (i + trigramLength) <= text.size(); ++i)
+        {
+            auto& postings = trigrams[trigramKey(text, i)];
+
+            if (postings.empty() || (postings.back() != entry))
+            {
+                postings.push_back(entry);
+            }
+        }
+
+        ids.push_back(id);
+        texts.push_back(std::move(text));
+        lastQuery.clear();
+        lastMatches.clear();
+    }
+
+    void SearchIndex::clear()
+    {
+        ids.clear();
+        texts.clear();
+        trigrams.clear();
+        lastQuery.clear();
+        lastMatches.clear();
+    }
+
+    std::size_t SearchIndex::size() const
+    {
+        return ids.size();
+    }
+
+    std::vector<SearchIndex::Id> SearchIndex::search(std::string_view query)
+    {
+        const std::string normalized = normalize(query);
+        const auto terms = splitTerms(normalized);
+        const bool refinesLast = (lastQuery.empty() == false) && (normalized.compare(0, lastQuery.size(), lastQuery) == 0);
+
+        if (refinesLast)
+        {
+            lastMatches.erase(std::remove_if(lastMatches.begin(), lastMatches.end(), [this, &terms](std::size_t entry)
+                                             { return matches(entry, terms) == false; }),
+                              lastMatches.end());
+        }
+        else
+        {
+            lastMatches = fullSearch(terms);
+        }
+        lastQuery = normalized;
+
+        std::vector<Id> result;
+        result.reserve(lastMatches.size());
+        std::transform(lastMatches.cbegin(), lastMatches.cend(), std::back_inserter(result), [this](std::size_t entry)
+                       { return ids[entry]; });
+        return result;
+    }
+
+    std::vector<std::size_t> SearchIndex::fullSearch(const std::vector<std::string>& terms) const
+    {
+        const std::vector<std::size_t>* candidates{nullptr};
+
+        for (const auto& term : terms)
+        {
+            for (std::size_t i = 0; (i + trigramLength) <= term.size(); ++i)
+            {
+                const auto itr = trigrams.find(trigramKey(term, i));
+
+                if (itr == trigrams.cend())
+                {
+                    return {};
+                }
+                if ((candidates == nullptr) || (itr->second.size() < candidates->size()))
+                {
+                    candidates = &itr->second;
+                }
+            }
+        }
+
+        std::vector<std::size_t> result;
+
+        if (candidates == nullptr)
+        {
+            result.reserve(texts.size());
+
+            for (std::size_t entry = 0; entry < texts.size(); ++entry)
+            {
+                if (matches(entry, terms))
+                {
+                    result.push_back(entry);
+                }
+            }
+        }
+        else
+        {
+            std::copy_if(candidates->cbegin(), candidates->cend(), std::back_inserter(result), [this, &terms](std::size_t entry)
+                         { return matches(entry, terms); });
+        }
+        return result;
+    }
+
+    bool SearchIndex::matches(std::size_t entry, const std::vector<std::string>& terms) const
+    {
+        const auto& text = texts[entry];
+        return std::all_of(terms.cbegin(), terms.cend(), [&text](const auto& term)
+                           { return text.find(term) != std::string::npos; });
+    }
+}
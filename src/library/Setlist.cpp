@@ -0,0 +1,232 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "library/Setlist.h"
+#include "library/FuseFormat.h"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace plug::library
+{
+    namespace
+    {
+        std::string_view trim(std::string_view text)
+        {
+            const auto isSpace = [](char c)
+            {
+                return std::isspace(static_cast<unsigned char>(c)) != 0;
+            };
+
+            while ((text.empty() == false) && isSpace(text.front()))
+            {
+                text.remove_prefix(1);
+            }
+            while ((text.empty() == false) && isSpace(text.back()))
+            {
+                text.remove_suffix(1);
+            }
+            return text;
+        }
+
+        bool isNumber(std::string_view text)
+        {
+            return std::all_of(text.cbegin(), text.cend(), [](char c)
+                               { return std::isdigit(static_cast<unsigned char>(c)) != 0; });
+        }
+
+        SetlistEntry parseEntry(std::string_view line, const std::filesystem::path& directory, std::size_t slots)
+        {
+            if (isNumber(line) == true)
+            {
+                const auto number = (line.size() <= 3) ? std::stoul(std::string{line}) : 0;
+
+                if ((number == 0) || (number > std::min<std::size_t>(slots, 0x100)))
+                {
+                    throw std::invalid_argument{"Invalid amp slot: " + std::string{line}};
+                }
+                return AmpSlot{static_cast<std::uint8_t>(number - 1)};
+            }
+
+            const std::filesystem::path path{line};
+            return (path.is_relative() ? (directory / path) : path).string();
+        }
+    }
+
+
+    std::vector<SetlistEntry> parseSetlist(std::string_view text, const std::string& directory, std::size_t slots)
+    {
+        std::vector<SetlistEntry> entries;
+
+        while (text.empty() == false)
+        {
+            const auto end = std::min(text.find('\n'), text.size());
+            const auto line = trim(text.substr(0, end));
+            text.remove_prefix(std::min(end + 1, text.size()));
+
+            if ((line.empty() == false) && (line.front() != '#'))
+            {
+                entries.push_back(parseEntry(line, directory, slots));
+            }
+        }
+        return entries;
+    }
+
+    std::vector<SetlistEntry> loadSetlistFile(const std::string& path, std::size_t slots)
+    {
+        std::ifstream file{path, std::ios::binary};
+
+        if (file.is_open() == false)
+        {
+            throw std::runtime_error{"Could not open file: " + path};
+        }
+
+        std::ostringstream buffer;
+        buffer << file.rdbuf();
+        const std::string text = buffer.str();
+        return parseSetlist(text, std::filesystem::path{path}.parent_path().string(), slots);
+    }
+
+
+    SetlistPlayer::SetlistPlayer(com::Mustang& mustangRef, std::vector<SetlistEntry> setlistEntries)
+        : mustang(mustangRef), entries(std::move(setlistEntries)), prepared(entries.size())
+    {
+        for (const auto& entry : entries)
+        {
+            if (const auto ampSlot = std::get_if<AmpSlot>(&entry); (ampSlot != nullptr) && (ampSlots.count(ampSlot->slot) == 0))
+            {
+                ampSlots.emplace(ampSlot->slot, mustang.load_memory_bank(ampSlot->slot));
+            }
+        }
+
+        if (entries.empty() == false)
+        {
+            prefetch(0);
+        }
+    }
+
+    SetlistPlayer::~SetlistPlayer()
+    {
+        waitForPrefetch();
+    }
+
+    SetlistPlayer::Transition SetlistPlayer::select(std::size_t index)
+    {
+        if (index >= entries.size())
+        {
+            throw std::out_of_range{"Invalid setlist entry: " + std::to_string(index)};
+        }
+
+        const auto start = Clock::now();
+        prefetch(index);
+        const bool ready = (prepared[index].wait_for(std::chrono::seconds{0}) == std::future_status::ready);
+
+        try
+        {
+            const auto& entry = prepared[index].get();
+            mustang.write_commands(entry.commands);
+            chain = entry.chain;
+        }
+        catch (...)
+        {
+            // Loaded again on the next attempt, the file may have been fixed meanwhile
+            prepared[index] = {};
+            throw;
+        }
+
+        const auto latency = Clock::now() - start;
+        active = index;
+
+        if ((index + 1) < entries.size())
+        {
+            prefetch(index + 1);
+        }
+        if (index > 0)
+        {
+            prefetch(index - 1);
+        }
+        return Transition{index, latency, ready};
+    }
+
+    std::optional<SetlistPlayer::Transition> SetlistPlayer::next()
+    {
+        const std::size_t index = active.has_value() ? (*active + 1) : 0;
+
+        if (index >= entries.size())
+        {
+            return std::nullopt;
+        }
+        return select(index);
+    }
+
+    std::optional<SetlistPlayer::Transition> SetlistPlayer::previous()
+    {
+        if ((active.has_value() == false) || (*active == 0))
+        {
+            return std::nullopt;
+        }
+        return select(*active - 1);
+    }
+
+    void SetlistPlayer::waitForPrefetch() const
+    {
+        std::for_each(prepared.cbegin(), prepared.cend(), [](const auto& entry)
+                      {
+                          if (entry.valid() == true)
+                          {
+                              entry.wait();
+                          } });
+    }
+
+    std::size_t SetlistPlayer::size() const
+    {
+        return entries.size();
+    }
+
+    std::optional<std::size_t> SetlistPlayer::position() const
+    {
+        return active;
+    }
+
+    const SignalChain& SetlistPlayer::current() const
+    {
+        return chain;
+    }
+
+    void SetlistPlayer::prefetch(std::size_t index)
+    {
+        if (prepared[index].valid() == false)
+        {
+            prepared[index] = std::async(std::launch::async, [this, index]
+                                         { return prepare(index); })
+                                  .share();
+        }
+    }
+
+    SetlistPlayer::Prepared SetlistPlayer::prepare(std::size_t index) const
+    {
+        const auto& entry = entries[index];
+        const auto loaded = std::holds_alternative<AmpSlot>(entry) ? ampSlots.at(std::get<AmpSlot>(entry).slot) : loadFuseFile(std::get<std::string>(entry));
+        return Prepared{loaded, com::serializeSignalChainCommands(loaded)};
+    }
+}
@@ -0,0 +1,206 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "library/ToneIndex.h"
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+
+namespace plug::library
+{
+    namespace
+    {
+        // Mismatch penalties of amp model, cabinet and the effect model of each family, in units of
+        // a full range knob difference.
+        constexpr std::array<float, ToneIndex::categories> categoryWeights{{4.0f, 1.0f, 2.0f, 2.0f, 2.0f, 2.0f}};
+
+        constexpr std::size_t effectFamily(effects effect)
+        {
+            if (effect <= effects::COMPRESSOR)
+            {
+                return 0;
+            }
+            if (effect <= effects::PITCH_SHIFTER)
+            {
+                return 1;
+            }
+            if (effect <= effects::STEREO_TAPE_DELAY)
+            {
+                return 2;
+            }
+            return 3;
+        }
+
+        constexpr float knob(std::uint8_t value)
+        {
+            return static_cast<float>(value) / 255.0f;
+        }
+
+        constexpr float scaled(std::uint8_t value, std::uint8_t max)
+        {
+            return static_cast<float>(std::min(value, max)) / static_cast<float>(max);
+        }
+
+        std::array<const fx_pedal_settings*, ToneIndex::effectFamilies> effectsByFamily(const EffectList& effects)
+        {
+            std::array<const fx_pedal_settings*, ToneIndex::effectFamilies> families{};
+
+            for (const auto& effect : effects)
+            {
+                if (effect.effect_num == effects::EMPTY)
+                {
+                    continue;
+                }
+
+                auto& family = families[effectFamily(effect.effect_num)];
+
+                if (family == nullptr)
+                {
+                    family = &effect;
+                }
+            }
+            return families;
+        }
+    }
+
+
+    ToneIndex::FeatureVector ToneIndex::encodeFeatures(const SignalChain& chain)
+    {
+        const auto& amp = chain.amp();
+        const auto& effects = chain.effects();
+        FeatureVector encoded{{knob(amp.volume), knob(amp.gain), knob(amp.gain2), knob(amp.master_vol),
+                               knob(amp.treble), knob(amp.middle), knob(amp.bass), knob(amp.presence),
+                               knob(amp.depth), knob(amp.bias), scaled(amp.noise_gate, 5), scaled(amp.threshold, 9),
+                               scaled(amp.sag, 2), (amp.brightness ? 1.0f : 0.0f)}};
+
+        const auto families = effectsByFamily(effects);
+        auto column = encoded.begin() + ampFeatures;
+
+        for (const auto* effect : families)
+        {
+            if (effect != nullptr)
+            {
+                *column++ = knob(effect->knob1);
+                *column++ = knob(effect->knob2);
+                *column++ = knob(effect->knob3);
+                *column++ = knob(effect->knob4);
+                *column++ = knob(effect->knob5);
+                *column++ = knob(effect->knob6);
+            }
+            else
+            {
+                column = std::fill_n(column, 6, 0.0f);
+            }
+        }
+        return encoded;
+    }
+
+    ToneIndex::CategoryVector ToneIndex::encodeCategories(const SignalChain& chain)
+    {
+        const auto& amp = chain.amp();
+        const auto& effects = chain.effects();
+        CategoryVector encoded{{value(amp.amp_num), value(amp.cabinet)}};
+
+        const auto families = effectsByFamily(effects);
+        std::transform(families.cbegin(), families.cend(), encoded.begin() + 2, [](const auto* effect)
+                       { return (effect != nullptr ? value(effect->effect_num) : value(effects::EMPTY)); });
+        return encoded;
+    }
+
+
+    void ToneIndex::insert(Id id, const SignalChain& chain)
+    {
+        const auto encodedFeatures = encodeFeatures(chain);
+        const auto encodedCategories = encodeCategories(chain);
+
+        ids.push_back(id);
+
+        for (std::size_t i = 0; i < features; ++i)
+        {
+            featureColumns[i].push_back(encodedFeatures[i]);
+        }
+
+        for (std::size_t i = 0; i < categories; ++i)
+        {
+            categoryColumns[i].push_back(encodedCategories[i]);
+        }
+    }
+
+    void ToneIndex::clear()
+    {
+        ids.clear();
+        std::for_each(featureColumns.begin(), featureColumns.end(), [](auto& column)
+                      { column.clear(); });
+        std::for_each(categoryColumns.begin(), categoryColumns.end(), [](auto& column)
+                      { column.clear(); });
+    }
+
+    std::size_t ToneIndex::size() const
+    {
+        return ids.size();
+    }
+
+    std::vector<ToneIndex::Match> ToneIndex::nearest(const SignalChain& chain, std::size_t k) const
+    {
+        const auto queryFeatures = encodeFeatures(chain);
+        const auto queryCategories = encodeCategories(chain);
+        const std::size_t count = ids.size();
+        std::vector<float> distances(count, 0.0f);
+        float* const distance = distances.data();
+
+        // Column at a time, so each pass is a branch free loop over two contiguous arrays.
+        for (std::size_t column = 0; column < features; ++column)
+        {
+            const float* const values = featureColumns[column].data();
+            const float query = queryFeatures[column];
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const float delta = values[i] - query;
+                distance[i] += delta * delta;
+            }
+        }
+
+        for (std::size_t column = 0; column < categories; ++column)
+        {
+            const std::uint8_t* const values = categoryColumns[column].data();
+            const std::uint8_t query = queryCategories[column];
+            const float weight = categoryWeights[column];
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                distance[i] += (values[i] != query ? weight : 0.0f);
+            }
+        }
+
+        std::vector<std::size_t> order(count);
+        std::iota(order.begin(), order.end(), 0);
+
+        const auto resultSize = std::min(k, count);
+        std::partial_sort(order.begin(), order.begin() + static_cast<std::ptrdiff_t>(resultSize), order.end(), [&distances](std::size_t lhs, std::size_t rhs)
+                          { return (distances[lhs] < distances[rhs]) || ((distances[lhs] == distances[rhs]) && (lhs < rhs)); });
+
+        std::vector<Match> matches;
+        matches.reserve(resultSize);
+        std::transform(order.cbegin(), order.cbegin() + static_cast<std::ptrdiff_t>(resultSize), std::back_inserter(matches), [this, &distances](std::size_t entry)
+                       { return Match{ids[entry], distances[entry]}; });
+        return matches;
+    }
+}
@@ -0,0 +1,84 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "library/BankConversion.h"
+#include "com/PresetBank.h"
+#include <cstdlib>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    int usage(std::string_view program)
+    {
+        std::cerr << "Usage: " << program << " list <bank>\n"
+                  << "       " << program << " pack <bank> <preset file>...\n"
+                  << "       " << program << " unpack <bank> <directory>\n\n"
+                  << "Converts between preset files and preset banks (" << plug::com::bank::fileExtension << ").\n";
+        return EXIT_FAILURE;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        return usage(argv[0]);
+    }
+
+    const std::string_view command{argv[1]};
+    const std::string bankFile{argv[2]};
+
+    try
+    {
+        if ((command == "list") && (argc == 3))
+        {
+            const plug::com::MappedBank bank{bankFile};
+
+            for (std::size_t i = 0; i < bank.size(); ++i)
+            {
+                std::cout << '[' << (i + 1) << "] " << bank.name(i) << '\n';
+            }
+        }
+        else if ((command == "pack") && (argc > 3))
+        {
+            const std::vector<std::string> files(argv + 3, argv + argc);
+            plug::library::fuseToBank(files, bankFile);
+            std::cout << files.size() << " presets written to " << bankFile << '\n';
+        }
+        else if ((command == "unpack") && (argc == 4))
+        {
+            const auto files = plug::library::bankToFuse(bankFile, argv[3]);
+            std::cout << files.size() << " presets written to " << argv[3] << '\n';
+        }
+        else
+        {
+            return usage(argv[0]);
+        }
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "Error: " << ex.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,528 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Parameters.h"
+#include "com/Mustang.h"
+#include "com/ConnectionFactory.h"
+#include "com/IdLookup.h"
+#include "com/PresetBank.h"
+#include "com/RestorePlan.h"
+#include "com/SceneMorph.h"
+#include "com/ThroughputProbe.h"
+#include "daemon/Client.h"
+#include "library/FuseFormat.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    using namespace plug;
+
+    inline constexpr std::array<std::string_view, 11> commands{{"info", "list", "show", "load", "apply", "amp", "effect", "morph", "backup", "restore", "calibrate"}};
+
+
+    int usage(std::string_view program)
+    {
+        std::cerr << "Usage: " << program << " info\n"
+                  << "       " << program << " list\n"
+                  << "       " << program << " show\n"
+                  << "       " << program << " load <slot>\n"
+                  << "       " << program << " apply <preset file>\n"
+                  << "       " << program << " amp <key=value>...\n"
+                  << "       " << program << " effect <fx slot> <model id|off> [<key=value>...]\n"
+                  << "       " << program << " morph <preset file|slot> <ms>\n"
+                  << "       " << program << " backup <bank>\n"
+                  << "       " << program << " restore [--full] <bank>\n"
+                  << "       " << program << " calibrate\n\n"
+                  << "Operates the amplifier without the user interface. The output consists of\n"
+                  << "tab separated fields, presets are printed as key=value pairs that are\n"
+                  << "accepted by the amp and effect commands. If plugd is running, the commands\n"
+                  << "are sent to it instead of the amplifier.\n\n"
+                  << "morph glides from the current preset to the given one within at most\n"
+                  << "65535 ms; other commands of plugd wait until it has finished.\n"
+                  << "Frames are paced by the rate limit calibrate stored.\n\n"
+                  << "calibrate measures the update rate the amplifier sustains and stores it\n"
+                  << "as limit for its model version; plugd must not be running.\n";
+        return EXIT_FAILURE;
+    }
+
+    unsigned long parseNumber(std::string_view value, unsigned long max)
+    {
+        std::size_t end{0};
+        const std::string str{value};
+        unsigned long number{0};
+
+        try
+        {
+            number = std::stoul(str, &end, 0);
+        }
+        catch (const std::logic_error&)
+        {
+            throw std::invalid_argument{"Invalid value: " + str};
+        }
+
+        if ((end != str.size()) || (number > max))
+        {
+            throw std::invalid_argument{"Invalid value: " + str};
+        }
+        return number;
+    }
+
+    std::uint8_t parseByte(std::string_view value)
+    {
+        return static_cast<std::uint8_t>(parseNumber(value, 0xff));
+    }
+
+    std::chrono::milliseconds parseDuration(std::string_view value)
+    {
+        return std::chrono::milliseconds{parseNumber(value, 0xffff)};
+    }
+
+    // Morph targets are slots if given as number, preset files otherwise
+    bool isSlot(std::string_view value)
+    {
+        return std::all_of(value.cbegin(), value.cend(), [](char c)
+                           { return std::isdigit(static_cast<unsigned char>(c)) != 0; });
+    }
+
+    std::pair<std::string_view, std::uint8_t> parseAssignment(std::string_view arg)
+    {
+        const auto pos = arg.find('=');
+
+        if (pos == std::string_view::npos)
+        {
+            throw std::invalid_argument{"Expected key=value: " + std::string{arg}};
+        }
+        return {arg.substr(0, pos), parseByte(arg.substr(pos + 1))};
+    }
+
+    std::string hex(std::uint8_t value)
+    {
+        std::ostringstream out;
+        out << "0x" << std::hex << std::setw(2) << std::setfill('0') << static_cast<unsigned>(value);
+        return out.str();
+    }
+
+    void printChain(const SignalChain& chain)
+    {
+        const auto amp = chain.amp();
+        std::cout << "name\t" << chain.name() << '\n'
+                  << "amp\tmodel=" << hex(lookupIdByAmp(amp.amp_num))
+                  << "\tcabinet=" << static_cast<unsigned>(value(amp.cabinet));
+
+        for (const auto& parameter : ampParameters)
+        {
+            std::cout << '\t' << parameter.key << '=' << static_cast<unsigned>(amp.*parameter.member);
+        }
+        std::cout << "\tbrightness=" << amp.brightness << "\tusb_gain=" << static_cast<unsigned>(amp.usb_gain) << '\n';
+
+        for (const auto& effect : chain.effects())
+        {
+            if (effect.effect_num == effects::EMPTY)
+            {
+                continue;
+            }
+
+            std::cout << "effect\t" << static_cast<unsigned>(effect.slot.id()) << '\t' << hex(lookupIdByEffect(effect.effect_num));
+
+            for (const auto& parameter : effectParameters)
+            {
+                std::cout << '\t' << parameter.key << '=' << static_cast<unsigned>(effect.*parameter.member);
+            }
+            std::cout << "\tenabled=" << effect.enabled << '\n';
+        }
+    }
+
+    template <class Device>
+    void setAmp(Device& device, amp_settings amp, const std::vector<std::string_view>& args)
+    {
+        for (const auto& arg : args)
+        {
+            const auto [key, value] = parseAssignment(arg);
+            setAmpParameter(amp, key, value);
+        }
+        device.set_amplifier(amp);
+    }
+
+    template <class Device>
+    void setEffect(Device& device, const EffectList& current, FxSlot slot, std::string_view model, const std::vector<std::string_view>& args)
+    {
+        const auto existing = std::find_if(current.cbegin(), current.cend(), [&slot](const auto& e)
+                                           { return (e.slot.id() == slot.id()) && (e.effect_num != effects::EMPTY); });
+
+        if (model == "off")
+        {
+            if (existing != current.cend())
+            {
+                auto effect = *existing;
+                effect.enabled = false;
+                device.set_effect(effect);
+            }
+            return;
+        }
+
+        fx_pedal_settings effect{slot, lookupEffectById(parseByte(model)), 0, 0, 0, 0, 0, 0, true};
+
+        if ((existing != current.cend()) && (existing->effect_num == effect.effect_num))
+        {
+            effect = *existing;
+            effect.enabled = true;
+        }
+
+        for (const auto& arg : args)
+        {
+            const auto [key, value] = parseAssignment(arg);
+            setEffectParameter(effect, key, value);
+        }
+        device.set_effect(effect);
+    }
+
+    std::size_t morph(com::Mustang& mustang, const SignalChain& current, const SignalChain& target, std::chrono::milliseconds duration)
+    {
+        com::SceneMorph sceneMorph{mustang};
+        sceneMorph.setRateLimit(com::RateLimits::load(com::defaultRateLimitsPath()).get(mustang.getDeviceModelVersion()));
+        return sceneMorph.run(current, target, duration);
+    }
+
+    // Loading the slot switches the amp to it, the current preset is set again before the morph starts
+    std::size_t morph(com::Mustang& mustang, const SignalChain& current, std::uint8_t slot, std::chrono::milliseconds duration)
+    {
+        const auto target = mustang.load_memory_bank(slot);
+        mustang.set_signal_chain(current);
+        return morph(mustang, current, target, duration);
+    }
+
+    template <class Target>
+    std::size_t morph(daemon::Client& client, const SignalChain&, const Target& target, std::chrono::milliseconds duration)
+    {
+        return client.morph(target, duration);
+    }
+
+    std::vector<com::PresetRecord> backup(com::Mustang& mustang, std::size_t slots)
+    {
+        return mustang.backupAll(slots);
+    }
+
+    std::vector<com::PresetRecord> backup(daemon::Client& client, std::size_t)
+    {
+        return client.backupAll();
+    }
+
+    std::size_t restore(com::Mustang& mustang, const std::vector<com::PresetRecord>& records, std::size_t slots, bool full)
+    {
+        if (full == true)
+        {
+            mustang.restoreAll(records);
+            return records.size();
+        }
+
+        if (records.size() > slots)
+        {
+            throw std::invalid_argument{"More presets than slots"};
+        }
+
+        // Only the slots the records cover are read for the differences
+        const auto updates = com::planRestore(mustang.backupAll(records.size()), records);
+        mustang.restore(updates);
+        return updates.size();
+    }
+
+    std::size_t restore(daemon::Client& client, const std::vector<com::PresetRecord>& records, std::size_t, bool full)
+    {
+        return client.restore(records, full);
+    }
+
+    std::unique_ptr<daemon::Client> connectDaemon()
+    {
+        const auto socketPath = daemon::defaultSocketPath();
+
+        if (std::filesystem::exists(socketPath) == false)
+        {
+            return nullptr;
+        }
+
+        try
+        {
+            return std::make_unique<daemon::Client>(socketPath);
+        }
+        catch (const std::exception& ex)
+        {
+            std::cerr << "Warning: " << ex.what() << ", using the amplifier directly\n";
+            return nullptr;
+        }
+    }
+
+    void calibrate()
+    {
+        if (std::filesystem::exists(daemon::defaultSocketPath()) == true)
+        {
+            throw std::runtime_error{"plugd is running, stop it to calibrate the amplifier"};
+        }
+
+        com::Mustang mustang{com::createUsbConnection()};
+        const auto initialData = mustang.start_amp();
+
+        // The probe runs as one operation, no other command is sent in between
+        const auto result = mustang.run(com::Priority::bulk, [&initialData](com::Connection& connection)
+                                        {
+            com::ThroughputProbe probe{connection};
+            return probe.run(initialData.signalChain.amp()); });
+
+        for (const auto& step : result.steps)
+        {
+            std::cout << "step\t" << step.updatesPerSecond << '\t' << step.updates << '\t' << step.timeouts << '\t'
+                      << step.meanLatency.count() << '\t' << step.maxLatency.count() << '\t'
+                      << (step.sustained ? "ok" : "overload") << '\n';
+        }
+
+        const auto path = com::defaultRateLimitsPath();
+        auto limits = com::RateLimits::load(path);
+        limits.set(mustang.getDeviceModelVersion(), result.limit);
+        limits.save(path);
+        std::cout << "limit\t" << result.limit.updatesPerSecond << '\n';
+
+        mustang.stop_amp();
+    }
+
+    // Checks the arguments without a device, so a mistyped command doesn't claim the amplifier;
+    // malformed values throw
+    bool validArguments(std::string_view command, const std::vector<std::string_view>& args)
+    {
+        if ((command == "info") || (command == "list") || (command == "show") || (command == "calibrate"))
+        {
+            return args.empty();
+        }
+        if (command == "load")
+        {
+            if (args.size() != 1)
+            {
+                return false;
+            }
+            parseByte(args[0]);
+            return true;
+        }
+        if (command == "amp")
+        {
+            amp_settings amp{};
+
+            for (const auto& arg : args)
+            {
+                const auto [key, value] = parseAssignment(arg);
+                setAmpParameter(amp, key, value);
+            }
+            return args.empty() == false;
+        }
+        if (command == "effect")
+        {
+            if (args.size() < 2)
+            {
+                return false;
+            }
+
+            fx_pedal_settings effect{FxSlot{parseByte(args[0])}, effects::EMPTY, 0, 0, 0, 0, 0, 0, true};
+
+            if (args[1] != "off")
+            {
+                effect.effect_num = lookupEffectById(parseByte(args[1]));
+            }
+
+            for (auto arg = std::next(args.cbegin(), 2); arg != args.cend(); ++arg)
+            {
+                const auto [key, value] = parseAssignment(*arg);
+                setEffectParameter(effect, key, value);
+            }
+            return true;
+        }
+        if (command == "morph")
+        {
+            if (args.size() != 2)
+            {
+                return false;
+            }
+            if (isSlot(args[0]) == true)
+            {
+                parseByte(args[0]);
+            }
+            parseDuration(args[1]);
+            return true;
+        }
+        if ((command == "apply") || (command == "backup"))
+        {
+            return args.size() == 1;
+        }
+        if (command == "restore")
+        {
+            return (args.size() == 1) || ((args.size() == 2) && (args[0] == "--full"));
+        }
+        return false;
+    }
+
+    template <class Device>
+    void run(Device& device, std::string_view command, const std::vector<std::string_view>& args)
+    {
+        const auto [signalChain, presetNames, diagnostics] = device.start_amp();
+
+        for (const auto& diagnostic : diagnostics)
+        {
+            std::cerr << "warning\t" << com::describe(diagnostic) << '\n';
+        }
+
+        if (command == "info")
+        {
+            std::cout << "device\t" << device.getDeviceName() << '\n'
+                      << "model_version\t" << (device.getDeviceModelVersion() == com::ModelVersion::v1 ? 1 : 2) << '\n'
+                      << "slots\t" << presetNames.size() << '\n'
+                      << "current\t" << signalChain.name() << '\n';
+        }
+        else if (command == "list")
+        {
+            for (std::size_t i = 0; i < presetNames.size(); ++i)
+            {
+                std::cout << i << '\t' << presetNames[i] << '\n';
+            }
+        }
+        else if (command == "show")
+        {
+            printChain(signalChain);
+        }
+        else if (command == "load")
+        {
+            const auto slot = parseByte(args[0]);
+
+            if (slot >= presetNames.size())
+            {
+                throw std::invalid_argument{"Invalid slot: " + std::string{args[0]}};
+            }
+            printChain(device.load_memory_bank(slot));
+        }
+        else if (command == "apply")
+        {
+            const auto chain = library::loadFuseFile(std::string{args[0]});
+            device.set_signal_chain(chain);
+            printChain(chain);
+        }
+        else if (command == "amp")
+        {
+            setAmp(device, signalChain.amp(), args);
+        }
+        else if (command == "effect")
+        {
+            setEffect(device, signalChain.effects(), FxSlot{parseByte(args[0])}, args[1], {std::next(args.cbegin(), 2), args.cend()});
+        }
+        else if (command == "morph")
+        {
+            const auto duration = parseDuration(args[1]);
+            std::size_t frames{0};
+
+            if (isSlot(args[0]) == true)
+            {
+                const auto slot = parseByte(args[0]);
+
+                if (slot >= presetNames.size())
+                {
+                    throw std::invalid_argument{"Invalid slot: " + std::string{args[0]}};
+                }
+                frames = morph(device, signalChain, slot, duration);
+            }
+            else
+            {
+                frames = morph(device, signalChain, library::loadFuseFile(std::string{args[0]}), duration);
+            }
+            std::cout << "frames\t" << frames << '\n';
+        }
+        else if (command == "backup")
+        {
+            const auto records = backup(device, presetNames.size());
+            com::writeBank(std::string{args[0]}, records);
+            std::cout << "written\t" << records.size() << '\n';
+        }
+        else if (command == "restore")
+        {
+            const com::MappedBank bank{std::string{args.back()}};
+            std::vector<com::PresetRecord> records;
+            records.reserve(bank.size());
+
+            for (std::size_t i = 0; i < bank.size(); ++i)
+            {
+                records.push_back(bank.record(i));
+            }
+
+            if (records.size() > presetNames.size())
+            {
+                throw std::invalid_argument{"The bank has more presets than the amplifier"};
+            }
+            std::cout << "written\t" << restore(device, records, presetNames.size(), (args.size() == 2)) << '\n';
+        }
+
+        device.stop_amp();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if ((argc < 2) || (std::find(commands.cbegin(), commands.cend(), std::string_view{argv[1]}) == commands.cend()))
+    {
+        return usage(argv[0]);
+    }
+
+    const std::string_view command{argv[1]};
+    const std::vector<std::string_view> args(argv + 2, argv + argc);
+
+    try
+    {
+        if (validArguments(command, args) == false)
+        {
+            return usage(argv[0]);
+        }
+
+        if (command == "calibrate")
+        {
+            calibrate();
+        }
+        else if (auto client = connectDaemon(); client != nullptr)
+        {
+            run(*client, command, args);
+        }
+        else
+        {
+            com::Mustang mustang{com::createUsbConnection()};
+            run(mustang, command, args);
+        }
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "Error: " << ex.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
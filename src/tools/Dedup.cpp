@@ -0,0 +1,107 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "library/Deduplication.h"
+#include "library/LibraryIndex.h"
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string_view>
+
+namespace
+{
+    namespace fs = std::filesystem;
+
+    int usage(std::string_view program)
+    {
+        std::cerr << "Usage: " << program << " [--cache-dir <directory>] <preset directory>\n\n"
+                  << "Lists preset files which are copies of each other or decode to the same settings.\n";
+        return EXIT_FAILURE;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    fs::path cacheDirectory = plug::library::defaultCacheDirectory();
+    std::string directory;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg{argv[i]};
+
+        if ((arg == "--cache-dir") && (i + 1 < argc))
+        {
+            cacheDirectory = argv[++i];
+        }
+        else if ((arg.empty() == false) && (arg[0] != '-') && directory.empty())
+        {
+            directory = arg;
+        }
+        else
+        {
+            return usage(argv[0]);
+        }
+    }
+
+    if (directory.empty())
+    {
+        return usage(argv[0]);
+    }
+
+    try
+    {
+        plug::library::LibraryIndex index;
+        const auto cacheFile = cacheDirectory / plug::library::cacheFileName(directory);
+
+        if (cacheDirectory.empty() == false)
+        {
+            index.load(cacheFile.string());
+        }
+
+        if ((index.refresh(directory) > 0) && (cacheDirectory.empty() == false))
+        {
+            fs::create_directories(cacheDirectory);
+            index.save(cacheFile.string());
+        }
+
+        const auto& entries = index.entries();
+        const auto groups = plug::library::findDuplicates(entries);
+
+        for (const auto& group : groups)
+        {
+            std::cout << std::hex << std::setw(16) << std::setfill('0') << group.hash << std::dec
+                      << (group.identical ? " identical" : " equivalent") << '\n';
+
+            for (const auto entry : group.entries)
+            {
+                std::cout << "    " << entries[entry].path << '\n';
+            }
+        }
+        std::cout << groups.size() << " duplicate groups in " << entries.size() << " files\n";
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "Error: " << ex.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -32,7 +32,7 @@ namespace plug
     Amplifier::Amplifier(QWidget* parent)
         : QMainWindow(parent),
           ui(std::make_unique<Ui::Amplifier>()),
-          advanced(std::make_unique<Amp_Advanced>(this)),
+          advanced(nullptr),
           amp_num(amps::FENDER_57_DELUXE),
           gain(0),
           volume(0),
@@ -58,7 +58,7 @@ namespace plug
         QSettings settings;
         restoreGeometry(settings.value("Windows/amplifierWindowGeometry").toByteArray());
 
-        connect(ui->advancedButton, SIGNAL(clicked()), advanced.get(), SLOT(open()));
+        connect(ui->advancedButton, SIGNAL(clicked()), this, SLOT(show_advanced()));
         choose_amp(0);
 
         connect(ui->comboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(choose_amp(int)));
@@ -184,85 +184,85 @@ namespace plug
         switch (static_cast<amps>(ampValue))
         {
             case amps::FENDER_57_DELUXE:
-                advanced->change_cabinet(value(cabinets::cab57DLX));
-                advanced->change_noise_gate(0);
+                set_cabinet(value(cabinets::cab57DLX));
+                set_noise_gate(0);
                 setWindowTitle("Amplifier: Fender '57 Delux");
                 setAccessibleName("Amplifier: Fender '57 Delux");
                 break;
 
             case amps::FENDER_59_BASSMAN:
-                advanced->change_cabinet(value(cabinets::cabBSSMN));
-                advanced->change_noise_gate(0);
+                set_cabinet(value(cabinets::cabBSSMN));
+                set_noise_gate(0);
                 setWindowTitle("Amplifier: Fender '59 Bassman");
                 setAccessibleName("Amplifier: Fender '59 Bassman");
                 break;
 
             case amps::FENDER_57_CHAMP:
-                advanced->change_cabinet(value(cabinets::cabCHAMP));
-                advanced->change_noise_gate(0);
+                set_cabinet(value(cabinets::cabCHAMP));
+                set_noise_gate(0);
                 setWindowTitle("Amplifier: Fender '57 Champ");
                 setAccessibleName("Amplifier: Fender '57 Champ");
                 break;
 
             case amps::FENDER_65_DELUXE_REVERB:
-                advanced->change_cabinet(value(cabinets::cab65DLX));
-                advanced->change_noise_gate(0);
+                set_cabinet(value(cabinets::cab65DLX));
+                set_noise_gate(0);
                 setWindowTitle("Amplifier: Fender '65 Deluxe Reverb");
                 setAccessibleName("Amplifier: Fender '65 Deluxe Reverb");
                 break;
 
             case amps::FENDER_65_PRINCETON:
-                advanced->change_cabinet(value(cabinets::cab65PRN));
-                advanced->change_noise_gate(0);
+                set_cabinet(value(cabinets::cab65PRN));
+                set_noise_gate(0);
                 setWindowTitle("Amplifier: Fender '65 Princeton");
                 setAccessibleName("Amplifier: Fender '65 Princeton");
                 break;
 
             case amps::FENDER_65_TWIN_REVERB:
-                advanced->change_cabinet(value(cabinets::cab65TWN));
-                advanced->change_noise_gate(0);
+                set_cabinet(value(cabinets::cab65TWN));
+                set_noise_gate(0);
                 setWindowTitle("Amplifier: Fender '65 Twin Reverb");
                 setAccessibleName("Amplifier: Fender '65 Twin Reverb");
                 break;
 
             case amps::FENDER_SUPER_SONIC:
-                advanced->change_cabinet(value(cabinets::cabSS112));
-                advanced->change_noise_gate(2);
+                set_cabinet(value(cabinets::cabSS112));
+                set_noise_gate(2);
                 setWindowTitle("Amplifier: Fender Super-Sonic");
                 setAccessibleName("Amplifier: Fender Super-Sonic");
                 break;
 
             case amps::BRITISH_60S:
-                advanced->change_cabinet(value(cabinets::cab2x12C));
-                advanced->change_noise_gate(0);
+                set_cabinet(value(cabinets::cab2x12C));
+                set_noise_gate(0);
                 setWindowTitle("Amplifier: British 60's");
                 setAccessibleName("Amplifier: British 60's");
                 break;
 
             case amps::BRITISH_70S:
-                advanced->change_cabinet(value(cabinets::cab4x12G));
-                advanced->change_noise_gate(1);
+                set_cabinet(value(cabinets::cab4x12G));
+                set_noise_gate(1);
                 setWindowTitle("Amplifier: British 70's");
                 setAccessibleName("Amplifier: British 70's");
                 break;
 
             case amps::BRITISH_80S:
-                advanced->change_cabinet(value(cabinets::cab4x12M));
-                advanced->change_noise_gate(1);
+                set_cabinet(value(cabinets::cab4x12M));
+                set_noise_gate(1);
                 setWindowTitle("Amplifier: British 80's");
                 setAccessibleName("Amplifier: British 80's");
                 break;
 
             case amps::AMERICAN_90S:
-                advanced->change_cabinet(value(cabinets::cab4x12V));
-                advanced->change_noise_gate(3);
+                set_cabinet(value(cabinets::cab4x12V));
+                set_noise_gate(3);
                 setWindowTitle("Amplifier: American 90's");
                 setAccessibleName("Amplifier: American 90's");
                 break;
 
             case amps::METAL_2000:
-                advanced->change_cabinet(value(cabinets::cab4x12G));
-                advanced->change_noise_gate(2);
+                set_cabinet(value(cabinets::cab4x12G));
+                set_noise_gate(2);
                 setWindowTitle("Amplifier: Metal 2000");
                 setAccessibleName("Amplifier: Metal 2000");
                 break;
@@ -270,6 +270,8 @@ namespace plug
             default:
                 break;
         }
+
+        update_advanced();
     }
 
     // send settings to the amplifier
@@ -315,18 +317,33 @@ namespace plug
         ui->dial_4->setValue(settings.middle);
         ui->dial_5->setValue(settings.bass);
 
-        advanced->change_cabinet(value(settings.cabinet));
-        advanced->change_noise_gate(settings.noise_gate);
-
-        advanced->set_master_vol(settings.master_vol);
-        advanced->set_gain2(settings.gain2);
-        advanced->set_presence(settings.presence);
-        advanced->set_depth(settings.depth);
-        advanced->set_threshold(settings.threshold);
-        advanced->set_bias(settings.bias);
-        advanced->set_sag(settings.sag);
-        advanced->set_brightness(settings.brightness);
-        advanced->set_usb_gain(settings.usb_gain);
+        set_advanced(settings);
+    }
+
+    // Sets only the controls of values that differ
+    void Amplifier::update(amp_settings settings)
+    {
+        if (settings.amp_num != amp_num)
+        {
+            ui->comboBox->setCurrentIndex(value(settings.amp_num));
+        }
+        const auto setIfChanged = [](QDial* dial, std::uint8_t current, std::uint8_t target)
+        {
+            if (current != target)
+            {
+                dial->setValue(target);
+            }
+        };
+        setIfChanged(ui->dial, gain, settings.gain);
+        setIfChanged(ui->dial_2, volume, settings.volume);
+        setIfChanged(ui->dial_3, treble, settings.treble);
+        setIfChanged(ui->dial_4, middle, settings.middle);
+        setIfChanged(ui->dial_5, bass, settings.bass);
+
+        if ((settings.cabinet != cabinet) || (settings.noise_gate != noise_gate) || (settings.master_vol != master_vol) || (settings.gain2 != gain2) || (settings.presence != presence) || (settings.depth != depth) || (settings.threshold != threshold) || (settings.bias != bias) || (settings.sag != sag) || (settings.brightness != brightness) || (settings.usb_gain != usb_gain))
+        {
+            set_advanced(settings);
+        }
     }
 
     void Amplifier::get_settings(amp_settings* settings)
@@ -355,6 +372,56 @@ namespace plug
         ui->setButton->setEnabled(value);
     }
 
+    // The advanced dialog is created when first opened, until then its values are kept here
+    void Amplifier::show_advanced()
+    {
+        if (advanced == nullptr)
+        {
+            advanced = std::make_unique<Amp_Advanced>(this);
+            update_advanced();
+        }
+        advanced->open();
+    }
+
+    void Amplifier::set_advanced(const amp_settings& settings)
+    {
+        set_cabinet(value(settings.cabinet));
+        set_noise_gate(settings.noise_gate);
+        set_master_vol(settings.master_vol);
+        set_gain2(settings.gain2);
+        set_presence(settings.presence);
+        set_depth(settings.depth);
+        set_threshold(settings.threshold);
+        set_bias(settings.bias);
+        set_sag(settings.sag);
+        set_brightness(settings.brightness);
+        set_usb_gain(settings.usb_gain);
+        update_advanced();
+    }
+
+    // Shows the values in the dialog; they are already set, so the dialog's signals change nothing
+    void Amplifier::update_advanced()
+    {
+        if (advanced == nullptr)
+        {
+            return;
+        }
+
+        const bool wasChanged = changed;
+        advanced->change_cabinet(value(cabinet));
+        advanced->change_noise_gate(noise_gate);
+        advanced->set_master_vol(master_vol);
+        advanced->set_gain2(gain2);
+        advanced->set_presence(presence);
+        advanced->set_depth(depth);
+        advanced->set_threshold(threshold);
+        advanced->set_bias(bias);
+        advanced->set_sag(sag);
+        advanced->set_brightness(brightness);
+        advanced->set_usb_gain(usb_gain);
+        changed = wasChanged;
+    }
+
     void Amplifier::showAndActivate()
     {
         show();
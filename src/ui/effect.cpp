@@ -131,12 +131,6 @@ namespace plug
 
         QShortcut* close = new QShortcut(QKeySequence(Qt::Key_Escape), this);
         connect(close, SIGNAL(activated()), this, SLOT(close()));
-
-        QShortcut* off = new QShortcut(QKeySequence(QString("F%1").arg(slotArg)), this, nullptr, nullptr, Qt::ApplicationShortcut);
-        connect(off, SIGNAL(activated()), ui->pushButton, SLOT(toggle()));
-
-        QShortcut* default_fx = new QShortcut(QKeySequence(QString("Ctrl+F%1").arg(slotArg)), this, nullptr, nullptr, Qt::ApplicationShortcut);
-        connect(default_fx, SIGNAL(activated()), this, SLOT(load_default_fx()));
     }
 
     Effect::~Effect()
@@ -1678,6 +1672,30 @@ namespace plug
         ui->dial_6->setValue(settings.knob6);
     }
 
+    // A changed model resets the knobs, so only knob changes of the same model are applied one by one
+    void Effect::update(fx_pedal_settings settings)
+    {
+        if (settings.effect_num != effect_num)
+        {
+            load(settings);
+            return;
+        }
+
+        const auto setIfChanged = [](QDial* dial, std::uint8_t current, std::uint8_t target)
+        {
+            if (current != target)
+            {
+                dial->setValue(target);
+            }
+        };
+        setIfChanged(ui->dial, knob1, settings.knob1);
+        setIfChanged(ui->dial_2, knob2, settings.knob2);
+        setIfChanged(ui->dial_3, knob3, settings.knob3);
+        setIfChanged(ui->dial_4, knob4, settings.knob4);
+        setIfChanged(ui->dial_5, knob5, settings.knob5);
+        setIfChanged(ui->dial_6, knob6, settings.knob6);
+    }
+
     void Effect::off_switch(bool value)
     {
         if (value)
@@ -1751,6 +1769,11 @@ namespace plug
         send_fx();
     }
 
+    void Effect::toggle_off_switch()
+    {
+        ui->pushButton->toggle();
+    }
+
     void Effect::set_changed(bool value)
     {
         changed = value;
@@ -22,12 +22,39 @@
 #include "ui/library.h"
 #include "ui/mainwindow.h"
 #include "ui_library.h"
+#include "library/Deduplication.h"
 #include <QDir>
 #include <QFileDialog>
+#include <QMessageBox>
 #include <QSettings>
+#include <QSignalBlocker>
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <unordered_set>
 
 namespace plug
 {
+    namespace
+    {
+        constexpr std::size_t maxSimilarPresets{10};
+
+        std::size_t rowOf(const QListWidgetItem* item)
+        {
+            return static_cast<std::size_t>(item->data(Qt::UserRole).value<qulonglong>());
+        }
+
+        void showOnly(QListWidget* list, const std::vector<library::SearchIndex::Id>& rows)
+        {
+            const std::unordered_set<std::size_t> visible(rows.cbegin(), rows.cend());
+
+            for (int i = 0; i < list->count(); ++i)
+            {
+                auto* item = list->item(i);
+                item->setHidden(visible.count(rowOf(item)) == 0);
+            }
+        }
+    }
 
     Library::Library(const std::vector<std::string>& names, QWidget* parent)
         : QDialog(parent),
@@ -51,22 +78,28 @@ namespace plug
         ui->spinBox->setValue(font.pointSize());
         ui->fontComboBox->setCurrentFont(font);
 
-        for (std::size_t i = 0; i < 100; ++i)
+        for (std::size_t i = 0; i < std::min<std::size_t>(names.size(), 100); ++i)
         {
             if (names[i][0] == 0x00)
             {
                 break;
             }
-            ui->listWidget->addItem(QString("[%1] %2").arg(i + 1).arg(QString::fromStdString(names[i])));
+            auto* item = new QListWidgetItem(QString("[%1] %2").arg(i + 1).arg(QString::fromStdString(names[i])), ui->listWidget);
+            item->setData(Qt::UserRole, QVariant::fromValue<qulonglong>(i));
+            ampIndex.insert(i, names[i]);
         }
 
         connect(ui->listWidget, SIGNAL(currentRowChanged(int)), this, SLOT(load_slot(std::size_t)));
         connect(ui->listWidget_2, SIGNAL(currentRowChanged(int)), this, SLOT(load_file(std::size_t)));
         connect(ui->pushButton, SIGNAL(clicked()), this, SLOT(get_directory()));
+        connect(ui->bankButton, SIGNAL(clicked()), this, SLOT(open_bank()));
         connect(this, SIGNAL(directory_changed(QString)), ui->label_3, SLOT(setText(QString)));
         connect(this, SIGNAL(directory_changed(QString)), this, SLOT(get_files(QString)));
         connect(ui->spinBox, SIGNAL(valueChanged(int)), this, SLOT(change_font_size(int)));
         connect(ui->fontComboBox, SIGNAL(currentFontChanged(QFont)), this, SLOT(change_font_family(QFont)));
+        connect(ui->searchEdit, SIGNAL(textChanged(QString)), this, SLOT(filter(QString)));
+        connect(ui->similarButton, SIGNAL(toggled(bool)), this, SLOT(show_similar(bool)));
+        connect(ui->duplicatesButton, SIGNAL(toggled(bool)), this, SLOT(show_duplicates(bool)));
     }
 
     Library::~Library()
@@ -97,24 +130,189 @@ namespace plug
 
     void Library::get_files(const QString& path)
     {
-        QDir directory(path, "*.fuse", (QDir::Name | QDir::IgnoreCase), (QDir::Files | QDir::NoDotAndDotDot | QDir::Readable));
+        const QString cacheDirectory = QString::fromStdString(library::defaultCacheDirectory());
+        const QString cacheFile = QString("%1/%2").arg(cacheDirectory).arg(QString::fromStdString(library::cacheFileName(path.toStdString())));
+
+        try
+        {
+            presetFiles.load(cacheFile.toStdString());
+
+            if (presetFiles.refresh(path.toStdString()) > 0)
+            {
+                QDir().mkpath(cacheDirectory);
+                presetFiles.save(cacheFile.toStdString());
+            }
+        }
+        catch (const std::exception&)
+        {
+            // Unreadable directories show up empty, a missing cache only costs time on the next scan
+        }
+
+        bank.reset();
+        ui->similarButton->setEnabled(true);
+        ui->duplicatesButton->setEnabled(true);
+        files->clear();
+        fileIndex.clear();
+        toneIndex.clear();
+
+        const auto& entries = presetFiles.entries();
+
+        for (std::size_t i = 0; i < entries.size(); ++i)
+        {
+            const auto& entry = entries[i];
+            files->append(QFileInfo(QString::fromStdString(entry.path)));
+            const std::string name = files->back().completeBaseName().toStdString();
+
+            if (entry.valid)
+            {
+                fileIndex.insert(i, name, std::string{entry.chain.name()} + " " + library::describeSignalChain(entry.chain));
+                toneIndex.insert(i, entry.chain);
+            }
+            else
+            {
+                fileIndex.insert(i, name);
+            }
+        }
+        update_files();
+    }
+
+    void Library::open_bank()
+    {
+        QSettings settings;
+        const QString filename = QFileDialog::getOpenFileName(this, tr("Open bank..."), settings.value("Library/lastDirectory", QDir::homePath()).toString(),
+                                                              tr("Preset banks (*%1)").arg(QString::fromUtf8(com::bank::fileExtension.data(), static_cast<int>(com::bank::fileExtension.size()))));
+
+        if (filename.isEmpty())
+        {
+            return;
+        }
+
+        try
+        {
+            bank = std::make_unique<com::MappedBank>(filename.toStdString());
+        }
+        catch (const std::exception& ex)
+        {
+            QMessageBox::critical(this, tr("Error!"), tr("Could not open bank: %1").arg(ex.what()));
+            return;
+        }
+
+        ui->label_3->setText(filename);
+        {
+            const QSignalBlocker similarBlocker{ui->similarButton};
+            const QSignalBlocker duplicatesBlocker{ui->duplicatesButton};
+            ui->similarButton->setChecked(false);
+            ui->similarButton->setEnabled(false);
+            ui->duplicatesButton->setChecked(false);
+            ui->duplicatesButton->setEnabled(false);
+        }
 
-        if (!files->isEmpty())
+        files->clear();
+        fileIndex.clear();
+        toneIndex.clear();
+        ui->listWidget_2->clear();
+
+        for (std::size_t i = 0; i < bank->size(); ++i)
         {
-            files->clear();
+            const std::string name = bank->name(i);
+            auto* item = new QListWidgetItem(QString("[%1] %2").arg(i + 1).arg(QString::fromStdString(name)), ui->listWidget_2);
+            item->setData(Qt::UserRole, QVariant::fromValue<qulonglong>(i));
+            fileIndex.insert(i, name);
         }
+        showOnly(ui->listWidget_2, fileIndex.search(ui->searchEdit->text().toStdString()));
+    }
+
+    void Library::show_files(const std::vector<std::size_t>& rows, const std::vector<QString>& notes)
+    {
         ui->listWidget_2->clear();
-        *files = directory.entryInfoList(QDir::Files | QDir::NoDotAndDotDot | QDir::Readable);
-        for (int i = 0; i < files->size(); ++i)
+
+        for (std::size_t i = 0; i < rows.size(); ++i)
+        {
+            const QString name = (*files)[static_cast<int>(rows[i])].completeBaseName();
+            auto* item = new QListWidgetItem(i < notes.size() ? QString("%1 (%2)").arg(name, notes[i]) : name, ui->listWidget_2);
+            item->setData(Qt::UserRole, QVariant::fromValue<qulonglong>(rows[i]));
+        }
+        showOnly(ui->listWidget_2, fileIndex.search(ui->searchEdit->text().toStdString()));
+    }
+
+    void Library::show_similar(bool enabled)
+    {
+        if (enabled)
+        {
+            const QSignalBlocker blocker{ui->duplicatesButton};
+            ui->duplicatesButton->setChecked(false);
+        }
+        update_files();
+    }
+
+    void Library::show_duplicates(bool enabled)
+    {
+        if (enabled)
+        {
+            const QSignalBlocker blocker{ui->similarButton};
+            ui->similarButton->setChecked(false);
+        }
+        update_files();
+    }
+
+    void Library::update_files()
+    {
+        std::vector<std::size_t> rows;
+        std::vector<QString> notes;
+
+        if (ui->similarButton->isChecked())
+        {
+            amp_settings amp{};
+            std::vector<fx_pedal_settings> effects;
+            dynamic_cast<MainWindow*>(parent())->get_settings(&amp, effects);
+
+            const auto matches = toneIndex.nearest(SignalChain{"", amp, effects}, maxSimilarPresets);
+            std::transform(matches.cbegin(), matches.cend(), std::back_inserter(rows), [](const auto& match)
+                           { return match.id; });
+        }
+        else if (ui->duplicatesButton->isChecked())
+        {
+            const auto groups = library::findDuplicates(presetFiles.entries());
+
+            for (std::size_t i = 0; i < groups.size(); ++i)
+            {
+                const QString note = (groups[i].identical ? tr("copy #%1") : tr("same settings #%1")).arg(i + 1);
+                rows.insert(rows.end(), groups[i].entries.cbegin(), groups[i].entries.cend());
+                notes.insert(notes.end(), groups[i].entries.size(), note);
+            }
+        }
+        else
         {
-            ui->listWidget_2->addItem((*files)[i].completeBaseName());
+            rows.resize(static_cast<std::size_t>(files->size()));
+            std::iota(rows.begin(), rows.end(), 0);
         }
+        show_files(rows, notes);
     }
 
     void Library::load_file(std::size_t row)
     {
+        const auto* item = ui->listWidget_2->item(static_cast<int>(row));
+
+        if (item == nullptr)
+        {
+            return;
+        }
+
         ui->listWidget->setCurrentRow(-1);
-        dynamic_cast<MainWindow*>(parent())->loadfile((*files)[row].canonicalFilePath());
+
+        if (bank != nullptr)
+        {
+            try
+            {
+                dynamic_cast<MainWindow*>(parent())->load_signal_chain(bank->decode(rowOf(item)));
+            }
+            catch (const std::exception& ex)
+            {
+                QMessageBox::critical(this, tr("Error!"), tr("Invalid preset: %1").arg(ex.what()));
+            }
+            return;
+        }
+        dynamic_cast<MainWindow*>(parent())->loadfile((*files)[static_cast<int>(rowOf(item))].canonicalFilePath());
     }
 
     void Library::resizeEvent(QResizeEvent* event)
@@ -144,6 +342,13 @@ namespace plug
 
         settings.setValue("Library/FontFamily", font.family());
     }
+
+    void Library::filter(const QString& text)
+    {
+        const std::string query = text.toStdString();
+        showOnly(ui->listWidget, ampIndex.search(query));
+        showOnly(ui->listWidget_2, fileIndex.search(query));
+    }
 }
 
 #include "ui/moc_library.moc"
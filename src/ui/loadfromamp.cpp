@@ -23,6 +23,7 @@
 #include "ui/mainwindow.h"
 #include "ui_loadfromamp.h"
 #include <QSettings>
+#include <algorithm>
 
 namespace plug
 {
@@ -38,6 +39,7 @@ namespace plug
 
         connect(ui->pushButton, SIGNAL(clicked()), this, SLOT(load()));
         connect(ui->pushButton_2, SIGNAL(clicked()), this, SLOT(close()));
+        connect(ui->filterEdit, SIGNAL(textChanged(QString)), this, SLOT(filter(QString)));
     }
 
     LoadFromAmp::~LoadFromAmp()
@@ -48,10 +50,16 @@ namespace plug
 
     void LoadFromAmp::load()
     {
+        if (ui->comboBox->currentIndex() < 0)
+        {
+            return;
+        }
+
         QSettings settings;
+        const int slot = ui->comboBox->currentData().toInt();
 
-        dynamic_cast<MainWindow*>(parent())->load_from_amp(ui->comboBox->currentIndex());
-        dynamic_cast<MainWindow*>(parent())->set_index(ui->comboBox->currentIndex());
+        dynamic_cast<MainWindow*>(parent())->load_from_amp(slot);
+        dynamic_cast<MainWindow*>(parent())->set_index(slot);
 
         if (!settings.value("Settings/keepWindowsOpen").toBool())
         {
@@ -61,28 +69,69 @@ namespace plug
 
     void LoadFromAmp::load_names(const std::vector<std::string>& names)
     {
-        for (std::size_t i = 0; i < 100; ++i)
+        labels.clear();
+
+        for (std::size_t i = 0; i < std::min<std::size_t>(names.size(), 100); ++i)
         {
             if (names[i][0] == 0x00)
             {
                 break;
             }
-            ui->comboBox->addItem(QString("[%1] %2").arg(i + 1).arg(QString::fromStdString(names[i])));
+            labels.push_back(QString("[%1] %2").arg(i + 1).arg(QString::fromStdString(names[i])));
         }
+
+        rebuildIndex();
+        filter(ui->filterEdit->text());
     }
 
     void LoadFromAmp::delete_items()
     {
-        for (int i = 0; i < ui->comboBox->count(); ++i)
+        labels.clear();
+        index.clear();
+        ui->comboBox->clear();
+    }
+
+    void LoadFromAmp::change_name(int slot, QString* name)
+    {
+        const auto pos = static_cast<std::size_t>(slot);
+
+        if (pos < labels.size())
         {
-            ui->comboBox->removeItem(0);
+            labels[pos] = *name;
+            rebuildIndex();
+            filter(ui->filterEdit->text());
         }
+        ui->comboBox->setCurrentIndex(ui->comboBox->findData(slot));
     }
 
-    void LoadFromAmp::change_name(int slot, QString* name)
+    void LoadFromAmp::filter(const QString& text)
     {
-        ui->comboBox->setItemText(slot, *name);
-        ui->comboBox->setCurrentIndex(slot);
+        populate(index.search(text.toStdString()));
+    }
+
+    void LoadFromAmp::populate(const std::vector<library::SearchIndex::Id>& slots)
+    {
+        const QVariant current = ui->comboBox->currentData();
+
+        ui->comboBox->clear();
+        for (const auto slot : slots)
+        {
+            ui->comboBox->addItem(labels[slot], static_cast<int>(slot));
+        }
+
+        if (const int pos = ui->comboBox->findData(current); pos >= 0)
+        {
+            ui->comboBox->setCurrentIndex(pos);
+        }
+    }
+
+    void LoadFromAmp::rebuildIndex()
+    {
+        index.clear();
+        for (std::size_t i = 0; i < labels.size(); ++i)
+        {
+            index.insert(i, labels[i].toStdString());
+        }
     }
 }
 
@@ -25,7 +25,6 @@
 #include "ui/effect.h"
 #include "ui/library.h"
 #include "ui/loadfromamp.h"
-#include "ui/loadfromfile.h"
 #include "ui/quickpresets.h"
 #include "ui/save_effects.h"
 #include "ui/saveonamp.h"
@@ -35,19 +34,29 @@
 #include "com/ConnectionFactory.h"
 #include "com/CommunicationException.h"
 #include "com/MustangUpdater.h"
+#include "com/SessionJournal.h"
+#include "com/ToneState.h"
+#include "library/FuseFormat.h"
+#include "library/Setlist.h"
 #include "ui_defaulteffects.h"
 #include "ui_mainwindow.h"
 #include <algorithm>
+#include <optional>
 #include <QFileDialog>
 #include <QMessageBox>
+#include <QProgressDialog>
 #include <QSettings>
 #include <QShortcut>
+#include <QStandardPaths>
 #include <QDebug>
 
 namespace plug
 {
     namespace
     {
+        // Amp settings shown before a tone is loaded
+        constexpr amp_settings defaultAmp{amps::FENDER_57_DELUXE, 0, 0, 0, 0, 0, cabinets::cab57DLX, 0, 128, 128, 128, 0, 128, 128, 1, false, 0};
+
         constexpr int check_fx_family(effects value)
         {
             if (value == effects::EMPTY)
@@ -73,6 +82,39 @@ namespace plug
             return 0;
         }
 
+        QString journalDirectory()
+        {
+            return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+        }
+
+        QString journalPath()
+        {
+            return QString("%1/session.journal").arg(journalDirectory());
+        }
+
+        // Sets the flag for the lifetime of the guard
+        class FlagGuard
+        {
+        public:
+            FlagGuard(bool& flagRef, bool value)
+                : flag(flagRef), previous(flagRef)
+            {
+                flag = value;
+            }
+
+            FlagGuard(const FlagGuard&) = delete;
+
+            ~FlagGuard()
+            {
+                flag = previous;
+            }
+
+            FlagGuard& operator=(const FlagGuard&) = delete;
+
+        private:
+            bool& flag;
+            bool previous;
+        };
     }
 
 
@@ -80,15 +122,22 @@ namespace plug
         : QMainWindow(parent),
           ui(std::make_unique<Ui::MainWindow>()),
           presetNames(100, ""),
+          presetIndex(-1),
           amp_ops(nullptr),
-          effectComponents{{new Effect{this, FxSlot{0}},
-                            new Effect{this, FxSlot{1}},
-                            new Effect{this, FxSlot{2}},
-                            new Effect{this, FxSlot{3}},
-                            new Effect{this, FxSlot{4}},
-                            new Effect{this, FxSlot{5}},
-                            new Effect{this, FxSlot{6}},
-                            new Effect{this, FxSlot{7}}}}
+          editorTone{{}},
+          amp(nullptr),
+          effectComponents{{}},
+          setButtonsEnabled(false),
+          save(nullptr),
+          load(nullptr),
+          seffects(nullptr),
+          settings_win(nullptr),
+          saver(nullptr),
+          quickpres(nullptr),
+          unknownAmp(false),
+          unknownEffects{{}},
+          recordEdits(true),
+          applyingHistory(false)
     {
         ui->setupUi(this);
 
@@ -119,41 +168,44 @@ namespace plug
             settings.setValue("Settings/defaultEffectValues", true);
         }
 
-        // create child objects
-        amp = new Amplifier(this);
-        save = new SaveOnAmp(this);
-        load = new LoadFromAmp(this);
-        seffects = new SaveEffects(this);
-        settings_win = new Settings(this);
-        saver = new SaveToFile(this);
-        quickpres = new QuickPresets(this);
+        // the amp and effect windows and the dialogs are created when first used
+        com::setAmpFields(editorTone, defaultAmp);
 
         connected = false;
 
         // connect buttons to slots
-        connect(ui->Amplifier, SIGNAL(clicked()), amp, SLOT(showAndActivate()));
-        connect(ui->EffectButton1, SIGNAL(clicked()), effectComponents[0], SLOT(showAndActivate()));
-        connect(ui->EffectButton2, SIGNAL(clicked()), effectComponents[1], SLOT(showAndActivate()));
-        connect(ui->EffectButton3, SIGNAL(clicked()), effectComponents[2], SLOT(showAndActivate()));
-        connect(ui->EffectButton4, SIGNAL(clicked()), effectComponents[3], SLOT(showAndActivate()));
-        connect(ui->FxEffectButton1, SIGNAL(clicked()), effectComponents[4], SLOT(showAndActivate()));
-        connect(ui->FxEffectButton2, SIGNAL(clicked()), effectComponents[5], SLOT(showAndActivate()));
-        connect(ui->FxEffectButton3, SIGNAL(clicked()), effectComponents[6], SLOT(showAndActivate()));
-        connect(ui->FxEffectButton4, SIGNAL(clicked()), effectComponents[7], SLOT(showAndActivate()));
+        connect(ui->Amplifier, &QAbstractButton::clicked, this, [this]
+                { amp_window()->showAndActivate(); });
+        const std::array<QAbstractButton*, 8> effectButtons{{ui->EffectButton1, ui->EffectButton2, ui->EffectButton3, ui->EffectButton4,
+                                                             ui->FxEffectButton1, ui->FxEffectButton2, ui->FxEffectButton3, ui->FxEffectButton4}};
+        for (std::size_t slot = 0; slot < effectButtons.size(); ++slot)
+        {
+            connect(effectButtons[slot], &QAbstractButton::clicked, this, [this, slot]
+                    { effect_window(slot)->showAndActivate(); });
+        }
         connect(ui->actionConnect, SIGNAL(triggered()), this, SLOT(start_amp()));
         connect(ui->actionDisconnect, SIGNAL(triggered()), this, SLOT(stop_amp()));
         connect(ui->actionExit, SIGNAL(triggered()), this, SLOT(close()));
         connect(ui->actionAbout, SIGNAL(triggered()), this, SLOT(about()));
-        connect(ui->actionSave_to_amplifier, SIGNAL(triggered()), save, SLOT(show()));
-        connect(ui->action_Load_from_amplifier, SIGNAL(triggered()), load, SLOT(show()));
-        connect(ui->actionSave_effects, SIGNAL(triggered()), seffects, SLOT(open()));
-        connect(ui->action_Options, SIGNAL(triggered()), settings_win, SLOT(show()));
+        connect(ui->actionSave_to_amplifier, &QAction::triggered, this, [this]
+                { save_window()->show(); });
+        connect(ui->action_Load_from_amplifier, &QAction::triggered, this, [this]
+                { load_window()->show(); });
+        connect(ui->actionSave_effects, &QAction::triggered, this, [this]
+                { create_window(seffects)->open(); });
+        connect(ui->action_Options, &QAction::triggered, this, [this]
+                { create_window(settings_win)->show(); });
         connect(ui->actionL_oad_from_file, SIGNAL(triggered()), this, SLOT(loadfile()));
-        connect(ui->actionS_ave_to_file, SIGNAL(triggered()), saver, SLOT(show()));
+        connect(ui->actionS_ave_to_file, &QAction::triggered, this, [this]
+                { create_window(saver)->show(); });
         connect(ui->action_Library_view, SIGNAL(triggered()), this, SLOT(show_library()));
         connect(ui->action_Update_firmware, SIGNAL(triggered()), this, SLOT(update_firmware()));
+        connect(ui->action_Backup_amplifier, SIGNAL(triggered()), this, SLOT(backup_amp()));
+        connect(ui->actionRestore_amplifier, SIGNAL(triggered()), this, SLOT(restore_amp()));
+        connect(ui->action_Open_setlist, SIGNAL(triggered()), this, SLOT(open_setlist()));
         connect(ui->action_Default_effects, SIGNAL(triggered()), this, SLOT(show_default_effects()));
-        connect(ui->action_Quick_presets, SIGNAL(triggered()), quickpres, SLOT(show()));
+        connect(ui->action_Quick_presets, &QAction::triggered, this, [this]
+                { quick_presets_window()->show(); });
 
         // shortcuts to activate effect windows
         QShortcut* showFx1 = new QShortcut(QKeySequence(Qt::CTRL + Qt::Key_1), this, nullptr, nullptr, Qt::ApplicationShortcut);
@@ -181,6 +233,18 @@ namespace plug
         connect(showFx8, &QShortcut::activated, this, [this]
                 { this->showEffect(7); });
 
+        // shortcuts to switch effects on and off and to load their default values
+        for (std::size_t slot = 0; slot < effectComponents.size(); ++slot)
+        {
+            const auto key = static_cast<int>(slot) + 1;
+            QShortcut* off = new QShortcut(QKeySequence(QString("F%1").arg(key)), this, nullptr, nullptr, Qt::ApplicationShortcut);
+            QShortcut* defaultFx = new QShortcut(QKeySequence(QString("Ctrl+F%1").arg(key)), this, nullptr, nullptr, Qt::ApplicationShortcut);
+            connect(off, &QShortcut::activated, this, [this, slot]
+                    { effect_window(slot)->toggle_off_switch(); });
+            connect(defaultFx, &QShortcut::activated, this, [this, slot]
+                    { effect_window(slot)->load_default_fx(); });
+        }
+
         QShortcut* showamp = new QShortcut(QKeySequence(Qt::CTRL + Qt::Key_A), this, nullptr, nullptr, Qt::ApplicationShortcut);
         connect(showamp, SIGNAL(activated()), this, SLOT(show_amp()));
 
@@ -216,6 +280,32 @@ namespace plug
         connect(loadpres9, &QShortcut::activated, this, [this]
                 { loadPreset(9); });
 
+        // undo and redo of tone edits
+        QShortcut* undo = new QShortcut(QKeySequence::Undo, this, nullptr, nullptr, Qt::ApplicationShortcut);
+        QShortcut* redo = new QShortcut(QKeySequence::Redo, this, nullptr, nullptr, Qt::ApplicationShortcut);
+        connect(undo, SIGNAL(activated()), this, SLOT(undo_edit()));
+        connect(redo, SIGNAL(activated()), this, SLOT(redo_edit()));
+
+        // setlist navigation, also sent by most page turner pedals
+        QShortcut* nextSong = new QShortcut(QKeySequence(Qt::Key_PageDown), this, nullptr, nullptr, Qt::ApplicationShortcut);
+        QShortcut* previousSong = new QShortcut(QKeySequence(Qt::Key_PageUp), this, nullptr, nullptr, Qt::ApplicationShortcut);
+        connect(nextSong, SIGNAL(activated()), this, SLOT(next_song()));
+        connect(previousSong, SIGNAL(activated()), this, SLOT(previous_song()));
+
+        // A/B snapshots, stored with Ctrl+Shift+number and recalled with Alt+number
+        for (std::size_t index = 0; index < snapshots.size(); ++index)
+        {
+            const auto key = Qt::Key_1 + static_cast<int>(index);
+            QShortcut* storeSnapshot = new QShortcut(QKeySequence(Qt::CTRL + Qt::SHIFT + key), this, nullptr, nullptr, Qt::ApplicationShortcut);
+            QShortcut* recallSnapshot = new QShortcut(QKeySequence(Qt::ALT + key), this, nullptr, nullptr, Qt::ApplicationShortcut);
+            connect(storeSnapshot, &QShortcut::activated, this, [this, index]
+                    { store_snapshot(index); });
+            connect(recallSnapshot, &QShortcut::activated, this, [this, index]
+                    { recall_snapshot(index); });
+        }
+        QShortcut* toggleSnapshot = new QShortcut(QKeySequence(Qt::CTRL + Qt::Key_B), this, nullptr, nullptr, Qt::ApplicationShortcut);
+        connect(toggleSnapshot, SIGNAL(activated()), this, SLOT(toggle_snapshot()));
+
         // shortcut to activate buttons
         QShortcut* shortcut = new QShortcut(QKeySequence(Qt::CTRL + Qt::SHIFT + Qt::Key_A), this);
         connect(shortcut, SIGNAL(activated()), this, SLOT(enable_buttons()));
@@ -234,6 +324,10 @@ namespace plug
 
     MainWindow::~MainWindow()
     {
+        setlist.reset();
+        eventListener.reset();
+        close_journal();
+
         QSettings settings;
         settings.setValue("Windows/mainWindowGeometry", saveGeometry());
         settings.setValue("Windows/mainWindowState", saveState());
@@ -263,7 +357,7 @@ namespace plug
     {
         QSettings settings;
         amp_settings amplifier_set{};
-        std::vector<fx_pedal_settings> effects_set{};
+        EffectList effects_set{};
         QString name;
 
         ui->statusBar->showMessage(tr("Connecting..."));
@@ -272,11 +366,26 @@ namespace plug
         try
         {
             amp_ops = std::make_unique<plug::com::Mustang>(plug::com::createUsbConnection());
-            const auto [signalChain, presets] = amp_ops->start_amp();
-            name = QString::fromStdString(signalChain.name());
-            amplifier_set = signalChain.amp();
-            effects_set = signalChain.effects();
+            const auto [signalChain, presets, diagnostics] = amp_ops->start_amp();
+
+            for (const auto& diagnostic : diagnostics)
+            {
+                qWarning() << "WARNING: " << QString::fromStdString(plug::com::describe(diagnostic));
+            }
+
+            const auto tone_set = offlineEdits.apply(signalChain);
+
+            if (offlineEdits.empty() == false)
+            {
+                amp_ops->write_signal_chain(signalChain, tone_set);
+            }
+
+            track_unknown_models(tone_set);
+            name = QString::fromStdString(std::string{tone_set.name()});
+            amplifier_set = tone_set.amp();
+            effects_set = tone_set.effects();
             presetNames = presets;
+            ampBank.clear();
         }
         catch (const std::exception& ex)
         {
@@ -285,9 +394,7 @@ namespace plug
             return;
         }
 
-        load->load_names(presetNames);
-        save->load_names(presetNames);
-        quickpres->load_names(presetNames);
+        load_preset_names();
 
         if (name.isEmpty() == true)
         {
@@ -305,56 +412,68 @@ namespace plug
 
         current_name = name;
 
-        amp->load(amplifier_set);
-        if (settings.value("Settings/popupChangedWindows").toBool())
-        {
-            amp->show();
-        }
-
-        std::for_each(effects_set.cbegin(), effects_set.cend(), [this, &settings](const auto& effect)
-                      {
-            Effect* component = effectComponents.at(effect.slot.id());
-            component->load(effect);
-
-            if ((effect.effect_num != effects::EMPTY) && (settings.value("Settings/popupChangedWindows").toBool()))
-            {
-                component->show();
-            } });
+        const bool shouldPopup = settings.value("Settings/popupChangedWindows").toBool();
+        load_amp(amplifier_set, shouldPopup);
+        std::for_each(effects_set.cbegin(), effects_set.cend(), [this, shouldPopup](const auto& effect)
+                      { load_effect(effect, shouldPopup); });
         // activate buttons
-        amp->enable_set_button(true);
-        std::for_each(effectComponents.cbegin(), effectComponents.cend(), [](const auto& effect)
-                      { effect->enable_set_button(true); });
+        enable_set_buttons(true);
         ui->actionConnect->setDisabled(true);
         ui->actionDisconnect->setDisabled(false);
         ui->actionSave_to_amplifier->setDisabled(false);
         ui->action_Load_from_amplifier->setDisabled(false);
         ui->actionSave_effects->setDisabled(false);
         ui->action_Library_view->setDisabled(false);
+        ui->action_Backup_amplifier->setDisabled(false);
+        ui->actionRestore_amplifier->setDisabled(false);
+        ui->action_Open_setlist->setDisabled(false);
         ui->statusBar->showMessage(tr("Connected"), 3000);
 
+        // Changes made on the amp itself are delivered on the listener's thread
+        eventListener = std::make_unique<com::AmpEventListener>(*amp_ops, SignalChain{name.toStdString(), amplifier_set, effects_set}, [this](const auto& events)
+                                                                { QMetaObject::invokeMethod(this, [this, events]
+                                                                                          { apply_amp_events(events); }, Qt::QueuedConnection); });
+
+        offlineEdits.clear();
+        history.clear();
+        tone = current_tone();
         connected = true;
+
+        restore_session();
+
+        try
+        {
+            QDir().mkpath(journalDirectory());
+            journal = std::make_unique<com::SessionJournal>(journalPath().toStdString(), tone);
+        }
+        catch (const std::exception& ex)
+        {
+            qWarning() << "WARNING: " << ex.what();
+        }
     }
 
     void MainWindow::stop_amp()
     {
-        save->delete_items();
-        load->delete_items();
-        quickpres->delete_items();
+        clear_preset_names();
 
         try
         {
+            setlist.reset();
+            eventListener.reset();
+            close_journal();
             amp_ops->stop_amp();
 
             // deactivate buttons
-            amp->enable_set_button(false);
-            std::for_each(effectComponents.cbegin(), effectComponents.cend(), [](const auto& effect)
-                          { effect->enable_set_button(false); });
+            enable_set_buttons(false);
             ui->actionConnect->setDisabled(false);
             ui->actionDisconnect->setDisabled(true);
             ui->actionSave_to_amplifier->setDisabled(true);
             ui->action_Load_from_amplifier->setDisabled(true);
             ui->actionSave_effects->setDisabled(true);
             ui->action_Library_view->setDisabled(true);
+            ui->action_Backup_amplifier->setDisabled(true);
+            ui->actionRestore_amplifier->setDisabled(true);
+            ui->action_Open_setlist->setDisabled(true);
             setWindowTitle(QString(tr("PLUG")));
             setAccessibleName(QString(tr("Main window: None")));
             ui->statusBar->showMessage(tr("Disconnected"), 5000);
@@ -372,37 +491,101 @@ namespace plug
     // pass the message to the amp
     void MainWindow::set_effect(fx_pedal_settings pedal)
     {
+        if (connected && !applyingHistory && unknownEffects[pedal.slot.id()])
+        {
+            ui->statusBar->showMessage(tr("The effect of this slot is unknown to PLUG, it can't be changed"), 5000);
+            return;
+        }
+
+        com::setSlotFields(editorTone, pedal);
+
         if (!connected)
+        {
+            offlineEdits.setEffect(pedal);
+            return;
+        }
+
+        if (applyingHistory)
         {
             return;
         }
 
         QSettings settings;
 
-        if (!settings.value("Settings/oneSetToSetThemAll").toBool())
+        // The amp sends the changed effects in this mode, and records them once they are sent
+        if (settings.value("Settings/oneSetToSetThemAll").toBool())
         {
-            try
-            {
-                amp_ops->set_effect(pedal);
-            }
-            catch (const std::exception& ex)
+            resend_amp();
+            return;
+        }
+
+        try
+        {
+            amp_ops->set_effect(pedal);
+        }
+        catch (const std::exception& ex)
+        {
+            qWarning() << "ERROR: " << ex.what();
+            ui->statusBar->showMessage(QString(tr("Error: %1")).arg(ex.what()), 5000);
+            return;
+        }
+
+        // The edit is recorded once, after the amp has been sent as well - unless its model is unknown
+        {
+            const FlagGuard pauseRecording{recordEdits, false};
+
+            if (!unknownAmp)
             {
-                qWarning() << "ERROR: " << ex.what();
-                ui->statusBar->showMessage(QString(tr("Error: %1")).arg(ex.what()), 5000);
-                return;
+                resend_amp();
             }
         }
-        amp->send_amp();
+        record_edit();
+    }
+
+    // Without an amp window the editor's amp is sent, as the window would
+    void MainWindow::resend_amp()
+    {
+        if (amp != nullptr)
+        {
+            amp->send_amp();
+        }
+        else
+        {
+            set_amplifier(com::ampFields(editorTone));
+        }
     }
 
     void MainWindow::set_amplifier(amp_settings amp_settings)
     {
-        if (!connected)
+        if (connected && !applyingHistory && unknownAmp)
         {
+            ui->statusBar->showMessage(tr("The amp model of this preset is unknown to PLUG, it can't be changed"), 5000);
             return;
         }
 
         QSettings settings;
+        com::setAmpFields(editorTone, amp_settings);
+
+        if (!connected)
+        {
+            if (settings.value("Settings/oneSetToSetThemAll").toBool())
+            {
+                std::for_each(effectComponents.begin(), effectComponents.end(), [this](const auto& comp)
+                              {
+                    if ((comp != nullptr) && comp->get_changed())
+                    {
+                        com::setSlotFields(editorTone, comp->getSettings());
+                        offlineEdits.setEffect(comp->getSettings());
+                    } });
+            }
+            offlineEdits.setAmplifier(amp_settings);
+            return;
+        }
+
+        if (applyingHistory)
+        {
+            return;
+        }
 
         try
         {
@@ -410,8 +593,9 @@ namespace plug
             {
                 std::for_each(effectComponents.begin(), effectComponents.end(), [this](const auto& comp)
                               {
-                    if (comp->get_changed())
+                    if ((comp != nullptr) && comp->get_changed())
                     {
+                        com::setSlotFields(editorTone, comp->getSettings());
                         amp_ops->set_effect(comp->getSettings());
                     } });
             }
@@ -424,6 +608,7 @@ namespace plug
             ui->statusBar->showMessage(QString(tr("Error: %1")).arg(ex.what()), 5000);
             return;
         }
+        record_edit();
     }
 
     void MainWindow::save_on_amp(char* name, int slot)
@@ -435,6 +620,7 @@ namespace plug
 
         try
         {
+            ampBank.clear();
             amp_ops->save_on_amp(name, static_cast<std::uint8_t>(slot));
         }
         catch (const std::exception& ex)
@@ -469,8 +655,10 @@ namespace plug
         QSettings settings;
         try
         {
+            const FlagGuard pauseRecording{recordEdits, false};
             const auto signalChain = amp_ops->load_memory_bank(static_cast<std::uint8_t>(slot));
-            const QString bankName = QString::fromStdString(signalChain.name());
+            track_unknown_models(signalChain);
+            const QString bankName = QString::fromStdString(std::string{signalChain.name()});
 
 
             if (bankName.isEmpty())
@@ -486,23 +674,12 @@ namespace plug
 
             current_name = bankName;
 
-            amp->load(signalChain.amp());
-            if (settings.value("Settings/popupChangedWindows").toBool())
-            {
-                amp->show();
-            }
-
-            const auto effects_set = signalChain.effects();
             const bool shouldPopup = settings.value("Settings/popupChangedWindows").toBool();
-            std::for_each(effects_set.cbegin(), effects_set.cend(), [this, shouldPopup](const auto& effect)
-                          {
-                const auto component = effectComponents.at(effect.slot.id());
+            load_amp(signalChain.amp(), shouldPopup);
 
-                component->load(effect);
-                if ((effect.effect_num != effects::EMPTY) && shouldPopup)
-                {
-                    component->show();
-                } });
+            const auto& effects_set = signalChain.effects();
+            std::for_each(effects_set.cbegin(), effects_set.cend(), [this, shouldPopup](const auto& effect)
+                          { load_effect(effect, shouldPopup); });
         }
         catch (const std::exception& ex)
         {
@@ -510,31 +687,45 @@ namespace plug
             ui->statusBar->showMessage(QString(tr("Error: %1")).arg(ex.what()), 5000);
             return;
         }
+
+        record_edit();
     }
 
     // activate buttons
     void MainWindow::enable_buttons()
     {
-        amp->enable_set_button(true);
-        std::for_each(effectComponents.cbegin(), effectComponents.cend(), [](const auto& effect)
-                      { effect->enable_set_button(true); });
+        enable_set_buttons(true);
         ui->actionConnect->setDisabled(false);
         ui->actionDisconnect->setDisabled(false);
         ui->actionSave_to_amplifier->setDisabled(false);
         ui->action_Load_from_amplifier->setDisabled(false);
         ui->actionSave_effects->setDisabled(false);
         ui->action_Library_view->setDisabled(false);
+        ui->action_Backup_amplifier->setDisabled(false);
+        ui->actionRestore_amplifier->setDisabled(false);
+        ui->action_Open_setlist->setDisabled(false);
     }
 
     void MainWindow::change_name(int slot, QString* name)
     {
-        load->change_name(slot, name);
-        quickpres->change_name(slot, name);
+        if (load != nullptr)
+        {
+            load->change_name(slot, name);
+        }
+        if (quickpres != nullptr)
+        {
+            quickpres->change_name(slot, name);
+        }
     }
 
     void MainWindow::set_index(int value)
     {
-        save->change_index(value, current_name);
+        presetIndex = value;
+
+        if (save != nullptr)
+        {
+            save->change_index(value, current_name);
+        }
     }
 
     void MainWindow::save_effects(int slot, char* name, int fx_num, bool mod, bool dly, bool rev)
@@ -545,17 +736,17 @@ namespace plug
         {
             if (mod)
             {
-                effects[0] = effectComponents[1]->getSettings();
+                effects[0] = com::slotFields(editorTone, FxSlot{1});
                 set_effect(effects[0]);
             }
             else if (dly)
             {
-                effects[0] = effectComponents[2]->getSettings();
+                effects[0] = com::slotFields(editorTone, FxSlot{2});
                 set_effect(effects[0]);
             }
             else if (rev)
             {
-                effects[0] = effectComponents[3]->getSettings();
+                effects[0] = com::slotFields(editorTone, FxSlot{3});
                 set_effect(effects[0]);
             }
             else
@@ -565,14 +756,15 @@ namespace plug
         }
         else
         {
-            effects[0] = effectComponents[2]->getSettings();
+            effects[0] = com::slotFields(editorTone, FxSlot{2});
             set_effect(effects[0]);
-            effects[1] = effectComponents[3]->getSettings();
+            effects[1] = com::slotFields(editorTone, FxSlot{3});
             set_effect(effects[1]);
         }
 
         try
         {
+            ampBank.clear();
             amp_ops->save_effects(static_cast<std::uint8_t>(slot), name, effects);
         }
         catch (const std::exception& ex)
@@ -598,185 +790,847 @@ namespace plug
         }
 
         settings.setValue("LoadFile/lastDirectory", QFileInfo(filename).absolutePath());
-        QFile file{filename, this};
 
-        if (file.exists())
-        {
-            if (!file.open(QFile::ReadOnly | QFile::Text))
-            {
-                QMessageBox::critical(this, tr("Error!"), tr("Could not open file"));
-                return;
-            }
-        }
-        else
+        if (!QFileInfo::exists(filename))
         {
             QMessageBox::critical(this, tr("Error!"), tr("No such file"));
             return;
         }
 
-        LoadFromFile loader{&file};
-        const auto fileSettings = loader.loadfile();
-        file.close();
+        SignalChain chain;
 
-        change_title(fileSettings.name);
-
-        amp->load(fileSettings.amp);
-        if (connected)
+        try
         {
-            amp->send_amp();
+            chain = library::loadFuseFile(filename.toStdString());
+        }
+        catch (const std::exception& ex)
+        {
+            QMessageBox::critical(this, tr("Error!"), tr("Could not load file: %1").arg(ex.what()));
+            return;
         }
 
-        const bool shouldPopup = settings.value("Settings/popupChangedWindows").toBool();
+        load_signal_chain(chain);
+    }
+
+    void MainWindow::load_signal_chain(const SignalChain& chain)
+    {
+        track_unknown_models(chain);
 
-        if (shouldPopup)
         {
-            amp->show();
-        }
+            const FlagGuard pauseRecording{recordEdits, false};
+            QSettings settings;
+            change_title(QString::fromStdString(std::string{chain.name()}));
 
-        std::for_each(fileSettings.effects.cbegin(), fileSettings.effects.cend(), [this, shouldPopup](auto& effect)
-                      {
-            const auto& component = effectComponents.at(effect.slot.id());
-            component->load(effect);
+            const bool shouldPopup = settings.value("Settings/popupChangedWindows").toBool();
+            load_amp(chain.amp(), shouldPopup);
 
-            if (connected)
+            if (connected && (amp != nullptr))
             {
-                component->send_fx();
+                amp->send_amp();
             }
-
-            if ((effect.effect_num != effects::EMPTY) && shouldPopup)
+            else if (connected)
             {
-                component->show();
-            } });
+                set_amplifier(chain.amp());
+            }
+
+            const auto& effects = chain.effects();
+            std::for_each(effects.cbegin(), effects.cend(), [this, shouldPopup](auto& effect)
+                          {
+                load_effect(effect, shouldPopup);
+
+                if (connected)
+                {
+                    set_effect(effect);
+                } });
+        }
+
+        if (!connected)
+        {
+            offlineEdits.setSignalChain(chain);
+        }
+        record_edit();
     }
 
     void MainWindow::get_settings(amp_settings* amplifier_settings, std::vector<fx_pedal_settings>& fx_settings)
     {
         if (amplifier_settings != nullptr)
         {
-            amp->get_settings(amplifier_settings);
+            *amplifier_settings = com::ampFields(editorTone);
         }
 
         fx_settings = std::vector<fx_pedal_settings>{};
 
-        std::for_each(effectComponents.cbegin(), effectComponents.cend(), [&fx_settings](const auto& comp)
-                      { fx_settings.push_back(comp->getSettings()); });
+        for (std::uint8_t slot = 0; slot < com::tone::slotCount; ++slot)
+        {
+            fx_settings.push_back(com::slotFields(editorTone, FxSlot{slot}));
+        }
     }
 
-    void MainWindow::change_title(const QString& name)
+    // Only the windows of changed parts are updated, they update only the changed controls
+    void MainWindow::apply_amp_events(const std::vector<com::AmpEvent>& events)
     {
-        current_name = name;
+        const FlagGuard pauseRecording{recordEdits, false};
 
-        if (current_name.isEmpty())
+        for (const auto& event : events)
         {
-            setWindowTitle(QString(tr("PLUG: NONE")));
-            setAccessibleName(QString(tr("Main window: NONE")));
+            if (const auto nameChange = std::get_if<com::PresetNameChange>(&event); nameChange != nullptr)
+            {
+                change_title(QString::fromStdString(nameChange->name));
+            }
+            else if (const auto ampChange = std::get_if<amp_settings>(&event); ampChange != nullptr)
+            {
+                if (amp != nullptr)
+                {
+                    amp->update(*ampChange);
+                }
+                com::setAmpFields(editorTone, *ampChange);
+            }
+            else if (const auto effectChange = std::get_if<com::EffectChange>(&event); effectChange != nullptr)
+            {
+                const auto effect = effectChange->effect.value_or(fx_pedal_settings{effectChange->slot, effects::EMPTY, 0, 0, 0, 0, 0, 0, false});
+
+                if (Effect* component = effectComponents.at(effectChange->slot.id()); component != nullptr)
+                {
+                    component->update(effect);
+                }
+                com::setSlotFields(editorTone, effect);
+            }
         }
-        else
+
+        // Changes made on the amp aren't undone, they become the base of the next step
+        if (connected)
         {
-            setWindowTitle(QString(tr("PLUG: %1")).arg(current_name));
-            setAccessibleName(QString(tr("Main window: %1")).arg(name));
+            set_tone(current_tone());
         }
     }
 
-    void MainWindow::showEffect(std::uint8_t slot)
+    void MainWindow::undo_edit()
     {
-        auto comp = effectComponents.at(slot);
+        const auto current = current_tone();
 
-        if (!comp->isVisible())
+        if (const auto previous = history.undo(current); previous.has_value() && !apply_history_step(current, *previous))
         {
-            comp->show();
+            history.redo(*previous);
         }
-        comp->activateWindow();
     }
 
-
-    void MainWindow::show_amp()
+    void MainWindow::redo_edit()
     {
-        if (!amp->isVisible())
+        const auto current = current_tone();
+
+        if (const auto next = history.redo(current); next.has_value() && !apply_history_step(current, *next))
         {
-            amp->show();
+            history.undo(*next);
         }
-        amp->activateWindow();
     }
 
-    void MainWindow::show_library()
+    SignalChain MainWindow::current_tone() const
     {
-        QSettings settings;
-        bool previous = settings.value("Settings/popupChangedWindows").toBool();
-
-        settings.setValue("Settings/popupChangedWindows", false);
-
-        Library library{presetNames, this};
-        std::for_each(effectComponents.cbegin(), effectComponents.cend(), [](const auto& comp)
-                      { comp->close(); });
-        amp->close();
-        this->close();
-        library.exec();
-
-        settings.setValue("Settings/popupChangedWindows", previous);
-        this->show();
+        return com::fromToneState(current_name.toStdString(), editorTone);
     }
 
-    void MainWindow::update_firmware()
+    // Edits made while disconnected aren't recorded, the tone is taken from the amp on connect
+    void MainWindow::record_edit()
     {
-        QString filename;
-        QMessageBox::information(this, "Prepare", R"(Please power off the amplifier, then power it back on while holding down:<ul><li>The "Save" button (Mustang I and II)</li><li>The Data Wheel (Mustang III, IV and IV)</li></ul>After pressing "OK" choose firmware file and then update will begin.It will take about one minute. You will be notified when it's finished.)");
-
-        filename = QFileDialog::getOpenFileName(this, tr("Open..."), QDir::homePath(), tr("Mustang firmware (*.upd)"));
-        if (filename.isEmpty())
+        if (!connected || !recordEdits)
         {
             return;
         }
 
-        if (connected)
+        const auto current = current_tone();
+        history.record(tone, current);
+        set_tone(current);
+        resync_amp_events(current);
+    }
+
+    // Every change of the tone is journaled, the journal's thread writes it
+    void MainWindow::set_tone(const SignalChain& chain)
+    {
+        if (journal != nullptr)
         {
-            this->stop_amp();
+            journal->update(chain);
         }
+        tone = chain;
+    }
 
-        ui->statusBar->showMessage("Updating firmware. Please wait...");
-        ui->centralWidget->setDisabled(true);
-        ui->menuBar->setDisabled(true);
-        this->repaint();
-        const int ret = com::updateFirmware(filename.toLatin1().constData());
-        ui->centralWidget->setDisabled(false);
-        ui->menuBar->setDisabled(false);
-        ui->statusBar->showMessage("", 1);
-        if (ret == -100)
+    // A journal left behind means the last session ended without disconnecting
+    void MainWindow::restore_session()
+    {
+        const auto recovered = com::recoverJournal(journalPath().toStdString());
+
+        if ((recovered.has_value() == false) || (com::toToneState(*recovered) == com::toToneState(tone)))
         {
-            ui->statusBar->showMessage(tr("Error: Suitable device not found!"), 5000);
             return;
         }
-        if (ret != 0)
+
+        if (QMessageBox::question(this, tr("Restore session"), tr("The last session ended unexpectedly. Restore its tone?")) == QMessageBox::Yes)
         {
-            ui->statusBar->showMessage(QString(tr("Communication error: %1")).arg(ret), 5000);
-            return;
+            const auto current = tone;
+
+            if (apply_history_step(current, *recovered))
+            {
+                change_title(QString::fromStdString(std::string{recovered->name()}));
+                history.record(current, *recovered);
+            }
         }
-        QMessageBox::information(this, "Update finished", R"(<b>Update finished</b><br>If "Exit" button is lit - update was succesful<br>If "Save" button is lit - update failed<br><br>Power off the amplifier and then back on to finish the process.)");
     }
 
-    void MainWindow::show_default_effects()
+    // The journal is only needed after a crash, it's removed on a regular disconnect
+    void MainWindow::close_journal()
     {
-        DefaultEffects deffx{this};
-        deffx.exec();
+        if (journal != nullptr)
+        {
+            journal.reset();
+            QFile::remove(journalPath());
+        }
     }
 
-    void MainWindow::empty_other(int value, Effect* caller)
+    // Only the amp and DSPs changed by the step are sent, all before their acks are read; a step
+    // which would have to send a model unknown to PLUG is refused, as it can't be encoded
+    bool MainWindow::apply_history_step(const SignalChain& current, const SignalChain& target)
     {
-        const int fx_family = check_fx_family(static_cast<effects>(value));
-        fx_pedal_settings settings{FxSlot{0}, effects::EMPTY, 0, 0, 0, 0, 0, 0, false};
+        if (!connected)
+        {
+            return true;
+        }
 
-        std::for_each(effectComponents.cbegin(), effectComponents.cend(), [&caller, &settings, fx_family](const auto& comp)
-                      {
-            if (caller != comp)
-            {
-                settings = comp->getSettings();
+        if (com::changesUnknownModels(current, target))
+        {
+            ui->statusBar->showMessage(tr("The step restores a model unknown to PLUG, it can't be applied"), 5000);
+            return false;
+        }
 
-                if (check_fx_family(settings.effect_num) == fx_family)
-                {
-                    comp->choose_fx(0);
-                    comp->send_fx();
-                }
-            } });
+        show_tone(target);
+        set_tone(target);
+        track_unknown_models(target);
+
+        try
+        {
+            amp_ops->write_signal_chain(current, target);
+        }
+        catch (const std::exception& ex)
+        {
+            qWarning() << "ERROR: " << ex.what();
+            ui->statusBar->showMessage(QString(tr("Error: %1")).arg(ex.what()), 5000);
+        }
+        resync_amp_events(target);
+        return true;
+    }
+
+    // Local writes become the state the amp's own changes are compared to
+    void MainWindow::resync_amp_events(const SignalChain& chain)
+    {
+        if (eventListener != nullptr)
+        {
+            eventListener->resync(chain);
+        }
+    }
+
+    // Updates the tone and its windows without sending anything to the amp
+    void MainWindow::show_tone(const SignalChain& chain)
+    {
+        const FlagGuard silent{applyingHistory, true};
+
+        if (amp != nullptr)
+        {
+            amp->update(chain.amp());
+        }
+
+        const auto& effects_set = chain.effects();
+        std::for_each(effectComponents.cbegin(), effectComponents.cend(), [&effects_set](const auto& comp)
+                      {
+            if (comp == nullptr)
+            {
+                return;
+            }
+
+            const auto slot = comp->getSettings().slot;
+            const auto effect = std::find_if(effects_set.cbegin(), effects_set.cend(), [slot](const auto& e)
+                                             { return e.slot.id() == slot.id(); });
+            comp->update((effect != effects_set.cend()) ? *effect : fx_pedal_settings{slot, effects::EMPTY, 0, 0, 0, 0, 0, 0, false}); });
+
+        // The windows' updates can empty other slots, the tone is set afterwards
+        editorTone = com::toToneState(chain);
+    }
+
+    // The windows are created when first used and start with the editor's tone
+    Amplifier* MainWindow::amp_window()
+    {
+        if (amp == nullptr)
+        {
+            amp = new Amplifier(this);
+            amp->load(com::ampFields(editorTone));
+            amp->enable_set_button(setButtonsEnabled);
+        }
+        return amp;
+    }
+
+    Effect* MainWindow::effect_window(std::size_t slot)
+    {
+        Effect*& component = effectComponents.at(slot);
+
+        if (component == nullptr)
+        {
+            const FxSlot fxSlot{static_cast<std::uint8_t>(slot)};
+            component = new Effect{this, fxSlot};
+            component->load(com::slotFields(editorTone, fxSlot));
+            component->set_changed(false);
+            component->enable_set_button(setButtonsEnabled);
+        }
+        return component;
+    }
+
+    // The windows show defaults in place of unknown models, which must not be written to the amp
+    void MainWindow::track_unknown_models(const SignalChain& chain)
+    {
+        const auto& amp_set = chain.amp();
+        unknownAmp = amp_set.unknownModel.has_value() || amp_set.unknownCabinet.has_value();
+        unknownEffects.fill(false);
+
+        const auto& effects_set = chain.effects();
+        std::for_each(effects_set.cbegin(), effects_set.cend(), [this](const auto& effect)
+                      {
+            if (effect.unknownModel.has_value() || effect.unknownSlot.has_value())
+            {
+                unknownEffects[effect.slot.id()] = true;
+            } });
+    }
+
+    void MainWindow::load_amp(const amp_settings& settings, bool popup)
+    {
+        if (amp != nullptr)
+        {
+            amp->load(settings);
+        }
+        com::setAmpFields(editorTone, settings);
+
+        if (popup)
+        {
+            amp_window()->show();
+        }
+    }
+
+    // A window chooses its effect by emptying the slots of the same family, slots without a window are emptied here
+    void MainWindow::load_effect(const fx_pedal_settings& effect, bool popup)
+    {
+        const auto slot = effect.slot.id();
+
+        if (Effect* component = effectComponents.at(slot); component != nullptr)
+        {
+            component->load(effect);
+        }
+        else if (effect.effect_num != effects::EMPTY)
+        {
+            const int fx_family = check_fx_family(effect.effect_num);
+
+            for (std::uint8_t other = 0; other < com::tone::slotCount; ++other)
+            {
+                if ((other != slot) && (check_fx_family(com::slotFields(editorTone, FxSlot{other}).effect_num) == fx_family))
+                {
+                    const fx_pedal_settings empty{FxSlot{other}, effects::EMPTY, 0, 0, 0, 0, 0, 0, false};
+
+                    if (effectComponents[other] != nullptr)
+                    {
+                        effectComponents[other]->update(empty);
+                    }
+                    com::setSlotFields(editorTone, empty);
+                }
+            }
+        }
+        com::setSlotFields(editorTone, effect);
+
+        if ((effect.effect_num != effects::EMPTY) && popup)
+        {
+            effect_window(slot)->show();
+        }
+    }
+
+    void MainWindow::enable_set_buttons(bool value)
+    {
+        setButtonsEnabled = value;
+
+        if (amp != nullptr)
+        {
+            amp->enable_set_button(value);
+        }
+        std::for_each(effectComponents.cbegin(), effectComponents.cend(), [value](const auto& comp)
+                      {
+            if (comp != nullptr)
+            {
+                comp->enable_set_button(value);
+            } });
+    }
+
+    void MainWindow::store_snapshot(std::size_t index)
+    {
+        snapshots.store(index, current_tone());
+        ui->statusBar->showMessage(QString(tr("Stored snapshot %1")).arg(index + 1), 2000);
+    }
+
+    void MainWindow::recall_snapshot(std::size_t index)
+    {
+        if (const auto chain = snapshots.recall(index); chain.has_value())
+        {
+            apply_snapshot(index, *chain);
+        }
+    }
+
+    void MainWindow::toggle_snapshot()
+    {
+        if (const auto chain = snapshots.toggle(); chain.has_value())
+        {
+            apply_snapshot(*snapshots.active(), *chain);
+        }
+    }
+
+    // Switching is an undoable step; only the amp and DSPs that differ from the current tone are sent
+    void MainWindow::apply_snapshot(std::size_t index, const SignalChain& chain)
+    {
+        const auto current = current_tone();
+
+        if (!connected)
+        {
+            show_tone(chain);
+            offlineEdits.setSignalChain(chain);
+        }
+        else if (apply_history_step(current, chain))
+        {
+            history.record(current, chain);
+        }
+        else
+        {
+            return;
+        }
+        ui->statusBar->showMessage(QString(tr("Snapshot %1")).arg(index + 1), 2000);
+    }
+
+    SaveOnAmp* MainWindow::save_window()
+    {
+        if (save == nullptr)
+        {
+            create_window(save);
+
+            if (connected)
+            {
+                save->load_names(presetNames);
+            }
+            if (presetIndex >= 0)
+            {
+                save->change_index(presetIndex, current_name);
+            }
+        }
+        return save;
+    }
+
+    LoadFromAmp* MainWindow::load_window()
+    {
+        if (load == nullptr)
+        {
+            create_window(load);
+
+            if (connected)
+            {
+                load->load_names(presetNames);
+            }
+        }
+        return load;
+    }
+
+    QuickPresets* MainWindow::quick_presets_window()
+    {
+        if (quickpres == nullptr)
+        {
+            create_window(quickpres);
+
+            if (connected)
+            {
+                quickpres->load_names(presetNames);
+            }
+        }
+        return quickpres;
+    }
+
+    template <class Window>
+    Window* MainWindow::create_window(Window*& window)
+    {
+        if (window == nullptr)
+        {
+            window = new Window(this);
+        }
+        return window;
+    }
+
+    // Windows not yet created are filled from the names when first shown
+    void MainWindow::load_preset_names()
+    {
+        if (save != nullptr)
+        {
+            save->load_names(presetNames);
+        }
+        if (load != nullptr)
+        {
+            load->load_names(presetNames);
+        }
+        if (quickpres != nullptr)
+        {
+            quickpres->load_names(presetNames);
+        }
+    }
+
+    void MainWindow::clear_preset_names()
+    {
+        if (save != nullptr)
+        {
+            save->delete_items();
+        }
+        if (load != nullptr)
+        {
+            load->delete_items();
+        }
+        if (quickpres != nullptr)
+        {
+            quickpres->delete_items();
+        }
+    }
+
+    void MainWindow::open_setlist()
+    {
+        QSettings settings;
+        const QString filename = QFileDialog::getOpenFileName(this, tr("Open setlist..."), settings.value("Setlist/lastDirectory", QDir::homePath()).toString(), tr("Setlists (*.txt *.setlist);;All files (*)"));
+
+        if (filename.isEmpty() || !connected)
+        {
+            return;
+        }
+
+        settings.setValue("Setlist/lastDirectory", QFileInfo(filename).absolutePath());
+        ui->statusBar->showMessage(tr("Reading setlist..."));
+
+        try
+        {
+            setlist.reset();
+            setlist = std::make_unique<library::SetlistPlayer>(*amp_ops, library::loadSetlistFile(filename.toStdString(), presetNames.size()));
+        }
+        catch (const std::exception& ex)
+        {
+            qWarning() << "ERROR: " << ex.what();
+            ui->statusBar->showMessage(QString(tr("Error: %1")).arg(ex.what()), 5000);
+            return;
+        }
+
+        next_song();
+    }
+
+    void MainWindow::next_song()
+    {
+        if ((setlist == nullptr) || !connected)
+        {
+            return;
+        }
+
+        try
+        {
+            if (const auto transition = setlist->next(); transition.has_value())
+            {
+                show_song(transition->latency, transition->prefetched);
+            }
+        }
+        catch (const std::exception& ex)
+        {
+            qWarning() << "ERROR: " << ex.what();
+            ui->statusBar->showMessage(QString(tr("Error: %1")).arg(ex.what()), 5000);
+        }
+    }
+
+    void MainWindow::previous_song()
+    {
+        if ((setlist == nullptr) || !connected)
+        {
+            return;
+        }
+
+        try
+        {
+            if (const auto transition = setlist->previous(); transition.has_value())
+            {
+                show_song(transition->latency, transition->prefetched);
+            }
+        }
+        catch (const std::exception& ex)
+        {
+            qWarning() << "ERROR: " << ex.what();
+            ui->statusBar->showMessage(QString(tr("Error: %1")).arg(ex.what()), 5000);
+        }
+    }
+
+    // The song is already on the amp, the switch is recorded like any other load
+    void MainWindow::show_song(std::chrono::steady_clock::duration latency, bool prefetched)
+    {
+        const auto& chain = setlist->current();
+        const auto name = QString::fromStdString(std::string{chain.name()});
+        const double milliseconds = std::chrono::duration<double, std::milli>(latency).count();
+
+        show_tone(chain);
+        change_title(name);
+        record_edit();
+
+        const QString report = tr("Song %1/%2: %3, switched in %4 ms%5")
+                                   .arg(setlist->position().value_or(0) + 1)
+                                   .arg(setlist->size())
+                                   .arg(name)
+                                   .arg(milliseconds, 0, 'f', 1)
+                                   .arg(prefetched ? QString{} : tr(" (not prefetched)"));
+        qInfo() << report;
+        ui->statusBar->showMessage(report);
+    }
+
+    void MainWindow::change_title(const QString& name)
+    {
+        current_name = name;
+
+        if (current_name.isEmpty())
+        {
+            setWindowTitle(QString(tr("PLUG: NONE")));
+            setAccessibleName(QString(tr("Main window: NONE")));
+        }
+        else
+        {
+            setWindowTitle(QString(tr("PLUG: %1")).arg(current_name));
+            setAccessibleName(QString(tr("Main window: %1")).arg(name));
+        }
+    }
+
+    void MainWindow::showEffect(std::uint8_t slot)
+    {
+        auto comp = effect_window(slot);
+
+        if (!comp->isVisible())
+        {
+            comp->show();
+        }
+        comp->activateWindow();
+    }
+
+
+    void MainWindow::show_amp()
+    {
+        auto window = amp_window();
+
+        if (!window->isVisible())
+        {
+            window->show();
+        }
+        window->activateWindow();
+    }
+
+    void MainWindow::show_library()
+    {
+        QSettings settings;
+        bool previous = settings.value("Settings/popupChangedWindows").toBool();
+
+        settings.setValue("Settings/popupChangedWindows", false);
+
+        Library library{presetNames, this};
+        std::for_each(effectComponents.cbegin(), effectComponents.cend(), [](const auto& comp)
+                      {
+            if (comp != nullptr)
+            {
+                comp->close();
+            } });
+        if (amp != nullptr)
+        {
+            amp->close();
+        }
+        this->close();
+        library.exec();
+
+        settings.setValue("Settings/popupChangedWindows", previous);
+        this->show();
+    }
+
+    void MainWindow::update_firmware()
+    {
+        QString filename;
+        QMessageBox::information(this, "Prepare", R"(Please power off the amplifier, then power it back on while holding down:<ul><li>The "Save" button (Mustang I and II)</li><li>The Data Wheel (Mustang III, IV and IV)</li></ul>After pressing "OK" choose firmware file and then update will begin.It will take about one minute. You will be notified when it's finished.)");
+
+        filename = QFileDialog::getOpenFileName(this, tr("Open..."), QDir::homePath(), tr("Mustang firmware (*.upd)"));
+        if (filename.isEmpty())
+        {
+            return;
+        }
+
+        if (connected)
+        {
+            this->stop_amp();
+        }
+
+        ui->statusBar->showMessage("Updating firmware. Please wait...");
+        ui->centralWidget->setDisabled(true);
+        ui->menuBar->setDisabled(true);
+        this->repaint();
+        const int ret = com::updateFirmware(filename.toLatin1().constData());
+        ui->centralWidget->setDisabled(false);
+        ui->menuBar->setDisabled(false);
+        ui->statusBar->showMessage("", 1);
+        if (ret == -100)
+        {
+            ui->statusBar->showMessage(tr("Error: Suitable device not found!"), 5000);
+            return;
+        }
+        if (ret != 0)
+        {
+            ui->statusBar->showMessage(QString(tr("Communication error: %1")).arg(ret), 5000);
+            return;
+        }
+        QMessageBox::information(this, "Update finished", R"(<b>Update finished</b><br>If "Exit" button is lit - update was succesful<br>If "Save" button is lit - update failed<br><br>Power off the amplifier and then back on to finish the process.)");
+    }
+
+    void MainWindow::backup_amp()
+    {
+        QSettings settings;
+        const QString filename = QFileDialog::getSaveFileName(this, tr("Backup amplifier..."), settings.value("Backup/lastDirectory", QDir::homePath()).toString(), tr("Preset banks (*%1)").arg(com::bank::fileExtension.data()));
+
+        if (filename.isEmpty())
+        {
+            return;
+        }
+        settings.setValue("Backup/lastDirectory", QFileInfo(filename).absolutePath());
+
+        QProgressDialog progressDialog{tr("Reading presets..."), QString{}, 0, static_cast<int>(presetNames.size()), this};
+        progressDialog.setWindowModality(Qt::WindowModal);
+        progressDialog.setMinimumDuration(0);
+
+        try
+        {
+            ampBank = amp_ops->backupAll(presetNames.size(), [&progressDialog](std::size_t done, std::size_t)
+                                         { progressDialog.setValue(static_cast<int>(done)); });
+            com::writeBank(filename.toStdString(), ampBank);
+        }
+        catch (const std::exception& ex)
+        {
+            qWarning() << "ERROR: " << ex.what();
+            ui->statusBar->showMessage(QString(tr("Error: %1")).arg(ex.what()), 5000);
+            return;
+        }
+        ui->statusBar->showMessage(tr("Backup finished"), 3000);
+    }
+
+    void MainWindow::restore_amp()
+    {
+        QSettings settings;
+        const QString filename = QFileDialog::getOpenFileName(this, tr("Restore amplifier..."), settings.value("Backup/lastDirectory", QDir::homePath()).toString(), tr("Preset banks (*%1)").arg(com::bank::fileExtension.data()));
+
+        if (filename.isEmpty())
+        {
+            return;
+        }
+        settings.setValue("Backup/lastDirectory", QFileInfo(filename).absolutePath());
+        std::optional<std::uint8_t> lastWritten;
+
+        try
+        {
+            const com::MappedBank bank{filename.toStdString()};
+
+            if (bank.size() > presetNames.size())
+            {
+                QMessageBox::critical(this, tr("Error!"), tr("The backup has more presets than the amplifier"));
+                return;
+            }
+
+            if (QMessageBox::question(this, tr("Restore amplifier"), tr("Overwrite %1 presets on the amplifier?").arg(bank.size())) != QMessageBox::Yes)
+            {
+                return;
+            }
+
+            std::vector<com::PresetRecord> records;
+            records.reserve(bank.size());
+
+            for (std::size_t i = 0; i < bank.size(); ++i)
+            {
+                records.push_back(bank.record(i));
+            }
+
+            QProgressDialog progressDialog{tr("Reading presets..."), QString{}, 0, static_cast<int>(presetNames.size()), this};
+            progressDialog.setWindowModality(Qt::WindowModal);
+            progressDialog.setMinimumDuration(0);
+            const auto showProgress = [&progressDialog](std::size_t done, std::size_t total)
+            {
+                progressDialog.setMaximum(static_cast<int>(total));
+                progressDialog.setValue(static_cast<int>(done));
+            };
+
+            // the differences are taken against the last known amp contents; if unknown, only the
+            // slots the backup covers are read
+            const bool cached = (ampBank.size() == presetNames.size());
+            const auto current = cached ? ampBank : amp_ops->backupAll(records.size(), showProgress);
+
+            const auto updates = com::planRestore(current, records);
+            progressDialog.setLabelText(tr("Writing %1 presets...").arg(updates.size()));
+            progressDialog.reset();
+            amp_ops->restore(updates, showProgress);
+
+            if (updates.empty() == false)
+            {
+                lastWritten = updates.back().slot;
+            }
+
+            if (cached)
+            {
+                std::copy(records.cbegin(), records.cend(), ampBank.begin());
+            }
+
+            for (std::size_t i = 0; i < bank.size(); ++i)
+            {
+                presetNames[i] = bank.name(i);
+            }
+        }
+        catch (const std::exception& ex)
+        {
+            ampBank.clear();
+            qWarning() << "ERROR: " << ex.what();
+            ui->statusBar->showMessage(QString(tr("Error: %1")).arg(ex.what()), 5000);
+            return;
+        }
+
+        clear_preset_names();
+        load_preset_names();
+
+        // Writing the slots replaced the amp's live tone, the last written slot is loaded to show it again
+        if (lastWritten.has_value())
+        {
+            load_from_amp(*lastWritten);
+        }
+        ui->statusBar->showMessage(tr("Restore finished"), 3000);
+    }
+
+    void MainWindow::show_default_effects()
+    {
+        DefaultEffects deffx{this};
+        deffx.exec();
+    }
+
+    // Slots without a window are emptied in the tone, set_effect sends them like the windows do
+    void MainWindow::empty_other(int value, Effect* caller)
+    {
+        const int fx_family = check_fx_family(static_cast<effects>(value));
+
+        for (std::uint8_t slot = 0; slot < com::tone::slotCount; ++slot)
+        {
+            Effect* comp = effectComponents[slot];
+
+            if (comp == nullptr)
+            {
+                if (check_fx_family(com::slotFields(editorTone, FxSlot{slot}).effect_num) == fx_family)
+                {
+                    set_effect(fx_pedal_settings{FxSlot{slot}, effects::EMPTY, 0, 0, 0, 0, 0, 0, false});
+                }
+            }
+            else if ((caller != comp) && (check_fx_family(comp->getSettings().effect_num) == fx_family))
+            {
+                comp->choose_fx(0);
+                comp->send_fx();
+            }
+        }
     }
 
     void MainWindow::loadPreset(std::size_t number)
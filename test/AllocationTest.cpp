@@ -0,0 +1,224 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/Mustang.h"
+#include "com/PacketSerializer.h"
+#include <gmock/gmock.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    std::atomic<bool> counting{false};
+    std::atomic<std::size_t> allocations{0};
+}
+
+void* operator new(std::size_t size)
+{
+    if (counting == true)
+    {
+        ++allocations;
+    }
+
+    if (void* ptr = std::malloc(size == 0 ? 1 : size); ptr != nullptr)
+    {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+
+namespace plug::test
+{
+    using namespace plug::com;
+    using namespace testing;
+
+    // Acknowledges every packet, a slot selection is answered with a preset dump
+    class StaticConnection : public Connection
+    {
+    public:
+        void close() override
+        {
+        }
+
+        bool isOpen() const override
+        {
+            return true;
+        }
+
+        std::vector<std::uint8_t> receive(std::size_t) override
+        {
+            throw std::logic_error{"Allocating receive used"};
+        }
+
+        std::vector<std::uint8_t> receiveWithin(std::size_t, std::chrono::milliseconds) override
+        {
+            throw std::logic_error{"Allocating receive used"};
+        }
+
+        std::string name() const override
+        {
+            return {};
+        }
+
+        ModelVersion modelVersion() const override
+        {
+            return ModelVersion::v1;
+        }
+
+        const PresetRecord dump = serializeSignalChain(3, SignalChain{"preset", amp_settings{}, {}});
+
+    private:
+        std::size_t sendImpl(std::uint8_t* data, std::size_t size) override
+        {
+            pendingDump = (data[2] == serializeLoadSlotCommand(0).getBytes()[2]) ? dump.size() + 1 : 1;
+            return size;
+        }
+
+        std::size_t receiveImpl(std::uint8_t* data, std::size_t size) override
+        {
+            if (pendingDump == 0)
+            {
+                return 0;
+            }
+
+            const auto index = dump.size() + 1 - pendingDump--;
+
+            if (index >= dump.size())
+            {
+                return 0;
+            }
+            std::copy_n(dump[index].cbegin(), size, data);
+            return size;
+        }
+
+        std::size_t pendingDump{0};
+    };
+
+
+    class AllocationTest : public testing::Test
+    {
+    protected:
+        template <class Operation>
+        std::size_t countAllocations(Operation operation)
+        {
+            allocations = 0;
+            counting = true;
+            operation();
+            counting = false;
+            return allocations;
+        }
+
+        std::unique_ptr<StaticConnection> connection = std::make_unique<StaticConnection>();
+        StaticConnection* conn = connection.get();
+        Mustang m{std::move(connection)};
+    };
+
+    TEST_F(AllocationTest, setAmplifierDoesntAllocate)
+    {
+        const amp_settings amp{amps::BRITISH_70S, 8, 9, 1, 2, 3, cabinets::cab4x12G, 3, 5, 3, 2, 1, 4, 1, 5, true, 4};
+
+        EXPECT_THAT(countAllocations([&]
+                                     { m.set_amplifier(amp); }),
+                    Eq(0));
+    }
+
+    TEST_F(AllocationTest, setEffectDoesntAllocate)
+    {
+        const fx_pedal_settings effect{FxSlot{2}, effects::MONO_DELAY, 1, 2, 3, 4, 5, 6, true};
+
+        EXPECT_THAT(countAllocations([&]
+                                     { m.set_effect(effect); }),
+                    Eq(0));
+    }
+
+    TEST_F(AllocationTest, loadMemoryBankIntoRecordDoesntAllocate)
+    {
+        PresetRecord record;
+
+        EXPECT_THAT(countAllocations([&]
+                                     { m.load_memory_bank(3, record); }),
+                    Eq(0));
+        EXPECT_THAT(record, Eq(conn->dump));
+    }
+
+    // The packets of a preset are stored in a table of fixed capacity
+    TEST_F(AllocationTest, decodeSignalChainDoesntAllocate)
+    {
+        auto dump = conn->dump;
+        dump[0][63] = 0x7e;
+        SignalChain chain{};
+
+        EXPECT_THAT(countAllocations([&]
+                                     { chain = decodeSignalChain(dump); }),
+                    Eq(0));
+        EXPECT_THAT(chain.name(), Eq("preset"));
+    }
+
+    TEST_F(AllocationTest, serializeSignalChainDoesntAllocate)
+    {
+        const SignalChain chain = decodeSignalChain(conn->dump);
+        PresetRecord record{};
+
+        EXPECT_THAT(countAllocations([&]
+                                     { record = serializeSignalChain(3, chain); }),
+                    Eq(0));
+        EXPECT_THAT(record, Eq(conn->dump));
+    }
+
+    TEST_F(AllocationTest, tryDecodeSignalChainDoesntAllocateWithoutDiagnostics)
+    {
+        EXPECT_THAT(countAllocations([&]
+                                     { static_cast<void>(tryDecodeSignalChain(conn->dump)); }),
+                    Eq(0));
+    }
+
+    TEST_F(AllocationTest, signalChainCopyAndAccessDontAllocate)
+    {
+        const fx_pedal_settings effect{FxSlot{2}, effects::MONO_DELAY, 1, 2, 3, 4, 5, 6, true};
+        const SignalChain chain{"preset", amp_settings{}, {effect}};
+        std::size_t size{0};
+
+        EXPECT_THAT(countAllocations([&]
+                                     {
+                                         const SignalChain copy{chain};
+                                         size = copy.name().size() + copy.effects().size() + copy.amp().gain; }),
+                    Eq(0));
+        EXPECT_THAT(size, Eq(7));
+    }
+
+    TEST_F(AllocationTest, allocationsAreCounted)
+    {
+        EXPECT_THAT(countAllocations([]
+                                     { std::make_unique<int>(1); }),
+                    Eq(1));
+    }
+}
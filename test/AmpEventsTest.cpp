@@ -0,0 +1,322 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/AmpEvents.h"
+#include "com/PacketSerializer.h"
+#include "mocks/MockConnection.h"
+#include <atomic>
+#include <future>
+#include <thread>
+#include <gmock/gmock.h>
+
+namespace plug::test
+{
+    using namespace plug::com;
+    using namespace testing;
+
+    class AmpEventsTest : public testing::Test
+    {
+    protected:
+        static amp_settings createAmp(std::uint8_t gain)
+        {
+            amp_settings amp{};
+            amp.amp_num = amps::FENDER_57_CHAMP;
+            amp.cabinet = cabinets::cab57DLX;
+            amp.gain = gain;
+            amp.sag = 1;
+            amp.depth = 0x80;
+            amp.usb_gain = 3;
+            return amp;
+        }
+
+        static PacketRawType createNamePacket(std::string_view name)
+        {
+            Header header{};
+            header.setStage(Stage::ready);
+            header.setType(Type::operation);
+            header.setDSP(DSP::opSaveEffectName);
+            NamePayload payload{};
+            payload.setName(name);
+            return Packet<NamePayload>{header, payload}.getBytes();
+        }
+
+        static PacketRawType createEmptyEffectPacket(DSP dsp)
+        {
+            Header header{};
+            header.setStage(Stage::ready);
+            header.setType(Type::data);
+            header.setDSP(dsp);
+            return Packet<EffectPayload>{header, EffectPayload{}}.getBytes();
+        }
+
+        const fx_pedal_settings chorus{FxSlot{1}, effects::SINE_CHORUS, 1, 2, 3, 4, 5, 0, true};
+        const SignalChain chain{"preset", createAmp(10), {chorus}};
+    };
+
+    TEST_F(AmpEventsTest, ampChangeIsDecoded)
+    {
+        AmpEventDecoder decoder{chain};
+        const auto packet = serializeAmpSettings(createAmp(99)).getBytes();
+
+        const auto events = decoder.decode(packet);
+        ASSERT_THAT(events.size(), Eq(1));
+        ASSERT_THAT(std::holds_alternative<amp_settings>(events[0]), IsTrue());
+        EXPECT_THAT(std::get<amp_settings>(events[0]).gain, Eq(99));
+        EXPECT_THAT(std::get<amp_settings>(events[0]).usb_gain, Eq(3));
+        EXPECT_THAT(decoder.decode(packet), IsEmpty());
+    }
+
+    TEST_F(AmpEventsTest, unchangedAmpYieldsNoEvent)
+    {
+        AmpEventDecoder decoder{chain};
+
+        EXPECT_THAT(decoder.decode(serializeAmpSettings(createAmp(10)).getBytes()), IsEmpty());
+        EXPECT_THAT(decoder.decode(serializeAmpSettingsUsbGain(createAmp(10)).getBytes()), IsEmpty());
+    }
+
+    TEST_F(AmpEventsTest, usbGainChangeIsDecoded)
+    {
+        AmpEventDecoder decoder{chain};
+        auto amp = createAmp(10);
+        amp.usb_gain = 77;
+
+        const auto events = decoder.decode(serializeAmpSettingsUsbGain(amp).getBytes());
+        ASSERT_THAT(events.size(), Eq(1));
+        EXPECT_THAT(std::get<amp_settings>(events[0]).usb_gain, Eq(77));
+        EXPECT_THAT(std::get<amp_settings>(events[0]).gain, Eq(10));
+    }
+
+    TEST_F(AmpEventsTest, effectKnobChangeIsDecoded)
+    {
+        AmpEventDecoder decoder{chain};
+        auto changed = chorus;
+        changed.knob3 = 200;
+
+        const auto events = decoder.decode(serializeEffectSettings(changed).getBytes());
+        ASSERT_THAT(events.size(), Eq(1));
+        const auto change = std::get<EffectChange>(events[0]);
+        EXPECT_THAT(change.slot.id(), Eq(1));
+        ASSERT_THAT(change.effect.has_value(), IsTrue());
+        EXPECT_THAT(change.effect->knob3, Eq(200));
+        EXPECT_THAT(decoder.decode(serializeEffectSettings(changed).getBytes()), IsEmpty());
+    }
+
+    TEST_F(AmpEventsTest, removedEffectIsDecoded)
+    {
+        AmpEventDecoder decoder{chain};
+
+        const auto events = decoder.decode(createEmptyEffectPacket(DSP::effect1));
+        ASSERT_THAT(events.size(), Eq(1));
+        EXPECT_THAT(std::get<EffectChange>(events[0]).slot.id(), Eq(1));
+        EXPECT_THAT(std::get<EffectChange>(events[0]).effect.has_value(), IsFalse());
+        EXPECT_THAT(decoder.state().effects(), IsEmpty());
+    }
+
+    TEST_F(AmpEventsTest, movedEffectClearsPreviousSlot)
+    {
+        AmpEventDecoder decoder{chain};
+        auto moved = chorus;
+        moved.slot = FxSlot{5};
+
+        const auto events = decoder.decode(serializeEffectSettings(moved).getBytes());
+        ASSERT_THAT(events.size(), Eq(2));
+        EXPECT_THAT(std::get<EffectChange>(events[0]).slot.id(), Eq(1));
+        EXPECT_THAT(std::get<EffectChange>(events[0]).effect.has_value(), IsFalse());
+        EXPECT_THAT(std::get<EffectChange>(events[1]).slot.id(), Eq(5));
+        EXPECT_THAT(std::get<EffectChange>(events[1]).effect.has_value(), IsTrue());
+    }
+
+    TEST_F(AmpEventsTest, knobTurnedBackAfterLocalEditIsDecoded)
+    {
+        AmpEventDecoder decoder{chain};
+        auto edited = chorus;
+        edited.knob1 = 90;
+        decoder.resync(SignalChain{"preset", createAmp(99), {edited}});
+
+        const auto ampEvents = decoder.decode(serializeAmpSettings(createAmp(10)).getBytes());
+        ASSERT_THAT(ampEvents.size(), Eq(1));
+        EXPECT_THAT(std::get<amp_settings>(ampEvents[0]).gain, Eq(10));
+
+        const auto effectEvents = decoder.decode(serializeEffectSettings(chorus).getBytes());
+        ASSERT_THAT(effectEvents.size(), Eq(1));
+        EXPECT_THAT(std::get<EffectChange>(effectEvents[0]).effect, Optional(chorus));
+    }
+
+    TEST_F(AmpEventsTest, resyncReplacesEffects)
+    {
+        AmpEventDecoder decoder{chain};
+        decoder.resync(SignalChain{"other", createAmp(10), {}});
+
+        EXPECT_THAT(decoder.state().name(), StrEq("other"));
+        EXPECT_THAT(decoder.state().effects(), IsEmpty());
+    }
+
+    TEST_F(AmpEventsTest, presetNameChangeIsDecoded)
+    {
+        AmpEventDecoder decoder{chain};
+
+        const auto events = decoder.decode(createNamePacket("other"));
+        ASSERT_THAT(events.size(), Eq(1));
+        EXPECT_THAT(std::get<PresetNameChange>(events[0]).name, Eq("other"));
+        EXPECT_THAT(decoder.state().name(), Eq("other"));
+    }
+
+    TEST_F(AmpEventsTest, otherPacketsAreIgnored)
+    {
+        AmpEventDecoder decoder{chain};
+        PacketRawType unknownDsp = serializeAmpSettings(createAmp(50)).getBytes();
+        unknownDsp[2] = 0x77;
+
+        EXPECT_THAT(decoder.decode(PacketRawType{}), IsEmpty());
+        EXPECT_THAT(decoder.decode(unknownDsp), IsEmpty());
+        EXPECT_THAT(decoder.decode(serializeApplyCommand().getBytes()), IsEmpty());
+    }
+
+    TEST_F(AmpEventsTest, receiveEventsReadsUntilTimeout)
+    {
+        auto connection = std::make_unique<mock::MockConnection>();
+        auto* conn = connection.get();
+        Mustang m{std::move(connection)};
+        const auto packet = serializeAmpSettings(createAmp(50)).getBytes();
+        const std::vector<std::uint8_t> data{packet.cbegin(), packet.cend()};
+
+        EXPECT_CALL(*conn, receiveWithin(packetRawTypeSize, AmpEventListener::pollTimeout))
+            .WillOnce(Return(data))
+            .WillOnce(Return(data))
+            .WillOnce(Return(std::vector<std::uint8_t>{}));
+
+        EXPECT_THAT(m.receiveEvents(AmpEventListener::pollTimeout), ElementsAre(packet, packet));
+    }
+
+    TEST_F(AmpEventsTest, stateAndAckPacketsAreToldApartByHeader)
+    {
+        EXPECT_THAT(isStatePacket(serializeAmpSettings(createAmp(50)).getBytes()), IsTrue());
+        EXPECT_THAT(isStatePacket(createNamePacket("preset")), IsTrue());
+        EXPECT_THAT(isStatePacket(createEmptyEffectPacket(DSP::effect2)), IsTrue());
+        EXPECT_THAT(isStatePacket(serializeApplyCommand().getBytes()), IsFalse());
+        EXPECT_THAT(isStatePacket(PacketRawType{}), IsFalse());
+    }
+
+    TEST_F(AmpEventsTest, statePacketBeforeAckIsPassedToReceiveEvents)
+    {
+        auto connection = std::make_unique<NiceMock<mock::MockConnection>>();
+        auto* conn = connection.get();
+        Mustang m{std::move(connection)};
+        const auto packet = serializeAmpSettings(createAmp(50)).getBytes();
+        const std::vector<std::uint8_t> ack(packetRawTypeSize, 0x00);
+
+        ON_CALL(*conn, sendImpl(_, _)).WillByDefault(Return(packetRawTypeSize));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize))
+            .Times(5)
+            .WillOnce(Return(std::vector<std::uint8_t>{packet.cbegin(), packet.cend()}))
+            .WillRepeatedly(Return(ack));
+        EXPECT_CALL(*conn, receiveWithin(_, _)).WillOnce(Return(ack)).WillOnce(Return(std::vector<std::uint8_t>{}));
+
+        m.set_amplifier(createAmp(10));
+
+        EXPECT_THAT(m.receiveEvents(AmpEventListener::pollTimeout), ElementsAre(packet));
+    }
+
+    TEST_F(AmpEventsTest, receiveEventsLetsCommandsThroughBetweenPackets)
+    {
+        auto connection = std::make_unique<NiceMock<mock::MockConnection>>();
+        auto* conn = connection.get();
+        Mustang m{std::move(connection)};
+        const auto packet = serializeAmpSettings(createAmp(50)).getBytes();
+        std::atomic<bool> receiving{false};
+        std::atomic<bool> commandDone{false};
+
+        ON_CALL(*conn, sendImpl(_, _)).WillByDefault(Return(packetRawTypeSize));
+        ON_CALL(*conn, receive(_)).WillByDefault(Return(std::vector<std::uint8_t>(packetRawTypeSize, 0x00)));
+        ON_CALL(*conn, receiveWithin(_, _)).WillByDefault([&](auto, auto)
+                                                          {
+            receiving = true;
+
+            if (commandDone == false)
+            {
+                return std::vector<std::uint8_t>{packet.cbegin(), packet.cend()};
+            }
+            return std::vector<std::uint8_t>{}; });
+
+        auto command = std::async(std::launch::async, [&]
+                                  {
+            while (receiving == false)
+            {
+                std::this_thread::yield();
+            }
+            m.set_amplifier(createAmp(10));
+            commandDone = true; });
+
+        EXPECT_THAT(m.receiveEvents(AmpEventListener::pollTimeout), Not(IsEmpty()));
+        command.get();
+    }
+
+    TEST_F(AmpEventsTest, listenerPassesEvents)
+    {
+        auto connection = std::make_unique<NiceMock<mock::MockConnection>>();
+        auto* conn = connection.get();
+        Mustang m{std::move(connection)};
+        const auto packet = serializeAmpSettings(createAmp(50)).getBytes();
+
+        EXPECT_CALL(*conn, receiveWithin(_, _))
+            .WillOnce(Return(std::vector<std::uint8_t>{packet.cbegin(), packet.cend()}))
+            .WillRepeatedly(Return(std::vector<std::uint8_t>{}));
+
+        std::promise<std::vector<AmpEvent>> received;
+        {
+            AmpEventListener listener{m, chain, [&received](const auto& events)
+                                      { received.set_value(events); }};
+            const auto events = received.get_future().get();
+
+            ASSERT_THAT(events.size(), Eq(1));
+            EXPECT_THAT(std::get<amp_settings>(events[0]).gain, Eq(50));
+        }
+    }
+
+    TEST_F(AmpEventsTest, listenerComparesWithResyncedState)
+    {
+        auto connection = std::make_unique<NiceMock<mock::MockConnection>>();
+        auto* conn = connection.get();
+        Mustang m{std::move(connection)};
+        const auto packet = serializeAmpSettings(createAmp(10)).getBytes();
+        std::atomic<bool> resynced{false};
+        std::atomic<bool> sent{false};
+
+        ON_CALL(*conn, receiveWithin(_, _)).WillByDefault([&](auto, auto)
+                                                          {
+            if (resynced && (sent.exchange(true) == false))
+            {
+                return std::vector<std::uint8_t>{packet.cbegin(), packet.cend()};
+            }
+            return std::vector<std::uint8_t>{}; });
+
+        std::promise<std::vector<AmpEvent>> received;
+        {
+            AmpEventListener listener{m, chain, [&received](const auto& events)
+                                      { received.set_value(events); }};
+            listener.resync(SignalChain{"preset", createAmp(99), {chorus}});
+            resynced = true;
+            const auto events = received.get_future().get();
+
+            ASSERT_THAT(events.size(), Eq(1));
+            EXPECT_THAT(std::get<amp_settings>(events[0]).gain, Eq(10));
+        }
+    }
+}
@@ -0,0 +1,104 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "library/BankConversion.h"
+#include "library/FuseFormat.h"
+#include "com/PresetBank.h"
+#include <gmock/gmock.h>
+#include <filesystem>
+
+namespace plug::test
+{
+    using namespace plug::library;
+    using namespace testing;
+    namespace fs = std::filesystem;
+
+    class BankConversionTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            directory = fs::temp_directory_path() / ("plug-conversion-test-" + std::string{::testing::UnitTest::GetInstance()->current_test_info()->name()});
+            fs::create_directories(directory / "out");
+            bankFile = (directory / "presets.plugbank").string();
+        }
+
+        void TearDown() override
+        {
+            fs::remove_all(directory);
+        }
+
+        std::string writePreset(const std::string& fileName, const std::string& name, amps model)
+        {
+            amp_settings amp{};
+            amp.amp_num = model;
+            amp.treble = 0x42;
+            const std::vector<fx_pedal_settings> effects{fx_pedal_settings{FxSlot{2}, effects::STEP_FILTER, 1, 2, 3, 4, 5, 0, true}};
+            const auto path = (directory / fileName).string();
+            saveFuseFile(path, SignalChain{name, amp, effects});
+            return path;
+        }
+
+        fs::path directory;
+        std::string bankFile;
+    };
+
+    TEST_F(BankConversionTest, fuseToBank)
+    {
+        fuseToBank({writePreset("b.fuse", "Second", amps::METAL_2000), writePreset("a.fuse", "First", amps::BRITISH_60S)}, bankFile);
+
+        const com::MappedBank bank{bankFile};
+        ASSERT_THAT(bank.size(), Eq(2));
+        EXPECT_THAT(bank.name(0), StrEq("Second"));
+        EXPECT_THAT(bank.decode(0).amp().amp_num, Eq(amps::METAL_2000));
+        EXPECT_THAT(bank.decode(1).amp().treble, Eq(0x42));
+        EXPECT_THAT(bank.decode(1).effects()[1].effect_num, Eq(effects::STEP_FILTER));
+    }
+
+    TEST_F(BankConversionTest, fuseToBankThrowsOnInvalidFile)
+    {
+        EXPECT_THROW(fuseToBank({(directory / "missing.fuse").string()}, bankFile), std::runtime_error);
+    }
+
+    TEST_F(BankConversionTest, fuseToBankThrowsOnMoreFilesThanSlots)
+    {
+        const std::vector<std::string> files(com::bank::maxRecords + 1, writePreset("a.fuse", "First", amps::BRITISH_60S));
+        EXPECT_THROW(fuseToBank(files, bankFile), std::invalid_argument);
+        EXPECT_THAT(fs::exists(bankFile), IsFalse());
+    }
+
+    TEST_F(BankConversionTest, bankToFuse)
+    {
+        fuseToBank({writePreset("b.fuse", "Second", amps::METAL_2000), writePreset("a.fuse", "A/B: test", amps::BRITISH_60S)}, bankFile);
+
+        const auto files = bankToFuse(bankFile, (directory / "out").string());
+        ASSERT_THAT(files.size(), Eq(2));
+        EXPECT_THAT(fs::path{files[0]}.filename().string(), StrEq("001 Second.fuse"));
+        EXPECT_THAT(fs::path{files[1]}.filename().string(), StrEq("002 A_B_ test.fuse"));
+
+        const auto chain = loadFuseFile(files[1]);
+        EXPECT_THAT(chain.name(), StrEq("A/B: test"));
+        EXPECT_THAT(chain.amp().amp_num, Eq(amps::BRITISH_60S));
+        EXPECT_THAT(chain.amp().treble, Eq(0x42));
+        ASSERT_THAT(chain.effects().size(), Eq(1));
+        EXPECT_THAT(chain.effects()[0].effect_num, Eq(effects::STEP_FILTER));
+        EXPECT_THAT(chain.effects()[0].knob5, Eq(5));
+    }
+}
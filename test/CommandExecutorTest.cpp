@@ -0,0 +1,201 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "com/CommandExecutor.h"
+#include "com/CommunicationException.h"
+#include "com/Mustang.h"
+#include "com/PacketSerializer.h"
+#include "mocks/MockConnection.h"
+#include <gmock/gmock.h>
+#include <thread>
+
+namespace plug::test
+{
+    using namespace plug::com;
+    using namespace testing;
+
+    class CommandExecutorTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            connection = std::make_unique<NiceMock<mock::MockConnection>>();
+            conn = connection.get();
+            ON_CALL(*conn, receive(_)).WillByDefault(Return(std::vector<std::uint8_t>(packetRawTypeSize)));
+        }
+
+        static amp_settings createAmp(std::uint8_t gain)
+        {
+            amp_settings amp{};
+            amp.amp_num = amps::FENDER_57_CHAMP;
+            amp.gain = gain;
+            return amp;
+        }
+
+        std::unique_ptr<NiceMock<mock::MockConnection>> connection;
+        NiceMock<mock::MockConnection>* conn;
+    };
+
+    TEST_F(CommandExecutorTest, operationResultIsDelivered)
+    {
+        EXPECT_CALL(*conn, name()).WillOnce(Return("mustang"));
+        CommandExecutor executor{std::move(connection)};
+
+        auto result = executor.submit(Priority::normal, [](Connection& c)
+                                      { return c.name(); });
+
+        EXPECT_THAT(result.get(), Eq("mustang"));
+    }
+
+    TEST_F(CommandExecutorTest, operationExceptionIsDelivered)
+    {
+        CommandExecutor executor{std::move(connection)};
+
+        auto result = executor.submit(Priority::normal, [](Connection&)
+                                      { throw CommunicationException{"failed"}; });
+
+        EXPECT_THROW(result.get(), CommunicationException);
+    }
+
+    TEST_F(CommandExecutorTest, runReturnsResult)
+    {
+        EXPECT_CALL(*conn, modelVersion()).WillOnce(Return(ModelVersion::v2));
+        CommandExecutor executor{std::move(connection)};
+
+        EXPECT_THAT(executor.run(Priority::interactive, [](Connection& c)
+                                 { return c.modelVersion(); }),
+                    Eq(ModelVersion::v2));
+    }
+
+    TEST_F(CommandExecutorTest, runRethrowsException)
+    {
+        CommandExecutor executor{std::move(connection)};
+
+        EXPECT_THROW(executor.run(Priority::interactive, [](Connection&)
+                                  { throw CommunicationException{"failed"}; }),
+                     CommunicationException);
+    }
+
+    TEST_F(CommandExecutorTest, operationRunsOnWorkerThread)
+    {
+        CommandExecutor executor{std::move(connection)};
+
+        const auto worker = executor.run(Priority::normal, [](Connection&)
+                                         { return std::this_thread::get_id(); });
+
+        EXPECT_THAT(worker, Ne(std::this_thread::get_id()));
+    }
+
+    TEST_F(CommandExecutorTest, operationRunByOperationRunsRightAway)
+    {
+        CommandExecutor executor{std::move(connection)};
+
+        const auto result = executor.run(Priority::bulk, [&executor](Connection&)
+                                         { return executor.run(Priority::interactive, [](Connection&)
+                                                               { return 3; }); });
+
+        EXPECT_THAT(result, Eq(3));
+    }
+
+    TEST_F(CommandExecutorTest, higherPriorityRunsFirst)
+    {
+        std::vector<char> order;
+        std::promise<void> unblock;
+        auto blocked = unblock.get_future().share();
+        {
+            CommandExecutor executor{std::move(connection)};
+            executor.submit(Priority::normal, [blocked](Connection&)
+                            { blocked.wait(); });
+            executor.submit(Priority::bulk, [&order](Connection&)
+                            { order.push_back('b'); });
+            executor.submit(Priority::normal, [&order](Connection&)
+                            { order.push_back('n'); });
+            executor.submit(Priority::interactive, [&order](Connection&)
+                            { order.push_back('i'); });
+            executor.submit(Priority::interactive, [&order](Connection&)
+                            { order.push_back('j'); });
+            unblock.set_value();
+        }
+
+        EXPECT_THAT(order, ElementsAre('i', 'j', 'n', 'b'));
+    }
+
+    TEST_F(CommandExecutorTest, pendingOperationsRunBeforeDestruction)
+    {
+        std::size_t count{0};
+        {
+            CommandExecutor executor{std::move(connection)};
+
+            for (std::size_t i = 0; i < 10; ++i)
+            {
+                executor.submit(Priority::bulk, [&count](Connection&)
+                                { ++count; });
+            }
+        }
+
+        EXPECT_THAT(count, Eq(10));
+    }
+
+    TEST_F(CommandExecutorTest, rejectsMissingConnection)
+    {
+        EXPECT_THROW(CommandExecutor{nullptr}, std::invalid_argument);
+    }
+
+    TEST_F(CommandExecutorTest, mustangOperationsFromSeveralThreadsDontInterleave)
+    {
+        std::vector<std::uint8_t> sent;
+        ON_CALL(*conn, sendImpl(_, _)).WillByDefault([&sent](std::uint8_t* data, std::size_t size)
+                                                    { sent.push_back(data[16]); return size; });
+        constexpr std::size_t operationsPerThread{20};
+        {
+            Mustang m{std::move(connection)};
+            std::vector<std::thread> threads;
+
+            for (std::uint8_t id = 1; id <= 4; ++id)
+            {
+                threads.emplace_back([&m, id]
+                                     {
+                                         for (std::size_t i = 0; i < operationsPerThread; ++i)
+                                         {
+                                             m.set_amplifier(createAmp(id));
+                                         } });
+            }
+
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+        }
+
+        const auto ampPacket = [](std::uint8_t id)
+        { return serializeAmpSettings(createAmp(id)).getBytes()[16]; };
+        const auto apply = serializeApplyCommand().getBytes()[16];
+        const auto gain = serializeAmpSettingsUsbGain(createAmp(0)).getBytes()[16];
+
+        ASSERT_THAT(sent.size(), Eq(4 * operationsPerThread * 4));
+
+        for (std::size_t i = 0; i < sent.size(); i += 4)
+        {
+            EXPECT_THAT(sent[i], AnyOf(ampPacket(1), ampPacket(2), ampPacket(3), ampPacket(4)));
+            EXPECT_THAT(sent[i + 1], Eq(apply));
+            EXPECT_THAT(sent[i + 2], Eq(gain));
+            EXPECT_THAT(sent[i + 3], Eq(apply));
+        }
+    }
+}
@@ -0,0 +1,144 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/CommandScheduler.h"
+#include <gmock/gmock.h>
+#include <thread>
+
+namespace plug::test
+{
+    using namespace plug::com;
+    using namespace testing;
+
+    class CommandSchedulerTest : public testing::Test
+    {
+    protected:
+        void waitUntilWaiting(Priority priority, std::size_t count)
+        {
+            while (scheduler.waiting(priority) != count)
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        std::thread startWaiter(Priority priority, char id)
+        {
+            return std::thread{[this, priority, id]
+                               {
+                                   const auto lease = scheduler.acquire(priority);
+                                   std::lock_guard lock{mutex};
+                                   order.push_back(id);
+                               }};
+        }
+
+        CommandScheduler scheduler;
+        std::mutex mutex;
+        std::vector<char> order;
+    };
+
+    TEST_F(CommandSchedulerTest, leaseIsExclusive)
+    {
+        std::thread waiter;
+        {
+            const auto lease = scheduler.acquire(Priority::bulk);
+            waiter = startWaiter(Priority::interactive, 'i');
+            waitUntilWaiting(Priority::interactive, 1);
+            EXPECT_THAT(order, IsEmpty());
+        }
+        waiter.join();
+
+        EXPECT_THAT(order, ElementsAre('i'));
+        EXPECT_THAT(scheduler.waiting(Priority::interactive), Eq(0));
+    }
+
+    TEST_F(CommandSchedulerTest, higherPriorityIsServedFirst)
+    {
+        std::vector<std::thread> waiters;
+        {
+            const auto lease = scheduler.acquire(Priority::normal);
+            waiters.push_back(startWaiter(Priority::bulk, 'b'));
+            waitUntilWaiting(Priority::bulk, 1);
+            waiters.push_back(startWaiter(Priority::normal, 'n'));
+            waitUntilWaiting(Priority::normal, 1);
+            waiters.push_back(startWaiter(Priority::interactive, 'i'));
+            waitUntilWaiting(Priority::interactive, 1);
+        }
+
+        for (auto& waiter : waiters)
+        {
+            waiter.join();
+        }
+        EXPECT_THAT(order, ElementsAre('i', 'n', 'b'));
+    }
+
+    TEST_F(CommandSchedulerTest, samePriorityIsServedInOrder)
+    {
+        std::vector<std::thread> waiters;
+        {
+            const auto lease = scheduler.acquire(Priority::interactive);
+
+            for (const char id : {'1', '2', '3'})
+            {
+                waiters.push_back(startWaiter(Priority::bulk, id));
+                waitUntilWaiting(Priority::bulk, waiters.size());
+            }
+        }
+
+        for (auto& waiter : waiters)
+        {
+            waiter.join();
+        }
+        EXPECT_THAT(order, ElementsAre('1', '2', '3'));
+    }
+
+    TEST_F(CommandSchedulerTest, bulkBatchesGiveWayToInteractiveCommands)
+    {
+        std::thread interactive;
+
+        for (std::size_t batch = 0; batch < 3; ++batch)
+        {
+            const auto lease = scheduler.acquire(Priority::bulk);
+            {
+                std::lock_guard lock{mutex};
+                order.push_back('b');
+            }
+
+            if (batch == 0)
+            {
+                interactive = startWaiter(Priority::interactive, 'i');
+                waitUntilWaiting(Priority::interactive, 1);
+            }
+        }
+        interactive.join();
+
+        EXPECT_THAT(order, ElementsAre('b', 'i', 'b', 'b'));
+    }
+
+    TEST_F(CommandSchedulerTest, movedLeaseReleasesOnce)
+    {
+        {
+            auto lease = scheduler.acquire(Priority::normal);
+            const auto moved = std::move(lease);
+        }
+
+        const auto lease = scheduler.acquire(Priority::normal);
+        EXPECT_THAT(scheduler.waiting(Priority::normal), Eq(0));
+    }
+}
@@ -0,0 +1,174 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "library/Deduplication.h"
+#include "library/PresetHash.h"
+#include "helper/SignalChains.h"
+#include <gmock/gmock.h>
+#include <filesystem>
+#include <fstream>
+
+namespace plug::test
+{
+    using namespace plug::library;
+    using namespace testing;
+
+    namespace
+    {
+        LibraryEntry createEntry(const SignalChain& chain, std::uint64_t contentHash, bool valid = true)
+        {
+            return LibraryEntry{"", 0, 0, contentHash, valid, chain};
+        }
+
+        constexpr fx_pedal_settings overdrive{FxSlot{0}, effects::OVERDRIVE, 1, 2, 3, 4, 5, 6, true};
+        constexpr fx_pedal_settings delay{FxSlot{2}, effects::MONO_DELAY, 6, 5, 4, 3, 2, 1, true};
+        constexpr fx_pedal_settings empty{FxSlot{1}, effects::EMPTY, 0, 0, 0, 0, 0, 0, true};
+    }
+
+
+    class DeduplicationTest : public testing::Test
+    {
+    protected:
+        // Entries with the same content hash have the same content
+        static std::vector<DuplicateGroup> duplicates(const std::vector<LibraryEntry>& entries)
+        {
+            return findDuplicates(entries, [](const auto&, const auto&)
+                                  { return true; });
+        }
+
+        static std::string writeFile(const std::string& suffix, const std::string& content)
+        {
+            const auto path = (std::filesystem::temp_directory_path() / ("plug-dedup-test-" + std::string{::testing::UnitTest::GetInstance()->current_test_info()->name()} + suffix)).string();
+            std::ofstream{path, std::ios::binary} << content;
+            return path;
+        }
+    };
+
+    TEST_F(DeduplicationTest, hashBytes)
+    {
+        static_assert(hashBytes("") == 0xcbf29ce484222325);
+        static_assert(hashBytes("a") == 0xaf63dc4c8601ec8c);
+        EXPECT_THAT(hashBytes("abc"), Ne(hashBytes("acb")));
+    }
+
+    TEST_F(DeduplicationTest, canonicalizeIgnoresNameAndEffectOrder)
+    {
+        const auto chain = createChain("a", 10, {overdrive, delay});
+        EXPECT_THAT(canonicalize(createChain("b", 10, {delay, overdrive})), Eq(canonicalize(chain)));
+        EXPECT_THAT(hashSignalChain(createChain("b", 10, {delay, empty, overdrive})), Eq(hashSignalChain(chain)));
+    }
+
+    TEST_F(DeduplicationTest, canonicalizeDistinguishesSettings)
+    {
+        const auto chain = createChain("a", 10, {overdrive});
+        auto otherKnob = overdrive;
+        otherKnob.knob5 = 7;
+
+        EXPECT_THAT(canonicalize(createChain("a", 11, {overdrive})), Ne(canonicalize(chain)));
+        EXPECT_THAT(canonicalize(createChain("a", 10, {otherKnob})), Ne(canonicalize(chain)));
+        EXPECT_THAT(canonicalize(createChain("a", 10)), Ne(canonicalize(chain)));
+    }
+
+    TEST_F(DeduplicationTest, canonicalizeIgnoresUnusedKnobs)
+    {
+        auto otherKnob = overdrive;
+        otherKnob.knob6 = 7;
+        const fx_pedal_settings compressor{FxSlot{0}, effects::SIMPLE_COMP, 1, 0, 0, 0, 0, 0, true};
+        const fx_pedal_settings compressorKnobs{FxSlot{0}, effects::SIMPLE_COMP, 1, 2, 3, 4, 5, 6, true};
+        const fx_pedal_settings tapeDelay{FxSlot{2}, effects::TAPE_DELAY, 1, 2, 3, 4, 5, 0, true};
+        const fx_pedal_settings tapeDelayKnob{FxSlot{2}, effects::TAPE_DELAY, 1, 2, 3, 4, 5, 6, true};
+
+        EXPECT_THAT(canonicalize(createChain("a", 10, {otherKnob})), Eq(canonicalize(createChain("a", 10, {overdrive}))));
+        EXPECT_THAT(canonicalize(createChain("a", 10, {compressorKnobs})), Eq(canonicalize(createChain("a", 10, {compressor}))));
+        EXPECT_THAT(canonicalize(createChain("a", 10, {tapeDelayKnob})), Ne(canonicalize(createChain("a", 10, {tapeDelay}))));
+    }
+
+    TEST_F(DeduplicationTest, noDuplicates)
+    {
+        EXPECT_THAT(duplicates({}), IsEmpty());
+        EXPECT_THAT(duplicates({createEntry(createChain("a", 1), 1), createEntry(createChain("a", 2), 2)}), IsEmpty());
+    }
+
+    TEST_F(DeduplicationTest, groupsIdenticalFiles)
+    {
+        const auto groups = duplicates({createEntry(createChain("a", 1), 1), createEntry(createChain("b", 2), 2), createEntry(createChain("a", 1), 1)});
+
+        ASSERT_THAT(groups.size(), Eq(1));
+        EXPECT_THAT(groups[0].identical, IsTrue());
+        EXPECT_THAT(groups[0].hash, Eq(hashSignalChain(createChain("a", 1))));
+        EXPECT_THAT(groups[0].entries, ElementsAre(0, 2));
+    }
+
+    TEST_F(DeduplicationTest, groupsEquivalentPresets)
+    {
+        const auto groups = duplicates({createEntry(createChain("a", 1, {overdrive, delay}), 1),
+                                            createEntry(createChain("b", 2), 2),
+                                            createEntry(createChain("c", 2), 3),
+                                            createEntry(createChain("d", 1, {delay, overdrive}), 4)});
+
+        ASSERT_THAT(groups.size(), Eq(2));
+        EXPECT_THAT(groups[0].identical, IsFalse());
+        EXPECT_THAT(groups[0].entries, ElementsAre(0, 3));
+        EXPECT_THAT(groups[1].identical, IsFalse());
+        EXPECT_THAT(groups[1].entries, ElementsAre(1, 2));
+    }
+
+    TEST_F(DeduplicationTest, groupsInvalidFilesByContent)
+    {
+        const auto groups = duplicates({createEntry(SignalChain{}, 7, false), createEntry(SignalChain{}, 8, false),
+                                            createEntry(SignalChain{}, 7, false), createEntry(SignalChain{}, 8)});
+
+        ASSERT_THAT(groups.size(), Eq(1));
+        EXPECT_THAT(groups[0].identical, IsTrue());
+        EXPECT_THAT(groups[0].hash, Eq(7));
+        EXPECT_THAT(groups[0].entries, ElementsAre(0, 2));
+    }
+
+    TEST_F(DeduplicationTest, hashCollisionIsNotIdentical)
+    {
+        const auto distinct = [](const auto&, const auto&)
+        { return false; };
+        const auto groups = findDuplicates({createEntry(createChain("a", 1), 1), createEntry(createChain("b", 1), 1),
+                                            createEntry(SignalChain{}, 7, false), createEntry(SignalChain{}, 7, false)},
+                                           distinct);
+
+        ASSERT_THAT(groups.size(), Eq(1));
+        EXPECT_THAT(groups[0].identical, IsFalse());
+        EXPECT_THAT(groups[0].entries, ElementsAre(0, 1));
+    }
+
+    TEST_F(DeduplicationTest, sameFileContentComparesBytes)
+    {
+        const auto first = writeFile("-1.fuse", "<Preset>a</Preset>");
+        const auto copy = writeFile("-2.fuse", "<Preset>a</Preset>");
+        const auto other = writeFile("-3.fuse", "<Preset>b</Preset>");
+        const auto entry = [](const std::string& path)
+        { return LibraryEntry{path, std::filesystem::file_size(path), 0, 1, true, SignalChain{}}; };
+
+        EXPECT_THAT(sameFileContent(entry(first), entry(copy)), IsTrue());
+        EXPECT_THAT(sameFileContent(entry(first), entry(other)), IsFalse());
+        EXPECT_THAT(sameFileContent(entry(first), LibraryEntry{"/nonexistent/a.fuse", 18, 0, 1, true, SignalChain{}}), IsFalse());
+
+        for (const auto& path : {first, copy, other})
+        {
+            std::filesystem::remove(path);
+        }
+    }
+}
@@ -0,0 +1,174 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/EditHistory.h"
+#include "helper/SignalChains.h"
+#include <gmock/gmock.h>
+
+namespace plug::test
+{
+    using namespace plug::com;
+    using namespace testing;
+
+    class EditHistoryTest : public testing::Test
+    {
+    protected:
+        EditHistory history;
+        const fx_pedal_settings chorus{FxSlot{1}, effects::SINE_CHORUS, 10, 20, 30, 40, 50, 0, true};
+        const fx_pedal_settings delay{FxSlot{5}, effects::MONO_DELAY, 1, 2, 3, 4, 5, 6, true};
+    };
+
+    TEST_F(EditHistoryTest, emptyHistoryHasNothingToUndoOrRedo)
+    {
+        EXPECT_THAT(history.canUndo(), IsFalse());
+        EXPECT_THAT(history.canRedo(), IsFalse());
+        EXPECT_THAT(history.undo(createChain("chain", 1)), Eq(std::nullopt));
+        EXPECT_THAT(history.redo(createChain("chain", 1)), Eq(std::nullopt));
+    }
+
+    TEST_F(EditHistoryTest, undoAndRedoStep)
+    {
+        const auto before = createChain("chain", 10, {chorus});
+        auto changedChorus = chorus;
+        changedChorus.knob3 = 99;
+        const auto after = createChain("chain", 20, {changedChorus, delay});
+        history.record(before, after);
+
+        const auto undone = history.undo(after);
+        ASSERT_THAT(undone, Ne(std::nullopt));
+        EXPECT_THAT(undone->amp(), Eq(before.amp()));
+        EXPECT_THAT(undone->effects(), Eq(before.effects()));
+        EXPECT_THAT(undone->name(), Eq("chain"));
+        EXPECT_THAT(history.canUndo(), IsFalse());
+
+        const auto redone = history.redo(*undone);
+        ASSERT_THAT(redone, Ne(std::nullopt));
+        EXPECT_THAT(redone->amp(), Eq(after.amp()));
+        EXPECT_THAT(redone->effects(), Eq(after.effects()));
+        EXPECT_THAT(history.canRedo(), IsFalse());
+    }
+
+    TEST_F(EditHistoryTest, undoRevertsOnlyChangedFields)
+    {
+        history.record(createChain("chain", 10), createChain("chain", 20));
+        auto current = createChain("chain", 20, {delay});
+
+        const auto undone = history.undo(current);
+        ASSERT_THAT(undone, Ne(std::nullopt));
+        EXPECT_THAT(undone->amp().gain, Eq(10));
+        EXPECT_THAT(undone->effects(), Eq(EffectList{delay}));
+    }
+
+    TEST_F(EditHistoryTest, undoRemovesAddedEffect)
+    {
+        history.record(createChain("chain", 10), createChain("chain", 10, {chorus}));
+
+        const auto undone = history.undo(createChain("chain", 10, {chorus}));
+        ASSERT_THAT(undone, Ne(std::nullopt));
+        EXPECT_THAT(undone->effects().empty(), IsTrue());
+    }
+
+    TEST_F(EditHistoryTest, undoKeepsUnknownIds)
+    {
+        auto unknownChorus = chorus;
+        unknownChorus.unknownModel = 0xee;
+        auto amp = createChain("chain", 10).amp();
+        amp.unknownModel = 0x7f;
+        const SignalChain before{"chain", amp, {unknownChorus}};
+        history.record(before, createChain("chain", 20));
+
+        const auto undone = history.undo(createChain("chain", 20));
+        ASSERT_THAT(undone, Ne(std::nullopt));
+        EXPECT_THAT(undone->amp(), Eq(amp));
+        EXPECT_THAT(undone->effects(), ElementsAre(unknownChorus));
+    }
+
+    TEST_F(EditHistoryTest, stepsAreUndoneInReverseOrder)
+    {
+        history.record(createChain("chain", 1), createChain("chain", 2));
+        history.record(createChain("chain", 2), createChain("chain", 3));
+        history.record(createChain("chain", 3), createChain("chain", 4));
+
+        auto current = createChain("chain", 4);
+        current = *history.undo(current);
+        EXPECT_THAT(current.amp().gain, Eq(3));
+        current = *history.undo(current);
+        EXPECT_THAT(current.amp().gain, Eq(2));
+        current = *history.redo(current);
+        EXPECT_THAT(current.amp().gain, Eq(3));
+    }
+
+    TEST_F(EditHistoryTest, unchangedToneIsNotRecorded)
+    {
+        history.record(createChain("chain", 1), SignalChain{"other name", createChain("chain", 1).amp(), {}});
+        EXPECT_THAT(history.canUndo(), IsFalse());
+    }
+
+    TEST_F(EditHistoryTest, emptyEffectsAreEqualToNoEffect)
+    {
+        const fx_pedal_settings empty{FxSlot{3}, effects::EMPTY, 0, 0, 0, 0, 0, 0, true};
+        history.record(createChain("chain", 1), createChain("chain", 1, {empty}));
+        EXPECT_THAT(history.canUndo(), IsFalse());
+    }
+
+    TEST_F(EditHistoryTest, recordAfterUndoDiscardsRedo)
+    {
+        history.record(createChain("chain", 1), createChain("chain", 2));
+        history.undo(createChain("chain", 2));
+        history.record(createChain("chain", 1), createChain("chain", 5));
+
+        EXPECT_THAT(history.canRedo(), IsFalse());
+        EXPECT_THAT(history.undo(createChain("chain", 5))->amp().gain, Eq(1));
+        EXPECT_THAT(history.canUndo(), IsFalse());
+    }
+
+    TEST_F(EditHistoryTest, fullHistoryDropsOldestSteps)
+    {
+        const std::size_t steps = EditHistory::capacity + 10;
+        for (std::size_t i = 0; i < steps; ++i)
+        {
+            history.record(createChain("chain", static_cast<std::uint8_t>(i)), createChain("chain", static_cast<std::uint8_t>(i + 1)));
+        }
+
+        auto current = createChain("chain", static_cast<std::uint8_t>(steps));
+        std::size_t undone{0};
+
+        while (const auto previous = history.undo(current))
+        {
+            current = *previous;
+            ++undone;
+        }
+        EXPECT_THAT(undone, Eq(EditHistory::capacity));
+        EXPECT_THAT(current.amp().gain, Eq(static_cast<std::uint8_t>(10)));
+    }
+
+    TEST_F(EditHistoryTest, historyIsCompact)
+    {
+        EXPECT_THAT(sizeof(EditHistory), Le(EditHistory::capacity * 3 + 64));
+    }
+
+    TEST_F(EditHistoryTest, clearRemovesAllSteps)
+    {
+        history.record(createChain("chain", 1), createChain("chain", 2));
+        history.clear();
+        EXPECT_THAT(history.canUndo(), IsFalse());
+        EXPECT_THAT(history.canRedo(), IsFalse());
+    }
+}
@@ -0,0 +1,238 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "library/FuseFormat.h"
+#include <gmock/gmock.h>
+
+namespace plug::test
+{
+    using namespace plug::library;
+    using namespace testing;
+
+    namespace
+    {
+        constexpr std::string_view document{R"(<?xml version="1.0" encoding="UTF-8"?>
+<Preset amplifier="Mustang I/II" ProductId="1">
+    <Amplifier>
+        <Module ID="94" POS="0" BypassState="1">
+            <Param ControlIndex="0">25700</Param>
+            <Param ControlIndex="1">51400</Param>
+            <Param ControlIndex="2">0</Param>
+            <Param ControlIndex="3">32896</Param>
+            <Param ControlIndex="4">257</Param>
+            <Param ControlIndex="5">514</Param>
+            <Param ControlIndex="6">771</Param>
+            <Param ControlIndex="7">1028</Param>
+            <Param ControlIndex="8">32896</Param>
+            <Param ControlIndex="9">1285</Param>
+            <Param ControlIndex="10">1542</Param>
+            <Param ControlIndex="15">2</Param>
+            <Param ControlIndex="16">7</Param>
+            <Param ControlIndex="17">6</Param>
+            <Param ControlIndex="19">1</Param>
+            <Param ControlIndex="20">1</Param>
+        </Module>
+    </Amplifier>
+    <FX>
+        <Stompbox ID="1">
+            <Module ID="60" POS="1" BypassState="1">
+                <Param ControlIndex="0">2570</Param>
+                <Param ControlIndex="1">5140</Param>
+                <Param ControlIndex="2">7710</Param>
+                <Param ControlIndex="3">10280</Param>
+                <Param ControlIndex="4">12850</Param>
+            </Module>
+        </Stompbox>
+        <Modulation ID="2">
+            <Module ID="0" POS="0" BypassState="1"></Module>
+        </Modulation>
+        <Delay ID="3">
+            <Module ID="0" POS="0" BypassState="1"/>
+        </Delay>
+        <Reverb ID="4">
+            <Module ID="58" POS="6" BypassState="1">
+                <Param ControlIndex="0">65535</Param>
+            </Module>
+        </Reverb>
+    </FX>
+    <!-- <UsbGain>1</UsbGain> -->
+    <FUSE>
+        <Info name="Rock &amp; Roll &quot;1&quot;" author="" rating="0" genre1="-1" genre2="-1" genre3="-1" tags="" fenderid="0"></Info>
+    </FUSE>
+    <UsbGain>9</UsbGain>
+</Preset>
+)"};
+    }
+
+
+    class FuseFormatTest : public testing::Test
+    {
+    protected:
+        static std::string withName(std::string_view name)
+        {
+            std::string text{document};
+            const std::string_view original{"Rock &amp; Roll &quot;1&quot;"};
+            return text.replace(text.find(original), original.size(), name);
+        }
+    };
+
+    TEST_F(FuseFormatTest, parseName)
+    {
+        EXPECT_THAT(parseFuse(document).name(), Eq("Rock & Roll \"1\""));
+    }
+
+    TEST_F(FuseFormatTest, parseNameWithCharacterReferences)
+    {
+        EXPECT_THAT(parseFuse(withName("Caf&#233; &#x20AC;&#x1F3B8;")).name(), Eq("Caf\xc3\xa9 \xe2\x82\xac\xf0\x9f\x8e\xb8"));
+    }
+
+    TEST_F(FuseFormatTest, parseThrowsOnMalformedCharacterReference)
+    {
+        EXPECT_THROW(parseFuse(withName("&#;")), std::invalid_argument);
+        EXPECT_THROW(parseFuse(withName("&#x;")), std::invalid_argument);
+        EXPECT_THROW(parseFuse(withName("&#12a;")), std::invalid_argument);
+        EXPECT_THROW(parseFuse(withName("&#0;")), std::invalid_argument);
+        EXPECT_THROW(parseFuse(withName("&#xD800;")), std::invalid_argument);
+        EXPECT_THROW(parseFuse(withName("&#x110000;")), std::invalid_argument);
+        EXPECT_THROW(parseFuse(withName("&#99999999999;")), std::invalid_argument);
+    }
+
+    TEST_F(FuseFormatTest, parseAmp)
+    {
+        const auto amp = parseFuse(document).amp();
+        EXPECT_THAT(amp.amp_num, Eq(amps::BRITISH_80S));
+        EXPECT_THAT(amp.volume, Eq(100));
+        EXPECT_THAT(amp.gain, Eq(200));
+        EXPECT_THAT(amp.gain2, Eq(0));
+        EXPECT_THAT(amp.master_vol, Eq(128));
+        EXPECT_THAT(amp.treble, Eq(1));
+        EXPECT_THAT(amp.middle, Eq(2));
+        EXPECT_THAT(amp.bass, Eq(3));
+        EXPECT_THAT(amp.presence, Eq(4));
+        EXPECT_THAT(amp.depth, Eq(5));
+        EXPECT_THAT(amp.bias, Eq(6));
+        EXPECT_THAT(amp.noise_gate, Eq(2));
+        EXPECT_THAT(amp.threshold, Eq(7));
+        EXPECT_THAT(amp.cabinet, Eq(cabinets::cab4x12M));
+        EXPECT_THAT(amp.sag, Eq(1));
+        EXPECT_THAT(amp.brightness, IsTrue());
+        EXPECT_THAT(amp.usb_gain, Eq(9));
+    }
+
+    TEST_F(FuseFormatTest, parseEffects)
+    {
+        const auto effects = parseFuse(document).effects();
+        ASSERT_THAT(effects.size(), Eq(2));
+
+        EXPECT_THAT(effects[0].effect_num, Eq(effects::OVERDRIVE));
+        EXPECT_THAT(effects[0].slot.id(), Eq(1));
+        EXPECT_THAT(effects[0].knob1, Eq(10));
+        EXPECT_THAT(effects[0].knob2, Eq(20));
+        EXPECT_THAT(effects[0].knob3, Eq(30));
+        EXPECT_THAT(effects[0].knob4, Eq(40));
+        EXPECT_THAT(effects[0].knob5, Eq(50));
+        EXPECT_THAT(effects[0].knob6, Eq(0));
+        EXPECT_THAT(effects[0].enabled, IsTrue());
+
+        EXPECT_THAT(effects[1].effect_num, Eq(effects::LARGE_HALL_REVERB));
+        EXPECT_THAT(effects[1].slot.id(), Eq(6));
+        EXPECT_THAT(effects[1].knob1, Eq(255));
+    }
+
+    TEST_F(FuseFormatTest, parsePresetWithoutEffects)
+    {
+        const auto chain = parseFuse(R"(<Preset><Amplifier><Module ID="103" POS="0"/></Amplifier><FX></FX></Preset>)");
+        EXPECT_THAT(chain.name(), IsEmpty());
+        EXPECT_THAT(chain.amp().amp_num, Eq(amps::FENDER_57_DELUXE));
+        EXPECT_THAT(chain.effects(), IsEmpty());
+    }
+
+    TEST_F(FuseFormatTest, parseThrowsOnNonFuseDocument)
+    {
+        EXPECT_THROW(parseFuse(""), std::invalid_argument);
+        EXPECT_THROW(parseFuse("hello world"), std::invalid_argument);
+        EXPECT_THROW(parseFuse("<!DOCTYPE html><html><body><p>Preset</p></body></html>"), std::invalid_argument);
+    }
+
+    TEST_F(FuseFormatTest, parseThrowsWithoutAmplifier)
+    {
+        EXPECT_THROW(parseFuse("<Preset><FX></FX></Preset>"), std::invalid_argument);
+        EXPECT_THROW(parseFuse("<Preset><Amplifier></Amplifier></Preset>"), std::invalid_argument);
+    }
+
+    TEST_F(FuseFormatTest, parseThrowsOnMalformedDocument)
+    {
+        EXPECT_THROW(parseFuse("<Preset><Amplifier"), std::invalid_argument);
+        EXPECT_THROW(parseFuse("<Preset><FUSE><Info name=\"abc></Info>"), std::invalid_argument);
+    }
+
+    TEST_F(FuseFormatTest, parseThrowsOnUnknownModel)
+    {
+        EXPECT_THROW(parseFuse(R"(<Preset><Amplifier><Module ID="1" POS="0"/></Amplifier></Preset>)"), std::invalid_argument);
+    }
+
+    TEST_F(FuseFormatTest, loadFileThrowsIfMissing)
+    {
+        EXPECT_THROW(loadFuseFile("/nonexistent/preset.fuse"), std::runtime_error);
+    }
+
+    TEST_F(FuseFormatTest, formatAndParse)
+    {
+        const auto chain = parseFuse(document);
+        const auto result = parseFuse(formatFuse(chain));
+
+        EXPECT_THAT(result.name(), Eq(chain.name()));
+        EXPECT_THAT(result.amp().amp_num, Eq(amps::BRITISH_80S));
+        EXPECT_THAT(result.amp().gain, Eq(200));
+        EXPECT_THAT(result.amp().cabinet, Eq(cabinets::cab4x12M));
+        EXPECT_THAT(result.amp().threshold, Eq(7));
+        EXPECT_THAT(result.amp().brightness, IsTrue());
+        EXPECT_THAT(result.amp().usb_gain, Eq(9));
+
+        const auto effects = result.effects();
+        ASSERT_THAT(effects.size(), Eq(2));
+        EXPECT_THAT(effects[0].effect_num, Eq(effects::OVERDRIVE));
+        EXPECT_THAT(effects[0].knob5, Eq(50));
+        EXPECT_THAT(effects[1].effect_num, Eq(effects::LARGE_HALL_REVERB));
+        EXPECT_THAT(effects[1].slot.id(), Eq(6));
+    }
+
+    TEST_F(FuseFormatTest, formatWritesModuleLayout)
+    {
+        amp_settings amp{};
+        amp.amp_num = amps::FENDER_65_DELUXE_REVERB;
+        amp.volume = 0x01;
+        const auto text = formatFuse(SignalChain{"<name>", amp, {fx_pedal_settings{FxSlot{0}, effects::SIMPLE_COMP, 3, 4, 5, 6, 7, 8, true}}});
+
+        EXPECT_THAT(text, HasSubstr(R"(<Module ID="83" POS="0" BypassState="1">)"));
+        EXPECT_THAT(text, HasSubstr(R"(<Param ControlIndex="0">257</Param>)"));
+        EXPECT_THAT(text, HasSubstr(R"(<Param ControlIndex="22">27242</Param>)"));
+        EXPECT_THAT(text, HasSubstr(R"(<Module ID="136" POS="0" BypassState="1">)"));
+        EXPECT_THAT(text, HasSubstr(R"(<Module ID="0" POS="0" BypassState="1"></Module>)"));
+        EXPECT_THAT(text, HasSubstr(R"(name="&lt;name&gt;")"));
+        EXPECT_THAT(text, Not(HasSubstr(R"(<Param ControlIndex="1">1028</Param>)")));
+    }
+
+    TEST_F(FuseFormatTest, formatWritesAuthor)
+    {
+        const auto text = formatFuse(SignalChain{"abc", amp_settings{}, {}}, "A & B");
+        EXPECT_THAT(text, HasSubstr(R"(<Info name="abc" author="A &amp; B" )"));
+    }
+}
@@ -51,6 +51,16 @@ namespace plug::test
         EXPECT_THROW(lookupAmpById(0x00), std::invalid_argument);
     }
 
+    TEST_F(IdLookupTest, findByIdReturnsNothingOnUnknownId)
+    {
+        EXPECT_EQ(findAmpById(0x6d), amps::METAL_2000);
+        EXPECT_FALSE(findAmpById(0x00).has_value());
+        EXPECT_EQ(findEffectById(0x0b), effects::FENDER_65_SPRING_REVERB);
+        EXPECT_FALSE(findEffectById(0xff).has_value());
+        EXPECT_EQ(findCabinetById(0x0c), cabinets::cabSS112);
+        EXPECT_FALSE(findCabinetById(0x0d).has_value());
+    }
+
     TEST_F(IdLookupTest, lookupEffectById)
     {
         EXPECT_EQ(lookupEffectById(0x00), effects::EMPTY);
@@ -119,4 +129,27 @@ namespace plug::test
     {
         EXPECT_THROW(lookupCabinetById(0xff), std::invalid_argument);
     }
+
+    TEST_F(IdLookupTest, lookupIdByAmp)
+    {
+        EXPECT_EQ(lookupIdByAmp(amps::FENDER_57_DELUXE), 0x67);
+        EXPECT_EQ(lookupIdByAmp(amps::METAL_2000), 0x6d);
+
+        for (std::uint8_t i = 0; i <= value(amps::METAL_2000); ++i)
+        {
+            EXPECT_EQ(value(lookupAmpById(lookupIdByAmp(static_cast<amps>(i)))), i);
+        }
+    }
+
+    TEST_F(IdLookupTest, lookupIdByEffect)
+    {
+        EXPECT_EQ(lookupIdByEffect(effects::EMPTY), 0x00);
+        EXPECT_EQ(lookupIdByEffect(effects::SIMPLE_COMP), 0x88);
+        EXPECT_EQ(lookupIdByEffect(effects::FENDER_65_SPRING_REVERB), 0x0b);
+
+        for (std::uint8_t i = 0; i <= value(effects::FENDER_65_SPRING_REVERB); ++i)
+        {
+            EXPECT_EQ(value(lookupEffectById(lookupIdByEffect(static_cast<effects>(i)))), i);
+        }
+    }
 }
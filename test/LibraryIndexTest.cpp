@@ -0,0 +1,208 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "library/LibraryIndex.h"
+#include "library/PresetHash.h"
+#include <gmock/gmock.h>
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+namespace plug::test
+{
+    using namespace plug::library;
+    using namespace testing;
+    namespace fs = std::filesystem;
+
+    class LibraryIndexTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            directory = fs::temp_directory_path() / ("plug-library-test-" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()) +
+                                                     "-" + ::testing::UnitTest::GetInstance()->current_test_info()->name());
+            fs::create_directories(directory);
+            cacheFile = (directory / "index.cache").string();
+        }
+
+        void TearDown() override
+        {
+            fs::remove_all(directory);
+        }
+
+        void writePreset(const std::string& fileName, const std::string& name, int ampId = 0x67)
+        {
+            std::ofstream file{directory / fileName};
+            file << "<Preset><Amplifier><Module ID=\"" << ampId << "\" POS=\"0\"><Param ControlIndex=\"1\">12850</Param></Module></Amplifier>"
+                 << "<FUSE><Info name=\"" << name << "\"/></FUSE></Preset>";
+        }
+
+        fs::path directory;
+        std::string cacheFile;
+        LibraryIndex index;
+    };
+
+    TEST_F(LibraryIndexTest, refreshParsesPresetFiles)
+    {
+        writePreset("b.fuse", "Second");
+        writePreset("A.FUSE", "First");
+        std::ofstream{directory / "notes.txt"} << "ignored";
+
+        EXPECT_THAT(index.refresh(directory.string()), Eq(2));
+
+        const auto& entries = index.entries();
+        ASSERT_THAT(entries.size(), Eq(2));
+        EXPECT_THAT(entries[0].valid, IsTrue());
+        EXPECT_THAT(entries[0].chain.name(), Eq("First"));
+        EXPECT_THAT(entries[0].chain.amp().gain, Eq(50));
+        EXPECT_THAT(entries[1].chain.name(), Eq("Second"));
+    }
+
+    TEST_F(LibraryIndexTest, refreshHashesFileContent)
+    {
+        writePreset("a.fuse", "First");
+        writePreset("b.fuse", "First");
+        writePreset("c.fuse", "Third", 0x01);
+        std::ofstream{directory / "d.fuse"} << "abc";
+
+        index.refresh(directory.string());
+
+        const auto& entries = index.entries();
+        ASSERT_THAT(entries.size(), Eq(4));
+        EXPECT_THAT(entries[0].contentHash, Eq(entries[1].contentHash));
+        EXPECT_THAT(entries[2].contentHash, Ne(entries[0].contentHash));
+        EXPECT_THAT(entries[3].contentHash, Eq(hashBytes("abc")));
+    }
+
+    TEST_F(LibraryIndexTest, refreshParsesManyFiles)
+    {
+        for (int i = 0; i < 100; ++i)
+        {
+            writePreset("preset" + std::to_string(1000 + i) + ".fuse", "Preset " + std::to_string(i));
+        }
+
+        EXPECT_THAT(index.refresh(directory.string()), Eq(100));
+
+        const auto& entries = index.entries();
+        ASSERT_THAT(entries.size(), Eq(100));
+        EXPECT_THAT(entries[0].chain.name(), Eq("Preset 0"));
+        EXPECT_THAT(entries[99].chain.name(), Eq("Preset 99"));
+        EXPECT_THAT(std::all_of(entries.cbegin(), entries.cend(), [](const auto& entry)
+                                { return entry.valid; }),
+                    IsTrue());
+    }
+
+    TEST_F(LibraryIndexTest, refreshKeepsInvalidFiles)
+    {
+        writePreset("invalid.fuse", "Invalid", 0x01);
+
+        index.refresh(directory.string());
+        ASSERT_THAT(index.entries().size(), Eq(1));
+        EXPECT_THAT(index.entries()[0].valid, IsFalse());
+    }
+
+    TEST_F(LibraryIndexTest, refreshKeepsNonPresetFilesInvalid)
+    {
+        std::ofstream{directory / "a.fuse"};
+        std::ofstream{directory / "b.fuse"} << "hello world";
+
+        index.refresh(directory.string());
+        ASSERT_THAT(index.entries().size(), Eq(2));
+        EXPECT_THAT(index.entries()[0].valid, IsFalse());
+        EXPECT_THAT(index.entries()[1].valid, IsFalse());
+    }
+
+    TEST_F(LibraryIndexTest, refreshReusesUnchangedFiles)
+    {
+        writePreset("a.fuse", "First");
+        writePreset("b.fuse", "Second");
+        index.refresh(directory.string());
+
+        writePreset("c.fuse", "Third");
+        fs::remove(directory / "b.fuse");
+
+        EXPECT_THAT(index.refresh(directory.string()), Eq(1));
+        ASSERT_THAT(index.entries().size(), Eq(2));
+        EXPECT_THAT(index.entries()[1].chain.name(), Eq("Third"));
+    }
+
+    TEST_F(LibraryIndexTest, refreshParsesModifiedFiles)
+    {
+        writePreset("a.fuse", "First");
+        index.refresh(directory.string());
+
+        writePreset("a.fuse", "Modified name");
+
+        EXPECT_THAT(index.refresh(directory.string()), Eq(1));
+        EXPECT_THAT(index.entries()[0].chain.name(), Eq("Modified name"));
+    }
+
+    TEST_F(LibraryIndexTest, saveAndLoadCache)
+    {
+        writePreset("a.fuse", "First");
+        writePreset("b.fuse", "Invalid", 0x01);
+        index.refresh(directory.string());
+        index.save(cacheFile);
+
+        LibraryIndex loaded;
+        ASSERT_THAT(loaded.load(cacheFile), IsTrue());
+        ASSERT_THAT(loaded.entries().size(), Eq(2));
+        EXPECT_THAT(loaded.entries()[0].path, Eq(index.entries()[0].path));
+        EXPECT_THAT(loaded.entries()[0].chain.name(), Eq("First"));
+        EXPECT_THAT(loaded.entries()[0].chain.amp().gain, Eq(50));
+        EXPECT_THAT(loaded.entries()[0].contentHash, Eq(index.entries()[0].contentHash));
+        EXPECT_THAT(loaded.entries()[1].valid, IsFalse());
+        EXPECT_THAT(loaded.refresh(directory.string()), Eq(0));
+    }
+
+    TEST_F(LibraryIndexTest, loadRejectsInvalidCache)
+    {
+        std::ofstream{cacheFile} << "not a cache";
+
+        EXPECT_THAT(index.load(cacheFile), IsFalse());
+        EXPECT_THAT(index.load((directory / "missing.cache").string()), IsFalse());
+        EXPECT_THAT(index.entries(), IsEmpty());
+    }
+
+    TEST_F(LibraryIndexTest, cacheFileNameDependsOnDirectory)
+    {
+        EXPECT_THAT(cacheFileName("/tmp/presets"), MatchesRegex("library-[0-9a-f]{16}\\.cache"));
+        EXPECT_THAT(cacheFileName("/tmp/presets/"), Eq(cacheFileName("/tmp/presets")));
+        EXPECT_THAT(cacheFileName("/tmp/presets2"), Ne(cacheFileName("/tmp/presets")));
+    }
+
+    TEST_F(LibraryIndexTest, defaultCacheDirectoryFollowsXdgCacheHome)
+    {
+        const std::string previous = (std::getenv("XDG_CACHE_HOME") != nullptr) ? std::getenv("XDG_CACHE_HOME") : "";
+        ::setenv("XDG_CACHE_HOME", "/tmp/cache", 1);
+
+        EXPECT_THAT(defaultCacheDirectory(), Eq("/tmp/cache/offa/Plug"));
+
+        if (previous.empty())
+        {
+            ::unsetenv("XDG_CACHE_HOME");
+        }
+        else
+        {
+            ::setenv("XDG_CACHE_HOME", previous.c_str(), 1);
+        }
+    }
+}
@@ -41,8 +41,9 @@ namespace plug::test
     protected:
         void SetUp() override
         {
-            conn = std::make_shared<mock::MockConnection>();
-            m = std::make_unique<com::Mustang>(conn);
+            auto connection = std::make_unique<mock::MockConnection>();
+            conn = connection.get();
+            m = std::make_unique<com::Mustang>(std::move(connection));
         }
 
         void TearDown() override
@@ -60,8 +61,26 @@ namespace plug::test
             return std::vector<std::uint8_t>{std::cbegin(c), std::cend(c)};
         }
 
+        // Expects the seven packets a slot is answered with, followed by the end of the transfer,
+        // which is waited for briefly instead of the full timeout
+        void expectPresetDump(const PresetRecord& record)
+        {
+            for (const auto& packet : record)
+            {
+                EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(asBuffer(packet))).RetiresOnSaturation();
+            }
+            EXPECT_CALL(*conn, receiveWithin(packetRawTypeSize, Lt(std::chrono::milliseconds{100}))).WillOnce(Return(noData)).RetiresOnSaturation();
+        }
+
+        [[nodiscard]] static PresetRecord createPresetDump(std::uint8_t slot, const std::string& name)
+        {
+            amp_settings amp{};
+            amp.amp_num = amps::FENDER_57_DELUXE;
+            return serializeSignalChain(slot, SignalChain{name, amp, {}});
+        }
 
-        std::shared_ptr<mock::MockConnection> conn;
+
+        mock::MockConnection* conn;
         std::unique_ptr<com::Mustang> m;
         const std::vector<std::uint8_t> noData{};
         const std::vector<std::uint8_t> ignoreData = std::vector<std::uint8_t>(packetRawTypeSize);
@@ -152,7 +171,7 @@ namespace plug::test
             .WillOnce(Return(noData));
 
 
-        const auto [signalChain, presets] = m->start_amp();
+        const auto [signalChain, presets, diagnostics] = m->start_amp();
         EXPECT_THAT(signalChain.name(), StrEq(actualName));
 
         static_cast<void>(presets);
@@ -196,12 +215,48 @@ namespace plug::test
             .WillOnce(Return(noData));
 
 
-        const auto [signalChain, presets] = m->start_amp();
+        const auto [signalChain, presets, diagnostics] = m->start_amp();
         EXPECT_THAT(signalChain.amp(), AmpIs(amp));
 
         static_cast<void>(presets);
     }
 
+    TEST_F(MustangTest, startReportsUnknownIdsOfCurrentAmp)
+    {
+        constexpr amp_settings amp{amps::BRITISH_60S, 4, 8, 5, 9, 1,
+                                   cabinets::cabBSSMN, 5, 3, 4, 7, 4, 2, 6, 1,
+                                   true, 17};
+        auto ampData = serializeAmpSettings(amp).getBytes();
+        ampData[16] = 0x7e;
+        const auto recvData = asBuffer(ampData);
+
+        InSequence s;
+        EXPECT_CALL(*conn, isOpen()).WillOnce(Return(true));
+        EXPECT_CALL(*conn, sendImpl(_, _)).WillOnce(Return(packetRawTypeSize));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(ignoreData));
+        EXPECT_CALL(*conn, sendImpl(_, _)).WillOnce(Return(packetRawTypeSize));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(ignoreData));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(loadCmd), loadCmd.size())).WillOnce(Return(loadCmd.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).Times(presetPacketCountShort).WillRepeatedly(Return(ignoreData));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(recvData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(ignoreData))
+            .WillOnce(Return(noData));
+
+        const auto [signalChain, presets, diagnostics] = m->start_amp();
+        ASSERT_THAT(diagnostics.size(), Eq(1));
+        EXPECT_THAT(diagnostics[0].field, Eq(DecodeField::amp));
+        EXPECT_THAT(diagnostics[0].rawId, Eq(0x7e));
+        EXPECT_THAT(signalChain.amp().gain, Eq(4));
+
+        static_cast<void>(presets);
+    }
+
     TEST_F(MustangTest, startRequestsCurrentEffects)
     {
         constexpr fx_pedal_settings e0{FxSlot{0x00}, effects::TRIANGLE_FLANGER, 10, 20, 30, 40, 50, 0};
@@ -244,7 +299,7 @@ namespace plug::test
             .WillOnce(Return(noData));
 
 
-        const auto [signalChain, presets] = m->start_amp();
+        const auto [signalChain, presets, diagnostics] = m->start_amp();
 
         EXPECT_THAT(signalChain.effects()[0], EffectIs(e0));
 
@@ -295,7 +350,7 @@ namespace plug::test
             .WillOnce(Return(noData));
 
 
-        const auto [signalChain, presetList] = m->start_amp();
+        const auto [signalChain, presetList, diagnostics] = m->start_amp();
 
         EXPECT_THAT(presetList.size(), Eq(presetPacketCountShort / 2));
         EXPECT_THAT(presetList[0], StrEq("abc"));
@@ -514,6 +569,16 @@ namespace plug::test
         m->set_effect(settings);
     }
 
+    TEST_F(MustangTest, setEffectWithUnknownModelDoesntClearDsp)
+    {
+        fx_pedal_settings settings{FxSlot{3}, effects::OVERDRIVE, 8, 7, 6, 5, 4, 3};
+        settings.unknownModel = 0xee;
+
+        EXPECT_CALL(*conn, sendImpl(_, _)).Times(0);
+
+        EXPECT_THROW(m->set_effect(settings), std::invalid_argument);
+    }
+
     TEST_F(MustangTest, setEffectDoesNotSendValueIfDisabled)
     {
         constexpr fx_pedal_settings settings{FxSlot{3}, effects::OVERDRIVE, 8, 7, 6, 5, 4, 3, false};
@@ -619,6 +684,120 @@ namespace plug::test
         EXPECT_THROW(m->save_effects(slot, "abcd", settings), std::invalid_argument);
     }
 
+    TEST_F(MustangTest, setSignalChainSetsAmpAndClearsUnusedEffects)
+    {
+        amp_settings amp{};
+        amp.amp_num = amps::BRITISH_70S;
+        const fx_pedal_settings delay{FxSlot{2}, effects::TAPE_DELAY, 1, 2, 3, 4, 5, 6, true};
+        const auto ampCmd = serializeAmpSettings(amp).getBytes();
+        const auto usbGainCmd = serializeAmpSettingsUsbGain(amp).getBytes();
+        const auto delayCmd = serializeEffectSettings(delay).getBytes();
+        const auto clearCmds = std::array{serializeClearEffectSettings(fx_pedal_settings{FxSlot{0}, effects::OVERDRIVE, 0, 0, 0, 0, 0, 0, false}).getBytes(),
+                                          serializeClearEffectSettings(fx_pedal_settings{FxSlot{1}, effects::SINE_CHORUS, 0, 0, 0, 0, 0, 0, false}).getBytes(),
+                                          serializeClearEffectSettings(delay).getBytes(),
+                                          serializeClearEffectSettings(fx_pedal_settings{FxSlot{3}, effects::SMALL_HALL_REVERB, 0, 0, 0, 0, 0, 0, false}).getBytes()};
+
+        InSequence s;
+        for (const auto& cmd : {ampCmd, usbGainCmd, clearCmds[0], clearCmds[1], clearCmds[2]})
+        {
+            EXPECT_CALL(*conn, sendImpl(BufferIs(cmd), cmd.size())).WillOnce(Return(cmd.size()));
+            EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(ignoreData));
+            EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Return(applyCmd.size()));
+            EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(ignoreData));
+        }
+        for (const auto& cmd : {delayCmd, clearCmds[3]})
+        {
+            EXPECT_CALL(*conn, sendImpl(BufferIs(cmd), cmd.size())).WillOnce(Return(cmd.size()));
+            EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(ignoreData));
+            EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Return(applyCmd.size()));
+            EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(ignoreData));
+        }
+
+        m->set_signal_chain(SignalChain{"abc", amp, {delay}});
+    }
+
+    TEST_F(MustangTest, updateSignalChainSendsChangedEffectOnly)
+    {
+        amp_settings amp{};
+        amp.amp_num = amps::BRITISH_70S;
+        const fx_pedal_settings delay{FxSlot{2}, effects::TAPE_DELAY, 1, 2, 3, 4, 5, 6, true};
+        auto changedDelay = delay;
+        changedDelay.knob4 = 99;
+        const auto delayCmd = serializeEffectSettings(changedDelay).getBytes();
+
+        InSequence s;
+        EXPECT_CALL(*conn, sendImpl(BufferIs(delayCmd), delayCmd.size())).WillOnce(Return(delayCmd.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(ignoreData));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Return(applyCmd.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(ignoreData));
+
+        EXPECT_THAT(m->update_signal_chain(SignalChain{"abc", amp, {delay}}, SignalChain{"abc", amp, {changedDelay}}), IsTrue());
+    }
+
+    TEST_F(MustangTest, updateSignalChainSendsAmpOnlyOnKnobChange)
+    {
+        amp_settings amp{};
+        amp.amp_num = amps::BRITISH_70S;
+        auto changedAmp = amp;
+        changedAmp.treble = 200;
+        const fx_pedal_settings delay{FxSlot{2}, effects::TAPE_DELAY, 1, 2, 3, 4, 5, 6, true};
+        const auto ampCmd = serializeAmpSettings(changedAmp).getBytes();
+
+        InSequence s;
+        EXPECT_CALL(*conn, sendImpl(BufferIs(ampCmd), ampCmd.size())).WillOnce(Return(ampCmd.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(ignoreData));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(applyCmd), applyCmd.size())).WillOnce(Return(applyCmd.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(ignoreData));
+
+        EXPECT_THAT(m->update_signal_chain(SignalChain{"abc", amp, {delay}}, SignalChain{"abc", changedAmp, {delay}}), IsTrue());
+    }
+
+    TEST_F(MustangTest, updateSignalChainSendsNothingIfUnchanged)
+    {
+        const SignalChain chain{"abc", amp_settings{}, {}};
+        EXPECT_CALL(*conn, sendImpl(_, _)).Times(0);
+
+        EXPECT_THAT(m->update_signal_chain(chain, chain), IsFalse());
+    }
+
+    TEST_F(MustangTest, writeSignalChainSendsChangesBeforeReceivingAcks)
+    {
+        amp_settings amp{};
+        amp.amp_num = amps::BRITISH_70S;
+        auto changedAmp = amp;
+        changedAmp.gain = 77;
+        const fx_pedal_settings delay{FxSlot{2}, effects::TAPE_DELAY, 1, 2, 3, 4, 5, 6, true};
+        const auto commands = std::array{serializeAmpSettings(changedAmp).getBytes(), applyCmd,
+                                         serializeClearEffectSettings(delay).getBytes(), applyCmd};
+
+        InSequence s;
+        for (const auto& cmd : commands)
+        {
+            EXPECT_CALL(*conn, sendImpl(BufferIs(cmd), cmd.size())).WillOnce(Return(cmd.size()));
+        }
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).Times(4).WillRepeatedly(Return(ignoreData));
+
+        EXPECT_THAT(m->write_signal_chain(SignalChain{"abc", amp, {delay}}, SignalChain{"abc", changedAmp, {}}), Eq(4));
+    }
+
+    TEST_F(MustangTest, changesUnknownModelsOnlyIfSectionWithUnknownIdsDiffers)
+    {
+        amp_settings unknownAmp{};
+        unknownAmp.unknownModel = 0x7f;
+        auto gainChanged = unknownAmp;
+        gainChanged.usb_gain = 5;
+        fx_pedal_settings unknownDelay{FxSlot{2}, effects::TAPE_DELAY, 1, 2, 3, 4, 5, 6, true};
+        unknownDelay.unknownModel = 0xee;
+        const fx_pedal_settings delay{FxSlot{2}, effects::TAPE_DELAY, 1, 2, 3, 4, 5, 6, true};
+        const SignalChain chain{"abc", unknownAmp, {unknownDelay}};
+
+        EXPECT_THAT(changesUnknownModels(chain, chain), IsFalse());
+        EXPECT_THAT(changesUnknownModels(chain, SignalChain{"abc", gainChanged, {unknownDelay}}), IsFalse());
+        EXPECT_THAT(changesUnknownModels(chain, SignalChain{"abc", unknownAmp, {}}), IsFalse());
+        EXPECT_THAT(changesUnknownModels(SignalChain{"abc", amp_settings{}, {unknownDelay}}, chain), IsTrue());
+        EXPECT_THAT(changesUnknownModels(SignalChain{"abc", unknownAmp, {delay}}, chain), IsTrue());
+    }
+
     TEST_F(MustangTest, saveOnAmp)
     {
         const std::string name(30, 'x');
@@ -641,4 +820,126 @@ namespace plug::test
         EXPECT_THAT(m->getDeviceName(), Eq("A Mustang Device"));
         EXPECT_THAT(m->getDeviceModelVersion(), Eq(ModelVersion::v1));
     }
+
+    TEST_F(MustangTest, backupAllReadsEachSlot)
+    {
+        const auto loadSlot0Cmd = serializeLoadSlotCommand(0).getBytes();
+        const auto loadSlot1Cmd = serializeLoadSlotCommand(1).getBytes();
+        const auto slot0 = createPresetDump(0, "abc");
+        const auto slot1 = createPresetDump(1, "def");
+        std::vector<std::pair<std::size_t, std::size_t>> progress;
+
+        InSequence s;
+        EXPECT_CALL(*conn, sendImpl(BufferIs(loadSlot0Cmd), loadSlot0Cmd.size())).WillOnce(Return(loadSlot0Cmd.size()));
+        expectPresetDump(slot0);
+        EXPECT_CALL(*conn, sendImpl(BufferIs(loadSlot1Cmd), loadSlot1Cmd.size())).WillOnce(Return(loadSlot1Cmd.size()));
+        expectPresetDump(slot1);
+
+        const auto records = m->backupAll(2, [&progress](std::size_t done, std::size_t total)
+                                          { progress.emplace_back(done, total); });
+        ASSERT_THAT(records.size(), Eq(2));
+        EXPECT_THAT(records[0], Eq(slot0));
+        EXPECT_THAT(records[1], Eq(slot1));
+        EXPECT_THAT(progress, ElementsAre(Pair(1, 2), Pair(2, 2)));
+    }
+
+    TEST_F(MustangTest, backupAllSkipsExtraPacketsOfSlot)
+    {
+        const auto slot0 = createPresetDump(0, "abc");
+        const auto slot1 = createPresetDump(1, "def");
+        auto extraPacket = ignoreData;
+        extraPacket[2] = 0x0a;
+
+        InSequence s;
+        EXPECT_CALL(*conn, sendImpl(_, _)).WillOnce(Return(packetRawTypeSize));
+
+        for (std::size_t i = 0; i < slot0.size(); ++i)
+        {
+            if (i == 6)
+            {
+                EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(extraPacket));
+            }
+            EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(asBuffer(slot0[i])));
+        }
+        EXPECT_CALL(*conn, receiveWithin(packetRawTypeSize, _)).WillOnce(Return(extraPacket));
+        EXPECT_CALL(*conn, receiveWithin(packetRawTypeSize, _)).WillOnce(Return(noData));
+        EXPECT_CALL(*conn, sendImpl(_, _)).WillOnce(Return(packetRawTypeSize));
+        expectPresetDump(slot1);
+
+        const auto records = m->backupAll(2);
+        ASSERT_THAT(records.size(), Eq(2));
+        EXPECT_THAT(records[0], Eq(slot0));
+        EXPECT_THAT(records[1], Eq(slot1));
+    }
+
+    TEST_F(MustangTest, backupAllThrowsOnUnexpectedPacket)
+    {
+        const auto slot0 = createPresetDump(0, "abc");
+
+        InSequence s;
+        EXPECT_CALL(*conn, sendImpl(_, _)).WillOnce(Return(packetRawTypeSize));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(asBuffer(slot0[0])));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(asBuffer(slot0[2])));
+
+        EXPECT_THROW(m->backupAll(1), CommunicationException);
+    }
+
+    TEST_F(MustangTest, backupAllThrowsOnIncompleteTransfer)
+    {
+        const auto slot0 = createPresetDump(0, "abc");
+
+        InSequence s;
+        EXPECT_CALL(*conn, sendImpl(_, _)).WillOnce(Return(packetRawTypeSize));
+
+        for (std::size_t i = 0; i < 3; ++i)
+        {
+            EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(asBuffer(slot0[i])));
+        }
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(noData));
+
+        EXPECT_THROW(m->backupAll(1), CommunicationException);
+    }
+
+    TEST_F(MustangTest, restoreAllWritesEachSlotAndReceivesAcksAfterwards)
+    {
+        amp_settings amp{};
+        amp.amp_num = amps::FENDER_57_DELUXE;
+        const PresetRecord record = serializeSignalChain(0, SignalChain{"abc", amp, {}});
+        const auto commands = serializeRestoreSlotCommands(0, record);
+        std::vector<std::pair<std::size_t, std::size_t>> progress;
+
+        ASSERT_THAT(commands.size(), Eq(8));
+        ASSERT_THAT(commands[6], Eq(applyCmd));
+        ASSERT_THAT(commands[7], Eq(serializeName(0, "abc").getBytes()));
+
+        InSequence s;
+
+        for (const auto& command : commands)
+        {
+            EXPECT_CALL(*conn, sendImpl(BufferIs(command), command.size())).WillOnce(Return(command.size()));
+        }
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).Times(8).WillRepeatedly(Return(ignoreData));
+
+        m->restoreAll({record}, [&progress](std::size_t done, std::size_t total)
+                      { progress.emplace_back(done, total); });
+        EXPECT_THAT(progress, ElementsAre(Pair(1, 1)));
+    }
+
+    TEST_F(MustangTest, restoreSelectsSlotOfPartialUpdates)
+    {
+        const auto loadSlotCmd = serializeLoadSlotCommand(3).getBytes();
+        const auto nameCmd = serializeName(3, "abc").getBytes();
+        const auto fullCmd = serializeName(4, "def").getBytes();
+        const std::vector<SlotUpdate> updates{SlotUpdate{3, true, {nameCmd}}, SlotUpdate{4, false, {fullCmd}}};
+
+        InSequence s;
+        EXPECT_CALL(*conn, sendImpl(BufferIs(loadSlotCmd), loadSlotCmd.size())).WillOnce(Return(loadSlotCmd.size()));
+        expectPresetDump(createPresetDump(3, "abc"));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(nameCmd), nameCmd.size())).WillOnce(Return(nameCmd.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(ignoreData));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(fullCmd), fullCmd.size())).WillOnce(Return(fullCmd.size()));
+        EXPECT_CALL(*conn, receive(packetRawTypeSize)).WillOnce(Return(ignoreData));
+
+        m->restore(updates);
+    }
 }
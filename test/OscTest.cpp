@@ -0,0 +1,255 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "daemon/Osc.h"
+#include "helper/SignalChains.h"
+#include <gmock/gmock.h>
+#include <cstring>
+
+namespace plug::test
+{
+    using namespace plug::daemon;
+    using namespace testing;
+
+    class OscTest : public testing::Test
+    {
+    protected:
+        static void putString(std::vector<std::uint8_t>& out, std::string_view value)
+        {
+            out.insert(out.end(), value.cbegin(), value.cend());
+            out.resize(out.size() + 4 - (value.size() % 4), 0x00);
+        }
+
+        static void putU32(std::vector<std::uint8_t>& out, std::uint32_t value)
+        {
+            out.insert(out.end(), {static_cast<std::uint8_t>(value >> 24), static_cast<std::uint8_t>(value >> 16),
+                                   static_cast<std::uint8_t>(value >> 8), static_cast<std::uint8_t>(value)});
+        }
+
+        static std::vector<std::uint8_t> intMessage(std::string_view address, std::int32_t value)
+        {
+            std::vector<std::uint8_t> data;
+            putString(data, address);
+            putString(data, ",i");
+            putU32(data, static_cast<std::uint32_t>(value));
+            return data;
+        }
+
+        static std::vector<std::uint8_t> floatMessage(std::string_view address, float value)
+        {
+            std::uint32_t bits{0};
+            std::memcpy(&bits, &value, sizeof(bits));
+
+            std::vector<std::uint8_t> data;
+            putString(data, address);
+            putString(data, ",f");
+            putU32(data, bits);
+            return data;
+        }
+
+        static std::vector<OscMessage> parse(const std::vector<std::uint8_t>& data)
+        {
+            return parseOsc(data.data(), data.size());
+        }
+
+        const fx_pedal_settings delay{FxSlot{2}, effects::MONO_DELAY, 1, 2, 3, 4, 5, 6, true};
+    };
+
+    TEST_F(OscTest, parseIntMessage)
+    {
+        const auto messages = parse(intMessage("/amp/gain", 123));
+
+        ASSERT_THAT(messages.size(), Eq(1));
+        EXPECT_THAT(messages[0].address, StrEq("/amp/gain"));
+        EXPECT_THAT(parameterValue(messages[0]), Eq(123));
+    }
+
+    TEST_F(OscTest, floatValuesAreScaledToParameterRange)
+    {
+        EXPECT_THAT(parameterValue(parse(floatMessage("/amp/gain", 1.0f))[0]), Eq(255));
+        EXPECT_THAT(parameterValue(parse(floatMessage("/amp/gain", 0.5f))[0]), Eq(128));
+        EXPECT_THAT(parameterValue(parse(floatMessage("/amp/gain", -3.0f))[0]), Eq(0));
+    }
+
+    TEST_F(OscTest, parseBundle)
+    {
+        const auto first = intMessage("/amp/volume", 1);
+        const auto second = intMessage("/fx/2/knob3", 2);
+        std::vector<std::uint8_t> data;
+        putString(data, "#bundle");
+        putU32(data, 0);
+        putU32(data, 1);
+        putU32(data, static_cast<std::uint32_t>(first.size()));
+        data.insert(data.end(), first.cbegin(), first.cend());
+        putU32(data, static_cast<std::uint32_t>(second.size()));
+        data.insert(data.end(), second.cbegin(), second.cend());
+
+        const auto messages = parse(data);
+        ASSERT_THAT(messages.size(), Eq(2));
+        EXPECT_THAT(messages[0].address, StrEq("/amp/volume"));
+        EXPECT_THAT(messages[1].address, StrEq("/fx/2/knob3"));
+    }
+
+    TEST_F(OscTest, parseThrowsOnMalformedPacket)
+    {
+        auto data = intMessage("/amp/gain", 1);
+        data.resize(data.size() - 4);
+
+        EXPECT_THROW(parse(data), std::invalid_argument);
+        EXPECT_THROW(parse({'/', 'a', 'b'}), std::invalid_argument);
+        EXPECT_THROW(parse({'a', 'b', 0, 0}), std::invalid_argument);
+    }
+
+    TEST_F(OscTest, intValueOutOfRangeThrows)
+    {
+        EXPECT_THROW(parameterValue(parse(intMessage("/amp/gain", 256))[0]), std::invalid_argument);
+    }
+
+    TEST_F(OscTest, batchCoalescesChangesPerDsp)
+    {
+        ParameterBatch batch{createChain("osc", 0, {delay}, amps::BRITISH_60S)};
+
+        for (std::int32_t i = 0; i < 200; ++i)
+        {
+            batch.add(parse(intMessage("/amp/gain", i))[0]);
+            batch.add(parse(intMessage("/fx/2/knob3", i))[0]);
+        }
+        batch.add(parse(intMessage("/amp/treble", 7))[0]);
+
+        const auto amp = batch.amp();
+        ASSERT_THAT(amp.has_value(), IsTrue());
+        EXPECT_THAT(amp->amp_num, Eq(amps::BRITISH_60S));
+        EXPECT_THAT(amp->gain, Eq(199));
+        EXPECT_THAT(amp->treble, Eq(7));
+
+        const auto changed = batch.effects();
+        ASSERT_THAT(changed.size(), Eq(1));
+        EXPECT_THAT(changed[0].effect_num, Eq(effects::MONO_DELAY));
+        EXPECT_THAT(changed[0].knob1, Eq(1));
+        EXPECT_THAT(changed[0].knob3, Eq(199));
+    }
+
+    TEST_F(OscTest, batchWithoutChanges)
+    {
+        const ParameterBatch batch{createChain("osc", 0, {delay}, amps::BRITISH_60S)};
+
+        EXPECT_THAT(batch.amp().has_value(), IsFalse());
+        EXPECT_THAT(batch.effects(), IsEmpty());
+    }
+
+    TEST_F(OscTest, effectCanBeAddedToEmptySlot)
+    {
+        ParameterBatch batch{createChain("osc", 0, {delay}, amps::BRITISH_60S)};
+        batch.add(parse(intMessage("/fx/5/model", 0x12))[0]);
+        batch.add(parse(intMessage("/fx/5/knob1", 9))[0]);
+
+        const auto changed = batch.effects();
+        ASSERT_THAT(changed.size(), Eq(1));
+        EXPECT_THAT(changed[0].slot.id(), Eq(5));
+        EXPECT_THAT(changed[0].effect_num, Eq(effects::SINE_CHORUS));
+        EXPECT_THAT(changed[0].knob1, Eq(9));
+    }
+
+    TEST_F(OscTest, effectReplacesEffectOfSameDsp)
+    {
+        ParameterBatch batch{createChain("osc", 0, {delay}, amps::BRITISH_60S)};
+        batch.add(parse(intMessage("/fx/2/knob1", 9))[0]);
+        batch.add(parse(intMessage("/fx/5/model", 0x2b))[0]);
+        batch.add(parse(intMessage("/fx/5/knob2", 8))[0]);
+
+        const auto changed = batch.effects();
+        ASSERT_THAT(changed.size(), Eq(1));
+        EXPECT_THAT(changed[0].slot.id(), Eq(5));
+        EXPECT_THAT(changed[0].effect_num, Eq(effects::TAPE_DELAY));
+        EXPECT_THAT(changed[0].knob2, Eq(8));
+        EXPECT_THROW(batch.add(parse(intMessage("/fx/2/knob1", 1))[0]), std::invalid_argument);
+    }
+
+    TEST_F(OscTest, modelChangeMovesEffectToItsDsp)
+    {
+        ParameterBatch batch{createChain("osc", 0, {delay}, amps::BRITISH_60S)};
+        batch.add(parse(intMessage("/fx/2/model", 0x3c))[0]);
+        batch.add(parse(intMessage("/fx/6/model", 0x16))[0]);
+
+        const auto changed = batch.effects();
+        ASSERT_THAT(changed.size(), Eq(2));
+        EXPECT_THAT(changed[0].slot.id(), Eq(2));
+        EXPECT_THAT(changed[0].effect_num, Eq(effects::OVERDRIVE));
+        EXPECT_THAT(changed[0].knob1, Eq(1));
+        EXPECT_THAT(changed[1].slot.id(), Eq(6));
+        EXPECT_THAT(changed[1].effect_num, Eq(effects::MONO_DELAY));
+    }
+
+    TEST_F(OscTest, emptyModelRemovesEffect)
+    {
+        ParameterBatch batch{createChain("osc", 0, {delay}, amps::BRITISH_60S)};
+        batch.add(parse(intMessage("/fx/2/model", 0x00))[0]);
+
+        const auto changed = batch.effects();
+        ASSERT_THAT(changed.size(), Eq(1));
+        EXPECT_THAT(changed[0].slot.id(), Eq(2));
+        EXPECT_THAT(changed[0].effect_num, Eq(effects::EMPTY));
+        EXPECT_THROW(batch.add(parse(intMessage("/fx/2/knob1", 1))[0]), std::invalid_argument);
+    }
+
+    TEST_F(OscTest, invalidIdsAreRejectedWithoutChanges)
+    {
+        ParameterBatch batch{createChain("osc", 0, {delay}, amps::BRITISH_60S)};
+
+        EXPECT_THROW(batch.add(parse(intMessage("/fx/2/model", 0x01))[0]), std::invalid_argument);
+        EXPECT_THROW(batch.add(parse(intMessage("/fx/4/model", 0x01))[0]), std::invalid_argument);
+        EXPECT_THROW(batch.add(parse(intMessage("/amp/model", 0x01))[0]), std::invalid_argument);
+        EXPECT_THROW(batch.add(parse(intMessage("/amp/cabinet", 0xff))[0]), std::invalid_argument);
+        EXPECT_THAT(batch.amp().has_value(), IsFalse());
+        EXPECT_THAT(batch.effects(), IsEmpty());
+        EXPECT_THROW(batch.add(parse(intMessage("/fx/4/knob1", 1))[0]), std::invalid_argument);
+    }
+
+    TEST_F(OscTest, floatIdsSelectValidModels)
+    {
+        ParameterBatch batch{createChain("osc", 0, {delay}, amps::BRITISH_60S)};
+        batch.add(parse(floatMessage("/amp/model", 0.5f))[0]);
+        batch.add(parse(floatMessage("/amp/cabinet", 1.0f))[0]);
+        batch.add(parse(floatMessage("/fx/2/model", 1.0f))[0]);
+        batch.add(parse(floatMessage("/fx/5/model", 0.0f))[0]);
+
+        const auto amp = batch.amp();
+        ASSERT_THAT(amp.has_value(), IsTrue());
+        EXPECT_THAT(amp->amp_num, Eq(amps::FENDER_65_PRINCETON));
+        EXPECT_THAT(amp->cabinet, Ne(cabinets::OFF));
+
+        const auto changed = batch.effects();
+        ASSERT_THAT(changed.size(), Eq(2));
+        EXPECT_THAT(changed[0].slot.id(), Eq(5));
+        EXPECT_THAT(changed[0].effect_num, Eq(effects::EMPTY));
+        EXPECT_THAT(changed[1].slot.id(), Eq(2));
+        EXPECT_THAT(changed[1].effect_num, Eq(effects::SIMPLE_COMP));
+    }
+
+    TEST_F(OscTest, batchRejectsInvalidAddresses)
+    {
+        ParameterBatch batch{createChain("osc", 0, {delay}, amps::BRITISH_60S)};
+
+        EXPECT_THROW(batch.add(parse(intMessage("/amp/unknown", 1))[0]), std::invalid_argument);
+        EXPECT_THROW(batch.add(parse(intMessage("/fx/8/knob1", 1))[0]), std::invalid_argument);
+        EXPECT_THROW(batch.add(parse(intMessage("/fx/3/knob1", 1))[0]), std::invalid_argument);
+        EXPECT_THROW(batch.add(parse(intMessage("/mixer/1", 1))[0]), std::invalid_argument);
+    }
+}
@@ -21,6 +21,7 @@
 #include "com/PacketSerializer.h"
 #include "data_structs.h"
 #include "matcher/PacketMatcher.h"
+#include "matcher/TypeMatcher.h"
 #include "helper/MustangConstants.h"
 #include <gmock/gmock.h>
 
@@ -31,6 +32,51 @@ namespace plug::test
     using namespace testing;
     using namespace test::matcher;
 
+    namespace
+    {
+        constexpr bool bytesEqual(const PacketRawType& lhs, const PacketRawType& rhs)
+        {
+            for (std::size_t i = 0; i < lhs.size(); ++i)
+            {
+                if (lhs[i] != rhs[i])
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        constexpr bool ampBasePacketsMatchCaptured()
+        {
+            for (std::size_t i = 0; i < v1::AMP_MODEL_BYTES.size(); ++i)
+            {
+                const auto bytes = ampBasePackets[i].getBytes();
+                const auto expected = v1::AMP_MODEL_BYTES[i];
+
+                if ((bytes[v1::DSP] != 0x05) || (bytes[v1::AMPLIFIER] != expected.ampId) || (bytes[40] != expected.unknown) ||
+                    (bytes[43] != expected.unknown) || (bytes[44] != expected.specific) || (bytes[45] != expected.specific) ||
+                    (bytes[46] != expected.specific) || (bytes[50] != expected.specific) || (bytes[54] != expected.last) ||
+                    (bytes[v1::DEPTH] != 0x80))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        static_assert(bytesEqual(serializeInitCommand()[0].getBytes(), v1::INIT_PACKET_0));
+        static_assert(bytesEqual(serializeInitCommand()[1].getBytes(), v1::INIT_PACKET_1));
+        static_assert(bytesEqual(serializeApplyCommand().getBytes(), v1::APPLY_PACKET));
+        static_assert(bytesEqual(serializeLoadCommand().getBytes(), v1::LOAD_PACKET));
+        static_assert(bytesEqual(serializeLoadSlotCommand(0).getBytes(), v1::LOAD_SLOT_PACKET));
+        static_assert(serializeLoadSlotCommand(7).getBytes()[v1::SAVE_SLOT] == 7);
+        static_assert(ampBasePackets.size() == v1::AMP_MODEL_BYTES.size());
+        static_assert(ampBasePacketsMatchCaptured());
+        static_assert(bytesEqual(serializeAmpSettings(amp_settings{amps::BRITISH_60S, 0, 0, 0, 0, 0, cabinets::OFF, 0, 0, 0, 0, 0, 0, 0, 0, false, 0}).getBytes(),
+                                 v1::AMP_BRITISH_60S_PACKET));
+        static_assert(serializeEffectSettings(fx_pedal_settings{FxSlot{0}, effects::PHASER, 1, 2, 3, 4, 9, 6}).getBytes()[v1::KNOB5] == 0x01);
+    }
+
     class PacketSerializerTest : public testing::Test
     {
     protected:
@@ -1152,4 +1198,261 @@ namespace plug::test
         EXPECT_THAT(result[3].slot.id(), Eq(7));
         EXPECT_THAT(result[3].slot.isFxLoop(), IsTrue());
     }
+
+    TEST_F(PacketSerializerTest, serializeSignalChain)
+    {
+        amp_settings amp{};
+        amp.amp_num = amps::BRITISH_80S;
+        amp.gain = 0x11;
+        amp.cabinet = cabinets::cab4x12G;
+        amp.usb_gain = 0x22;
+        const std::vector<fx_pedal_settings> effects{fx_pedal_settings{FxSlot{6}, effects::TAPE_DELAY, 1, 2, 3, 4, 5, 6, true},
+                                                     fx_pedal_settings{FxSlot{1}, effects::WAH, 7, 8, 9, 10, 11, 12, true},
+                                                     fx_pedal_settings{FxSlot{2}, effects::PHASER, 1, 1, 1, 1, 1, 1, false}};
+
+        const auto data = serializeSignalChain(3, SignalChain{"abc", amp, effects});
+
+        EXPECT_THAT(data[0], Eq(serializeName(3, "abc").getBytes()));
+        EXPECT_THAT(data[1], Eq(serializeAmpSettings(amp).getBytes()));
+        EXPECT_THAT(data[2], Eq(serializeEffectSettings(effects[1]).getBytes()));
+        EXPECT_THAT(data[3], Eq(serializeClearEffectSettings(effects[2]).getBytes()));
+        EXPECT_THAT(data[4], Eq(serializeEffectSettings(effects[0]).getBytes()));
+        EXPECT_THAT(data[6], Eq(serializeAmpSettingsUsbGain(amp).getBytes()));
+    }
+
+    TEST_F(PacketSerializerTest, decodeSignalChainOfSerializedChain)
+    {
+        amp_settings amp{};
+        amp.amp_num = amps::FENDER_65_PRINCETON;
+        amp.volume = 0x33;
+        amp.cabinet = cabinets::cab65PRN;
+        amp.usb_gain = 0x44;
+        const fx_pedal_settings effect{FxSlot{5}, effects::ARENA_REVERB, 1, 2, 3, 4, 5, 6, true};
+
+        const auto result = decodeSignalChain(serializeSignalChain(0, SignalChain{"preset", amp, {effect}}));
+
+        EXPECT_THAT(result.name(), StrEq("preset"));
+        EXPECT_THAT(result.amp().amp_num, Eq(amps::FENDER_65_PRINCETON));
+        EXPECT_THAT(result.amp().volume, Eq(0x33));
+        EXPECT_THAT(result.amp().cabinet, Eq(cabinets::cab65PRN));
+        EXPECT_THAT(result.amp().usb_gain, Eq(0x44));
+
+        const auto effects = result.effects();
+        ASSERT_THAT(effects.size(), Eq(4));
+        EXPECT_THAT(effects[0].effect_num, Eq(effects::EMPTY));
+        EXPECT_THAT(effects[1].effect_num, Eq(effects::EMPTY));
+        EXPECT_THAT(effects[2].effect_num, Eq(effects::EMPTY));
+        EXPECT_THAT(effects[3].effect_num, Eq(effects::ARENA_REVERB));
+        EXPECT_THAT(effects[3].slot.id(), Eq(5));
+        EXPECT_THAT(effects[3].knob5, Eq(5));
+    }
+
+    TEST_F(PacketSerializerTest, tryDecodeSignalChainOfSerializedChain)
+    {
+        amp_settings amp{};
+        amp.amp_num = amps::BRITISH_70S;
+        amp.cabinet = cabinets::cab4x12G;
+        amp.depth = 0x80;
+        const fx_pedal_settings effect{FxSlot{6}, effects::MONO_DELAY, 1, 2, 3, 4, 5, 0, true};
+
+        const auto result = tryDecodeSignalChain(serializeSignalChain(0, SignalChain{"preset", amp, {effect}}));
+
+        EXPECT_THAT(result.ok(), Eq(true));
+        EXPECT_THAT(result.value.amp(), AmpIs(amp));
+        EXPECT_THAT(result.value.effects()[2], EffectIs(effect));
+    }
+
+    TEST_F(PacketSerializerTest, tryDecodeSignalChainReportsUnknownIds)
+    {
+        const fx_pedal_settings effect{FxSlot{2}, effects::MONO_DELAY, 1, 2, 3, 4, 5, 0, true};
+        auto data = serializeSignalChain(0, SignalChain{"preset", amp_settings{}, {effect}});
+        data[1][v1::AMPLIFIER] = 0x7f;
+        data[1][v1::CABINET] = 0x20;
+        data[3][v1::EFFECT] = 0xee;
+        data[4][v1::FXSLOT] = 0x09;
+
+        const auto result = tryDecodeSignalChain(data);
+
+        ASSERT_THAT(result.diagnostics.size(), Eq(4));
+        EXPECT_THAT(describe(result.diagnostics[0]), StrEq("packet 1: amp unknown(0x7f)"));
+        EXPECT_THAT(describe(result.diagnostics[1]), StrEq("packet 1: cabinet unknown(0x20)"));
+        EXPECT_THAT(describe(result.diagnostics[2]), StrEq("packet 3: effect unknown(0xee)"));
+        EXPECT_THAT(describe(result.diagnostics[3]), StrEq("packet 4: fx slot unknown(0x09)"));
+
+        const auto effects = result.value.effects();
+        EXPECT_THAT(result.value.name(), StrEq("preset"));
+        EXPECT_THAT(effects[2].effect_num, Eq(effects::MONO_DELAY));
+        EXPECT_THAT(effects[2].slot.id(), Eq(0));
+        EXPECT_THAT(effects[2].knob3, Eq(3));
+        EXPECT_THAT(serializeSignalChain(0, result.value), ContainerEq(data));
+    }
+
+    TEST_F(PacketSerializerTest, tryDecodeSignalChainKeepsUnknownIds)
+    {
+        const fx_pedal_settings effect{FxSlot{2}, effects::MONO_DELAY, 1, 2, 3, 4, 5, 0, true};
+        auto data = serializeSignalChain(0, SignalChain{"preset", amp_settings{}, {effect}});
+        data[1][v1::AMPLIFIER] = 0x7f;
+        data[1][v1::CABINET] = 0x20;
+        data[3][v1::EFFECT] = 0xee;
+        data[4][v1::FXSLOT] = 0x09;
+
+        const auto result = tryDecodeSignalChain(data).value;
+
+        EXPECT_THAT(result.amp().unknownModel, Optional(0x7f));
+        EXPECT_THAT(result.amp().unknownCabinet, Optional(0x20));
+
+        const auto effects = result.effects();
+        EXPECT_THAT(effects[0].unknownModel, Eq(std::nullopt));
+        EXPECT_THAT(effects[1].effect_num, Eq(effects::SINE_CHORUS));
+        EXPECT_THAT(effects[1].unknownModel, Optional(0xee));
+        EXPECT_THAT(effects[2].unknownModel, Eq(std::nullopt));
+        EXPECT_THAT(effects[2].unknownSlot, Optional(0x09));
+    }
+
+    TEST_F(PacketSerializerTest, serializeSignalChainWritesUnknownIdsBackAfterManyOtherChains)
+    {
+        auto data = serializeSignalChain(0, SignalChain{"preset", amp_settings{}, {}});
+        data[1][v1::AMPLIFIER] = 0x7f;
+        const auto chain = tryDecodeSignalChain(data).value;
+
+        for (std::uint8_t i = 0; i < 200; ++i)
+        {
+            auto other = data;
+            other[1][v1::AMPLIFIER] = 0x5e;
+            other[0][40] = i;
+            static_cast<void>(decodeSignalChain(other));
+        }
+
+        EXPECT_THAT(chain.isRawDropped(), Eq(false));
+        EXPECT_THAT(serializeSignalChain(0, chain), ContainerEq(data));
+    }
+
+    TEST_F(PacketSerializerTest, serializeSignalChainRefusesModifiedSectionsWithUnknownIds)
+    {
+        auto data = serializeSignalChain(0, SignalChain{"preset", amp_settings{}, {}});
+        data[1][v1::AMPLIFIER] = 0x7f;
+        data[3][v1::EFFECT] = 0xee;
+        const auto chain = tryDecodeSignalChain(data).value;
+
+        auto ampChanged = chain;
+        auto amp = chain.amp();
+        amp.gain = 0x10;
+        ampChanged.setAmp(amp);
+
+        auto effectsChanged = chain;
+        auto effects = chain.effects();
+        effects.push_back(fx_pedal_settings{FxSlot{6}, effects::MONO_DELAY, 1, 2, 3, 4, 5, 0, true});
+        effectsChanged.setEffects(effects);
+
+        EXPECT_THROW(serializeSignalChain(0, ampChanged), std::invalid_argument);
+        EXPECT_THROW(serializeSignalChain(0, effectsChanged), std::invalid_argument);
+    }
+
+    TEST_F(PacketSerializerTest, serializeSettingsWithUnknownIdsThrows)
+    {
+        amp_settings amp{};
+        amp.unknownCabinet = 0x20;
+        fx_pedal_settings effect{FxSlot{2}, effects::MONO_DELAY, 1, 2, 3, 4, 5, 0, true};
+        effect.unknownModel = 0xee;
+
+        EXPECT_THROW(serializeAmpSettings(amp), std::invalid_argument);
+        EXPECT_THROW(serializeEffectSettings(effect), std::invalid_argument);
+    }
+
+    TEST_F(PacketSerializerTest, decodeSignalChainThrowsOnUnknownIds)
+    {
+        auto data = serializeSignalChain(0, SignalChain{"preset", amp_settings{}, {}});
+        data[1][v1::AMPLIFIER] = 0x7f;
+
+        EXPECT_THROW(decodeSignalChain(data), std::invalid_argument);
+    }
+
+    TEST_F(PacketSerializerTest, serializeSignalChainKeepsUnmodifiedRawData)
+    {
+        amp_settings amp{};
+        amp.amp_num = amps::BRITISH_80S;
+        const fx_pedal_settings effect{FxSlot{1}, effects::PHASER, 1, 2, 3, 4, 1, 0, true};
+        auto data = serializeSignalChain(2, SignalChain{"raw", amp, {effect}});
+        data[0][60] = 0x11;
+        data[1][3] = 0x22;
+        data[1][40] = 0x33;
+        data[3][63] = 0x44;
+        data[6][50] = 0x55;
+
+        const auto chain = decodeSignalChain(data);
+
+        EXPECT_THAT(chain.isModified(ChainSection::amp), Eq(false));
+        EXPECT_THAT(serializeSignalChain(2, chain), ContainerEq(data));
+    }
+
+    TEST_F(PacketSerializerTest, serializeSignalChainSetsSlotOfRawName)
+    {
+        const auto data = serializeSignalChain(2, SignalChain{"raw", amp_settings{}, {}});
+
+        const auto result = serializeSignalChain(7, decodeSignalChain(data));
+        EXPECT_THAT(result[0][v1::SAVE_SLOT], Eq(7));
+        EXPECT_THAT(result[0], Eq(serializeName(7, "raw").getBytes()));
+    }
+
+    TEST_F(PacketSerializerTest, serializeSignalChainEncodesModifiedSectionsOnly)
+    {
+        auto data = serializeSignalChain(2, SignalChain{"raw", amp_settings{}, {}});
+        data[2][63] = 0x44;
+        data[6][50] = 0x55;
+        auto chain = decodeSignalChain(data);
+        auto amp = chain.amp();
+        amp.gain = 0x66;
+        chain.setAmp(amp);
+        chain.setName("edited");
+
+        const auto result = serializeSignalChain(2, chain);
+        EXPECT_THAT(chain.isModified(ChainSection::usbGain), Eq(false));
+        EXPECT_THAT(result[0], Eq(serializeName(2, "edited").getBytes()));
+        EXPECT_THAT(result[1], Eq(serializeAmpSettings(amp).getBytes()));
+        EXPECT_THAT(result[2], Eq(data[2]));
+        EXPECT_THAT(result[6], Eq(data[6]));
+    }
+
+    TEST_F(PacketSerializerTest, serializeSignalChainEncodesEditedEffects)
+    {
+        auto data = serializeSignalChain(2, SignalChain{"raw", amp_settings{}, {}});
+        data[2][63] = 0x44;
+        auto chain = decodeSignalChain(data);
+        const fx_pedal_settings effect{FxSlot{0}, effects::OVERDRIVE, 1, 2, 3, 4, 5, 0, true};
+        chain.setEffects({effect});
+
+        const auto result = serializeSignalChain(2, chain);
+        EXPECT_THAT(chain.isModified(ChainSection::effects), Eq(true));
+        EXPECT_THAT(result[2], Eq(serializeEffectSettings(effect).getBytes()));
+    }
+
+    TEST_F(PacketSerializerTest, signalChainWithoutRawDataIsModified)
+    {
+        const SignalChain chain{"new", amp_settings{}, {}};
+        EXPECT_THAT(chain.raw(), Eq(std::nullopt));
+        EXPECT_THAT(chain.isModified(ChainSection::name), Eq(true));
+        EXPECT_THAT(chain.isModified(ChainSection::effects), Eq(true));
+    }
+
+    TEST_F(PacketSerializerTest, serializeRestoreSlotCommands)
+    {
+        amp_settings amp{};
+        amp.amp_num = amps::METAL_2000;
+        amp.usb_gain = 0x12;
+        const fx_pedal_settings effect{FxSlot{2}, effects::PHASER, 1, 2, 3, 4, 5, 6, true};
+        auto data = serializeSignalChain(9, SignalChain{"restored", amp, {effect}});
+        data[1][0] = 0x1c;
+        data[1][1] = 0x01;
+
+        const auto commands = serializeRestoreSlotCommands(4, data);
+
+        EXPECT_THAT(commands, ElementsAre(serializeAmpSettings(amp).getBytes(),
+                                          serializeClearEffectSettings(fx_pedal_settings{FxSlot{0}, effects::OVERDRIVE, 0, 0, 0, 0, 0, 0, false}).getBytes(),
+                                          serializeEffectSettings(effect).getBytes(),
+                                          serializeClearEffectSettings(fx_pedal_settings{FxSlot{0}, effects::MONO_DELAY, 0, 0, 0, 0, 0, 0, false}).getBytes(),
+                                          serializeClearEffectSettings(fx_pedal_settings{FxSlot{0}, effects::SMALL_HALL_REVERB, 0, 0, 0, 0, 0, 0, false}).getBytes(),
+                                          serializeAmpSettingsUsbGain(amp).getBytes(),
+                                          serializeApplyCommand().getBytes(),
+                                          serializeName(4, "restored").getBytes()));
+    }
 }
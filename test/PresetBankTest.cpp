@@ -0,0 +1,117 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/PresetBank.h"
+#include "com/PacketSerializer.h"
+#include <gmock/gmock.h>
+#include <filesystem>
+#include <fstream>
+
+namespace plug::test
+{
+    using namespace plug::com;
+    using namespace testing;
+    namespace fs = std::filesystem;
+
+    class PresetBankTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            file = (fs::temp_directory_path() / ("plug-bank-test-" + std::string{::testing::UnitTest::GetInstance()->current_test_info()->name()} + ".plugbank")).string();
+        }
+
+        void TearDown() override
+        {
+            fs::remove(file);
+        }
+
+        static PresetRecord createRecord(std::uint8_t slot, const std::string& name)
+        {
+            amp_settings amp{};
+            amp.amp_num = amps::FENDER_57_CHAMP;
+            amp.gain = slot;
+            return serializeSignalChain(slot, SignalChain{name, amp, {}});
+        }
+
+        std::string file;
+    };
+
+    TEST_F(PresetBankTest, writeAndMapBank)
+    {
+        const std::vector<PresetRecord> records{createRecord(0, "first"), createRecord(1, "second"), createRecord(2, "third")};
+        writeBank(file, records);
+
+        EXPECT_THAT(fs::file_size(file), Eq(bank::headerSize + 3 * bank::recordSize));
+
+        const MappedBank mapped{file};
+        ASSERT_THAT(mapped.size(), Eq(3));
+        EXPECT_THAT(mapped.record(0), Eq(records[0]));
+        EXPECT_THAT(mapped.record(2), Eq(records[2]));
+        EXPECT_THAT(mapped.name(1), StrEq("second"));
+        EXPECT_THAT(mapped.decode(2).name(), StrEq("third"));
+        EXPECT_THAT(mapped.decode(2).amp().gain, Eq(2));
+    }
+
+    TEST_F(PresetBankTest, writeEmptyBank)
+    {
+        writeBank(file, {});
+
+        const MappedBank mapped{file};
+        EXPECT_THAT(mapped.size(), Eq(0));
+    }
+
+    TEST_F(PresetBankTest, writeReplacesBank)
+    {
+        writeBank(file, {createRecord(0, "first"), createRecord(1, "second")});
+        writeBank(file, {createRecord(0, "replaced")});
+
+        const MappedBank mapped{file};
+        ASSERT_THAT(mapped.size(), Eq(1));
+        EXPECT_THAT(mapped.name(0), StrEq("replaced"));
+    }
+
+    TEST_F(PresetBankTest, accessOutOfRangeThrows)
+    {
+        writeBank(file, {createRecord(0, "first")});
+
+        const MappedBank mapped{file};
+        EXPECT_THROW(mapped.record(1), std::out_of_range);
+        EXPECT_THROW(mapped.name(1), std::out_of_range);
+    }
+
+    TEST_F(PresetBankTest, mapThrowsOnMissingFile)
+    {
+        EXPECT_THROW(MappedBank{file}, std::runtime_error);
+    }
+
+    TEST_F(PresetBankTest, mapThrowsOnInvalidFile)
+    {
+        std::ofstream{file} << std::string(64, 'x');
+        EXPECT_THROW(MappedBank{file}, std::runtime_error);
+    }
+
+    TEST_F(PresetBankTest, mapThrowsOnTruncatedFile)
+    {
+        writeBank(file, {createRecord(0, "first"), createRecord(1, "second")});
+        fs::resize_file(file, bank::headerSize + bank::recordSize + 10);
+        EXPECT_THROW(MappedBank{file}, std::runtime_error);
+    }
+}
@@ -0,0 +1,191 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "daemon/Protocol.h"
+#include <gmock/gmock.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace plug::test
+{
+    using namespace plug::daemon;
+    using namespace testing;
+
+    class ProtocolTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            ASSERT_THAT(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds.data()), Eq(0));
+        }
+
+        void TearDown() override
+        {
+            ::close(fds[0]);
+            ::close(fds[1]);
+        }
+
+        std::array<int, 2> fds{{-1, -1}};
+    };
+
+    TEST_F(ProtocolTest, encodeMessage)
+    {
+        const auto data = encodeMessage(Message{Request::loadSlot, Status::error, {0xaa, 0xbb, 0xcc}});
+
+        EXPECT_THAT(data, ElementsAre(0x04, 0x01, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0xaa, 0xbb, 0xcc));
+    }
+
+    TEST_F(ProtocolTest, writeAndReadMessage)
+    {
+        writeMessage(fds[0], Message{Request::backup, Status::ok, std::vector<std::uint8_t>(5000, 0x12)});
+
+        const auto message = readMessage(fds[1]);
+        ASSERT_THAT(message.has_value(), IsTrue());
+        EXPECT_THAT(message->type, Eq(Request::backup));
+        EXPECT_THAT(message->status, Eq(Status::ok));
+        EXPECT_THAT(message->payload, Each(Eq(0x12)));
+        EXPECT_THAT(message->payload.size(), Eq(5000));
+    }
+
+    TEST_F(ProtocolTest, readMessageReturnsNothingIfClosed)
+    {
+        ::shutdown(fds[0], SHUT_WR);
+
+        EXPECT_THAT(readMessage(fds[1]).has_value(), IsFalse());
+    }
+
+    TEST_F(ProtocolTest, readMessageThrowsOnIncompleteMessage)
+    {
+        const auto data = encodeMessage(Message{Request::info, Status::ok, {0x01, 0x02}});
+        ASSERT_THAT(::write(fds[0], data.data(), data.size() - 1), Eq(static_cast<ssize_t>(data.size() - 1)));
+        ::shutdown(fds[0], SHUT_WR);
+
+        EXPECT_THROW(readMessage(fds[1]), std::runtime_error);
+    }
+
+    TEST_F(ProtocolTest, readMessageThrowsOnOversizedPayload)
+    {
+        const std::array<std::uint8_t, headerSize> header{{0x01, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x7f}};
+        ASSERT_THAT(::write(fds[0], header.data(), header.size()), Eq(static_cast<ssize_t>(header.size())));
+
+        EXPECT_THROW(readMessage(fds[1]), std::runtime_error);
+    }
+
+    TEST_F(ProtocolTest, messageBufferWaitsForCompleteMessage)
+    {
+        const auto data = encodeMessage(Message{Request::loadSlot, Status::ok, {0x07, 0x08}});
+        MessageBuffer buffer;
+
+        buffer.append(data.data(), 5);
+        EXPECT_THAT(buffer.next().has_value(), IsFalse());
+        buffer.append(data.data() + 5, data.size() - 5);
+        buffer.append(data.data(), data.size());
+
+        for (int i = 0; i < 2; ++i)
+        {
+            const auto message = buffer.next();
+            ASSERT_THAT(message.has_value(), IsTrue());
+            EXPECT_THAT(message->type, Eq(Request::loadSlot));
+            EXPECT_THAT(message->payload, ElementsAre(0x07, 0x08));
+        }
+        EXPECT_THAT(buffer.next().has_value(), IsFalse());
+    }
+
+    TEST_F(ProtocolTest, messageBufferReceiveDoesNotBlockOnPartialMessage)
+    {
+        const auto data = encodeMessage(Message{Request::info, Status::ok, {0x01, 0x02}});
+        ASSERT_THAT(::write(fds[0], data.data(), 3), Eq(3));
+        MessageBuffer buffer;
+
+        EXPECT_THAT(buffer.receive(fds[1]), IsTrue());
+        EXPECT_THAT(buffer.next().has_value(), IsFalse());
+
+        ASSERT_THAT(::write(fds[0], data.data() + 3, data.size() - 3), Eq(static_cast<ssize_t>(data.size() - 3)));
+        EXPECT_THAT(buffer.receive(fds[1]), IsTrue());
+        EXPECT_THAT(buffer.next().has_value(), IsTrue());
+
+        ::shutdown(fds[0], SHUT_WR);
+        EXPECT_THAT(buffer.receive(fds[1]), IsFalse());
+    }
+
+    TEST_F(ProtocolTest, messageBufferThrowsOnOversizedPayload)
+    {
+        const std::array<std::uint8_t, headerSize> header{{0x01, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x7f}};
+        MessageBuffer buffer;
+        buffer.append(header.data(), header.size());
+
+        EXPECT_THROW(buffer.next(), std::runtime_error);
+    }
+
+    TEST_F(ProtocolTest, payloadRoundTrip)
+    {
+        constexpr amp_settings amp{amps::BRITISH_80S, 1, 2, 3, 4, 5, cabinets::cab4x12G, 6, 7, 8, 9, 10, 11, 12, 13, true, 14};
+        constexpr fx_pedal_settings effect{FxSlot{6}, effects::PITCH_SHIFTER, 1, 2, 3, 4, 5, 6, false};
+        com::PresetRecord record{{}};
+        record[3][17] = 0x99;
+
+        PayloadWriter writer;
+        writer.putByte(0x42);
+        writer.putU16(0x1234);
+        writer.putString("preset");
+        writer.putAmp(amp);
+        writer.putEffect(effect);
+        writer.putRecord(record);
+        const auto data = writer.data();
+
+        PayloadReader reader{data};
+        EXPECT_THAT(reader.getByte(), Eq(0x42));
+        EXPECT_THAT(reader.getU16(), Eq(0x1234));
+        EXPECT_THAT(reader.getString(), StrEq("preset"));
+
+        const auto resultAmp = reader.getAmp();
+        EXPECT_THAT(resultAmp.amp_num, Eq(amps::BRITISH_80S));
+        EXPECT_THAT(resultAmp.cabinet, Eq(cabinets::cab4x12G));
+        EXPECT_THAT(resultAmp.sag, Eq(13));
+        EXPECT_THAT(resultAmp.brightness, IsTrue());
+        EXPECT_THAT(resultAmp.usb_gain, Eq(14));
+
+        const auto resultEffect = reader.getEffect();
+        EXPECT_THAT(resultEffect.slot.id(), Eq(6));
+        EXPECT_THAT(resultEffect.effect_num, Eq(effects::PITCH_SHIFTER));
+        EXPECT_THAT(resultEffect.knob6, Eq(6));
+        EXPECT_THAT(resultEffect.enabled, IsFalse());
+
+        EXPECT_THAT(reader.getRecord(), Eq(record));
+        EXPECT_THAT(reader.atEnd(), IsTrue());
+    }
+
+    TEST_F(ProtocolTest, payloadReaderThrowsIfTruncated)
+    {
+        const std::vector<std::uint8_t> data{0x05, 0x00, 'a', 'b'};
+        PayloadReader reader{data};
+
+        EXPECT_THROW(reader.getString(), std::invalid_argument);
+    }
+
+    TEST_F(ProtocolTest, payloadReaderThrowsOnInvalidEnumValue)
+    {
+        std::vector<std::uint8_t> data(17, 0x00);
+        data[0] = 0xf0;
+        PayloadReader reader{data};
+
+        EXPECT_THROW(reader.getAmp(), std::invalid_argument);
+    }
+}
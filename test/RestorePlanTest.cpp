@@ -0,0 +1,106 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/RestorePlan.h"
+#include "com/PacketSerializer.h"
+#include "helper/SignalChains.h"
+#include <gmock/gmock.h>
+
+namespace plug::test
+{
+    using namespace plug::com;
+    using namespace testing;
+
+    class RestorePlanTest : public testing::Test
+    {
+    protected:
+        static PresetRecord createRecord(std::uint8_t slot, const SignalChain& chain)
+        {
+            return serializeSignalChain(slot, chain);
+        }
+
+        const fx_pedal_settings delay{FxSlot{2}, effects::MONO_DELAY, 1, 2, 3, 4, 5, 0, true};
+        const fx_pedal_settings chorus{FxSlot{1}, effects::SINE_CHORUS, 1, 2, 3, 4, 5, 0, true};
+        const fx_pedal_settings reverb{FxSlot{3}, effects::SMALL_HALL_REVERB, 1, 2, 3, 4, 5, 0, true};
+    };
+
+    TEST_F(RestorePlanTest, identicalSlotsAreSkipped)
+    {
+        const std::vector<PresetRecord> bank{createRecord(0, createChain("a", 1)), createRecord(1, createChain("b", 2))};
+
+        EXPECT_THAT(planRestore(bank, bank), IsEmpty());
+    }
+
+    TEST_F(RestorePlanTest, headersAreIgnored)
+    {
+        const std::vector<PresetRecord> current{createRecord(0, createChain("a", 1))};
+        auto target = current;
+        target[0][1][0] = 0x1c;
+        target[0][4][3] = 0x00;
+
+        EXPECT_THAT(planRestore(current, target), IsEmpty());
+    }
+
+    TEST_F(RestorePlanTest, renamedSlotIsSavedWithoutSections)
+    {
+        const std::vector<PresetRecord> current{createRecord(0, createChain("a", 1)), createRecord(1, createChain("b", 2))};
+        const std::vector<PresetRecord> target{current[0], createRecord(1, createChain("renamed", 2))};
+
+        const auto plan = planRestore(current, target);
+        ASSERT_THAT(plan.size(), Eq(1));
+        EXPECT_THAT(plan[0].slot, Eq(1));
+        EXPECT_THAT(plan[0].selectSlot, IsTrue());
+        EXPECT_THAT(plan[0].commands, ElementsAre(serializeName(1, "renamed").getBytes()));
+    }
+
+    TEST_F(RestorePlanTest, changedSectionsAreSentPartially)
+    {
+        const std::vector<PresetRecord> current{createRecord(0, createChain("a", 1, {delay}))};
+        const std::vector<PresetRecord> target{createRecord(0, createChain("a", 7, {delay}))};
+
+        const auto plan = planRestore(current, target);
+        ASSERT_THAT(plan.size(), Eq(1));
+        EXPECT_THAT(plan[0].selectSlot, IsTrue());
+        EXPECT_THAT(plan[0].commands, ElementsAre(serializeAmpSettings(createChain("a", 7).amp()).getBytes(),
+                                                  serializeApplyCommand().getBytes(),
+                                                  serializeName(0, "a").getBytes()));
+    }
+
+    TEST_F(RestorePlanTest, slotIsWrittenCompletelyIfManySectionsChanged)
+    {
+        const std::vector<PresetRecord> current{createRecord(0, createChain("a", 1))};
+        const auto targetChain = createChain("a", 3, {chorus, delay, reverb});
+        const std::vector<PresetRecord> target{createRecord(0, targetChain)};
+        const auto commands = serializeRestoreSlotCommands(0, target[0]);
+
+        const auto plan = planRestore(current, target);
+        ASSERT_THAT(plan.size(), Eq(1));
+        EXPECT_THAT(plan[0].selectSlot, IsFalse());
+        EXPECT_THAT(plan[0].commands, ElementsAreArray(commands));
+    }
+
+    TEST_F(RestorePlanTest, throwsIfTargetHasMoreSlots)
+    {
+        const std::vector<PresetRecord> current{createRecord(0, createChain("a", 1))};
+        const std::vector<PresetRecord> target{current[0], current[0]};
+
+        EXPECT_THROW(planRestore(current, target), std::invalid_argument);
+    }
+}
@@ -0,0 +1,159 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/SceneMorph.h"
+#include "com/PacketSerializer.h"
+#include "mocks/MockConnection.h"
+#include "helper/SignalChains.h"
+#include <gmock/gmock.h>
+
+namespace plug::test
+{
+    using namespace plug::com;
+    using namespace testing;
+    using namespace std::chrono_literals;
+
+    class SceneMorphTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            auto connection = std::make_unique<NiceMock<mock::MockConnection>>();
+            conn = connection.get();
+            m = std::make_unique<Mustang>(std::move(connection));
+            morph = std::make_unique<SceneMorph>(
+                *m, [this]
+                { return time; },
+                [this](SceneMorph::Clock::time_point t)
+                { time = std::max(time, t); });
+
+            ON_CALL(*conn, sendImpl(_, _)).WillByDefault([this](std::uint8_t*, std::size_t size)
+                                                        { time += costPerPacket; return size; });
+            ON_CALL(*conn, receive(_)).WillByDefault(Return(std::vector<std::uint8_t>(packetRawTypeSize)));
+        }
+
+
+        NiceMock<mock::MockConnection>* conn;
+        std::unique_ptr<Mustang> m;
+        std::unique_ptr<SceneMorph> morph;
+        SceneMorph::Clock::time_point time{};
+        SceneMorph::Clock::duration costPerPacket{1ms};
+        const fx_pedal_settings chorus{FxSlot{1}, effects::SINE_CHORUS, 0, 10, 20, 30, 40, 0, true};
+        const fx_pedal_settings fastChorus{FxSlot{1}, effects::SINE_CHORUS, 100, 110, 120, 130, 140, 0, true};
+        const fx_pedal_settings flanger{FxSlot{1}, effects::SINE_FLANGER, 1, 2, 3, 4, 5, 0, true};
+    };
+
+    TEST_F(SceneMorphTest, interpolateEndpoints)
+    {
+        const auto from = createChain("chain", 0, {chorus}, amps::FENDER_57_CHAMP);
+        const auto to = createChain("chain", 200, {fastChorus}, amps::BRITISH_80S);
+
+        EXPECT_THAT(interpolate(from, to, 0.0).amp().gain, Eq(0));
+        EXPECT_THAT(interpolate(from, to, 0.0).amp().amp_num, Eq(amps::FENDER_57_CHAMP));
+        EXPECT_THAT(interpolate(from, to, 1.0).amp().gain, Eq(200));
+        EXPECT_THAT(interpolate(from, to, 1.0).amp().amp_num, Eq(amps::BRITISH_80S));
+        EXPECT_THAT(interpolate(from, to, 1.0).effects()[0].knob5, Eq(140));
+    }
+
+    TEST_F(SceneMorphTest, interpolateContinuousValues)
+    {
+        const auto from = createChain("chain", 0, {chorus}, amps::FENDER_57_CHAMP);
+        auto to = createChain("chain", 200, {fastChorus}, amps::FENDER_57_CHAMP);
+        auto amp = to.amp();
+        amp.volume = 200;
+        to.setAmp(amp);
+
+        const auto result = interpolate(from, to, 0.25);
+        EXPECT_THAT(result.amp().gain, Eq(50));
+        EXPECT_THAT(result.amp().volume, Eq(50));
+        ASSERT_THAT(result.effects().size(), Eq(1));
+        EXPECT_THAT(result.effects()[0].knob1, Eq(25));
+        EXPECT_THAT(result.effects()[0].knob2, Eq(35));
+    }
+
+    TEST_F(SceneMorphTest, interpolateSwitchesModelsAtSwitchPoint)
+    {
+        const auto from = createChain("chain", 0, {chorus}, amps::FENDER_57_CHAMP);
+        const auto to = createChain("chain", 100, {flanger}, amps::BRITISH_80S);
+
+        EXPECT_THAT(interpolate(from, to, 0.2, 0.3).amp().amp_num, Eq(amps::FENDER_57_CHAMP));
+        EXPECT_THAT(interpolate(from, to, 0.2, 0.3).effects()[0].effect_num, Eq(effects::SINE_CHORUS));
+        EXPECT_THAT(interpolate(from, to, 0.3, 0.3).amp().amp_num, Eq(amps::BRITISH_80S));
+        EXPECT_THAT(interpolate(from, to, 0.3, 0.3).effects()[0].effect_num, Eq(effects::SINE_FLANGER));
+        EXPECT_THAT(interpolate(from, to, 0.3, 0.3).effects()[0].knob1, Eq(1));
+    }
+
+    TEST_F(SceneMorphTest, interpolateRemovesEffectAtSwitchPoint)
+    {
+        const auto from = createChain("chain", 0, {chorus}, amps::FENDER_57_CHAMP);
+        const auto to = createChain("chain", 0, {}, amps::FENDER_57_CHAMP);
+
+        EXPECT_THAT(interpolate(from, to, 0.4).effects().size(), Eq(1));
+        EXPECT_THAT(interpolate(from, to, 0.6).effects(), IsEmpty());
+    }
+
+    TEST_F(SceneMorphTest, runRespectsFrameRate)
+    {
+        const auto from = createChain("chain", 0, {}, amps::FENDER_57_CHAMP);
+        const auto to = createChain("chain", 255, {}, amps::FENDER_57_CHAMP);
+
+        const auto frames = morph->run(from, to, 200ms);
+
+        EXPECT_THAT(frames, Le(200ms / SceneMorph::minFrameInterval + 1));
+        EXPECT_THAT(frames, Ge(2));
+        EXPECT_THAT(morph->frameInterval(), Eq(SceneMorph::minFrameInterval));
+    }
+
+    TEST_F(SceneMorphTest, runAdaptsToSlowAmp)
+    {
+        costPerPacket = 10ms;
+        const auto from = createChain("chain", 0, {}, amps::FENDER_57_CHAMP);
+        const auto to = createChain("chain", 255, {}, amps::FENDER_57_CHAMP);
+
+        const auto frames = morph->run(from, to, 400ms);
+
+        EXPECT_THAT(morph->frameInterval(), Eq(20ms));
+        EXPECT_THAT(frames, Le(400ms / 20ms + 1));
+    }
+
+    TEST_F(SceneMorphTest, runWithoutDurationSendsTargetOnce)
+    {
+        const auto from = createChain("chain", 0, {chorus}, amps::FENDER_57_CHAMP);
+        const auto to = createChain("chain", 255, {chorus}, amps::FENDER_57_CHAMP);
+
+        EXPECT_CALL(*conn, sendImpl(_, _)).Times(2);
+        EXPECT_THAT(morph->run(from, to, 0ms), Eq(1));
+    }
+
+    TEST_F(SceneMorphTest, runSendsNothingForIdenticalChains)
+    {
+        const auto chain = createChain("chain", 10, {chorus}, amps::FENDER_57_CHAMP);
+
+        EXPECT_CALL(*conn, sendImpl(_, _)).Times(0);
+        EXPECT_THAT(morph->run(chain, chain, 100ms), Eq(0));
+    }
+
+    TEST_F(SceneMorphTest, rateLimitBoundsFrameInterval)
+    {
+        morph->setRateLimit(RateLimit{10.0, 0us});
+
+        EXPECT_THAT(morph->frameInterval(), Eq(100ms));
+    }
+}
@@ -0,0 +1,113 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "library/SearchIndex.h"
+#include <gmock/gmock.h>
+
+namespace plug::test
+{
+    using namespace plug::library;
+    using namespace testing;
+
+    class SearchIndexTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            index.insert(10, "Clean Sparkle", "Fender '65 Twin Reverb Small Hall Reverb");
+            index.insert(11, "Crunch Rhythm", "British 70's Overdrive");
+            index.insert(12, "Lead Solo", "Metal 2000 Mono Delay Large Hall Reverb");
+            index.insert(13, "Clean Jazz", "Fender '59 Bassman");
+        }
+
+        SearchIndex index;
+    };
+
+    TEST_F(SearchIndexTest, emptyQueryMatchesAll)
+    {
+        EXPECT_THAT(index.search(""), ElementsAre(10, 11, 12, 13));
+        EXPECT_THAT(index.search("  "), ElementsAre(10, 11, 12, 13));
+    }
+
+    TEST_F(SearchIndexTest, searchByName)
+    {
+        EXPECT_THAT(index.search("clean"), ElementsAre(10, 13));
+        EXPECT_THAT(index.search("Solo"), ElementsAre(12));
+    }
+
+    TEST_F(SearchIndexTest, searchByMetadata)
+    {
+        EXPECT_THAT(index.search("hall reverb"), ElementsAre(10, 12));
+        EXPECT_THAT(index.search("bassman"), ElementsAre(13));
+        EXPECT_THAT(index.search("'65"), ElementsAre(10));
+    }
+
+    TEST_F(SearchIndexTest, searchWithShortTerms)
+    {
+        EXPECT_THAT(index.search("c"), ElementsAre(10, 11, 13));
+        EXPECT_THAT(index.search("ja"), ElementsAre(13));
+    }
+
+    TEST_F(SearchIndexTest, searchRequiresAllTerms)
+    {
+        EXPECT_THAT(index.search("clean twin"), ElementsAre(10));
+        EXPECT_THAT(index.search("lead twin"), IsEmpty());
+    }
+
+    TEST_F(SearchIndexTest, searchWithoutMatch)
+    {
+        EXPECT_THAT(index.search("xyz"), IsEmpty());
+    }
+
+    TEST_F(SearchIndexTest, incrementalSearch)
+    {
+        EXPECT_THAT(index.search("c"), ElementsAre(10, 11, 13));
+        EXPECT_THAT(index.search("cl"), ElementsAre(10, 13));
+        EXPECT_THAT(index.search("cle"), ElementsAre(10, 13));
+        EXPECT_THAT(index.search("clean j"), ElementsAre(13));
+        EXPECT_THAT(index.search("clean"), ElementsAre(10, 13));
+        EXPECT_THAT(index.search("cr"), ElementsAre(11));
+    }
+
+    TEST_F(SearchIndexTest, insertInvalidatesPreviousSearch)
+    {
+        EXPECT_THAT(index.search("clean"), ElementsAre(10, 13));
+        index.insert(14, "Clean Blues");
+        EXPECT_THAT(index.search("clean"), ElementsAre(10, 13, 14));
+    }
+
+    TEST_F(SearchIndexTest, clearRemovesEntries)
+    {
+        index.clear();
+        EXPECT_THAT(index.size(), Eq(0));
+        EXPECT_THAT(index.search(""), IsEmpty());
+    }
+
+    TEST_F(SearchIndexTest, describeSignalChain)
+    {
+        const SignalChain chain{"name",
+                                amp_settings{amps::BRITISH_80S, 0, 0, 0, 0, 0, cabinets::OFF, 0, 0, 0, 0, 0, 0, 0, 0, false, 0},
+                                {fx_pedal_settings{FxSlot{0}, effects::OVERDRIVE, 0, 0, 0, 0, 0, 0},
+                                 fx_pedal_settings{FxSlot{1}, effects::EMPTY, 0, 0, 0, 0, 0, 0},
+                                 fx_pedal_settings{FxSlot{2}, effects::TAPE_DELAY, 0, 0, 0, 0, 0, 0}}};
+
+        EXPECT_THAT(library::describeSignalChain(chain), Eq("British 80's Overdrive Tape Delay"));
+    }
+}
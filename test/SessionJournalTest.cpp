@@ -0,0 +1,197 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/SessionJournal.h"
+#include "helper/SignalChains.h"
+#include <gmock/gmock.h>
+#include <filesystem>
+#include <fstream>
+
+namespace plug::test
+{
+    using namespace plug::com;
+    using namespace testing;
+    namespace fs = std::filesystem;
+
+    class SessionJournalTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            file = (fs::temp_directory_path() / ("plug-journal-test-" + std::string{::testing::UnitTest::GetInstance()->current_test_info()->name()} + ".journal")).string();
+        }
+
+        void TearDown() override
+        {
+            fs::remove(file);
+        }
+
+
+        static void expectChain(const std::optional<SignalChain>& actual, const SignalChain& expected)
+        {
+            ASSERT_THAT(actual, Ne(std::nullopt));
+            EXPECT_THAT(actual->name(), Eq(expected.name()));
+            EXPECT_THAT(actual->amp(), Eq(expected.amp()));
+            EXPECT_THAT(actual->effects(), Eq(expected.effects()));
+        }
+
+        std::string file;
+        const fx_pedal_settings phaser{FxSlot{2}, effects::PHASER, 10, 20, 30, 40, 50, 0, true};
+        const fx_pedal_settings reverb{FxSlot{6}, effects::ARENA_REVERB, 1, 2, 3, 4, 5, 0, true};
+    };
+
+    TEST_F(SessionJournalTest, recoverInitialChain)
+    {
+        const auto chain = createChain("initial", 5, {phaser});
+        SessionJournal journal{file, chain};
+
+        expectChain(recoverJournal(file), chain);
+    }
+
+    TEST_F(SessionJournalTest, recoverUpdates)
+    {
+        SessionJournal journal{file, createChain("chain", 5, {phaser})};
+        auto changedPhaser = phaser;
+        changedPhaser.knob2 = 99;
+        journal.update(createChain("chain", 6, {phaser}));
+        journal.update(createChain("chain", 6, {changedPhaser, reverb}));
+        journal.update(createChain("chain", 7, {reverb}));
+        journal.flush();
+
+        expectChain(recoverJournal(file), createChain("chain", 7, {reverb}));
+    }
+
+    TEST_F(SessionJournalTest, recoverRenamedChain)
+    {
+        SessionJournal journal{file, createChain("first", 5)};
+        journal.update(createChain("second", 8, {reverb}));
+        journal.flush();
+
+        expectChain(recoverJournal(file), createChain("second", 8, {reverb}));
+    }
+
+    TEST_F(SessionJournalTest, recoverKeepsUnknownIds)
+    {
+        SessionJournal journal{file, createChain("chain", 5)};
+        auto unknownReverb = reverb;
+        unknownReverb.unknownModel = 0xee;
+        auto chain = createChain("chain", 6, {unknownReverb});
+        auto amp = chain.amp();
+        amp.unknownCabinet = 0x20;
+        chain.setAmp(amp);
+        journal.update(chain);
+        journal.flush();
+
+        expectChain(recoverJournal(file), chain);
+    }
+
+    TEST_F(SessionJournalTest, destructionWritesPendingUpdates)
+    {
+        {
+            SessionJournal journal{file, createChain("chain", 5)};
+            journal.update(createChain("chain", 9));
+        }
+
+        expectChain(recoverJournal(file), createChain("chain", 9));
+    }
+
+    TEST_F(SessionJournalTest, unchangedChainAppendsNothing)
+    {
+        SessionJournal journal{file, createChain("chain", 5)};
+        journal.flush();
+        const auto size = fs::file_size(file);
+
+        journal.update(createChain("chain", 5));
+        journal.flush();
+
+        EXPECT_THAT(fs::file_size(file), Eq(size));
+    }
+
+    TEST_F(SessionJournalTest, updatesAppendOnlyChangedParts)
+    {
+        SessionJournal journal{file, createChain("chain", 5, {phaser})};
+        journal.flush();
+        const auto size = fs::file_size(file);
+
+        journal.update(createChain("chain", 5, {phaser, reverb}));
+        journal.flush();
+
+        EXPECT_THAT(fs::file_size(file) - size, Eq(2 + 1 + tone::fieldsPerSlot + 4));
+    }
+
+    TEST_F(SessionJournalTest, recoverIgnoresTornRecord)
+    {
+        {
+            SessionJournal journal{file, createChain("chain", 5)};
+            journal.update(createChain("chain", 6));
+            journal.flush();
+            journal.update(createChain("chain", 7));
+        }
+        fs::resize_file(file, fs::file_size(file) - 1);
+
+        expectChain(recoverJournal(file), createChain("chain", 6));
+    }
+
+    TEST_F(SessionJournalTest, recoverIgnoresCorruptRecord)
+    {
+        {
+            SessionJournal journal{file, createChain("chain", 5)};
+            journal.update(createChain("chain", 6));
+        }
+        {
+            std::fstream stream{file, std::ios::binary | std::ios::in | std::ios::out};
+            stream.seekp(-5, std::ios::end);
+            stream.put(0x7f);
+        }
+
+        expectChain(recoverJournal(file), createChain("chain", 5));
+    }
+
+    TEST_F(SessionJournalTest, compactionKeepsLatestChain)
+    {
+        SessionJournal journal{file, createChain("chain", 0), JournalPolicy{std::chrono::milliseconds{0}, 256}};
+
+        for (std::uint8_t gain = 1; gain < 200; ++gain)
+        {
+            journal.update(createChain("chain", gain, {phaser}));
+            journal.flush();
+        }
+
+        EXPECT_THAT(fs::file_size(file), Le(256 + 64));
+        expectChain(recoverJournal(file), createChain("chain", 199, {phaser}));
+    }
+
+    TEST_F(SessionJournalTest, recoverWithoutJournalReturnsNothing)
+    {
+        EXPECT_THAT(recoverJournal(file), Eq(std::nullopt));
+    }
+
+    TEST_F(SessionJournalTest, recoverInvalidFileReturnsNothing)
+    {
+        std::ofstream{file} << "not a journal at all";
+
+        EXPECT_THAT(recoverJournal(file), Eq(std::nullopt));
+    }
+
+    TEST_F(SessionJournalTest, createThrowsOnInvalidPath)
+    {
+        EXPECT_THROW(SessionJournal(file + "/missing/journal", createChain("chain", 0)), std::runtime_error);
+    }
+}
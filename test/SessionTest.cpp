@@ -0,0 +1,223 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "daemon/Session.h"
+#include "daemon/Client.h"
+#include "com/PacketSerializer.h"
+#include "com/CommunicationException.h"
+#include "mocks/MockConnection.h"
+#include "matcher/Matcher.h"
+#include <gmock/gmock.h>
+#include <filesystem>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace plug::test
+{
+    using namespace plug::test::matcher;
+    using namespace plug::daemon;
+    using namespace testing;
+
+    class SessionTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            auto connection = std::make_unique<mock::MockConnection>();
+            conn = connection.get();
+            session = std::make_unique<Session>(std::move(connection));
+        }
+
+        static std::string errorOf(const Message& message)
+        {
+            PayloadReader reader{message.payload};
+            return reader.getString();
+        }
+
+        mock::MockConnection* conn;
+        std::unique_ptr<Session> session;
+        const std::vector<std::uint8_t> ignoreData = std::vector<std::uint8_t>(com::packetRawTypeSize);
+    };
+
+    TEST_F(SessionTest, infoReturnsDevice)
+    {
+        EXPECT_CALL(*conn, modelVersion()).WillOnce(Return(com::ModelVersion::v2));
+        EXPECT_CALL(*conn, name()).WillOnce(Return("Mustang"));
+
+        const auto response = session->handle(Message{Request::info, Status::ok, {}});
+        ASSERT_THAT(response.status, Eq(Status::ok));
+
+        PayloadReader reader{response.payload};
+        EXPECT_THAT(reader.getByte(), Eq(2));
+        EXPECT_THAT(reader.getString(), StrEq("Mustang"));
+    }
+
+    TEST_F(SessionTest, setAmpSendsSettings)
+    {
+        amp_settings amp{};
+        amp.amp_num = amps::FENDER_65_TWIN_REVERB;
+        amp.gain = 0x31;
+        const auto ampCmd = com::serializeAmpSettings(amp).getBytes();
+        PayloadWriter writer;
+        writer.putAmp(amp);
+
+        EXPECT_CALL(*conn, sendImpl(_, _)).WillRepeatedly(Return(com::packetRawTypeSize));
+        EXPECT_CALL(*conn, sendImpl(BufferIs(ampCmd), ampCmd.size())).WillOnce(Return(ampCmd.size()));
+        EXPECT_CALL(*conn, receive(com::packetRawTypeSize)).Times(4).WillRepeatedly(Return(ignoreData));
+
+        EXPECT_THAT(session->handle(Message{Request::setAmp, Status::ok, writer.data()}).status, Eq(Status::ok));
+
+        const auto current = session->handle(Message{Request::current, Status::ok, {}});
+        PayloadReader reader{current.payload};
+        EXPECT_THAT(com::decodeSignalChain(reader.getRecord()).amp().gain, Eq(0x31));
+    }
+
+    TEST_F(SessionTest, setEffectReplacesEffectOfSameDsp)
+    {
+        const fx_pedal_settings overdrive{FxSlot{0}, effects::OVERDRIVE, 1, 2, 3, 4, 5, 6, true};
+        const fx_pedal_settings delay{FxSlot{2}, effects::MONO_DELAY, 1, 2, 3, 4, 5, 6, true};
+        const fx_pedal_settings tapeDelay{FxSlot{5}, effects::TAPE_DELAY, 6, 5, 4, 3, 2, 1, true};
+
+        EXPECT_CALL(*conn, sendImpl(_, _)).WillRepeatedly(Return(com::packetRawTypeSize));
+        EXPECT_CALL(*conn, receive(com::packetRawTypeSize)).WillRepeatedly(Return(ignoreData));
+
+        session->setEffect(overdrive);
+        session->setEffect(delay);
+        session->setEffect(tapeDelay);
+
+        EXPECT_THAT(session->currentChain().effects(), UnorderedElementsAre(overdrive, tapeDelay));
+    }
+
+    TEST_F(SessionTest, morphToPresetEndsOnTarget)
+    {
+        amp_settings amp{};
+        amp.amp_num = amps::FENDER_65_TWIN_REVERB;
+        amp.gain = 0x31;
+        PayloadWriter writer;
+        writer.putByte(static_cast<std::uint8_t>(MorphTarget::preset));
+        writer.putRecord(com::serializeSignalChain(0, SignalChain{"target", amp, {}}));
+        writer.putU16(0);
+
+        EXPECT_CALL(*conn, sendImpl(_, _)).WillRepeatedly(Return(com::packetRawTypeSize));
+        EXPECT_CALL(*conn, receive(com::packetRawTypeSize)).WillRepeatedly(Return(ignoreData));
+
+        const auto response = session->handle(Message{Request::morph, Status::ok, writer.data()});
+        ASSERT_THAT(response.status, Eq(Status::ok));
+
+        PayloadReader reader{response.payload};
+        EXPECT_THAT(reader.getU16(), Eq(1));
+        EXPECT_THAT(session->currentChain().name(), StrEq("target"));
+        EXPECT_THAT(session->currentChain().amp().gain, Eq(0x31));
+    }
+
+    TEST_F(SessionTest, morphIsPacedByRateLimit)
+    {
+        amp_settings amp{};
+        amp.amp_num = amps::FENDER_65_TWIN_REVERB;
+        amp.gain = 0xff;
+        PayloadWriter writer;
+        writer.putByte(static_cast<std::uint8_t>(MorphTarget::preset));
+        writer.putRecord(com::serializeSignalChain(0, SignalChain{"target", amp, {}}));
+        writer.putU16(100);
+
+        EXPECT_CALL(*conn, sendImpl(_, _)).WillRepeatedly(Return(com::packetRawTypeSize));
+        EXPECT_CALL(*conn, receive(com::packetRawTypeSize)).WillRepeatedly(Return(ignoreData));
+
+        session->setRateLimit(com::RateLimit{10.0, std::chrono::microseconds{0}});
+        const auto response = session->handle(Message{Request::morph, Status::ok, writer.data()});
+        ASSERT_THAT(response.status, Eq(Status::ok));
+
+        PayloadReader reader{response.payload};
+        EXPECT_THAT(reader.getU16(), Le(3));
+    }
+
+    TEST_F(SessionTest, morphRejectsInvalidTarget)
+    {
+        const auto invalidSlot = session->handle(Message{Request::morph, Status::ok, {static_cast<std::uint8_t>(MorphTarget::slot), 3, 0x00, 0x00}});
+        EXPECT_THAT(invalidSlot.status, Eq(Status::error));
+        EXPECT_THAT(errorOf(invalidSlot), HasSubstr("Invalid slot"));
+
+        const auto invalidType = session->handle(Message{Request::morph, Status::ok, {0x07, 0x00, 0x00, 0x00}});
+        EXPECT_THAT(invalidType.status, Eq(Status::error));
+        EXPECT_THAT(errorOf(invalidType), HasSubstr("Invalid morph target"));
+    }
+
+    TEST_F(SessionTest, invalidSlotIsRejected)
+    {
+        const auto response = session->handle(Message{Request::loadSlot, Status::ok, {3}});
+
+        EXPECT_THAT(response.status, Eq(Status::error));
+        EXPECT_THAT(errorOf(response), HasSubstr("Invalid slot"));
+    }
+
+    TEST_F(SessionTest, truncatedRequestIsRejected)
+    {
+        const auto response = session->handle(Message{Request::setAmp, Status::ok, {0x01, 0x02}});
+
+        EXPECT_THAT(response.status, Eq(Status::error));
+        EXPECT_THAT(errorOf(response), StrEq("Truncated message"));
+    }
+
+    TEST_F(SessionTest, unknownRequestIsRejected)
+    {
+        const auto response = session->handle(Message{static_cast<Request>(0x7f), Status::ok, {}});
+
+        EXPECT_THAT(response.status, Eq(Status::error));
+        EXPECT_THAT(response.type, Eq(static_cast<Request>(0x7f)));
+    }
+
+    TEST_F(SessionTest, clientRequestsAreServed)
+    {
+        const auto socketPath = (std::filesystem::temp_directory_path() / ("plugd-test-" + std::to_string(::getpid()) + ".sock")).string();
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        socketPath.copy(address.sun_path, sizeof(address.sun_path) - 1);
+
+        const int listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        ::unlink(socketPath.c_str());
+        ASSERT_THAT(::bind(listenFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)), Eq(0));
+        ASSERT_THAT(::listen(listenFd, 1), Eq(0));
+
+        std::thread server{[this, listenFd]
+                           {
+                               const int fd = ::accept(listenFd, nullptr, nullptr);
+
+                               while (const auto request = readMessage(fd))
+                               {
+                                   writeMessage(fd, session->handle(*request));
+                               }
+                               ::close(fd);
+                           }};
+
+        EXPECT_CALL(*conn, name()).WillOnce(Return("Mustang over socket"));
+
+        {
+            Client client{socketPath};
+            EXPECT_THAT(client.getDeviceName(), StrEq("Mustang over socket"));
+            EXPECT_THROW(client.load_memory_bank(5), com::CommunicationException);
+        }
+
+        server.join();
+        ::close(listenFd);
+        ::unlink(socketPath.c_str());
+    }
+}
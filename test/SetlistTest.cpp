@@ -0,0 +1,184 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "library/Setlist.h"
+#include "library/FuseFormat.h"
+#include "com/PacketSerializer.h"
+#include "mocks/MockConnection.h"
+#include "helper/SignalChains.h"
+#include <gmock/gmock.h>
+#include <filesystem>
+#include <fstream>
+
+namespace plug::test
+{
+    using namespace plug::library;
+    using namespace testing;
+    namespace fs = std::filesystem;
+
+    class SetlistTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            directory = fs::temp_directory_path() / ("plug-setlist-test-" + std::string{::testing::UnitTest::GetInstance()->current_test_info()->name()});
+            fs::create_directories(directory);
+            saveFuseFile((directory / "first.fuse").string(), first);
+            saveFuseFile((directory / "second.fuse").string(), second);
+
+            auto connection = std::make_unique<NiceMock<mock::MockConnection>>();
+            conn = connection.get();
+            ON_CALL(*conn, sendImpl(_, _)).WillByDefault([this](std::uint8_t* data, std::size_t size)
+                                                        {
+                                                            com::PacketRawType packet{};
+                                                            std::copy_n(data, size, packet.begin());
+                                                            sent.push_back(packet);
+                                                            return size; });
+            m = std::make_unique<com::Mustang>(std::move(connection));
+        }
+
+        void TearDown() override
+        {
+            fs::remove_all(directory);
+        }
+
+
+        std::vector<SetlistEntry> files() const
+        {
+            return {(directory / "first.fuse").string(), (directory / "second.fuse").string()};
+        }
+
+        fs::path directory;
+        NiceMock<mock::MockConnection>* conn;
+        std::unique_ptr<com::Mustang> m;
+        std::vector<com::PacketRawType> sent;
+        const SignalChain first{createChain("first", 0x80, {fx_pedal_settings{FxSlot{1}, effects::SINE_CHORUS, 1, 2, 3, 4, 5, 0, true}}, amps::BRITISH_60S)};
+        const SignalChain second{createChain("second", 0x80, {}, amps::METAL_2000)};
+    };
+
+    TEST_F(SetlistTest, parseSetlist)
+    {
+        const auto entries = parseSetlist("# opener\n3\n\n  song.fuse  \n/presets/other.fuse\n", "/setlists", 100);
+
+        ASSERT_THAT(entries.size(), Eq(3));
+        EXPECT_THAT(std::get<AmpSlot>(entries[0]).slot, Eq(2));
+        EXPECT_THAT(std::get<std::string>(entries[1]), Eq("/setlists/song.fuse"));
+        EXPECT_THAT(std::get<std::string>(entries[2]), Eq("/presets/other.fuse"));
+    }
+
+    TEST_F(SetlistTest, parseSetlistThrowsOnInvalidSlot)
+    {
+        EXPECT_THROW(parseSetlist("0\n", "/setlists", 100), std::invalid_argument);
+        EXPECT_THROW(parseSetlist("101\n", "/setlists", 100), std::invalid_argument);
+        EXPECT_THROW(parseSetlist("99999999999999999999\n", "/setlists", 100), std::invalid_argument);
+    }
+
+    TEST_F(SetlistTest, parseSetlistAcceptsLastSlot)
+    {
+        const auto entries = parseSetlist("1\n100\n", "/setlists", 100);
+
+        ASSERT_THAT(entries.size(), Eq(2));
+        EXPECT_THAT(std::get<AmpSlot>(entries[0]).slot, Eq(0));
+        EXPECT_THAT(std::get<AmpSlot>(entries[1]).slot, Eq(99));
+    }
+
+    TEST_F(SetlistTest, selectSendsPreparedChain)
+    {
+        SetlistPlayer player{*m, files()};
+        const auto transition = player.select(1);
+
+        EXPECT_THAT(transition.index, Eq(1));
+        EXPECT_THAT(player.current().name(), Eq("second"));
+        EXPECT_THAT(sent, ContainerEq(com::serializeSignalChainCommands(player.current())));
+    }
+
+    TEST_F(SetlistTest, nextAndPreviousStepThroughSetlist)
+    {
+        SetlistPlayer player{*m, files()};
+
+        EXPECT_THAT(player.previous(), Eq(std::nullopt));
+        EXPECT_THAT(player.next()->index, Eq(0));
+        EXPECT_THAT(player.current().amp().amp_num, Eq(amps::BRITISH_60S));
+        EXPECT_THAT(player.next()->index, Eq(1));
+        EXPECT_THAT(player.current().amp().amp_num, Eq(amps::METAL_2000));
+        EXPECT_THAT(player.next(), Eq(std::nullopt));
+        EXPECT_THAT(player.previous()->index, Eq(0));
+        EXPECT_THAT(player.position(), Eq(0));
+    }
+
+    TEST_F(SetlistTest, nextEntryIsPrefetched)
+    {
+        SetlistPlayer player{*m, files()};
+        player.next();
+        player.waitForPrefetch();
+
+        const auto transition = player.next();
+        ASSERT_THAT(transition, Ne(std::nullopt));
+        EXPECT_THAT(transition->prefetched, IsTrue());
+        EXPECT_THAT(transition->latency, Gt(SetlistPlayer::Clock::duration::zero()));
+    }
+
+    TEST_F(SetlistTest, ampSlotsAreReadUpFront)
+    {
+        const auto record = com::serializeSignalChain(7, second);
+        EXPECT_CALL(*conn, receive(_)).WillRepeatedly(Return(std::vector<std::uint8_t>{}));
+        {
+            InSequence s;
+            for (const auto& packet : record)
+            {
+                EXPECT_CALL(*conn, receive(_)).WillOnce(Return(std::vector<std::uint8_t>(packet.cbegin(), packet.cend()))).RetiresOnSaturation();
+            }
+        }
+
+        SetlistPlayer player{*m, {AmpSlot{7}, AmpSlot{7}}};
+        EXPECT_THAT(sent, ElementsAre(com::serializeLoadSlotCommand(7).getBytes()));
+
+        player.select(1);
+        EXPECT_THAT(player.current().name(), Eq("second"));
+        EXPECT_THAT(player.current().amp().amp_num, Eq(amps::METAL_2000));
+    }
+
+    TEST_F(SetlistTest, selectThrowsOnMissingFile)
+    {
+        SetlistPlayer player{*m, {(directory / "missing.fuse").string()}};
+
+        EXPECT_THROW(player.select(0), std::runtime_error);
+        EXPECT_THAT(player.position(), Eq(std::nullopt));
+        EXPECT_THAT(sent, IsEmpty());
+    }
+
+    TEST_F(SetlistTest, selectThrowsOnInvalidIndex)
+    {
+        SetlistPlayer player{*m, files()};
+
+        EXPECT_THROW(player.select(2), std::out_of_range);
+    }
+
+    TEST_F(SetlistTest, loadSetlistFileResolvesRelativePaths)
+    {
+        const auto path = (directory / "set.txt").string();
+        std::ofstream{path} << "first.fuse\n5\n";
+
+        const auto entries = loadSetlistFile(path, 100);
+        ASSERT_THAT(entries.size(), Eq(2));
+        EXPECT_THAT(std::get<std::string>(entries[0]), Eq((directory / "first.fuse").string()));
+        EXPECT_THAT(std::get<AmpSlot>(entries[1]).slot, Eq(4));
+    }
+}
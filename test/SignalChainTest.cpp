@@ -0,0 +1,148 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SignalChain.h"
+#include <cstring>
+#include <gmock/gmock.h>
+
+
+namespace plug::test
+{
+    using namespace testing;
+
+    class SignalChainTest : public testing::Test
+    {
+    protected:
+        const fx_pedal_settings effect{FxSlot{2}, effects::MONO_DELAY, 1, 2, 3, 4, 5, 6, true};
+    };
+
+    TEST_F(SignalChainTest, defaultIsEmpty)
+    {
+        const SignalChain chain{};
+        EXPECT_THAT(chain.name(), IsEmpty());
+        EXPECT_THAT(chain.effects(), IsEmpty());
+    }
+
+    TEST_F(SignalChainTest, holdsNameAmpAndEffects)
+    {
+        amp_settings amp{};
+        amp.gain = 0x12;
+        const SignalChain chain{"chain name", amp, {effect, effect}};
+
+        EXPECT_THAT(chain.name(), Eq("chain name"));
+        EXPECT_THAT(chain.amp().gain, Eq(0x12));
+        EXPECT_THAT(chain.effects().size(), Eq(2));
+        EXPECT_THAT(chain.effects()[1].knob6, Eq(6));
+    }
+
+    TEST_F(SignalChainTest, limitsNameLength)
+    {
+        const std::string name(40, 'x');
+        SignalChain chain{name, amp_settings{}, {}};
+        EXPECT_THAT(chain.name(), Eq(name.substr(0, 32)));
+
+        chain.setName("short");
+        EXPECT_THAT(chain.name(), Eq("short"));
+    }
+
+    TEST_F(SignalChainTest, effectsFromVector)
+    {
+        const std::vector<fx_pedal_settings> effects{effect, effect, effect};
+        const SignalChain chain{"", amp_settings{}, effects};
+        EXPECT_THAT(chain.effects().toVector(), Eq(effects));
+    }
+
+    TEST_F(SignalChainTest, throwsIfEffectsExceedCapacity)
+    {
+        const std::vector<fx_pedal_settings> effects(EffectList::capacity + 1, effect);
+        EXPECT_THROW((SignalChain{"", amp_settings{}, effects}), std::invalid_argument);
+    }
+
+    TEST_F(SignalChainTest, isCopiedBytewise)
+    {
+        const SignalChain chain{"copied", amp_settings{}, {effect}};
+        SignalChain copy{};
+        std::memcpy(&copy, &chain, sizeof(SignalChain));
+
+        EXPECT_THAT(copy.name(), Eq("copied"));
+        EXPECT_THAT(copy.effects(), ElementsAre(effect));
+    }
+
+    TEST_F(SignalChainTest, rawDataIsKeptOutsideOfChain)
+    {
+        RawPresetData raw{};
+        raw[1][3] = 0x42;
+        const SignalChain chain{"raw", amp_settings{}, {effect}, raw};
+        const SignalChain same{"other", amp_settings{}, {}, raw};
+        SignalChain copy{};
+        std::memcpy(&copy, &chain, sizeof(SignalChain));
+
+        EXPECT_THAT(copy.raw(), Optional(raw));
+        EXPECT_THAT(same.raw(), Optional(raw));
+        EXPECT_THAT(copy.isModified(ChainSection::amp), IsFalse());
+        EXPECT_THAT(SignalChain{}.raw(), Eq(std::nullopt));
+    }
+
+    TEST_F(SignalChainTest, rawDataOfOldestChainIsDroppedIfTableIsFull)
+    {
+        RawPresetData raw{};
+        raw[0][0] = 0xa5;
+        raw[0][1] = 0x5a;
+        const SignalChain oldest{"oldest", amp_settings{}, {}, raw};
+        raw[0][4] = 0x01;
+
+        for (std::uint32_t i = 0; i < detail::RawPresetTable::capacity; ++i)
+        {
+            raw[0][2] = static_cast<std::uint8_t>(i);
+            raw[0][3] = static_cast<std::uint8_t>(i >> 8);
+            static_cast<void>(SignalChain{"other", amp_settings{}, {}, raw});
+        }
+
+        EXPECT_THAT(oldest.raw(), Eq(std::nullopt));
+        EXPECT_THAT(oldest.isRawDropped(), IsTrue());
+        EXPECT_THAT(oldest.name(), Eq("oldest"));
+    }
+
+    TEST_F(SignalChainTest, rawDataOfChainWithUnknownIdsIsNeverDropped)
+    {
+        RawPresetData raw{};
+        raw[0][0] = 0x5a;
+        raw[0][1] = 0xa5;
+        amp_settings amp{};
+        amp.unknownModel = 0x99;
+        const SignalChain unknown{"unknown", amp, {}, raw};
+        raw[0][4] = 0x02;
+
+        for (std::uint32_t i = 0; i < detail::RawPresetTable::capacity * 2; ++i)
+        {
+            raw[0][2] = static_cast<std::uint8_t>(i);
+            raw[0][3] = static_cast<std::uint8_t>(i >> 8);
+            static_cast<void>(SignalChain{"other", amp_settings{}, {}, raw});
+        }
+
+        raw[0][2] = 0x00;
+        raw[0][3] = 0x00;
+        raw[0][4] = 0x00;
+        EXPECT_THAT(unknown.raw(), Optional(raw));
+        EXPECT_THAT(unknown.isRawDropped(), IsFalse());
+        EXPECT_THAT(SignalChain{}.isRawDropped(), IsFalse());
+    }
+
+}
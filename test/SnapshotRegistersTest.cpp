@@ -0,0 +1,108 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/SnapshotRegisters.h"
+#include "helper/SignalChains.h"
+#include <gmock/gmock.h>
+
+namespace plug::test
+{
+    using namespace plug::com;
+    using namespace testing;
+
+    class SnapshotRegistersTest : public testing::Test
+    {
+    protected:
+        SnapshotRegisters registers{4};
+    };
+
+    TEST_F(SnapshotRegistersTest, registersAreEmptyInitially)
+    {
+        EXPECT_THAT(registers.size(), Eq(4));
+        EXPECT_THAT(registers.isStored(0), IsFalse());
+        EXPECT_THAT(registers.active(), Eq(std::nullopt));
+        EXPECT_THAT(registers.recall(0), Eq(std::nullopt));
+        EXPECT_THAT(registers.toggle(), Eq(std::nullopt));
+    }
+
+    TEST_F(SnapshotRegistersTest, storeMakesRegisterActive)
+    {
+        registers.store(2, createChain("snapshot", 10));
+
+        EXPECT_THAT(registers.isStored(2), IsTrue());
+        EXPECT_THAT(registers.at(2).amp().gain, Eq(10));
+        EXPECT_THAT(registers.active(), Eq(2));
+    }
+
+    TEST_F(SnapshotRegistersTest, recallReturnsStoredChain)
+    {
+        registers.store(0, createChain("snapshot", 10));
+        registers.store(1, createChain("snapshot", 20));
+
+        const auto chain = registers.recall(0);
+
+        ASSERT_THAT(chain, Ne(std::nullopt));
+        EXPECT_THAT(chain->amp().gain, Eq(10));
+        EXPECT_THAT(registers.active(), Eq(0));
+    }
+
+    TEST_F(SnapshotRegistersTest, recallOfEmptyRegisterKeepsActive)
+    {
+        registers.store(1, createChain("snapshot", 20));
+
+        EXPECT_THAT(registers.recall(3), Eq(std::nullopt));
+        EXPECT_THAT(registers.active(), Eq(1));
+    }
+
+    TEST_F(SnapshotRegistersTest, toggleSwitchesBetweenStoredRegisters)
+    {
+        registers.store(0, createChain("snapshot", 10));
+        registers.store(2, createChain("snapshot", 30));
+
+        EXPECT_THAT(registers.toggle()->amp().gain, Eq(10));
+        EXPECT_THAT(registers.toggle()->amp().gain, Eq(30));
+        EXPECT_THAT(registers.toggle()->amp().gain, Eq(10));
+        EXPECT_THAT(registers.active(), Eq(0));
+    }
+
+    TEST_F(SnapshotRegistersTest, toggleWithSingleRegisterReturnsIt)
+    {
+        registers.store(3, createChain("snapshot", 40));
+
+        EXPECT_THAT(registers.toggle()->amp().gain, Eq(40));
+        EXPECT_THAT(registers.active(), Eq(3));
+    }
+
+    TEST_F(SnapshotRegistersTest, clearRemovesAllRegisters)
+    {
+        registers.store(0, createChain("snapshot", 10));
+        registers.clear();
+
+        EXPECT_THAT(registers.isStored(0), IsFalse());
+        EXPECT_THAT(registers.active(), Eq(std::nullopt));
+    }
+
+    TEST_F(SnapshotRegistersTest, invalidIndexThrows)
+    {
+        EXPECT_THROW(registers.store(4, createChain("snapshot", 10)), std::out_of_range);
+        EXPECT_THROW(registers.recall(4), std::out_of_range);
+        EXPECT_THROW(registers.at(0), std::out_of_range);
+    }
+}
@@ -0,0 +1,153 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/ThroughputProbe.h"
+#include "com/CommunicationException.h"
+#include "helper/SimulatedAmp.h"
+#include <filesystem>
+#include <fstream>
+#include <gmock/gmock.h>
+
+namespace plug::test
+{
+    using namespace plug::com;
+    using namespace testing;
+    using namespace std::chrono_literals;
+    namespace fs = std::filesystem;
+
+    class ThroughputProbeTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            file = (fs::temp_directory_path() / ("plug-ratelimits-test-" + std::string{::testing::UnitTest::GetInstance()->current_test_info()->name()})).string();
+        }
+
+        void TearDown() override
+        {
+            fs::remove(file);
+        }
+
+        ThroughputProbe createProbe(Connection& conn)
+        {
+            return ThroughputProbe{conn, [this]
+                                   { return time; },
+                                   [this](ThroughputProbe::Clock::time_point t)
+                                   { time = std::max(time, t); }};
+        }
+
+        SimulatedAmp::Clock::time_point time{};
+        std::string file;
+        const amp_settings amp{amps::FENDER_57_CHAMP, 1, 2, 3, 4, 5, cabinets::cab2x12C, 0, 0, 0, 0, 0, 0, 0, 0, false, 0};
+    };
+
+    TEST_F(ThroughputProbeTest, probeStopsAtFirstOverloadedRate)
+    {
+        SimulatedAmp sim{time, ModelVersion::v1, 1ms, 8ms};
+        auto probe = createProbe(sim);
+
+        const auto result = probe.run(amp);
+
+        ASSERT_THAT(result.steps.size(), Eq(7));
+        EXPECT_THAT(result.steps[5].sustained, IsTrue());
+        EXPECT_THAT(result.steps[6].sustained, IsFalse());
+        EXPECT_THAT(result.steps[6].timeouts, Eq(1));
+        EXPECT_THAT(result.limit.updatesPerSecond, DoubleEq(result.steps[5].updatesPerSecond * 0.8));
+        EXPECT_THAT(result.limit.ackLatency, Eq(2ms));
+        EXPECT_THAT(sim.dropped, Gt(0));
+    }
+
+    TEST_F(ThroughputProbeTest, probeMeasuresDeviceSpeed)
+    {
+        SimulatedAmp fast{time, ModelVersion::v2, 1ms, 1ms};
+        SimulatedAmp slow{time, ModelVersion::v1, 1ms, 30ms};
+        auto fastProbe = createProbe(fast);
+        auto slowProbe = createProbe(slow);
+
+        EXPECT_THAT(fastProbe.run(amp).limit.updatesPerSecond, Gt(slowProbe.run(amp).limit.updatesPerSecond));
+    }
+
+    TEST_F(ThroughputProbeTest, probeEndsAtMaxRate)
+    {
+        SimulatedAmp sim{time, ModelVersion::v1, 100us, 0ms};
+        auto probe = createProbe(sim);
+
+        const auto result = probe.run(amp, ProbeOptions{10.0, 100.0, 2.0, 5, 1.0});
+
+        EXPECT_THAT(result.steps.size(), Eq(4));
+        EXPECT_THAT(result.limit.updatesPerSecond, DoubleEq(80.0));
+        EXPECT_THAT(sim.dropped, Eq(0));
+    }
+
+    TEST_F(ThroughputProbeTest, probeThrowsIfNothingIsSustained)
+    {
+        SimulatedAmp sim{time, ModelVersion::v1, 1ms, 1s};
+        auto probe = createProbe(sim);
+
+        EXPECT_THROW(probe.run(amp), CommunicationException);
+    }
+
+    TEST_F(ThroughputProbeTest, probeRejectsInvalidOptions)
+    {
+        SimulatedAmp sim{time, ModelVersion::v1, 1ms, 1ms};
+        auto probe = createProbe(sim);
+
+        EXPECT_THROW(probe.run(amp, ProbeOptions{0.0, 100.0, 2.0, 5, 1.0}), std::invalid_argument);
+        EXPECT_THROW(probe.run(amp, ProbeOptions{10.0, 100.0, 1.0, 5, 1.0}), std::invalid_argument);
+    }
+
+    TEST_F(ThroughputProbeTest, rateLimitsDefaultToConservativeLimit)
+    {
+        const auto limits = RateLimits::load(file);
+
+        EXPECT_THAT(limits.get(ModelVersion::v1).updatesPerSecond, DoubleEq(defaultRateLimit.updatesPerSecond));
+        EXPECT_THAT(limits.get(ModelVersion::v2).updatesPerSecond, DoubleEq(defaultRateLimit.updatesPerSecond));
+    }
+
+    TEST_F(ThroughputProbeTest, rateLimitsAreStoredPerModelVersion)
+    {
+        RateLimits limits;
+        limits.set(ModelVersion::v2, RateLimit{120.5, 1500us});
+        limits.save(file);
+
+        const auto loaded = RateLimits::load(file);
+        EXPECT_THAT(loaded.get(ModelVersion::v1).updatesPerSecond, DoubleEq(defaultRateLimit.updatesPerSecond));
+        EXPECT_THAT(loaded.get(ModelVersion::v2).updatesPerSecond, DoubleEq(120.5));
+        EXPECT_THAT(loaded.get(ModelVersion::v2).ackLatency, Eq(1500us));
+    }
+
+    TEST_F(ThroughputProbeTest, rateLimitsRejectInvalidEntries)
+    {
+        std::ofstream{file} << "v3 100 0\n";
+        EXPECT_THROW(RateLimits::load(file), std::invalid_argument);
+
+        std::ofstream{file} << "v1 fast\n";
+        EXPECT_THROW(RateLimits::load(file), std::runtime_error);
+
+        RateLimits limits;
+        EXPECT_THROW(limits.set(ModelVersion::v1, RateLimit{0.0, 0us}), std::invalid_argument);
+    }
+
+    TEST_F(ThroughputProbeTest, rateLimitInterval)
+    {
+        const RateLimit limit{40.0, 0us};
+        EXPECT_THAT(limit.interval(), Eq(25ms));
+    }
+}
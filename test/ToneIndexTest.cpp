@@ -0,0 +1,106 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "library/ToneIndex.h"
+#include "helper/SignalChains.h"
+#include <gmock/gmock.h>
+
+namespace plug::test
+{
+    using namespace plug::library;
+    using namespace testing;
+
+    namespace
+    {
+        fx_pedal_settings createEffect(effects effect, std::uint8_t knob)
+        {
+            return fx_pedal_settings{FxSlot{0}, effect, knob, knob, knob, knob, knob, knob, true};
+        }
+    }
+
+
+    class ToneIndexTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            index.insert(0, createChain("", 200, {}, amps::BRITISH_80S));
+            index.insert(1, createChain("", 100, {}, amps::BRITISH_80S));
+            index.insert(2, createChain("", 200, {}, amps::FENDER_65_TWIN_REVERB));
+            index.insert(3, createChain("", 200, {createEffect(effects::MONO_DELAY, 50)}, amps::BRITISH_80S));
+        }
+
+        ToneIndex index;
+    };
+
+    TEST_F(ToneIndexTest, nearestOnEmptyIndex)
+    {
+        index.clear();
+        EXPECT_THAT(index.size(), Eq(0));
+        EXPECT_THAT(index.nearest(createChain("", 0, {}, amps::BRITISH_80S), 5), IsEmpty());
+    }
+
+    TEST_F(ToneIndexTest, nearestFindsIdenticalChain)
+    {
+        const auto matches = index.nearest(createChain("", 100, {}, amps::BRITISH_80S), 1);
+        ASSERT_THAT(matches.size(), Eq(1));
+        EXPECT_THAT(matches[0].id, Eq(1));
+        EXPECT_THAT(matches[0].distance, FloatEq(0.0f));
+    }
+
+    TEST_F(ToneIndexTest, nearestOrdersByDistance)
+    {
+        const auto matches = index.nearest(createChain("", 200, {}, amps::BRITISH_80S), 4);
+        ASSERT_THAT(matches.size(), Eq(4));
+        EXPECT_THAT(matches[0].id, Eq(0));
+        EXPECT_THAT(matches[1].id, Eq(1));
+        EXPECT_THAT(matches[2].id, Eq(3));
+        EXPECT_THAT(matches[3].id, Eq(2));
+        EXPECT_THAT(matches[1].distance, Le(matches[2].distance));
+    }
+
+    TEST_F(ToneIndexTest, nearestLimitsResults)
+    {
+        EXPECT_THAT(index.nearest(createChain("", 200, {}, amps::BRITISH_80S), 2).size(), Eq(2));
+        EXPECT_THAT(index.nearest(createChain("", 200, {}, amps::BRITISH_80S), 10).size(), Eq(4));
+    }
+
+    TEST_F(ToneIndexTest, nearestMatchesEffectsByFamily)
+    {
+        const auto matches = index.nearest(createChain("", 200, {createEffect(effects::MONO_DELAY, 60)}, amps::BRITISH_80S), 1);
+        ASSERT_THAT(matches.size(), Eq(1));
+        EXPECT_THAT(matches[0].id, Eq(3));
+    }
+
+    TEST_F(ToneIndexTest, encodeGroupsEffectsByFamily)
+    {
+        auto chain = createChain("", 0, {createEffect(effects::SMALL_HALL_REVERB, 255), createEffect(effects::OVERDRIVE, 0)}, amps::METAL_2000);
+        auto amp = chain.amp();
+        amp.cabinet = cabinets::cab4x12M;
+        chain.setAmp(amp);
+        const auto categories = ToneIndex::encodeCategories(chain);
+        const auto features = ToneIndex::encodeFeatures(chain);
+
+        EXPECT_THAT(categories, ElementsAre(value(amps::METAL_2000), value(cabinets::cab4x12M), value(effects::OVERDRIVE),
+                                            value(effects::EMPTY), value(effects::EMPTY), value(effects::SMALL_HALL_REVERB)));
+        EXPECT_THAT(features[ToneIndex::ampFeatures], FloatEq(0.0f));
+        EXPECT_THAT(features[ToneIndex::ampFeatures + 3 * 6], FloatEq(1.0f));
+    }
+}
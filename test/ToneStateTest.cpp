@@ -0,0 +1,110 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "com/ToneState.h"
+#include <gmock/gmock.h>
+
+namespace plug::test
+{
+    using namespace plug::com;
+    using namespace testing;
+
+    class ToneStateTest : public testing::Test
+    {
+    protected:
+        static amp_settings createAmp(std::uint8_t gain)
+        {
+            amp_settings amp{};
+            amp.amp_num = amps::BRITISH_80S;
+            amp.gain = gain;
+            amp.cabinet = cabinets::cab4x12G;
+            amp.sag = 1;
+            amp.brightness = true;
+            return amp;
+        }
+
+        const fx_pedal_settings chorus{FxSlot{1}, effects::SINE_CHORUS, 10, 20, 30, 40, 50, 0, false};
+    };
+
+    TEST_F(ToneStateTest, ampFieldsReturnsAmp)
+    {
+        ToneState state{{}};
+        setAmpFields(state, createAmp(33));
+
+        const auto amp = ampFields(state);
+        EXPECT_THAT(amp.amp_num, Eq(amps::BRITISH_80S));
+        EXPECT_THAT(amp.gain, Eq(33));
+        EXPECT_THAT(amp.cabinet, Eq(cabinets::cab4x12G));
+        EXPECT_THAT(amp.sag, Eq(1));
+        EXPECT_THAT(amp.brightness, IsTrue());
+    }
+
+    TEST_F(ToneStateTest, slotFieldsReturnsEffectOfSlot)
+    {
+        ToneState state{{}};
+        setSlotFields(state, chorus);
+
+        const auto effect = slotFields(state, FxSlot{1});
+        EXPECT_THAT(effect.slot.id(), Eq(1));
+        EXPECT_THAT(effect.effect_num, Eq(effects::SINE_CHORUS));
+        EXPECT_THAT(effect.knob1, Eq(10));
+        EXPECT_THAT(effect.knob5, Eq(50));
+        EXPECT_THAT(effect.enabled, IsFalse());
+    }
+
+    TEST_F(ToneStateTest, slotFieldsOfEmptySlotIsEmptyEffect)
+    {
+        ToneState state{{}};
+        setSlotFields(state, chorus);
+        setSlotFields(state, fx_pedal_settings{FxSlot{1}, effects::EMPTY, 0, 0, 0, 0, 0, 0, false});
+
+        const auto effect = slotFields(state, FxSlot{1});
+        EXPECT_THAT(effect.slot.id(), Eq(1));
+        EXPECT_THAT(effect.effect_num, Eq(effects::EMPTY));
+        EXPECT_THAT(effect.enabled, IsFalse());
+    }
+
+    TEST_F(ToneStateTest, unknownIdsAreKept)
+    {
+        auto amp = createAmp(33);
+        amp.unknownModel = 0x7f;
+        auto effect = chorus;
+        effect.unknownModel = 0xee;
+        effect.unknownSlot = 0x09;
+        const SignalChain chain{"unknown", amp, {effect}};
+
+        const auto result = fromToneState("unknown", toToneState(chain));
+        EXPECT_THAT(result.amp().unknownModel, Optional(0x7f));
+        EXPECT_THAT(result.amp().unknownCabinet, Eq(std::nullopt));
+        EXPECT_THAT(result.effects(), ElementsAre(effect));
+    }
+
+    TEST_F(ToneStateTest, knownSettingsClearUnknownIds)
+    {
+        auto amp = createAmp(33);
+        amp.unknownCabinet = 0x20;
+        ToneState state{{}};
+        setAmpFields(state, amp);
+        setAmpFields(state, createAmp(34));
+
+        EXPECT_THAT(ampFields(state).unknownCabinet, Eq(std::nullopt));
+    }
+}
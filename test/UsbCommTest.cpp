@@ -109,6 +109,30 @@ namespace plug::test
         EXPECT_THAT(received, Eq(data));
     }
 
+    TEST_F(UsbCommTest, receiveIntoReadsIntoBuffer)
+    {
+        EXPECT_CALL(*deviceMock, open());
+        EXPECT_CALL(*deviceMock, name());
+
+        std::array<std::uint8_t, 4> buffer{{}};
+        EXPECT_CALL(*deviceMock, read(0x81, buffer.data(), buffer.size())).WillOnce(Return(3));
+
+        UsbComm com = create();
+        EXPECT_THAT(com.receiveInto(buffer), Eq(3));
+    }
+
+    TEST_F(UsbCommTest, receiveWithinPassesTimeout)
+    {
+        EXPECT_CALL(*deviceMock, open());
+        EXPECT_CALL(*deviceMock, name());
+
+        std::vector<std::uint8_t> data{{0x00, 0xa1}};
+        EXPECT_CALL(*deviceMock, receive(0x81, data.size(), std::chrono::milliseconds{5})).WillOnce(Return(data));
+
+        UsbComm com = create();
+        EXPECT_THAT(com.receiveWithin(data.size(), std::chrono::milliseconds{5}), Eq(data));
+    }
+
     TEST_F(UsbCommTest, modelName)
     {
         EXPECT_CALL(*deviceMock, open());
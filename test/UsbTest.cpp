@@ -537,6 +537,50 @@ namespace plug::test
         EXPECT_THAT(device.receive(0x88, 99), SizeIs(0));
     }
 
+    TEST_F(UsbTest, readReadsIntoBuffer)
+    {
+        EXPECT_CALL(*usbmock, ref_device(_)).WillOnce(Return(&dev));
+        libusb_device_descriptor descr{};
+        EXPECT_CALL(*usbmock, get_device_descriptor(_, _)).WillOnce(DoAll(SetArgPointee<1>(descr), Return(LIBUSB_SUCCESS)));
+        EXPECT_CALL(*usbmock, unref_device(_));
+        EXPECT_CALL(*usbmock, open(_, _))
+            .WillOnce(DoAll(SetArgPointee<1>(handle), Return(LIBUSB_SUCCESS)));
+        EXPECT_CALL(*usbmock, set_auto_detach_kernel_driver(_, _)).WillOnce(Return(LIBUSB_SUCCESS));
+        EXPECT_CALL(*usbmock, claim_interface(_, _)).WillOnce(Return(LIBUSB_SUCCESS));
+        EXPECT_CALL(*usbmock, release_interface(_, _)).WillOnce(Return(LIBUSB_SUCCESS));
+        EXPECT_CALL(*usbmock, close(_));
+
+        std::array<std::uint8_t, 4> buffer{{}};
+        const std::array<std::uint8_t, 2> data{{0x10, 0x11}};
+        EXPECT_CALL(*usbmock, interrupt_transfer(handle, 0xcd, buffer.data(), buffer.size(), NotNull(), 500))
+            .WillOnce(DoAll(SetArrayArgument<2>(data.begin(), data.end()), SetArgPointee<4>(data.size()), Return(LIBUSB_SUCCESS)));
+
+        Device device{&dev};
+        device.open();
+        EXPECT_THAT(device.read(0xcd, buffer.data(), buffer.size()), Eq(2));
+        EXPECT_THAT(buffer[1], Eq(0x11));
+    }
+
+    TEST_F(UsbTest, receiveUsesTimeout)
+    {
+        EXPECT_CALL(*usbmock, ref_device(_)).WillOnce(Return(&dev));
+        libusb_device_descriptor descr{};
+        EXPECT_CALL(*usbmock, get_device_descriptor(_, _)).WillOnce(DoAll(SetArgPointee<1>(descr), Return(LIBUSB_SUCCESS)));
+        EXPECT_CALL(*usbmock, unref_device(_));
+        EXPECT_CALL(*usbmock, open(_, _))
+            .WillOnce(DoAll(SetArgPointee<1>(handle), Return(LIBUSB_SUCCESS)));
+        EXPECT_CALL(*usbmock, set_auto_detach_kernel_driver(_, _)).WillOnce(Return(LIBUSB_SUCCESS));
+        EXPECT_CALL(*usbmock, claim_interface(_, _)).WillOnce(Return(LIBUSB_SUCCESS));
+        EXPECT_CALL(*usbmock, release_interface(_, _)).WillOnce(Return(LIBUSB_SUCCESS));
+        EXPECT_CALL(*usbmock, close(_));
+
+        EXPECT_CALL(*usbmock, interrupt_transfer(handle, 0x81, NotNull(), 64, NotNull(), 5)).WillOnce(Return(LIBUSB_ERROR_TIMEOUT));
+
+        Device device{&dev};
+        device.open();
+        EXPECT_THAT(device.receive(0x81, 64, std::chrono::milliseconds{5}), SizeIs(0));
+    }
+
     TEST_F(UsbTest, receiveThrowsOnTransmitFailure)
     {
         EXPECT_CALL(*usbmock, ref_device(_)).WillOnce(Return(&dev));
@@ -0,0 +1,113 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "com/WriteBehindQueue.h"
+#include "helper/SignalChains.h"
+#include <gmock/gmock.h>
+
+namespace plug::test
+{
+    using namespace plug::com;
+    using namespace testing;
+
+    class WriteBehindQueueTest : public testing::Test
+    {
+    protected:
+        static fx_pedal_settings empty(std::uint8_t slot)
+        {
+            return fx_pedal_settings{FxSlot{slot}, effects::EMPTY, 0, 0, 0, 0, 0, 0, false};
+        }
+
+        WriteBehindQueue queue;
+        const fx_pedal_settings overdrive{FxSlot{0}, effects::OVERDRIVE, 1, 2, 3, 4, 5, 0, true};
+        const fx_pedal_settings fuzz{FxSlot{3}, effects::FUZZ, 6, 7, 8, 9, 10, 0, true};
+        const fx_pedal_settings delay{FxSlot{5}, effects::MONO_DELAY, 11, 12, 13, 14, 15, 16, true};
+    };
+
+    TEST_F(WriteBehindQueueTest, emptyQueueKeepsChain)
+    {
+        const auto chain = createChain("on amp", 5, {overdrive});
+
+        EXPECT_THAT(queue.empty(), IsTrue());
+        EXPECT_THAT(queue.apply(chain).amp(), Eq(chain.amp()));
+        EXPECT_THAT(queue.apply(chain).effects(), Eq(chain.effects()));
+    }
+
+    TEST_F(WriteBehindQueueTest, latestAmpEditWins)
+    {
+        queue.setAmplifier(createChain("on amp", 10).amp());
+        queue.setAmplifier(createChain("on amp", 20).amp());
+
+        EXPECT_THAT(queue.empty(), IsFalse());
+        EXPECT_THAT(queue.apply(createChain("on amp", 5)).amp().gain, Eq(20));
+        EXPECT_THAT(queue.apply(createChain("on amp", 5)).name(), Eq("on amp"));
+    }
+
+    TEST_F(WriteBehindQueueTest, latestEffectEditOfSlotWins)
+    {
+        auto changed = delay;
+        changed.knob1 = 99;
+        queue.setEffect(delay);
+        queue.setEffect(changed);
+
+        EXPECT_THAT(queue.apply(createChain("on amp", 5)).effects(), Eq(EffectList{changed}));
+    }
+
+    TEST_F(WriteBehindQueueTest, effectReplacesEffectOfSameDsp)
+    {
+        queue.setEffect(fuzz);
+
+        EXPECT_THAT(queue.apply(createChain("on amp", 5, {overdrive, delay})).effects(), Eq(EffectList{delay, fuzz}));
+    }
+
+    TEST_F(WriteBehindQueueTest, effectReplacesQueuedEffectOfSameDsp)
+    {
+        queue.setEffect(overdrive);
+        queue.setEffect(fuzz);
+
+        EXPECT_THAT(queue.apply(createChain("on amp", 5)).effects(), Eq(EffectList{fuzz}));
+    }
+
+    TEST_F(WriteBehindQueueTest, emptyEffectClearsSlot)
+    {
+        queue.setEffect(empty(5));
+
+        EXPECT_THAT(queue.apply(createChain("on amp", 5, {overdrive, delay})).effects(), Eq(EffectList{overdrive}));
+    }
+
+    TEST_F(WriteBehindQueueTest, signalChainReplacesAllSlots)
+    {
+        queue.setEffect(delay);
+        queue.setSignalChain(createChain("on amp", 30, {fuzz}));
+
+        const auto result = queue.apply(createChain("on amp", 5, {overdrive, delay}));
+        EXPECT_THAT(result.amp().gain, Eq(30));
+        EXPECT_THAT(result.effects(), Eq(EffectList{fuzz}));
+    }
+
+    TEST_F(WriteBehindQueueTest, clearDropsEdits)
+    {
+        queue.setAmplifier(createChain("on amp", 10).amp());
+        queue.setEffect(delay);
+        queue.clear();
+
+        EXPECT_THAT(queue.empty(), IsTrue());
+    }
+}
@@ -21,6 +21,7 @@
 
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <cstddef>
 
@@ -63,5 +64,47 @@ namespace plug::com
         // save fields
         inline constexpr std::size_t SAVE_SLOT{4};
         inline constexpr std::size_t FXKNOB{3};
+
+        // captured packets
+        using CapturedPacket = std::array<std::uint8_t, 64>;
+
+        inline constexpr CapturedPacket INIT_PACKET_0{{0x00, 0xc3}};
+        inline constexpr CapturedPacket INIT_PACKET_1{{0x1a, 0x03}};
+        inline constexpr CapturedPacket APPLY_PACKET{{0x1c, 0x03}};
+        inline constexpr CapturedPacket LOAD_PACKET{{0xff, 0xc1}};
+        inline constexpr CapturedPacket LOAD_SLOT_PACKET{{0x1c, 0x01, 0x01, 0x00, 0x00, 0x00, 0x01}};
+
+        // British 60s with all controls at zero and the noise gate off
+        inline constexpr CapturedPacket AMP_BRITISH_60S_PACKET{{0x1c, 0x03, 0x05, 0x00, 0x00, 0x00, 0x01, 0x01,
+                                                                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                                                0x61, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                                                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                                                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                                                0x80, 0x80, 0x00, 0x80, 0x07, 0x07, 0x07, 0x00,
+                                                                0x00, 0x00, 0x07, 0x00, 0x00, 0x01, 0x5e, 0x00,
+                                                                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}};
+
+        // amp model specific bytes, in order of the amps enum: amp id (16), unknown (40, 43),
+        // unknown amp specific (44, 45, 46, 50) and (54)
+        struct AmpModelBytes
+        {
+            std::uint8_t ampId;
+            std::uint8_t unknown;
+            std::uint8_t specific;
+            std::uint8_t last;
+        };
+
+        inline constexpr std::array<AmpModelBytes, 12> AMP_MODEL_BYTES{{{0x67, 0x80, 0x01, 0x53},
+                                                                        {0x64, 0x80, 0x02, 0x67},
+                                                                        {0x7c, 0x80, 0x0c, 0x00},
+                                                                        {0x53, 0x00, 0x03, 0x6a},
+                                                                        {0x6a, 0x80, 0x04, 0x61},
+                                                                        {0x75, 0x80, 0x05, 0x72},
+                                                                        {0x72, 0x80, 0x06, 0x79},
+                                                                        {0x61, 0x80, 0x07, 0x5e},
+                                                                        {0x79, 0x80, 0x0b, 0x7c},
+                                                                        {0x5e, 0x80, 0x09, 0x5d},
+                                                                        {0x5d, 0x80, 0x0a, 0x6d},
+                                                                        {0x6d, 0x80, 0x08, 0x75}}};
     }
 }
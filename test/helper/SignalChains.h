@@ -21,33 +21,18 @@
 
 #pragma once
 
-#include "data_structs.h"
-#include <QFile>
-#include <QXmlStreamReader>
-#include <vector>
-#include <memory>
+#include "SignalChain.h"
+#include <string_view>
+#include <cstdint>
 
-namespace plug
+namespace plug::test
 {
-    class LoadFromFile
+    // A chain with the gain and effects, the other amp settings are zero
+    inline SignalChain createChain(std::string_view name, std::uint8_t gain, const EffectList& effects = {}, amps model = amps::BRITISH_80S)
     {
-    public:
-        struct Settings
-        {
-            QString name;
-            std::vector<fx_pedal_settings> effects;
-            amp_settings amp;
-        };
-
-        explicit LoadFromFile(QFile* file);
-
-        Settings loadfile();
-
-    private:
-        QXmlStreamReader xml;
-
-        amp_settings parseAmp();
-        std::vector<fx_pedal_settings> parseFX();
-        QString parseFUSE();
-    };
+        amp_settings amp{};
+        amp.amp_num = model;
+        amp.gain = gain;
+        return SignalChain{name, amp, effects};
+    }
 }
@@ -0,0 +1,111 @@
+/*
+ * PLUG - software to operate Fender Mustang amplifier
+ *        Linux replacement for Fender FUSE software
+ *
+ * Copyright (C) 2017-2023  offa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "com/Connection.h"
+#include "com/PacketSerializer.h"
+#include <algorithm>
+#include <chrono>
+
+namespace plug::test
+{
+    // Amp model running on a virtual clock: every packet is acknowledged after ackDelay, but after
+    // an apply command the DSP is busy for settleTime and drops packets sent meanwhile. Receiving
+    // without an outstanding ack times out like the USB transfer does.
+    class SimulatedAmp : public plug::com::Connection
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        static constexpr Clock::duration timeout{std::chrono::milliseconds{500}};
+
+        SimulatedAmp(Clock::time_point& clock, plug::com::ModelVersion version, Clock::duration ackDelay, Clock::duration settleTime)
+            : time(clock), version_(version), ackDelay_(ackDelay), settleTime_(settleTime)
+        {
+        }
+
+        void close() override
+        {
+            open = false;
+        }
+
+        bool isOpen() const override
+        {
+            return open;
+        }
+
+        std::vector<std::uint8_t> receive(std::size_t recvSize) override
+        {
+            if (pendingAcks == 0)
+            {
+                time += timeout;
+                return {};
+            }
+
+            --pendingAcks;
+            time += ackDelay_;
+            return std::vector<std::uint8_t>(recvSize, 0x00);
+        }
+
+        std::vector<std::uint8_t> receiveWithin(std::size_t recvSize, std::chrono::milliseconds) override
+        {
+            return receive(recvSize);
+        }
+
+        std::string name() const override
+        {
+            return "Simulated Mustang";
+        }
+
+        plug::com::ModelVersion modelVersion() const override
+        {
+            return version_;
+        }
+
+        std::size_t dropped{0};
+
+    private:
+        std::size_t sendImpl(std::uint8_t* data, std::size_t size) override
+        {
+            if (time < busyUntil)
+            {
+                ++dropped;
+                return size;
+            }
+
+            ++pendingAcks;
+
+            if (const auto apply = plug::com::serializeApplyCommand().getBytes(); std::equal(apply.cbegin(), apply.cend(), data))
+            {
+                busyUntil = time + ackDelay_ + settleTime_;
+            }
+            return size;
+        }
+
+        Clock::time_point& time;
+        const plug::com::ModelVersion version_;
+        const Clock::duration ackDelay_;
+        const Clock::duration settleTime_;
+        Clock::time_point busyUntil{};
+        std::size_t pendingAcks{0};
+        bool open{true};
+    };
+}
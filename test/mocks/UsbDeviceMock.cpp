@@ -128,9 +128,19 @@ namespace plug::com::usb
         return plug::test::mock::usbDeviceMock->write(endpoint, data, dataSize);
     }
 
+    std::size_t Device::read(std::uint8_t endpoint, std::uint8_t* data, std::size_t dataSize)
+    {
+        return plug::test::mock::usbDeviceMock->read(endpoint, data, dataSize);
+    }
+
     std::vector<std::uint8_t> Device::receive(std::uint8_t endpoint, std::size_t dataSize)
     {
         return plug::test::mock::usbDeviceMock->receive(endpoint, dataSize);
     }
 
+    std::vector<std::uint8_t> Device::receive(std::uint8_t endpoint, std::size_t dataSize, std::chrono::milliseconds timeout)
+    {
+        return plug::test::mock::usbDeviceMock->receive(endpoint, dataSize, timeout);
+    }
+
 }